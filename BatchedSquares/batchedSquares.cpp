@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// batchedSquares.cpp
+// (modifying experimentTwoSquares.cpp)
+//
+// This program draws the red and green squares of experimentTwoSquares.cpp through the
+// quad batch renderer of quadBatch.h rather than one glBegin(GL_POLYGON) block each.
+// The squares are written into a streaming vertex buffer with a color per vertex
+// and drawn by a single call, in the order they were added.
+//
+// To measure driver overhead, the two squares can be replaced by any number of
+// rectangles with colored corners scattered over the glOrtho(0, 100, 0, 100) space,
+// drawn either batched or in immediate mode. The benchmark draws 1,000 to 4,000,000
+// rectangles a frame both ways and writes the frame times to the C++ window; while
+// drawing interactively, the number of rectangles, the time to submit them and the
+// number of draws are shown in the window.
+//
+// Interaction:
+// Press m to toggle between batched and immediate mode drawing.
+// Press +/- to multiply/divide the number of rectangles by 10 (0 for the two squares).
+// Press b to run the benchmark.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/demoHooks.h"
+#include "../Common/quadBatch.h"
+
+// A rectangle of the scene.
+struct Rect
+{
+	float x0, y0, x1, y1;
+	unsigned char colors[4][4];
+};
+
+// Globals.
+static int isBatched = 1; // Draw batched?
+static int numRects = 0; // Number of rectangles, 0 for the two squares.
+static std::vector<Rect> rects; // The rectangles.
+static QuadBatch batch; // Quad batch renderer.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to create numRects random rectangles of sizes up to 5 x 5 with random corner colors.
+void createRects(void)
+{
+	rects.resize(numRects);
+	for (int i = 0; i < numRects; i++)
+	{
+		Rect &r = rects[i];
+		r.x0 = 95.0 * rand() / RAND_MAX;
+		r.y0 = 95.0 * rand() / RAND_MAX;
+		r.x1 = r.x0 + 0.5 + 4.5 * rand() / RAND_MAX;
+		r.y1 = r.y0 + 0.5 + 4.5 * rand() / RAND_MAX;
+		for (int j = 0; j < 4; j++)
+		{
+			for (int k = 0; k < 3; k++) r.colors[j][k] = rand() & 0xFF;
+			r.colors[j][3] = 255;
+		}
+	}
+}
+
+// Routine to draw the scene: two squares or the rectangles, batched or immediate.
+void drawRects(void)
+{
+	if (numRects == 0)
+	{
+		if (isBatched)
+		{
+			// Draw a large red square, then a smaller green square.
+			batch.addQuad(20.0, 20.0, 80.0, 80.0, 1.0, 0.0, 0.0);
+			batch.addQuad(40.0, 40.0, 60.0, 60.0, 0.0, 1.0, 0.0);
+			batch.flush();
+		}
+		else
+		{
+			// Draw a large red square.
+			glColor3f(1.0, 0.0, 0.0);
+			glBegin(GL_POLYGON);
+			glVertex3f(20.0, 20.0, 0.0);
+			glVertex3f(80.0, 20.0, 0.0);
+			glVertex3f(80.0, 80.0, 0.0);
+			glVertex3f(20.0, 80.0, 0.0);
+			glEnd();
+
+			// Draw a smaller green square.
+			glColor3f(0.0, 1.0, 0.0);
+			glBegin(GL_POLYGON);
+			glVertex3f(40.0, 40.0, 0.0);
+			glVertex3f(60.0, 40.0, 0.0);
+			glVertex3f(60.0, 60.0, 0.0);
+			glVertex3f(40.0, 60.0, 0.0);
+			glEnd();
+		}
+		return;
+	}
+
+	if (isBatched)
+	{
+		for (int i = 0; i < numRects; i++)
+			batch.addQuad(rects[i].x0, rects[i].y0, rects[i].x1, rects[i].y1, rects[i].colors);
+		batch.flush();
+	}
+	else
+	{
+		for (int i = 0; i < numRects; i++)
+		{
+			const Rect &r = rects[i];
+			glBegin(GL_POLYGON);
+			glColor4ubv(r.colors[0]);
+			glVertex3f(r.x0, r.y0, 0.0);
+			glColor4ubv(r.colors[1]);
+			glVertex3f(r.x1, r.y0, 0.0);
+			glColor4ubv(r.colors[2]);
+			glVertex3f(r.x1, r.y1, 0.0);
+			glColor4ubv(r.colors[3]);
+			glVertex3f(r.x0, r.y1, 0.0);
+			glEnd();
+		}
+	}
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	char text[128];
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	PROFILE_PHASE("rectangles");
+	batch.resetCounters();
+	auto start = std::chrono::high_resolution_clock::now();
+	drawRects();
+	double millis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	PROFILE_PHASE("text");
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(text, "%d rectangles %s: submitted in %.2f ms, %d draws", numRects ? numRects : 2,
+		isBatched ? "batched" : "immediate", millis, isBatched ? batch.numDraws : (numRects ? numRects : 2));
+	glRasterPos3f(2.0, 2.0, 0.0);
+	writeBitmapString((void*)font, text);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Routine to time drawing 1,000 to 4,000,000 rectangles a frame, batched and immediate.
+void benchmark(void)
+{
+	const int counts[] = { 1000, 10000, 100000, 1000000, 4000000 };
+	const int frames = 10;
+	int savedNumRects = numRects, savedIsBatched = isBatched;
+
+	std::cout << "Rectangles, immediate ms/frame, batched ms/frame, batched Mrects/s:" << std::endl;
+	for (int c = 0; c < 5; c++)
+	{
+		double millis[2];
+		numRects = counts[c];
+		createRects();
+		for (isBatched = 0; isBatched <= 1; isBatched++)
+		{
+			drawRects(); // Warm up.
+			glFinish();
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int f = 0; f < frames; f++)
+			{
+				glClear(GL_COLOR_BUFFER_BIT);
+				drawRects();
+			}
+			glFinish();
+			millis[isBatched] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / frames;
+		}
+		std::cout << counts[c] << ", " << millis[0] << ", " << millis[1] << ", "
+			<< counts[c] / (1000.0 * millis[1]) << std::endl;
+	}
+
+	numRects = savedNumRects;
+	isBatched = savedIsBatched;
+	createRects();
+	glutPostRedisplay();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	batch.init();
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'm':
+		if (isBatched) isBatched = 0; else isBatched = 1;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (numRects == 0) numRects = 1;
+		else if (numRects < 10000000) numRects *= 10;
+		createRects();
+		glutPostRedisplay();
+		break;
+	case '-':
+		numRects /= 10;
+		createRects();
+		glutPostRedisplay();
+		break;
+	case 'b':
+		benchmark();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press m to toggle between batched and immediate mode drawing." << std::endl
+		<< "Press +/- to multiply/divide the number of rectangles by 10 (0 for the two squares)." << std::endl
+		<< "Press b to run the benchmark." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("batchedSquares.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
@@ -3,97 +3,33 @@
 //
 // This program draws a wire box.
 //
+// The torso and head can be picked with the mouse by ray casting (picking.h);
+// the part picked turns red.
+//
+// Interaction:
+// Click the left mouse button on the torso or head to pick it.
+//
+// The box's globals and routines are those of the unit Box (box.h), which the
+// launcher runs too.
+//
 // Sumanta Guha.
 /////////////////////////////////
 
-#include <iostream>
-
 #include <GL/glew.h>
 #include <GL/freeglut.h> 
 
-static float X = 0.0;
-static float Y = 0.0;
-static float Z = -15.0;
-
-// Drawing routine.
-void drawScene(void)
-{
-	glClear(GL_COLOR_BUFFER_BIT);
-	glColor3f(0.0, 0.0, 0.0);
+#define DEMO_GL_TRACE
+#include "../Common/demoHooks.h"
+#include "box.h"
 
-	glLoadIdentity();
-
-	glTranslatef(0.0, 0.0, -15.0);
-
-	//glPushMatrix();
-	glScalef(1.0, 2.0, 1.0);
-	glutWireCube(5.0); // Box torso.
-	//glPopMatrix();
-	
-	glTranslatef(0.0, 7.0, 0.0);
-	glutWireSphere(2.0, 10, 8); // Spherical head.
-
-	glFlush();
-}
-
-// Initialization routine.
-void setup(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-}
-
-// OpenGL window reshape routine.
-void resize(int w, int h)
-{
-	glViewport(0, 0, w, h);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
-
-	glMatrixMode(GL_MODELVIEW);
-}
-
-// Keyboard input processing routine.
-void keyInput(unsigned char key, int x, int y)
-{
-	switch (key)
-	{
-	case 27:
-		exit(0);
-		break;
-	case 'a':
-		X+=0.5;
-		glutPostRedisplay();
-		break;
-	case 'd':
-		X -= 0.5;
-		glutPostRedisplay();
-		break;
-	case 's':
-		Y -= 0.5;
-		glutPostRedisplay();
-		break;
-	case 'w':
-		Y += 0.5;
-		glutPostRedisplay();
-		break;
-	case 'q':
-		Z -= 0.5;
-		glutPostRedisplay();
-		break;
-	case 'e':
-		Z += 0.5;
-		glutPostRedisplay();
-		break;
-	default:
-		break;
-	}
-}
+static Box box; // The demo.
 
 // Main routine.
 int main(int argc, char **argv)
 {
+	box.printInteraction();
 	glutInit(&argc, argv);
+	demoInit(&argc, argv);
 
 	glutInitContextVersion(4, 3);
 	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
@@ -102,14 +38,9 @@ int main(int argc, char **argv)
 	glutInitWindowSize(500, 500);
 	glutInitWindowPosition(100, 100);
 	glutCreateWindow("box.cpp");
-	glutDisplayFunc(drawScene);
-	glutReshapeFunc(resize);
-	glutKeyboardFunc(keyInput);
-
-	glewExperimental = GL_TRUE;
-	glewInit();
+	demoUnitCallbacks(&box);
 
-	setup();
+	demoSetup(&box);
 
 	glutMainLoop();
 }
@@ -0,0 +1,143 @@
+/////////////////////////////////
+// box.h
+//
+// The wire box of box.cpp as a demo unit (demoUnit.h): its globals and routines,
+// run by box.cpp and by the launcher.
+/////////////////////////////////
+
+#ifndef BOX_H
+#define BOX_H
+
+#include <cstdlib>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+#include "../Common/picking.h"
+
+class Box : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void mouseControl(int button, int state, int x, int y);
+	void printInteraction(void);
+
+	enum { TORSO, HEAD }; // Parts.
+
+	float X = 0.0;
+	float Y = 0.0;
+	float Z = -15.0;
+	PickScene pickScene; // Parts drawn in the last frame.
+	int picked = -1; // Part picked, -1 if none.
+	const char *partNames[2] = { "torso", "head" };
+};
+
+// Drawing routine.
+inline void Box::drawScene(void)
+{
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+
+	glLoadIdentity();
+	pickScene.clear();
+
+	glTranslatef(0.0, 0.0, -15.0);
+
+	PROFILE_PHASE("torso");
+	//glPushMatrix();
+	glScalef(1.0, 2.0, 1.0);
+	glColor3f(picked == TORSO ? 1.0 : 0.0, 0.0, 0.0);
+	glutWireCube(5.0); // Box torso.
+	pickScene.add(TORSO, pickCube(5.0));
+	//glPopMatrix();
+
+	PROFILE_PHASE("head");
+	glTranslatef(0.0, 7.0, 0.0);
+	glColor3f(picked == HEAD ? 1.0 : 0.0, 0.0, 0.0);
+	glutWireSphere(2.0, 10, 8); // Spherical head.
+	pickScene.add(HEAD, pickSphere(2.0, 10, 8));
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+inline void Box::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void Box::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+inline void Box::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'a':
+		X+=0.5;
+		glutPostRedisplay();
+		break;
+	case 'd':
+		X -= 0.5;
+		glutPostRedisplay();
+		break;
+	case 's':
+		Y -= 0.5;
+		glutPostRedisplay();
+		break;
+	case 'w':
+		Y += 0.5;
+		glutPostRedisplay();
+		break;
+	case 'q':
+		Z -= 0.5;
+		glutPostRedisplay();
+		break;
+	case 'e':
+		Z += 0.5;
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Mouse callback routine.
+inline void Box::mouseControl(int button, int state, int x, int y)
+{
+	if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN)
+	{
+		picked = pickScene.pick(x, y);
+		std::cout << "Picked " << (picked >= 0 ? partNames[picked] : "nothing") << " in " << pickScene.pickMicros
+			<< " us, hierarchy of " << pickScene.numObjects() << " parts built in " << pickScene.buildMicros << " us" << std::endl;
+		glutPostRedisplay();
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void Box::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Click the left mouse button on the torso or head to pick it." << std::endl;
+}
+
+#endif
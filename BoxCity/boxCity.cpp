@@ -0,0 +1,469 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// boxCity.cpp
+//
+// This program enhances box.cpp to draw a whole city of the box figures (a box torso
+// with a spherical head), laid out on a square grid, viewed through the glFrustum()
+// of box.cpp. The X, Y, Z globals of box.cpp move the viewer.
+//
+// The figures are culled against the viewing frustum with the bounding volume
+// hierarchy of bvh.h, only those not entirely outside being drawn. When the figures
+// walk, the hierarchy is refitted incrementally: just the nodes above the figures
+// that moved are updated.
+//
+// Clicking picks a figure with the same hierarchy: the ray through the mouse is
+// cast against it, and only figures whose box the ray enters have their torso and
+// head tested triangle by triangle (picking.h). The nearest figure hit turns red.
+//
+// Interaction:
+// Press a/d, w/s, q/e to move the viewer left/right, up/down, forward/back.
+// Press the left/right arrow keys to turn the viewer.
+// Press space to toggle between walking figures on and off.
+// Press c to toggle culling on and off.
+// Press +/- to double/halve the number of figures.
+// Press r to rebuild the hierarchy.
+// Press b to time culling and picking with the hierarchy against testing every figure.
+// Click the left mouse button on a figure to pick it.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/bvh.h"
+#include "../Common/picking.h"
+#include "../Common/demoHooks.h"
+
+#define SPACING 15.0 // Distance between neighbouring figures.
+#define WALK_RADIUS 3.0 // Radius of the circle a walking figure follows.
+#define FIGURE_RADIUS 12.03 // Radius of the bounding sphere of a figure.
+
+// Globals.
+static float X = 0.0;
+static float Y = -5.0;
+static float Z = -15.0;
+static float yaw = 0.0; // Turn of the viewer.
+static int numFigures = 65536; // Number of figures.
+static int isAnimate = 0; // Figures walking?
+static int isCulled = 1; // Culling on?
+static float walkAngle = 0.0; // Angle of the walking figures on their circles.
+static std::vector<float> homeX, homeZ; // Grid position of each figure.
+static std::vector<float> posX, posZ; // Current position of each figure.
+static Bvh bvh; // Hierarchy over the figures.
+static std::vector<int> visible; // Figures to draw.
+static CullStats stats; // Statistics of the last cull.
+static int refitted = 0; // Nodes refitted in the last frame.
+static double cullMicros = 0.0, refitMicros = 0.0; // Times of the last frame.
+static int picked = -1; // Figure picked, -1 if none.
+static const char *pickedPart = ""; // Part of it hit.
+static double pickMicros = 0.0; // Time of the last pick.
+static RayStats pickStats; // Statistics of the last pick.
+static char theStringBuffer[128]; // String buffer.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to compute the box and bounding sphere of the figure at (x, 0, z): the
+// torso is a 5 x 10 x 5 box centered there, the head a sphere of radius 2 scaled
+// by 2 in y centered at y = 14.
+void figureBounds(float x, float z, Aabb &box, float &cy)
+{
+	box.min[0] = x - 2.5; box.max[0] = x + 2.5;
+	box.min[1] = -5.0; box.max[1] = 18.0;
+	box.min[2] = z - 2.5; box.max[2] = z + 2.5;
+	cy = 6.5;
+}
+
+// Routine to build the hierarchy over the figures at their current positions.
+void buildHierarchy(void)
+{
+	std::vector<Aabb> boxes(numFigures);
+	std::vector<float> sx(posX), sy(numFigures), sz(posZ), sr(numFigures, FIGURE_RADIUS);
+
+	for (int i = 0; i < numFigures; i++) figureBounds(posX[i], posZ[i], boxes[i], sy[i]);
+	bvh.build(boxes, sx, sy, sz, sr);
+}
+
+// Routine to lay out the city and build the hierarchy.
+void createCity(void)
+{
+	int side = (int)ceil(sqrt((float)numFigures));
+
+	homeX.resize(numFigures); homeZ.resize(numFigures);
+	posX.resize(numFigures); posZ.resize(numFigures);
+	for (int i = 0; i < numFigures; i++)
+	{
+		homeX[i] = posX[i] = SPACING * (i % side - 0.5 * (side - 1));
+		homeZ[i] = posZ[i] = -SPACING * (i / side);
+	}
+	buildHierarchy();
+	picked = -1;
+}
+
+// Routine to move every fourth figure along its circle and refit the hierarchy.
+void walk(void)
+{
+	Aabb box;
+	float cy;
+
+	walkAngle += 5.0;
+	if (walkAngle > 360.0) walkAngle -= 360.0;
+	for (int i = 0; i < numFigures; i += 4)
+	{
+		float a = (M_PI / 180.0) * (walkAngle + i);
+		posX[i] = homeX[i] + WALK_RADIUS * cos(a);
+		posZ[i] = homeZ[i] + WALK_RADIUS * sin(a);
+		figureBounds(posX[i], posZ[i], box, cy);
+		bvh.update(i, box, posX[i], cy, posZ[i], FIGURE_RADIUS);
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	refitted = bvh.refit();
+	refitMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Routine to compute the frustum from the current projection and modelview matrices.
+void currentFrustum(Frustum &f)
+{
+	float p[16], mv[16], m[16];
+
+	glGetFloatv(GL_PROJECTION_MATRIX, p);
+	glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+	for (int c = 0; c < 4; c++)
+		for (int r = 0; r < 4; r++)
+			m[4 * c + r] = p[r] * mv[4 * c] + p[4 + r] * mv[4 * c + 1] + p[8 + r] * mv[4 * c + 2] + p[12 + r] * mv[4 * c + 3];
+	f.fromMatrix(m);
+}
+
+// Routine to load the viewer's transformation into the modelview matrix.
+void placeViewer(void)
+{
+	glLoadIdentity();
+	glRotatef(yaw, 0.0, 1.0, 0.0);
+	glTranslatef(X, Y, Z);
+}
+
+// Routine to return the t at which the ray hits the torso or head of figure i, or
+// tMax if neither is hit before tMax, setting part to the part hit.
+float figureHit(int i, const Ray &ray, float tMax, const char *&part)
+{
+	// Inverses of the torso's translate-and-scale and of the head's further translate.
+	float torso[16] = { 1.0, 0.0, 0.0, 0.0, 0.0, 0.5, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, -posX[i], 0.0, -posZ[i], 1.0 };
+	float head[16] = { 1.0, 0.0, 0.0, 0.0, 0.0, 0.5, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, -posX[i], -7.0, -posZ[i], 1.0 };
+	float t = pickHit(pickCube(5.0), torso, ray, tMax);
+	if (t < tMax)
+	{
+		tMax = t;
+		part = "torso";
+	}
+	t = pickHit(pickSphere(2.0, 10, 8), head, ray, tMax);
+	if (t < tMax)
+	{
+		tMax = t;
+		part = "head";
+	}
+	return tMax;
+}
+
+// Routine to make the ray through the pixel (x, y) in world space.
+void worldRay(int x, int y, Ray &ray)
+{
+	double view[16];
+
+	glPushMatrix();
+	placeViewer();
+	glGetDoublev(GL_MODELVIEW_MATRIX, view);
+	glPopMatrix();
+	pickRay(x, y, view, ray);
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	Frustum f;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+
+	placeViewer();
+
+	PROFILE_PHASE("cull");
+	// Cull, or submit every figure.
+	visible.clear();
+	if (isCulled)
+	{
+		currentFrustum(f);
+		auto start = std::chrono::high_resolution_clock::now();
+		bvh.cull(f, visible, stats);
+		cullMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	else
+	{
+		for (int i = 0; i < numFigures; i++) visible.push_back(i);
+		stats.nodesVisited = stats.spheresTested = 0;
+		cullMicros = 0.0;
+	}
+
+	PROFILE_PHASE("figures");
+	for (size_t k = 0; k < visible.size(); k++)
+	{
+		int i = visible[k];
+		if (i == picked) glColor3f(1.0, 0.0, 0.0);
+		glPushMatrix();
+		glTranslatef(posX[i], 0.0, posZ[i]);
+		glScalef(1.0, 2.0, 1.0);
+		glutWireCube(5.0); // Box torso.
+		glTranslatef(0.0, 7.0, 0.0);
+		glutWireSphere(2.0, 10, 8); // Spherical head.
+		glPopMatrix();
+		if (i == picked) glColor3f(0.0, 0.0, 0.0);
+	}
+
+	PROFILE_PHASE("text");
+	// Write the statistics.
+	sprintf(theStringBuffer, "%d of %d figures drawn, %s", (int)visible.size(), numFigures, isCulled ? "culled" : "not culled");
+	glWindowPos2i(5, 35);
+	writeBitmapString((void*)font, theStringBuffer);
+	sprintf(theStringBuffer, "Cull %.1f us: %d of %d nodes, %d spheres", cullMicros, stats.nodesVisited, bvh.numNodes(), stats.spheresTested);
+	glWindowPos2i(5, 20);
+	writeBitmapString((void*)font, theStringBuffer);
+	sprintf(theStringBuffer, "Refit %.1f us: %d nodes", refitMicros, refitted);
+	glWindowPos2i(5, 5);
+	writeBitmapString((void*)font, theStringBuffer);
+	if (picked >= 0) sprintf(theStringBuffer, "Picked figure %d, %s, in %.1f us: %d nodes, %d figures", picked, pickedPart,
+		pickMicros, pickStats.nodesVisited, pickStats.itemsTested);
+	else sprintf(theStringBuffer, "Nothing picked");
+	glWindowPos2i(5, 50);
+	writeBitmapString((void*)font, theStringBuffer);
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Routine to time culling with the hierarchy against testing every figure's sphere,
+// and picking at the center of the window with it against testing every figure's box.
+void benchmark(void)
+{
+	const int repeats = 100;
+	Frustum f;
+	std::vector<int> result;
+	CullStats s;
+
+	placeViewer();
+	currentFrustum(f);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		result.clear();
+		bvh.cull(f, result, s);
+	}
+	double tree = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+	size_t treeVisible = result.size();
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		result.clear();
+		bvh.cullBruteForce(f, result);
+	}
+	double brute = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+
+	std::cout << numFigures << " figures: hierarchy " << tree << " us (" << treeVisible << " visible), every sphere "
+		<< brute << " us (" << result.size() << " visible)" << std::endl;
+
+	Ray ray;
+	RayStats r;
+	const char *part;
+	float t;
+	int hit;
+	worldRay(glutGet(GLUT_WINDOW_WIDTH) / 2, glutGet(GLUT_WINDOW_HEIGHT) / 2, ray);
+	auto test = [&ray, &part](int i, float tMax) { return figureHit(i, ray, tMax, part); };
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		t = 1.0;
+		hit = bvh.intersect(ray, t, test, r);
+	}
+	tree = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+	int treeHit = hit;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		t = 1.0;
+		hit = bvh.intersectBruteForce(ray, t, test);
+	}
+	brute = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+
+	std::cout << 2 * numFigures << " parts: pick with hierarchy " << tree << " us (figure " << treeHit << "), every box "
+		<< brute << " us (figure " << hit << ")" << std::endl;
+}
+
+// Mouse callback routine.
+void mouseControl(int button, int state, int x, int y)
+{
+	if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN)
+	{
+		Ray ray;
+		float t = 1.0; // Far plane.
+		auto start = std::chrono::high_resolution_clock::now();
+		worldRay(x, y, ray);
+		picked = bvh.intersect(ray, t, [&ray](int i, float tMax) { return figureHit(i, ray, tMax, pickedPart); }, pickStats);
+		pickMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		glutPostRedisplay();
+	}
+}
+
+// Timer function.
+void animate(int value)
+{
+	if (isAnimate)
+	{
+		walk();
+
+		glutPostRedisplay();
+		glutTimerFunc(50, animate, 1);
+	}
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	createCity();
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'a':
+		X += 0.5;
+		break;
+	case 'd':
+		X -= 0.5;
+		break;
+	case 's':
+		Y += 0.5;
+		break;
+	case 'w':
+		Y -= 0.5;
+		break;
+	case 'q':
+		Z -= 0.5;
+		break;
+	case 'e':
+		Z += 0.5;
+		break;
+	case ' ':
+		if (isAnimate) isAnimate = 0;
+		else
+		{
+			isAnimate = 1;
+			animate(1);
+		}
+		break;
+	case 'c':
+		if (isCulled) isCulled = 0; else isCulled = 1;
+		break;
+	case '+':
+		if (numFigures < (1 << 22)) numFigures *= 2;
+		createCity();
+		break;
+	case '-':
+		if (numFigures > 1) numFigures /= 2;
+		createCity();
+		break;
+	case 'r':
+		buildHierarchy();
+		break;
+	case 'b':
+		benchmark();
+		break;
+	default:
+		break;
+	}
+	glutPostRedisplay();
+}
+
+// Callback routine for non-ASCII key entry.
+void specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_LEFT) yaw -= 5.0;
+	if (key == GLUT_KEY_RIGHT) yaw += 5.0;
+	glutPostRedisplay();
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press a/d, w/s, q/e to move the viewer left/right, up/down, forward/back." << std::endl
+		<< "Press the left/right arrow keys to turn the viewer." << std::endl
+		<< "Press space to toggle between walking figures on and off." << std::endl
+		<< "Press c to toggle culling on and off." << std::endl
+		<< "Press +/- to double/halve the number of figures." << std::endl
+		<< "Press r to rebuild the hierarchy." << std::endl
+		<< "Press b to time culling and picking with the hierarchy against testing every figure." << std::endl
+		<< "Click the left mouse button on a figure to pick it." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("boxCity.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+	glutSpecialFunc(specialKeyInput);
+	glutMouseFunc(mouseControl);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// circularAnnuluses.h
+//
+// The three circular annuluses of circularAnnuluses.cpp as a demo unit (demoUnit.h):
+// its globals and routines, run by circularAnnuluses.cpp and by the launcher.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CIRCULAR_ANNULUSES_H
+#define CIRCULAR_ANNULUSES_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+
+class CircularAnnuluses : public DemoUnit
+{
+public:
+	void writeBitmapString(void *font, char *string);
+	void drawDisc(float R, float X, float Y, float Z);
+	void drawScene(void);
+	void build(void);
+	void setup(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void printInteraction(void);
+
+	// Globals.
+	int N = 40; // Number of vertices on the boundary of the disc.
+	int isWire = 0; // Is wireframe?
+	long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+};
+
+// Routine to draw a bitmap character string.
+inline void CircularAnnuluses::writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Function to draw a disc with center at (X, Y, Z), radius R, parallel to the xy-plane.
+inline void CircularAnnuluses::drawDisc(float R, float X, float Y, float Z)
+{
+	float t;
+	int i;
+
+	glBegin(GL_TRIANGLE_FAN);
+	glVertex3f(X, Y, Z);
+	for (i = 0; i <= N; ++i)
+	{
+		t = 2 * M_PI * i / N;
+		glVertex3f(X + cos(t) * R, Y + sin(t) * R, Z);
+	}
+	glEnd();
+}
+
+// Drawing routine.
+inline void CircularAnnuluses::drawScene(void)
+{
+	float angle;
+	int i;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the buffers including the depth buffer.
+	glPolygonMode(GL_FRONT, GL_FILL);
+
+	PROFILE_PHASE("discs");
+	// Upper left circular annulus: the white disc overwrites the red disc.
+	glColor3f(1.0, 0.0, 0.0);
+	drawDisc(20.0, 25.0, 75.0, 0.0);
+	glColor3f(1.0, 1.0, 1.0);
+	drawDisc(10.0, 25.0, 75.0, 0.0);
+
+	// Upper right circular annulus: the white disc is in front of the red disc blocking it.
+	glEnable(GL_DEPTH_TEST); // Enable depth testing. 
+	glColor3f(1.0, 0.0, 0.0);
+	drawDisc(20.0, 75.0, 75.0, 0.0);
+	glColor3f(1.0, 1.0, 1.0);
+	drawDisc(10.0, 75.0, 75.0, 0.5); // Compare this z-value with that of the red disc.
+	glDisable(GL_DEPTH_TEST); // Disable depth testing.
+
+	PROFILE_PHASE("annulus");
+	// Lower circular annulus: with a true hole.
+	if (isWire) glPolygonMode(GL_FRONT, GL_LINE);else glPolygonMode(GL_FRONT, GL_FILL);
+	glColor3f(1.0, 0.0, 0.0);
+	glBegin(GL_TRIANGLE_STRIP);
+	for (i = 0; i <= N; ++i)
+	{
+		angle = 2 * M_PI * i / N;
+		glVertex3f(50 + cos(angle) * 10.0, 30 + sin(angle) * 10.0, 0.0);
+		glVertex3f(50 + cos(angle) * 20.0, 30 + sin(angle) * 20.0, 0.0);
+	}
+	glEnd();
+
+	PROFILE_PHASE("labels");
+	// Write labels.
+	glColor3f(0.0, 0.0, 0.0);
+	glRasterPos3f(15.0, 51.0, 0.0);
+	writeBitmapString((void*)font, "Overwritten");
+	glRasterPos3f(69.0, 51.0, 0.0);
+	writeBitmapString((void*)font, "Floating");
+	glRasterPos3f(38.0, 6.0, 0.0);
+	writeBitmapString((void*)font, "The real deal!");
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Routine to register the quality governor's knob, once.
+inline void CircularAnnuluses::build(void)
+{
+	governorKnob("N", &N, 8);
+}
+
+// Initialization routine.
+inline void CircularAnnuluses::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void CircularAnnuluses::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+inline void CircularAnnuluses::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case ' ':
+		if (isWire == 0) isWire = 1;
+		else isWire = 0;
+		glutPostRedisplay();
+		break;
+	case 27:
+		exit(0);
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void CircularAnnuluses::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press the space bar to toggle between wirefrime and filled for the lower annulus." << std::endl;
+}
+
+#endif
@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////
+// clown3.h
+//
+// The clown's head of clown3.cpp as a demo unit (demoUnit.h): its globals and
+// routines, run by clown3.cpp and by the launcher.
+////////////////////////////////////////////////////////////////////////
+
+#ifndef CLOWN3_H
+#define CLOWN3_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+#include "../Common/picking.h"
+
+class Clown3 : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void specialKeyInput(int key, int x, int y);
+	void mouseControl(int button, int state, int x, int y);
+	void printInteraction(void);
+	void partColor(int part, float r, float g, float b);
+	void increaseAngle(void);
+	void animate(int value);
+
+	enum { HEAD, HAT, BRIM, LEFT_EAR, RIGHT_EAR }; // Parts.
+
+	// Globals.
+	float angle = 0.0; // Rotation.angle of hat.
+	int isAnimate = 0; // Animated?
+	int animationPeriod = 100; // Time interval between frames.
+	PickScene pickScene; // Parts drawn in the last frame.
+	int picked = -1; // Part picked, -1 if none.
+	const char *partNames[5] = { "head", "hat", "brim", "left ear", "right ear" };
+};
+
+// Routine to set the drawing color of a part, black if it is picked.
+inline void Clown3::partColor(int part, float r, float g, float b)
+{
+	if (part == picked) glColor3f(0.0, 0.0, 0.0);
+	else glColor3f(r, g, b);
+}
+
+// Drawing routine.
+/***
+Parts contributed by clown1.cpp, clown2.cpp and clown3.cpp are indicated.
+Uncomment the part from clown2.cpp and then clown3.cpp, successively, for those programs.
+***/
+
+inline void Clown3::drawScene(void)
+{
+	float t; // Parameter along helix.
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glLoadIdentity();
+	pickScene.clear();
+
+	// Place scene in frustum.
+	glTranslatef(0.0, 0.0, -9.0);
+		
+	//*** clown1.cpp starts here. ***
+
+	PROFILE_PHASE("clown");
+	// Head.
+	partColor(HEAD, 0.0, 0.0, 1.0);
+	glutWireSphere(2.0, 20, 20);
+	pickScene.add(HEAD, pickSphere(2.0, 20, 20));
+	//*** clown1.cpp ends here. ***
+	
+	
+	/*
+	//*** clown2.cpp starts here. ***
+	glPushMatrix();
+
+	// Transformations of the hat and brim.
+	glRotatef(angle, 0.0, 1.0, 0.0);
+	glRotatef(30.0, 0.0, 0.0, 1.0);
+	glRotatef(-90.0, 1.0, 0.0, 0.0);
+	glTranslatef(0.0, 0.0, 2.0);
+
+	// Hat.
+	partColor(HAT, 0.0, 1.0, 0.0);
+	glutWireCone(2.0, 4.0, 20, 20);
+	pickScene.add(HAT, pickCone(2.0, 4.0, 20, 20));
+
+	// Brim.
+	partColor(BRIM, 0.0, 1.0, 0.0);
+	glutWireTorus(0.2, 2.2, 10, 25);
+	pickScene.add(BRIM, pickTorus(0.2, 2.2, 10, 25));
+
+	glPopMatrix();
+	//*** clown2.cpp ends here. ***
+	*/
+	
+	/*
+	//*** clown3.cpp starts here. NOTE: Also leave the part for clown2.cpp above uncommented. ***
+	glPushMatrix();
+
+	// Transformations of the left ear.
+	glTranslatef(sin((M_PI/180.0)*angle), 0.0, 0.0);
+	glTranslatef(3.5, 0.0, 0.0);
+
+	// Left ear.
+	partColor(LEFT_EAR, 1.0, 0.0, 0.0);
+	glutWireSphere(0.5, 10, 10);
+	pickScene.add(LEFT_EAR, pickSphere(0.5, 10, 10));
+
+	glPopMatrix();
+
+	glPushMatrix();
+
+	// Transformations of the right ear.
+	glTranslatef(-sin((M_PI/180.0)*angle), 0.0, 0.0);
+	glTranslatef(-3.5, 0.0, 0.0);
+
+	// Right ear.
+	partColor(RIGHT_EAR, 1.0, 0.0, 0.0);
+	glutWireSphere(0.5, 10, 10);
+	pickScene.add(RIGHT_EAR, pickSphere(0.5, 10, 10));
+
+	glPopMatrix();
+
+	glPushMatrix();
+
+	// Transformations of the spring to the left ear.
+	glTranslatef(-2.0, 0.0, 0.0);
+	glScalef(-1 - sin( (M_PI/180.0) * angle ), 1.0, 1.0);
+
+	// Spring to left ear.
+	glColor3f(0.0, 1.0, 0.0);
+	glBegin(GL_LINE_STRIP);
+	for(t = 0.0; t <= 1.0; t += 0.05)
+	glVertex3f(t, 0.25 * cos(10.0 * M_PI * t), 0.25 * sin(10.0 * M_PI * t));
+	glEnd();
+
+	glPopMatrix();
+
+	glPushMatrix();
+
+	// Transformations of the spring to the right ear.
+	glTranslatef(2.0, 0.0, 0.0);
+	glScalef(1 + sin( (M_PI/180.0) * angle ), 1.0, 1.0);
+
+	// Spring to right ear.
+	glColor3f(0.0, 1.0, 0.0);
+	glBegin(GL_LINE_STRIP);
+	for(t = 0.0; t <= 1.0; t += 0.05)
+	glVertex3f(t, 0.25 * cos(10.0 * M_PI * t), 0.25 * sin(10.0 * M_PI * t));
+	glEnd();
+
+	glPopMatrix();
+	//*** clown3.cpp ends here. ***
+	*/
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Routine to increase the rotation angle.
+inline void Clown3::increaseAngle(void)
+{
+	angle += 5.0;
+	if (angle > 360.0) angle -= 360.0;
+}
+
+// Timer function.
+inline void Clown3::animate(int value)
+{
+	if (isAnimate)
+	{
+		increaseAngle();
+
+		glutPostRedisplay();
+		timerFunc(animationPeriod, &Clown3::animate, 1);
+	}
+}
+
+// Initialization routine.
+inline void Clown3::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void Clown3::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+inline void Clown3::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate) isAnimate = 0;
+		else
+		{
+			isAnimate = 1;
+			animate(1);
+		}
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Callback routine for non-ASCII key entry.
+inline void Clown3::specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_DOWN) animationPeriod += 5;
+	if (key == GLUT_KEY_UP) if (animationPeriod > 5) animationPeriod -= 5;
+	glutPostRedisplay();
+}
+
+// Mouse callback routine.
+inline void Clown3::mouseControl(int button, int state, int x, int y)
+{
+	if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN)
+	{
+		picked = pickScene.pick(x, y);
+		std::cout << "Picked " << (picked >= 0 ? partNames[picked] : "nothing") << " in " << pickScene.pickMicros
+			<< " us, hierarchy of " << pickScene.numObjects() << " parts built in " << pickScene.buildMicros << " us" << std::endl;
+		glutPostRedisplay();
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void Clown3::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl
+		<< "Press the up/down arrow keys to speed up/slow down animation." << std::endl
+		<< "Click the left mouse button on a part of the clown drawn to pick it" << std::endl
+		<< "(only the head until the clown2.cpp and clown3.cpp parts are uncommented)." << std::endl;
+}
+
+#endif
@@ -0,0 +1,578 @@
+////////////////////////////////////////////////////////////////////////////////////
+// clownCrowd.cpp
+//
+// This program enhances clown3.cpp to animate a whole crowd of clowns, each with
+// its own phase and speed.
+//
+// The per-clown animation state (position, phase, rate) is stored in SoA
+// (structure of arrays) form. Every frame the part transforms of all the clowns -
+// ear offsets, spring positions and scales and the hat rotation - are evaluated
+// four clowns at a time with SSE, the crowd being split across a pool of worker
+// threads. The results are written straight into SoA instance arrays which are
+// uploaded and consumed by one instanced draw per clown part.
+//
+// Throughput of the animation evaluation is reported in figures per second.
+//
+// Interaction:
+// Press space to toggle between animation on and off.
+// Press the up/down arrow keys to speed up/slow down animation.
+// Press n/N to halve/double the number of clowns.
+// Press t/T to decrease/increase the number of worker threads.
+// Press b to benchmark the animation evaluation for 1, 2, ... all threads.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE
+#include <emmintrin.h>
+#endif
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/workerPool.h"
+#include "../Common/programCache.h"
+#include "../Common/demoHooks.h"
+
+#define SPRING_VERTICES 21 // Vertices on a spring line strip: t = 0.0, 0.05, ..., 1.0.
+
+// Indices of the instance arrays, each an array of one float per clown.
+enum InstanceArray
+{
+	POS_X, POS_Y, POS_Z,       // Clown position (static).
+	EAR_LEFT_X, EAR_RIGHT_X,   // Ear translations.
+	SPRING_LEFT_X, SPRING_RIGHT_X, // Spring translations.
+	SPRING_LEFT_S, SPRING_RIGHT_S, // Spring scales.
+	HAT_COS, HAT_SIN,          // Hat rotation.
+	NUM_INSTANCE_ARRAYS
+};
+
+// Clown parts, each drawn by one instanced draw call.
+enum Part { HEAD, HAT, EAR_LEFT, EAR_RIGHT, SPRING_LEFT, SPRING_RIGHT, NUM_PARTS };
+
+// Globals.
+static float angleStep = 5.0; // Angle advanced by a clown of rate 1 every frame.
+static int isAnimate = 0; // Animated?
+static int animationPeriod = 100; // Time interval between frames.
+static int numClowns = 16384; // Number of clowns in the crowd.
+static int numPadded = 0; // Number of clowns rounded up to a multiple of 4.
+static int numThreads = 1; // Number of threads evaluating the animation.
+
+// Per-clown animation state in SoA form.
+static std::vector<float> phase; // Animation angle of the clown in degrees.
+static std::vector<float> rate; // Speed of the clown relative to angleStep.
+
+// Evaluated part transforms in SoA form: one array of numPadded floats per InstanceArray.
+static std::vector<float> instanceData;
+
+// Throughput accounting.
+static double evalSeconds = 0.0; // Time spent evaluating animation since the last report.
+static long long evalFigures = 0; // Figures evaluated since the last report.
+
+// GL objects.
+static unsigned int program; // Shader program.
+static unsigned int vao; // Vertex array object.
+static unsigned int meshBuffer; // All part meshes one after another.
+static unsigned int instanceBuffer; // SoA instance arrays.
+static int meshFirst[NUM_PARTS], meshCount[NUM_PARTS]; // Range of each part in meshBuffer.
+static int colorLoc; // Location of the color uniform.
+
+// Vertex shader: scale in x, rotate about y, then translate by the per-instance values.
+static const char *vertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 vertex;\n"
+"layout(location = 1) in float instX;\n"
+"layout(location = 2) in float instY;\n"
+"layout(location = 3) in float instZ;\n"
+"layout(location = 4) in float instScale;\n"
+"layout(location = 5) in float instCos;\n"
+"layout(location = 6) in float instSin;\n"
+"void main(void)\n"
+"{\n"
+"   vec3 p = vec3(vertex.x * instScale, vertex.yz);\n"
+"   p = vec3(instCos * p.x + instSin * p.z, p.y, -instSin * p.x + instCos * p.z);\n"
+"   gl_Position = gl_ModelViewProjectionMatrix * vec4(p + vec3(instX, instY, instZ), 1.0);\n"
+"}\n";
+
+static const char *fragmentShaderSource =
+"#version 430 compatibility\n"
+"uniform vec3 color;\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"   fragColor = vec4(color, 1.0);\n"
+"}\n";
+
+static WorkerPool *pool = NULL;
+
+#ifdef USE_SSE
+// Four-wide sine of angles in degrees: reduce to [-pi, pi], fold into [-pi/2, pi/2]
+// and evaluate the Taylor polynomial to x^9 (max error about 4e-6).
+static inline __m128 sinDegrees4(__m128 deg)
+{
+	const __m128 toRad = _mm_set1_ps((float)(M_PI / 180.0));
+	const __m128 twoPi = _mm_set1_ps((float)(2.0 * M_PI));
+	const __m128 invTwoPi = _mm_set1_ps((float)(0.5 / M_PI));
+	const __m128 pi = _mm_set1_ps((float)M_PI);
+	const __m128 halfPi = _mm_set1_ps((float)(M_PI / 2.0));
+
+	__m128 x = _mm_mul_ps(deg, toRad);
+	__m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, invTwoPi))); // Round to nearest.
+	x = _mm_sub_ps(x, _mm_mul_ps(k, twoPi));
+
+	// sin(x) = sin(pi - x) for x > pi/2 and sin(x) = sin(-pi - x) for x < -pi/2.
+	__m128 hi = _mm_cmpgt_ps(x, halfPi);
+	__m128 lo = _mm_cmplt_ps(x, _mm_sub_ps(_mm_setzero_ps(), halfPi));
+	x = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(hi, lo), x),
+		_mm_or_ps(_mm_and_ps(hi, _mm_sub_ps(pi, x)),
+			_mm_and_ps(lo, _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), pi), x))));
+
+	__m128 x2 = _mm_mul_ps(x, x);
+	__m128 p = _mm_set1_ps(1.0f / 362880.0f);
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 5040.0f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 120.0f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 6.0f));
+	p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+	return _mm_mul_ps(p, x);
+}
+#endif
+
+// Routine to advance clowns [begin, end), begin and end being multiples of 4, by
+// step degrees each and evaluate their part transforms. Mirrors the transformations
+// of clown3.cpp: ears at +/-(3.5 + s), springs at +/-2 scaled by +/-(1 + s) and
+// hat turned by the angle, where s = sin(angle) and angle is the clown's phase.
+void evaluateClowns(int begin, int end, float step)
+{
+	float *d = instanceData.data();
+	const float *posX = d + POS_X * numPadded;
+	float *earL = d + EAR_LEFT_X * numPadded, *earR = d + EAR_RIGHT_X * numPadded;
+	float *springLX = d + SPRING_LEFT_X * numPadded, *springRX = d + SPRING_RIGHT_X * numPadded;
+	float *springLS = d + SPRING_LEFT_S * numPadded, *springRS = d + SPRING_RIGHT_S * numPadded;
+	float *hatCos = d + HAT_COS * numPadded, *hatSin = d + HAT_SIN * numPadded;
+
+#ifdef USE_SSE
+	const __m128 stepv = _mm_set1_ps(step);
+	const __m128 full = _mm_set1_ps(360.0);
+	const __m128 one = _mm_set1_ps(1.0);
+	const __m128 two = _mm_set1_ps(2.0);
+	const __m128 earOffset = _mm_set1_ps(3.5);
+	const __m128 ninety = _mm_set1_ps(90.0);
+	const __m128 zero = _mm_setzero_ps();
+	for (int i = begin; i < end; i += 4)
+	{
+		__m128 a = _mm_add_ps(_mm_loadu_ps(&phase[i]), _mm_mul_ps(_mm_loadu_ps(&rate[i]), stepv));
+		a = _mm_sub_ps(a, _mm_and_ps(_mm_cmpgt_ps(a, full), full));
+		_mm_storeu_ps(&phase[i], a);
+		__m128 x = _mm_loadu_ps(posX + i);
+		__m128 s = sinDegrees4(a);
+		__m128 ear = _mm_add_ps(earOffset, s);
+		__m128 scale = _mm_add_ps(one, s);
+		_mm_storeu_ps(earL + i, _mm_add_ps(x, ear));
+		_mm_storeu_ps(earR + i, _mm_sub_ps(x, ear));
+		_mm_storeu_ps(springLX + i, _mm_sub_ps(x, two));
+		_mm_storeu_ps(springRX + i, _mm_add_ps(x, two));
+		_mm_storeu_ps(springLS + i, _mm_sub_ps(zero, scale));
+		_mm_storeu_ps(springRS + i, scale);
+		_mm_storeu_ps(hatCos + i, sinDegrees4(_mm_add_ps(a, ninety)));
+		_mm_storeu_ps(hatSin + i, s);
+	}
+#else
+	for (int i = begin; i < end; i++)
+	{
+		phase[i] += rate[i] * step;
+		if (phase[i] > 360.0) phase[i] -= 360.0;
+		float a = (M_PI / 180.0) * phase[i];
+		float s = sin(a);
+		earL[i] = posX[i] + 3.5 + s;
+		earR[i] = posX[i] - 3.5 - s;
+		springLX[i] = posX[i] - 2.0;
+		springRX[i] = posX[i] + 2.0;
+		springLS[i] = -1 - s;
+		springRS[i] = 1 + s;
+		hatCos[i] = cos(a);
+		hatSin[i] = s;
+	}
+#endif
+}
+
+// Routine to advance and evaluate the whole crowd on the given number of threads.
+// Returns the time taken in seconds.
+double evaluateCrowd(int threads, float step)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	int batches = numPadded / 4;
+	pool->run(threads, [batches, step](int part, int parts)
+	{
+		PROFILE_ZONE("evaluate clowns");
+		evaluateClowns(4 * (batches * part / parts), 4 * (batches * (part + 1) / parts), step);
+	});
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Routine to place the clowns on a square grid in the xz-plane and give each a
+// random phase and rate.
+void createCrowd(void)
+{
+	int side = (int)ceil(sqrt((float)numClowns));
+	numPadded = (numClowns + 3) & ~3;
+
+	phase.assign(numPadded, 0.0);
+	rate.assign(numPadded, 0.0);
+	instanceData.assign(NUM_INSTANCE_ARRAYS * numPadded, 0.0);
+
+	for (int i = 0; i < numClowns; i++)
+	{
+		instanceData[POS_X * numPadded + i] = 14.0 * (i % side - 0.5 * (side - 1));
+		instanceData[POS_Y * numPadded + i] = 0.0;
+		instanceData[POS_Z * numPadded + i] = -14.0 * (i / side);
+		phase[i] = 360.0 * rand() / RAND_MAX;
+		rate[i] = 0.5 + 1.5 * rand() / RAND_MAX;
+	}
+
+	evaluateCrowd(numThreads, 0.0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(float), instanceData.data(), GL_DYNAMIC_DRAW);
+}
+
+// Routines to append line segments of the wire parts to a vertex list, as drawn
+// by glutWireSphere(), glutWireCone() and glutWireTorus().
+void addLine(std::vector<float> &v, float x0, float y0, float z0, float x1, float y1, float z1)
+{
+	float line[] = { x0, y0, z0, x1, y1, z1 };
+	v.insert(v.end(), line, line + 6);
+}
+
+void addWireSphere(std::vector<float> &v, float r, int slices, int stacks)
+{
+	for (int j = 0; j < stacks; j++)
+		for (int i = 0; i < slices; i++)
+		{
+			float phi0 = M_PI * j / stacks - M_PI / 2.0, theta0 = 2.0 * M_PI * i / slices;
+			float theta1 = 2.0 * M_PI * ((i + 1) % slices) / slices, phi1 = M_PI * (j + 1) / stacks - M_PI / 2.0;
+			if (j > 0) // Latitude.
+				addLine(v, r * cos(phi0) * cos(theta0), r * cos(phi0) * sin(theta0), r * sin(phi0),
+					r * cos(phi0) * cos(theta1), r * cos(phi0) * sin(theta1), r * sin(phi0));
+			addLine(v, r * cos(phi0) * cos(theta0), r * cos(phi0) * sin(theta0), r * sin(phi0), // Longitude.
+				r * cos(phi1) * cos(theta0), r * cos(phi1) * sin(theta0), r * sin(phi1));
+		}
+}
+
+void addWireCone(std::vector<float> &v, float base, float height, int slices, int stacks)
+{
+	for (int i = 0; i < slices; i++)
+	{
+		float theta0 = 2.0 * M_PI * i / slices, theta1 = 2.0 * M_PI * (i + 1) / slices;
+		addLine(v, base * cos(theta0), base * sin(theta0), 0.0, 0.0, 0.0, height);
+		for (int j = 0; j < stacks; j++)
+		{
+			float r = base * (1.0 - (float)j / stacks), z = height * j / stacks;
+			addLine(v, r * cos(theta0), r * sin(theta0), z, r * cos(theta1), r * sin(theta1), z);
+		}
+	}
+}
+
+void addWireTorus(std::vector<float> &v, float inner, float outer, int sides, int rings)
+{
+	for (int i = 0; i < rings; i++)
+		for (int j = 0; j < sides; j++)
+		{
+			float theta0 = 2.0 * M_PI * i / rings, theta1 = 2.0 * M_PI * (i + 1) / rings;
+			float phi0 = 2.0 * M_PI * j / sides, phi1 = 2.0 * M_PI * (j + 1) / sides;
+			float r0 = outer + inner * cos(phi0), r1 = outer + inner * cos(phi1);
+			addLine(v, r0 * cos(theta0), r0 * sin(theta0), inner * sin(phi0),
+				r0 * cos(theta1), r0 * sin(theta1), inner * sin(phi0));
+			addLine(v, r0 * cos(theta0), r0 * sin(theta0), inner * sin(phi0),
+				r1 * cos(theta0), r1 * sin(theta0), inner * sin(phi1));
+		}
+}
+
+// Routine to bake the fixed hat transformations of clown3.cpp, namely
+// glRotatef(30.0, 0.0, 0.0, 1.0); glRotatef(-90.0, 1.0, 0.0, 0.0); glTranslatef(0.0, 0.0, 2.0);
+// into the hat vertices from index first on. The per-clown y rotation is left to the shader.
+void bakeHat(std::vector<float> &v, int first)
+{
+	float c = cos(M_PI / 6.0), s = sin(M_PI / 6.0);
+	for (size_t i = 3 * first; i < v.size(); i += 3)
+	{
+		float x = v[i], y = v[i + 1], z = v[i + 2] + 2.0;
+		float y1 = z, z1 = -y; // Rotation by -90 degrees about x.
+		v[i] = c * x - s * y1;
+		v[i + 1] = s * x + c * y1;
+		v[i + 2] = z1;
+	}
+}
+
+// Initialization routine.
+void setup(void)
+{
+	std::vector<float> v;
+
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	glEnable(GL_DEPTH_TEST);
+
+	program = programCacheBuild(vertexShaderSource, fragmentShaderSource);
+	colorLoc = glGetUniformLocation(program, "color");
+
+	// Part meshes in the order of enum Part.
+	meshFirst[HEAD] = 0;
+	addWireSphere(v, 2.0, 20, 20);
+	meshFirst[HAT] = v.size() / 3;
+	addWireCone(v, 2.0, 4.0, 20, 20);
+	addWireTorus(v, 0.2, 2.2, 10, 25);
+	bakeHat(v, meshFirst[HAT]);
+	meshFirst[EAR_LEFT] = meshFirst[EAR_RIGHT] = v.size() / 3;
+	addWireSphere(v, 0.5, 10, 10);
+	meshFirst[SPRING_LEFT] = meshFirst[SPRING_RIGHT] = v.size() / 3;
+	for (int i = 0; i < SPRING_VERTICES; i++)
+	{
+		float t = 0.05 * i;
+		float vertex[] = { t, (float)(0.25 * cos(10.0 * M_PI * t)), (float)(0.25 * sin(10.0 * M_PI * t)) };
+		v.insert(v.end(), vertex, vertex + 3);
+	}
+	meshCount[HEAD] = meshFirst[HAT] - meshFirst[HEAD];
+	meshCount[HAT] = meshFirst[EAR_LEFT] - meshFirst[HAT];
+	meshCount[EAR_LEFT] = meshCount[EAR_RIGHT] = meshFirst[SPRING_LEFT] - meshFirst[EAR_LEFT];
+	meshCount[SPRING_LEFT] = meshCount[SPRING_RIGHT] = SPRING_VERTICES;
+
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	glGenBuffers(1, &meshBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+	glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glEnableVertexAttribArray(0);
+
+	glGenBuffers(1, &instanceBuffer);
+	for (int i = 1; i <= 6; i++) glVertexAttribDivisor(i, 1);
+	glBindVertexArray(0);
+
+	pool = new WorkerPool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+	numThreads = pool->size();
+
+	createCrowd();
+}
+
+// Routine to source instance attribute location from InstanceArray array,
+// or to hold it at a constant value if array is negative.
+void setInstanceAttrib(int location, int array, float value)
+{
+	if (array < 0)
+	{
+		glDisableVertexAttribArray(location);
+		glVertexAttrib1f(location, value);
+	}
+	else
+	{
+		glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, 0, (void *)(array * numPadded * sizeof(float)));
+		glEnableVertexAttribArray(location);
+	}
+}
+
+// Routine to draw one part of every clown with a single instanced draw.
+void drawPart(int part, int mode, float r, float g, float b, int x, int scale, int cosine, int sine)
+{
+	glUniform3f(colorLoc, r, g, b);
+	setInstanceAttrib(1, x, 0.0);
+	setInstanceAttrib(2, POS_Y, 0.0);
+	setInstanceAttrib(3, POS_Z, 0.0);
+	setInstanceAttrib(4, scale, 1.0);
+	setInstanceAttrib(5, cosine, 1.0);
+	setInstanceAttrib(6, sine, 0.0);
+	glDrawArraysInstanced(mode, meshFirst[part], meshCount[part], numClowns);
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glLoadIdentity();
+
+	// Look down on the crowd from above its front row.
+	gluLookAt(0.0, 40.0, 30.0, 0.0, 0.0, -40.0, 0.0, 1.0, 0.0);
+
+	PROFILE_PHASE("upload");
+	// Upload the dynamic instance arrays, i.e., all but the positions.
+	glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	glBufferSubData(GL_ARRAY_BUFFER, EAR_LEFT_X * numPadded * sizeof(float),
+		(NUM_INSTANCE_ARRAYS - EAR_LEFT_X) * numPadded * sizeof(float), &instanceData[EAR_LEFT_X * numPadded]);
+
+	PROFILE_PHASE("clowns");
+	glUseProgram(program);
+	glBindVertexArray(vao);
+
+	drawPart(HEAD, GL_LINES, 0.0, 0.0, 1.0, POS_X, -1, -1, -1);
+	drawPart(HAT, GL_LINES, 0.0, 1.0, 0.0, POS_X, -1, HAT_COS, HAT_SIN);
+	drawPart(EAR_LEFT, GL_LINES, 1.0, 0.0, 0.0, EAR_LEFT_X, -1, -1, -1);
+	drawPart(EAR_RIGHT, GL_LINES, 1.0, 0.0, 0.0, EAR_RIGHT_X, -1, -1, -1);
+	drawPart(SPRING_LEFT, GL_LINE_STRIP, 0.0, 1.0, 0.0, SPRING_LEFT_X, SPRING_LEFT_S, -1, -1);
+	drawPart(SPRING_RIGHT, GL_LINE_STRIP, 0.0, 1.0, 0.0, SPRING_RIGHT_X, SPRING_RIGHT_S, -1, -1);
+
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Routine to advance the crowd's animation.
+void increaseAngle(void)
+{
+	evalSeconds += evaluateCrowd(numThreads, angleStep);
+	evalFigures += numClowns;
+}
+
+// Timer function.
+void animate(int value)
+{
+	if (isAnimate)
+	{
+		increaseAngle();
+
+		glutPostRedisplay();
+		glutTimerFunc(animationPeriod, animate, 1);
+	}
+}
+
+// Routine to output the animation throughput every second.
+void throughputCounter(int value)
+{
+	if (evalFigures > 0)
+		std::cout << numClowns << " clowns, " << numThreads << " threads: "
+		<< evalFigures / evalSeconds << " figures/s" << std::endl;
+	evalSeconds = 0.0;
+	evalFigures = 0;
+	glutTimerFunc(1000, throughputCounter, 1);
+}
+
+// Routine to measure animation throughput for each thread count from 1 to the pool size.
+void benchmark(void)
+{
+	const int repeats = 200;
+	double baseline = 0.0;
+
+	std::cout << "Benchmarking " << numClowns << " clowns x " << repeats << " evaluations:" << std::endl;
+	for (int threads = 1; threads <= pool->size(); threads++)
+	{
+		double seconds = 0.0;
+		evaluateCrowd(threads, angleStep); // Warm up.
+		for (int i = 0; i < repeats; i++) seconds += evaluateCrowd(threads, angleStep);
+		double figuresPerSecond = (double)numClowns * repeats / seconds;
+		if (threads == 1) baseline = figuresPerSecond;
+		std::cout << "  " << threads << " threads: " << figuresPerSecond << " figures/s (x"
+			<< figuresPerSecond / baseline << ")" << std::endl;
+	}
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	gluPerspective(60.0, (float)w / (float)h, 5.0, 2000.0);
+
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		delete pool;
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate) isAnimate = 0;
+		else
+		{
+			isAnimate = 1;
+			animate(1);
+		}
+		glutPostRedisplay();
+		break;
+	case 'n':
+		if (numClowns > 1) numClowns /= 2;
+		createCrowd();
+		glutPostRedisplay();
+		break;
+	case 'N':
+		if (numClowns < (1 << 22)) numClowns *= 2;
+		createCrowd();
+		glutPostRedisplay();
+		break;
+	case 't':
+		if (numThreads > 1) numThreads--;
+		std::cout << numThreads << " threads." << std::endl;
+		break;
+	case 'T':
+		if (numThreads < pool->size()) numThreads++;
+		std::cout << numThreads << " threads." << std::endl;
+		break;
+	case 'b':
+		benchmark();
+		break;
+	default:
+		break;
+	}
+}
+
+// Callback routine for non-ASCII key entry.
+void specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_DOWN) animationPeriod += 5;
+	if (key == GLUT_KEY_UP) if (animationPeriod > 5) animationPeriod -= 5;
+	glutPostRedisplay();
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl
+		<< "Press the up/down arrow keys to speed up/slow down animation." << std::endl
+		<< "Press n/N to halve/double the number of clowns." << std::endl
+		<< "Press t/T to decrease/increase the number of worker threads." << std::endl
+		<< "Press b to benchmark the animation evaluation for 1, 2, ... all threads." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("clownCrowd.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+	glutSpecialFunc(specialKeyInput);
+	glutTimerFunc(0, throughputCounter, 0);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
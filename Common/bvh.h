@@ -0,0 +1,477 @@
+////////////////////////////////////////////////////////////////////////////////////
+// bvh.h
+//
+// A bounding volume hierarchy over the instances of a scene, each bounded by an
+// axis-aligned box (AABB) and a sphere.
+//
+// The tree is binary, built top-down by splitting at the median of the longest
+// axis of the box centers, with up to BVH_LEAF_SIZE instances a leaf. Instances
+// are stored in leaf order, their bounding spheres in SoA arrays, so the spheres
+// of a leaf are tested against a plane four at a time with SSE.
+//
+// Frustum culling walks the tree testing node boxes against the six planes with
+// SSE (four planes in one go, then the other two). Subtrees entirely inside the
+// frustum are accepted without further tests.
+//
+// When instances move, update() records their new bounds and refit() recomputes
+// only the boxes of the leaves that hold them and of those leaves' ancestors,
+// stopping as soon as a box comes out unchanged. Refitting keeps the tree valid
+// but not optimal; rebuild with build() if instances travel far.
+//
+// Ray casting finds the nearest instance a ray hits: intersect() walks the tree
+// with slab tests against the node boxes, entering the nearer child first and
+// skipping any node that starts beyond the nearest hit so far, and hands the
+// instances of the leaves it reaches to a caller's exact test.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BVH_USE_SSE
+#include <emmintrin.h>
+#endif
+
+#define BVH_LEAF_SIZE 4 // Maximum number of instances a leaf.
+
+// Axis-aligned box.
+struct Aabb
+{
+	float min[3], max[3];
+
+	void merge(const Aabb &b)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (b.min[i] < min[i]) min[i] = b.min[i];
+			if (b.max[i] > max[i]) max[i] = b.max[i];
+		}
+	}
+
+	bool operator==(const Aabb &b) const
+	{
+		for (int i = 0; i < 3; i++) if (min[i] != b.min[i] || max[i] != b.max[i]) return false;
+		return true;
+	}
+};
+
+// Six planes n.x + d >= 0 bounding a view frustum, SoA, padded to eight with planes
+// everything is inside of.
+struct Frustum
+{
+	float nx[8], ny[8], nz[8], d[8];
+
+	// Routine to extract the planes from the matrix m = projection * modelview
+	// (column-major, as returned by glGetFloatv()): the planes of world space points
+	// inside the clip volume -w <= x, y, z <= w.
+	void fromMatrix(const float m[16])
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			int row = i / 2;
+			float sign = (i % 2 == 0) ? 1.0f : -1.0f; // Left/bottom/near, then right/top/far.
+			float a = m[3] + sign * m[row], b = m[7] + sign * m[4 + row];
+			float c = m[11] + sign * m[8 + row], e = m[15] + sign * m[12 + row];
+			float len = std::sqrt(a * a + b * b + c * c);
+			nx[i] = a / len; ny[i] = b / len; nz[i] = c / len; d[i] = e / len;
+		}
+		for (int i = 6; i < 8; i++)
+		{
+			nx[i] = ny[i] = nz[i] = 0.0;
+			d[i] = 1.0;
+		}
+	}
+};
+
+// Culling statistics.
+struct CullStats
+{
+	int nodesVisited; // Nodes whose box was tested.
+	int spheresTested; // Instance spheres tested.
+};
+
+// Ray origin + t dir, with the reciprocals of dir for the slab tests.
+struct Ray
+{
+	float origin[3], dir[3], invDir[3];
+
+	void set(const float o[3], const float d[3])
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			origin[a] = o[a];
+			dir[a] = d[a];
+			invDir[a] = 1.0f / d[a]; // Infinite for a zero component, which the slab test handles.
+		}
+	}
+
+	// Routine to return the t at which the ray enters box b, or -1 if it misses b
+	// or enters it only beyond tMax.
+	float enters(const Aabb &b, float tMax) const
+	{
+		float tNear = 0.0, tFar = tMax;
+		for (int a = 0; a < 3; a++)
+		{
+			float t0 = (b.min[a] - origin[a]) * invDir[a], t1 = (b.max[a] - origin[a]) * invDir[a];
+			if (t0 > t1) std::swap(t0, t1);
+			if (t0 > tNear) tNear = t0; // NaN (origin on a slab of a flat box) leaves the bounds alone.
+			if (t1 < tFar) tFar = t1;
+		}
+		return tNear <= tFar ? tNear : -1.0f;
+	}
+};
+
+// Ray casting statistics.
+struct RayStats
+{
+	int nodesVisited; // Nodes whose box was tested.
+	int itemsTested; // Instances handed to the exact test.
+};
+
+class Bvh
+{
+public:
+	// Routine to build the tree over instances 0 to n - 1 with the given boxes and
+	// bounding spheres (center x, y, z and radius r).
+	void build(const std::vector<Aabb> &boxes, const std::vector<float> &sx, const std::vector<float> &sy,
+		const std::vector<float> &sz, const std::vector<float> &sr)
+	{
+		int n = (int)boxes.size();
+
+		itemBoxes = boxes;
+		items.resize(n);
+		for (int i = 0; i < n; i++) items[i] = i;
+		nodes.clear();
+		nodes.reserve(2 * (n / BVH_LEAF_SIZE + 1));
+		if (n > 0) buildNode(0, n, -1);
+
+		itemPos.resize(n);
+		leafOf.resize(n);
+		int padded = n + BVH_LEAF_SIZE;
+		sphereX.assign(padded, 0.0); sphereY.assign(padded, 0.0);
+		sphereZ.assign(padded, 0.0); sphereR.assign(padded, -1.0);
+		for (int i = 0; i < n; i++)
+		{
+			int item = items[i];
+			itemPos[item] = i;
+			sphereX[i] = sx[item]; sphereY[i] = sy[item]; sphereZ[i] = sz[item]; sphereR[i] = sr[item];
+		}
+		for (int i = 0; i < (int)nodes.size(); i++)
+			if (nodes[i].count > 0)
+				for (int j = 0; j < nodes[i].count; j++) leafOf[items[nodes[i].first + j]] = i;
+		dirtyLeaves.clear();
+	}
+
+	// Routine to record new bounds of an instance; they take effect on refit().
+	void update(int item, const Aabb &box, float x, float y, float z, float r)
+	{
+		int pos = itemPos[item];
+		itemBoxes[item] = box;
+		sphereX[pos] = x; sphereY[pos] = y; sphereZ[pos] = z; sphereR[pos] = r;
+		dirtyLeaves.push_back(leafOf[item]);
+	}
+
+	// Routine to refit the boxes of the leaves updated since the last refit and of their
+	// ancestors. Returns the number of node boxes recomputed.
+	int refit(void)
+	{
+		int refitted = 0;
+
+		for (size_t k = 0; k < dirtyLeaves.size(); k++)
+		{
+			int i = dirtyLeaves[k];
+			Aabb box = leafBox(nodes[i]);
+			refitted++;
+			if (box == nodes[i].box) continue;
+			nodes[i].box = box;
+
+			// Walk up while the parent's box changes.
+			for (int p = nodes[i].parent; p >= 0; p = nodes[p].parent)
+			{
+				Aabb merged = nodes[p + 1].box;
+				merged.merge(nodes[nodes[p].right].box);
+				refitted++;
+				if (merged == nodes[p].box) break;
+				nodes[p].box = merged;
+			}
+		}
+		dirtyLeaves.clear();
+		return refitted;
+	}
+
+	// Routine to append to visible the instances whose bounding sphere is not entirely
+	// outside the frustum.
+	void cull(const Frustum &f, std::vector<int> &visible, CullStats &stats) const
+	{
+		stats.nodesVisited = stats.spheresTested = 0;
+		if (!nodes.empty()) cullNode(0, f, visible, stats);
+	}
+
+	// Routine to append all instances whose sphere is not outside the frustum, testing
+	// every sphere (four at a time) without the tree, for comparison. As the tree also
+	// tests boxes, which are tighter than the spheres, cull() may return fewer.
+	void cullBruteForce(const Frustum &f, std::vector<int> &visible) const
+	{
+		for (int pos = 0; pos < (int)items.size(); pos += BVH_LEAF_SIZE)
+		{
+			int count = std::min(BVH_LEAF_SIZE, (int)items.size() - pos);
+			int mask = spheresInside(f, pos);
+			for (int j = 0; j < count; j++) if (mask & (1 << j)) visible.push_back(items[pos + j]);
+		}
+	}
+
+	// Routine to return the nearest instance hit by the ray no further than tHit
+	// along it, or -1, setting tHit to where it is hit. Instances whose box the ray
+	// enters are passed to test(item, tMax), which returns the t of the exact hit,
+	// or anything at or beyond tMax for none.
+	template <class Test>
+	int intersect(const Ray &ray, float &tHit, Test test, RayStats &stats) const
+	{
+		int stack[64], top = 0, hit = -1; // Nodes to visit, each deeper than the last.
+		float entry[64]; // Where the ray enters each.
+
+		stats.nodesVisited = stats.itemsTested = 0;
+		if (nodes.empty()) return -1;
+		stats.nodesVisited++;
+		entry[0] = ray.enters(nodes[0].box, tHit);
+		if (entry[0] < 0.0) return -1;
+		stack[top++] = 0;
+		while (top > 0)
+		{
+			top--;
+			if (entry[top] > tHit) continue; // A nearer hit has been found since it was pushed.
+			const Node &node = nodes[stack[top]];
+			if (node.count > 0)
+			{
+				for (int j = 0; j < node.count; j++)
+				{
+					int item = items[node.first + j];
+					stats.itemsTested++;
+					if (ray.enters(itemBoxes[item], tHit) < 0.0) continue;
+					float t = test(item, tHit);
+					if (t < tHit)
+					{
+						tHit = t;
+						hit = item;
+					}
+				}
+				continue;
+			}
+
+			// Push the farther child first so that the nearer is taken next.
+			int left = stack[top] + 1, right = node.right;
+			float tLeft = ray.enters(nodes[left].box, tHit), tRight = ray.enters(nodes[right].box, tHit);
+			stats.nodesVisited += 2;
+			if (tLeft > tRight)
+			{
+				std::swap(left, right);
+				std::swap(tLeft, tRight);
+			}
+			if (tRight >= 0.0)
+			{
+				stack[top] = right;
+				entry[top++] = tRight;
+			}
+			if (tLeft >= 0.0)
+			{
+				stack[top] = left;
+				entry[top++] = tLeft;
+			}
+		}
+		return hit;
+	}
+
+	// Routine to do what intersect() does by testing every instance's box, for comparison.
+	template <class Test>
+	int intersectBruteForce(const Ray &ray, float &tHit, Test test) const
+	{
+		int hit = -1;
+		for (int item = 0; item < (int)itemBoxes.size(); item++)
+		{
+			if (ray.enters(itemBoxes[item], tHit) < 0.0) continue;
+			float t = test(item, tHit);
+			if (t < tHit)
+			{
+				tHit = t;
+				hit = item;
+			}
+		}
+		return hit;
+	}
+
+	int numNodes(void) const { return (int)nodes.size(); }
+
+private:
+	struct Node
+	{
+		Aabb box;
+		int parent; // -1 for the root.
+		int right; // Right child of an inner node; the left child is the next node.
+		int first, count; // Instances items[first .. first + count - 1] of a leaf, count 0 if inner.
+	};
+
+	Aabb leafBox(const Node &node) const
+	{
+		Aabb box = itemBoxes[items[node.first]];
+		for (int j = 1; j < node.count; j++) box.merge(itemBoxes[items[node.first + j]]);
+		return box;
+	}
+
+	int buildNode(int first, int count, int parent)
+	{
+		int index = (int)nodes.size();
+		nodes.push_back(Node());
+		Node node;
+		node.parent = parent;
+		node.first = first;
+		node.count = count;
+		node.right = -1;
+		node.box = leafBox(node);
+
+		if (count > BVH_LEAF_SIZE)
+		{
+			// Split at the median of the box centers along the longest axis of their extent.
+			float lo[3] = { 1e30f, 1e30f, 1e30f }, hi[3] = { -1e30f, -1e30f, -1e30f };
+			for (int j = first; j < first + count; j++)
+				for (int a = 0; a < 3; a++)
+				{
+					float c = itemBoxes[items[j]].min[a] + itemBoxes[items[j]].max[a];
+					lo[a] = std::min(lo[a], c);
+					hi[a] = std::max(hi[a], c);
+				}
+			int axis = 0;
+			for (int a = 1; a < 3; a++) if (hi[a] - lo[a] > hi[axis] - lo[axis]) axis = a;
+
+			// Keep leaves full: the left half gets a multiple of the leaf size.
+			int half = ((count / 2 + BVH_LEAF_SIZE - 1) / BVH_LEAF_SIZE) * BVH_LEAF_SIZE;
+			std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+				[this, axis](int a, int b)
+			{
+				return itemBoxes[a].min[axis] + itemBoxes[a].max[axis] < itemBoxes[b].min[axis] + itemBoxes[b].max[axis];
+			});
+
+			node.count = 0;
+			buildNode(first, half, index);
+			node.right = buildNode(first + half, count - half, index);
+		}
+		nodes[index] = node;
+		return index;
+	}
+
+	// Routine to return a bit mask of the (up to four) spheres from pos on not outside f.
+	int spheresInside(const Frustum &f, int pos) const
+	{
+#ifdef BVH_USE_SSE
+		__m128 x = _mm_loadu_ps(&sphereX[pos]), y = _mm_loadu_ps(&sphereY[pos]);
+		__m128 z = _mm_loadu_ps(&sphereZ[pos]), r = _mm_loadu_ps(&sphereR[pos]);
+		__m128 negR = _mm_sub_ps(_mm_setzero_ps(), r);
+		__m128 inside = _mm_cmpge_ps(r, _mm_setzero_ps()); // Padding has radius -1.
+		for (int i = 0; i < 6; i++)
+		{
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nx[i]), x), _mm_mul_ps(_mm_set1_ps(f.ny[i]), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(f.nz[i]), z), _mm_set1_ps(f.d[i])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negR));
+		}
+		return _mm_movemask_ps(inside);
+#else
+		int mask = 0;
+		for (int j = 0; j < 4; j++)
+		{
+			int k = pos + j;
+			bool in = sphereR[k] >= 0.0;
+			for (int i = 0; i < 6 && in; i++)
+				in = f.nx[i] * sphereX[k] + f.ny[i] * sphereY[k] + f.nz[i] * sphereZ[k] + f.d[i] >= -sphereR[k];
+			if (in) mask |= 1 << j;
+		}
+		return mask;
+#endif
+	}
+
+	// Routine to classify a box against f: 0 outside, 1 intersecting, 2 inside.
+	static int classifyBox(const Frustum &f, const Aabb &b)
+	{
+		float c[3], e[3];
+		for (int a = 0; a < 3; a++)
+		{
+			c[a] = 0.5f * (b.min[a] + b.max[a]);
+			e[a] = 0.5f * (b.max[a] - b.min[a]);
+		}
+#ifdef BVH_USE_SSE
+		__m128 cx = _mm_set1_ps(c[0]), cy = _mm_set1_ps(c[1]), cz = _mm_set1_ps(c[2]);
+		__m128 ex = _mm_set1_ps(e[0]), ey = _mm_set1_ps(e[1]), ez = _mm_set1_ps(e[2]);
+		__m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+		int outside = 0, inside = 0xFF;
+		for (int i = 0; i < 8; i += 4)
+		{
+			__m128 nx = _mm_loadu_ps(&f.nx[i]), ny = _mm_loadu_ps(&f.ny[i]), nz = _mm_loadu_ps(&f.nz[i]);
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+				_mm_add_ps(_mm_mul_ps(nz, cz), _mm_loadu_ps(&f.d[i])));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask), ex),
+				_mm_mul_ps(_mm_and_ps(ny, absMask), ey)), _mm_mul_ps(_mm_and_ps(nz, absMask), ez));
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), radius))) << i;
+			inside &= ~(_mm_movemask_ps(_mm_cmplt_ps(dist, radius)) << i);
+		}
+		if (outside) return 0;
+		return (inside & 0x3F) == 0x3F ? 2 : 1;
+#else
+		bool all = true;
+		for (int i = 0; i < 6; i++)
+		{
+			float dist = f.nx[i] * c[0] + f.ny[i] * c[1] + f.nz[i] * c[2] + f.d[i];
+			float radius = std::fabs(f.nx[i]) * e[0] + std::fabs(f.ny[i]) * e[1] + std::fabs(f.nz[i]) * e[2];
+			if (dist < -radius) return 0;
+			if (dist < radius) all = false;
+		}
+		return all ? 2 : 1;
+#endif
+	}
+
+	// Routine to append all instances of a subtree.
+	void acceptNode(int i, std::vector<int> &visible) const
+	{
+		const Node &node = nodes[i];
+		if (node.count > 0)
+		{
+			for (int j = 0; j < node.count; j++) visible.push_back(items[node.first + j]);
+			return;
+		}
+		acceptNode(i + 1, visible);
+		acceptNode(node.right, visible);
+	}
+
+	void cullNode(int i, const Frustum &f, std::vector<int> &visible, CullStats &stats) const
+	{
+		const Node &node = nodes[i];
+		stats.nodesVisited++;
+		int c = classifyBox(f, node.box);
+		if (c == 0) return;
+		if (c == 2)
+		{
+			acceptNode(i, visible);
+			return;
+		}
+		if (node.count > 0)
+		{
+			int mask = spheresInside(f, node.first);
+			stats.spheresTested += node.count;
+			for (int j = 0; j < node.count; j++) if (mask & (1 << j)) visible.push_back(items[node.first + j]);
+			return;
+		}
+		cullNode(i + 1, f, visible, stats);
+		cullNode(node.right, f, visible, stats);
+	}
+
+	std::vector<Node> nodes;
+	std::vector<int> items; // Instances in leaf order.
+	std::vector<int> itemPos; // Position of each instance in items.
+	std::vector<int> leafOf; // Leaf holding each instance.
+	std::vector<Aabb> itemBoxes; // Box of each instance, by instance.
+	std::vector<float> sphereX, sphereY, sphereZ, sphereR; // Spheres in leaf order, padded.
+	std::vector<int> dirtyLeaves; // Leaves updated since the last refit.
+};
+
+#endif
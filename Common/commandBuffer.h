@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////////
+// commandBuffer.h
+//
+// Command buffers for recording draws on worker threads and submitting them to
+// OpenGL on the thread owning the context.
+//
+// A CommandBuffer is a linear, growable byte buffer of packets - program and vertex
+// array binds, polygon mode, matrix and color uniforms, and draws - each a small
+// header followed by its arguments. Recording touches no GL state and allocates
+// only when the buffer outgrows its largest size so far, so each worker records
+// into a buffer of its own and reuses it frame after frame.
+//
+// replayCommands() runs the packets of a list of buffers in list order on the GL
+// thread. Workers given consecutive ranges of the scene therefore reproduce the
+// single-thread draw order exactly. Program, vertex array and polygon mode changes
+// which would set the value already current are dropped as they are replayed.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+#include <GL/glew.h>
+
+#include "vecmath.h"
+
+// Packet types.
+enum CommandType
+{
+	CMD_USE_PROGRAM, CMD_BIND_VERTEX_ARRAY, CMD_POLYGON_MODE,
+	CMD_UNIFORM_MATRIX, CMD_UNIFORM_COLOR,
+	CMD_DRAW_ARRAYS, CMD_DRAW_ELEMENTS
+};
+
+// Packet header; packets are padded to a multiple of 8 bytes.
+struct CommandHeader
+{
+	unsigned short type, size; // Type and size in bytes including the header.
+};
+
+// Packet arguments.
+struct CmdName { unsigned int name; };
+struct CmdPolygonMode { unsigned int mode; };
+struct CmdUniformMatrix { int location; Mat4 matrix; };
+struct CmdUniformColor { int location; float rgba[4]; };
+struct CmdDrawArrays { unsigned int mode; int first, count; };
+struct CmdDrawElements { unsigned int mode, type; int count, baseVertex; size_t offset; };
+
+class CommandBuffer
+{
+public:
+	CommandBuffer(void) : numCommands(0), used(0) {}
+
+	// Routine to empty the buffer, keeping its memory.
+	void reset(void) { used = 0; numCommands = 0; }
+
+	void useProgram(unsigned int program) { CmdName c = { program }; write(CMD_USE_PROGRAM, c); }
+	void bindVertexArray(unsigned int vao) { CmdName c = { vao }; write(CMD_BIND_VERTEX_ARRAY, c); }
+	void polygonMode(unsigned int mode) { CmdPolygonMode c = { mode }; write(CMD_POLYGON_MODE, c); }
+
+	void uniformMatrix(int location, const Mat4 &m)
+	{
+		CmdUniformMatrix c;
+		c.location = location;
+		c.matrix = m;
+		write(CMD_UNIFORM_MATRIX, c);
+	}
+
+	void uniformColor(int location, float r, float g, float b, float a = 1.0)
+	{
+		CmdUniformColor c = { location, { r, g, b, a } };
+		write(CMD_UNIFORM_COLOR, c);
+	}
+
+	void drawArrays(unsigned int mode, int first, int count)
+	{
+		CmdDrawArrays c = { mode, first, count };
+		write(CMD_DRAW_ARRAYS, c);
+	}
+
+	void drawElements(unsigned int mode, int count, unsigned int type, size_t offset, int baseVertex = 0)
+	{
+		CmdDrawElements c = { mode, type, count, baseVertex, offset };
+		write(CMD_DRAW_ELEMENTS, c);
+	}
+
+	size_t size(void) const { return used; } // Bytes recorded.
+	const unsigned char *begin(void) const { return data.data(); }
+
+	int numCommands; // Packets recorded.
+
+private:
+	template <class T> void write(CommandType type, const T &args)
+	{
+		size_t size = (sizeof(CommandHeader) + sizeof(T) + 7) & ~(size_t)7;
+		if (used + size > data.size()) data.resize(data.empty() ? 4096 : 2 * (used + size));
+		CommandHeader header = { (unsigned short)type, (unsigned short)size };
+		memcpy(&data[used], &header, sizeof(header));
+		memcpy(&data[used + sizeof(header)], &args, sizeof(T));
+		used += size;
+		numCommands++;
+	}
+
+	std::vector<unsigned char> data;
+	size_t used;
+};
+
+// Replay statistics.
+struct ReplayStats
+{
+	int commands; // Packets read.
+	int redundant; // State changes dropped.
+	int draws; // Draw calls issued.
+};
+
+// Routine to read a packet's arguments, which may not be aligned in the buffer.
+template <class T> inline T commandArgs(const unsigned char *p)
+{
+	T args;
+	memcpy(&args, p + sizeof(CommandHeader), sizeof(T));
+	return args;
+}
+
+// Routine to issue the packets of buffers[0], ..., buffers[n - 1] in order. The
+// program, vertex array and polygon mode are assumed unknown on entry.
+inline void replayCommands(const CommandBuffer *buffers, int n, ReplayStats &stats)
+{
+	unsigned int program = ~0u, vao = ~0u, polygonMode = ~0u;
+
+	stats.commands = stats.redundant = stats.draws = 0;
+	for (int b = 0; b < n; b++)
+	{
+		const unsigned char *p = buffers[b].begin(), *end = p + buffers[b].size();
+		while (p < end)
+		{
+			CommandHeader header;
+			memcpy(&header, p, sizeof(header));
+			switch (header.type)
+			{
+			case CMD_USE_PROGRAM:
+			{
+				CmdName c = commandArgs<CmdName>(p);
+				if (c.name == program) stats.redundant++;
+				else glUseProgram(program = c.name);
+				break;
+			}
+			case CMD_BIND_VERTEX_ARRAY:
+			{
+				CmdName c = commandArgs<CmdName>(p);
+				if (c.name == vao) stats.redundant++;
+				else glBindVertexArray(vao = c.name);
+				break;
+			}
+			case CMD_POLYGON_MODE:
+			{
+				CmdPolygonMode c = commandArgs<CmdPolygonMode>(p);
+				if (c.mode == polygonMode) stats.redundant++;
+				else glPolygonMode(GL_FRONT_AND_BACK, polygonMode = c.mode);
+				break;
+			}
+			case CMD_UNIFORM_MATRIX:
+			{
+				CmdUniformMatrix c = commandArgs<CmdUniformMatrix>(p);
+				glUniformMatrix4fv(c.location, 1, GL_FALSE, c.matrix.m);
+				break;
+			}
+			case CMD_UNIFORM_COLOR:
+			{
+				CmdUniformColor c = commandArgs<CmdUniformColor>(p);
+				glUniform4fv(c.location, 1, c.rgba);
+				break;
+			}
+			case CMD_DRAW_ARRAYS:
+			{
+				CmdDrawArrays c = commandArgs<CmdDrawArrays>(p);
+				glDrawArrays(c.mode, c.first, c.count);
+				stats.draws++;
+				break;
+			}
+			case CMD_DRAW_ELEMENTS:
+			{
+				CmdDrawElements c = commandArgs<CmdDrawElements>(p);
+				glDrawElementsBaseVertex(c.mode, c.count, c.type, (void *)c.offset, c.baseVertex);
+				stats.draws++;
+				break;
+			}
+			}
+			stats.commands++;
+			p += header.size;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////////
+// demoHooks.h
+//
+// The measurement and recording hooks of the demos behind five calls:
+//
+//   demoInit(&argc, argv);       // In main(), after glutInit().
+//   demoSetup(setup);            // In main(), after the window and callbacks.
+//   demoFrameBegin();            // At the top of the drawing routine.
+//   demoFrameEnd();              // In place of its glutSwapBuffers() or glFlush().
+//   demoInput();                 // First thing in the keyboard routines.
+//
+// demoInit() reads the options of each header below from the command line;
+// demoSetup() loads the extensions and calls the demo's setup(), marking the
+// stages of startup (startupTimer.h); demoFrameBegin() and demoFrameEnd()
+// bracket the frame for input latency (inputLatency.h), anti-aliasing (postAA.h)
+// and the quality governor (qualityGovernor.h), and demoFrameEnd() reads the frame
+// back for recording (frameCapture.h), swaps the buffers if the window is double
+// buffered, flushes it if not, and ends the frame's profiling (profiler.h).
+//
+// The drawing routine marks its phases with PROFILE_PHASE(name) and no
+// PROFILE_PHASES of its own; the phases are this header's and demoFrameEnd()
+// closes the last.
+//
+// Three hooks are chosen per demo by defining, before including this header,
+//
+//   DEMO_GL_TRACE       call capture (glTrace.h), for the immediate-mode demos;
+//   DEMO_GOVERNOR       the quality governor, for demos registering knobs;
+//   DEMO_NO_POST_AA     no anti-aliasing, for a demo reading its framebuffer.
+//
+// The headers are included here in the order their hooks need: glTrace.h first,
+// to wrap the calls of everything after it, then profiler.h, whose memory
+// accounting hooks the allocations of the headers after it. So this header comes
+// before the demo's other Common headers.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEMO_HOOKS_H
+#define DEMO_HOOKS_H
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#ifdef DEMO_GL_TRACE
+#include "glTrace.h"
+#endif
+#include "profiler.h"
+#include "frameCapture.h"
+#ifndef DEMO_NO_POST_AA
+#include "postAA.h"
+#endif
+#ifdef DEMO_GOVERNOR
+#include "qualityGovernor.h"
+#endif
+#include "inputLatency.h"
+
+// Phases of the frame being drawn, for PROFILE_PHASE().
+#ifdef ENABLE_PROFILER
+static ProfilePhases profilePhases;
+#endif
+#ifdef ENABLE_MEMORY_STATS
+static MemoryPhases memoryPhases;
+#endif
+
+// Routine to read the options of the hooks, removing them from the command line.
+inline void demoInit(int *argc, char **argv)
+{
+#ifdef DEMO_GL_TRACE
+	glTraceInit(argc, argv);
+#endif
+	profileInit(argc, argv);
+	captureInit(argc, argv);
+#ifndef DEMO_NO_POST_AA
+	postAAInit(argc, argv);
+#endif
+#ifdef DEMO_GOVERNOR
+	governorInit(argc, argv);
+#endif
+	latencyInit(argc, argv);
+}
+
+// Routine to load the extensions and call the demo's setup routine, once the window
+// is created, marking the stages of startup.
+inline void demoSetup(void (*setup)(void))
+{
+	startupMark("context creation");
+
+	glewExperimental = GL_TRUE;
+	glewInit();
+	startupMark("extension loading");
+
+	setup();
+	startupMark("resource generation");
+}
+
+// Routine to begin a frame.
+inline void demoFrameBegin(void)
+{
+	latencyFrameBegin();
+#ifdef DEMO_GOVERNOR
+	governorBegin();
+#endif
+#ifndef DEMO_NO_POST_AA
+	postAABegin();
+#endif
+}
+
+// Routine to end a frame: resolves and records it, swaps or flushes, and ends
+// its timing.
+inline void demoFrameEnd(void)
+{
+	static int window = 0; // Window last asked whether double buffered.
+	static bool doubleBuffered = false;
+
+#ifndef DEMO_NO_POST_AA
+	postAAEnd();
+#endif
+#ifdef DEMO_GOVERNOR
+	governorEnd();
+#endif
+	latencySubmit();
+	captureFrame();
+	if (glutGetWindow() != window)
+	{
+		window = glutGetWindow();
+		doubleBuffered = glutGet(GLUT_WINDOW_DOUBLEBUFFER) != 0;
+	}
+	if (doubleBuffered) glutSwapBuffers(); else glFlush();
+	latencySwap();
+
+#ifdef ENABLE_PROFILER
+	profilePhases.next(NULL);
+#endif
+#ifdef ENABLE_MEMORY_STATS
+	memoryPhases.next(NULL);
+#endif
+	profileFrameEnd();
+}
+
+// Routine to note an input event; called first thing in the keyboard routines.
+inline void demoInput(void)
+{
+	latencyInput();
+}
+
+#endif
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////////
+// demoUnit.h
+//
+// A demo as a unit: a class derived from DemoUnit whose members are the demo's
+// globals and whose setup, drawing, reshape, keyboard and mouse routines are the
+// class's, so that the demo's own program and the launcher (launcher.cpp) run the
+// same code, the launcher with an object per window. The demo's program creates
+// its window and hands it the unit:
+//
+//   static Clown3 clown3;
+//   ...
+//   glutCreateWindow("clown3.cpp");
+//   demoUnitCallbacks(&clown3);          // In place of glutDisplayFunc() and the rest.
+//   demoSetup(&clown3);                  // In place of demoSetup(setup).
+//
+// A unit's routines are called with its window current. GLUT's timer and idle
+// routines are plain functions, and the idle routine one for the whole program, so
+// a unit has its own, called back with its window current:
+//
+//   timerFunc(animationPeriod, &Clown3::animate, 1);   // For glutTimerFunc(animationPeriod, animate, 1).
+//   idleFunc(&RotatingHelix2::increaseAngle);          // For glutIdleFunc(increaseAngle).
+//   idleFunc(NULL);                                    // For glutIdleFunc(NULL).
+//
+// A timer set by a unit whose window has since closed does nothing, and the idle
+// routines of all the units are called in turn from the one of GLUT.
+//
+// setup() only sets GL state, so that the launcher, whose windows share a context,
+// can set a window's state again before each of its routines; what is made once
+// per window, buffers, programs and governor knobs, is made in build(), which
+// demoSetup() calls first. destroy() releases it as the launcher closes a window.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DEMO_UNIT_H
+#define DEMO_UNIT_H
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "demoHooks.h"
+
+class DemoUnit
+{
+public:
+	DemoUnit(void) : window(0), idle(NULL) {}
+	virtual ~DemoUnit(void) {}
+
+	virtual void build(void) {}
+	virtual void setup(void) {}
+	virtual void drawScene(void) = 0;
+	virtual void resize(int w, int h) {}
+	virtual void keyInput(unsigned char key, int x, int y) {}
+	virtual void specialKeyInput(int key, int x, int y) {}
+	virtual void mouseControl(int button, int state, int x, int y) {}
+	virtual void printInteraction(void) {}
+	virtual void destroy(void) {}
+
+	// Routine to call timer(value) of this unit after msecs, as glutTimerFunc() does.
+	template <class T> void timerFunc(unsigned int msecs, void (T::*timer)(int), int value)
+	{
+		timerFunc(msecs, static_cast<void (DemoUnit::*)(int)>(timer), value);
+	}
+	void timerFunc(unsigned int msecs, void (DemoUnit::*timer)(int), int value);
+
+	// Routine to set the idle routine of this unit, or clear it with NULL, as
+	// glutIdleFunc() does.
+	template <class T> void idleFunc(void (T::*routine)(void))
+	{
+		idleFunc(static_cast<void (DemoUnit::*)(void)>(routine));
+	}
+	void idleFunc(void (DemoUnit::*routine)(void));
+
+	int window; // GLUT window.
+	void (DemoUnit::*idle)(void); // Idle routine, NULL if none.
+};
+
+// A timer set by a unit.
+struct DemoTimer
+{
+	DemoUnit *unit; // NULL once called or its window closed.
+	void (DemoUnit::*timer)(int);
+	int value;
+};
+
+static std::vector<DemoUnit *> demoUnits; // Units with a window, in order of opening.
+static std::vector<DemoTimer> demoTimers; // Timers set, a slot reused once free.
+static std::vector<DemoUnit *> demoIdleUnits; // Units with an idle routine.
+
+// Routine to attach a unit to the current window.
+inline void demoUnitAttach(DemoUnit *unit)
+{
+	unit->window = glutGetWindow();
+	demoUnits.push_back(unit);
+}
+
+// Routine to detach a unit whose window is closing, dropping its timers and idle
+// routine.
+inline void demoUnitDetach(DemoUnit *unit)
+{
+	for (size_t k = 0; k < demoTimers.size(); k++)
+		if (demoTimers[k].unit == unit) demoTimers[k].unit = NULL;
+	unit->idleFunc(NULL);
+	demoUnits.erase(std::remove(demoUnits.begin(), demoUnits.end(), unit), demoUnits.end());
+}
+
+// Routine to return the unit of the current window, NULL if none.
+inline DemoUnit *demoUnitCurrent(void)
+{
+	int window = glutGetWindow();
+	for (size_t k = 0; k < demoUnits.size(); k++)
+		if (demoUnits[k]->window == window) return demoUnits[k];
+	return NULL;
+}
+
+// Timer function of every unit, slot indexing demoTimers.
+inline void demoUnitTimer(int slot)
+{
+	DemoTimer timer = demoTimers[slot];
+	demoTimers[slot].unit = NULL;
+	if (timer.unit)
+	{
+		glutSetWindow(timer.unit->window);
+		(timer.unit->*timer.timer)(timer.value);
+	}
+}
+
+inline void DemoUnit::timerFunc(unsigned int msecs, void (DemoUnit::*timer)(int), int value)
+{
+	size_t slot = 0;
+	while (slot < demoTimers.size() && demoTimers[slot].unit) slot++;
+	DemoTimer t = { this, timer, value };
+	if (slot == demoTimers.size()) demoTimers.push_back(t);
+	else demoTimers[slot] = t;
+	glutTimerFunc(msecs, demoUnitTimer, (int)slot);
+}
+
+// Idle routine of every unit: calls each unit's in turn. The launcher, running its
+// own loop, calls it while demoIdleUnits is not empty.
+inline void demoUnitIdle(void)
+{
+	std::vector<DemoUnit *> units = demoIdleUnits; // An idle routine may clear itself.
+	for (size_t k = 0; k < units.size(); k++)
+		if (units[k]->idle)
+		{
+			glutSetWindow(units[k]->window);
+			(units[k]->*units[k]->idle)();
+		}
+}
+
+inline void DemoUnit::idleFunc(void (DemoUnit::*routine)(void))
+{
+	idle = routine;
+	std::vector<DemoUnit *>::iterator k = std::find(demoIdleUnits.begin(), demoIdleUnits.end(), this);
+	if (idle && k == demoIdleUnits.end()) demoIdleUnits.push_back(this);
+	if (!idle && k != demoIdleUnits.end()) demoIdleUnits.erase(k);
+	glutIdleFunc(demoIdleUnits.empty() ? NULL : demoUnitIdle);
+}
+
+// Callback routines of a demo's own window, calling its unit's.
+inline void demoUnitDrawScene(void) { demoUnitCurrent()->drawScene(); }
+inline void demoUnitResize(int w, int h) { demoUnitCurrent()->resize(w, h); }
+inline void demoUnitKeyInput(unsigned char key, int x, int y) { demoUnitCurrent()->keyInput(key, x, y); }
+inline void demoUnitSpecialKeyInput(int key, int x, int y) { demoUnitCurrent()->specialKeyInput(key, x, y); }
+inline void demoUnitMouseControl(int button, int state, int x, int y) { demoUnitCurrent()->mouseControl(button, state, x, y); }
+
+// Routine to attach a unit to the current window and register the callback
+// routines calling its routines.
+inline void demoUnitCallbacks(DemoUnit *unit)
+{
+	demoUnitAttach(unit);
+	glutDisplayFunc(demoUnitDrawScene);
+	glutReshapeFunc(demoUnitResize);
+	glutKeyboardFunc(demoUnitKeyInput);
+	glutSpecialFunc(demoUnitSpecialKeyInput);
+	glutMouseFunc(demoUnitMouseControl);
+}
+
+// Routine to load the extensions, then build and set up a unit, as demoSetup() does
+// a demo's setup routine.
+inline void demoSetup(DemoUnit *unit)
+{
+	static DemoUnit *setupUnit; // Unit being set up.
+	struct Setup
+	{
+		static void routine(void)
+		{
+			setupUnit->build();
+			setupUnit->setup();
+		}
+	};
+	setupUnit = unit;
+	demoSetup(Setup::routine);
+}
+
+#endif
@@ -0,0 +1,427 @@
+////////////////////////////////////////////////////////////////////////////////////
+// frameCapture.h
+//
+// Recording of the frames of a demo to PNG or PPM files without stalling the
+// render thread.
+//
+// glReadPixels() into client memory waits for the GPU to finish the frame. Here
+// each frame is instead read into one of a ring of GL_PIXEL_PACK_BUFFER objects,
+// which returns at once, and a fence is inserted after it. At later frames the
+// fence is polled; once it has signaled, typically one or two frames on, the
+// buffer is mapped and handed, still mapped, to a pool of encoder threads. An
+// encoder flips the rows (GL's are bottom-up), converts RGBA to RGB (with SSSE3
+// where available), encodes the image and writes it; the render thread unmaps
+// the buffer when the encoder is done and reuses it. The render thread only
+// waits if every buffer of the ring is still busy.
+//
+// A demo calls captureInit(&argc, argv) after glutInit() and captureFrame() just
+// before its glutSwapBuffers() or glFlush(). Run as
+//
+//   demo -record frames/helix png        (or ppm)
+//
+// it writes frames/helix_00000.png, ... for every frame drawn, and on exit the
+// number of frames and the time captureFrame() cost the render thread. The frames
+// in flight are finished when the window is closed, by a close callback which
+// captureFrame() sets, while the context still exists; a demo which sets its own
+// with glutCloseFunc() calls captureClose() from it. PNGs are
+// written with stored (uncompressed) deflate blocks, there being no zlib here;
+// PPM is the raw RGB with a short header. Without -record captureFrame() costs
+// one test of a flag.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define CAPTURE_SSSE3
+#endif
+
+#define CAPTURE_BUFFERS 4 // Pixel pack buffers in the ring.
+
+// Output formats.
+enum CaptureFormat { CAPTURE_PNG, CAPTURE_PPM };
+
+// States of a pixel pack buffer.
+enum { SLOT_FREE, SLOT_READING, SLOT_ENCODING, SLOT_DONE };
+
+// A pixel pack buffer of the ring.
+struct CaptureSlot
+{
+	unsigned int buffer;
+	GLsync fence; // Signaled when the read into buffer is complete.
+	std::atomic<int> state;
+	const unsigned char *mapped; // While encoding.
+	int frame, width, height;
+};
+
+// Routine to convert a row of RGBA pixels to RGB.
+inline void captureRgbaToRgb(const unsigned char *in, unsigned char *out, int width)
+{
+	int i = 0;
+#ifdef CAPTURE_SSSE3
+	const __m128i drop = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	for (; i + 6 <= width; i += 4) // Each store writes 16 bytes, 4 beyond the 4 pixels.
+		_mm_storeu_si128((__m128i *)(out + 3 * i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 4 * i)), drop));
+#endif
+	for (; i < width; i++)
+	{
+		out[3 * i] = in[4 * i];
+		out[3 * i + 1] = in[4 * i + 1];
+		out[3 * i + 2] = in[4 * i + 2];
+	}
+}
+
+// Routine to give the CRC-32 of PNG chunks, continuing from crc.
+inline unsigned int captureCrc(unsigned int crc, const unsigned char *p, size_t n)
+{
+	static unsigned int table[256];
+	static bool made = false;
+	if (!made) // Filled identically by any thread, so a race is harmless.
+	{
+		for (unsigned int k = 0; k < 256; k++)
+		{
+			unsigned int c = k;
+			for (int j = 0; j < 8; j++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			table[k] = c;
+		}
+		made = true;
+	}
+	crc = ~crc;
+	for (size_t i = 0; i < n; i++) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+// Routine to append a big-endian 32-bit value.
+inline void capturePut32(std::vector<unsigned char> &out, unsigned int v)
+{
+	unsigned char b[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+	out.insert(out.end(), b, b + 4);
+}
+
+// Routine to append a PNG chunk whose data are the bytes after its type.
+inline void capturePngChunk(std::vector<unsigned char> &out, const char *type, const unsigned char *data, size_t n)
+{
+	capturePut32(out, (unsigned int)n);
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data, data + n);
+	capturePut32(out, captureCrc(0, &out[start], n + 4));
+}
+
+// Routine to encode the RGB image (top row first, rows preceded by their filter
+// byte) as a PNG into out.
+inline void captureEncodePng(const std::vector<unsigned char> &rows, int width, int height,
+	std::vector<unsigned char> &out, std::vector<unsigned char> &zlib)
+{
+	const unsigned char signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	unsigned char header[13] = { (unsigned char)(width >> 24), (unsigned char)(width >> 16), (unsigned char)(width >> 8),
+		(unsigned char)width, (unsigned char)(height >> 24), (unsigned char)(height >> 16), (unsigned char)(height >> 8),
+		(unsigned char)height, 8, 2, 0, 0, 0 }; // 8 bits, RGB, deflate, no filtering method, no interlace.
+
+	// zlib stream of stored blocks of up to 65535 bytes, then the Adler-32 of the rows.
+	zlib.clear();
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	size_t n = rows.size();
+	for (size_t pos = 0; pos < n || pos == 0; )
+	{
+		size_t len = n - pos < 65535 ? n - pos : 65535;
+		zlib.push_back(pos + len == n ? 1 : 0);
+		unsigned char lens[4] = { (unsigned char)len, (unsigned char)(len >> 8), (unsigned char)~len, (unsigned char)(~len >> 8) };
+		zlib.insert(zlib.end(), lens, lens + 4);
+		zlib.insert(zlib.end(), rows.begin() + pos, rows.begin() + pos + len);
+		pos += len;
+		if (n == 0) break;
+	}
+	unsigned int a = 1, b = 0;
+	for (size_t i = 0; i < n; )
+	{
+		size_t end = i + 5552 < n ? i + 5552 : n; // Longest run without overflow.
+		for (; i < end; i++)
+		{
+			a += rows[i];
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	capturePut32(zlib, (b << 16) | a);
+
+	out.clear();
+	out.insert(out.end(), signature, signature + 8);
+	capturePngChunk(out, "IHDR", header, 13);
+	capturePngChunk(out, "IDAT", zlib.data(), zlib.size());
+	capturePngChunk(out, "IEND", NULL, 0);
+}
+
+// Capture state.
+struct CaptureState
+{
+	CaptureState(void) : on(false), format(CAPTURE_PNG), frame(0), next(0), width(0), height(0),
+		quit(false), closeSet(false), stalls(0), renderMicros(0.0) {}
+
+	bool on; // Recording?
+	std::string prefix; // File names.
+	int format;
+	int frame; // Frames captured.
+	int next; // Slot for the next frame.
+	int width, height; // Size of the slots' buffers.
+	CaptureSlot slots[CAPTURE_BUFFERS];
+
+	std::vector<std::thread> encoders;
+	std::deque<CaptureSlot *> jobs;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	bool quit;
+	bool closeSet; // Close callback set?
+
+	long long stalls; // Waits for a busy buffer.
+	double renderMicros; // Time spent in captureFrame().
+};
+
+static CaptureState capture;
+
+// Routine run by each encoder thread.
+inline void captureEncoder(void)
+{
+	std::vector<unsigned char> rows, out, zlib;
+	for (;;)
+	{
+		CaptureSlot *slot;
+		{
+			std::unique_lock<std::mutex> lock(capture.mutex);
+			capture.wake.wait(lock, [] { return capture.quit || !capture.jobs.empty(); });
+			if (capture.jobs.empty()) return;
+			slot = capture.jobs.front();
+			capture.jobs.pop_front();
+		}
+
+		// Flip and convert into rows, each preceded by the PNG filter byte (none).
+		int w = slot->width, h = slot->height;
+		bool png = capture.format == CAPTURE_PNG;
+		size_t stride = 3 * w + (png ? 1 : 0);
+		rows.resize(stride * h);
+		for (int y = 0; y < h; y++)
+		{
+			unsigned char *row = &rows[stride * y];
+			if (png) *row++ = 0;
+			captureRgbaToRgb(slot->mapped + 4 * (size_t)w * (h - 1 - y), row, w);
+		}
+		int frame = slot->frame;
+		{
+			std::lock_guard<std::mutex> lock(capture.mutex);
+			slot->state = SLOT_DONE; // The mapped memory is no longer needed.
+		}
+		capture.done.notify_all();
+
+		char name[32];
+		sprintf(name, png ? "_%05d.png" : "_%05d.ppm", frame);
+		FILE *file = fopen((capture.prefix + name).c_str(), "wb");
+		if (!file) continue;
+		if (png)
+		{
+			captureEncodePng(rows, w, h, out, zlib);
+			fwrite(out.data(), 1, out.size(), file);
+		}
+		else
+		{
+			fprintf(file, "P6\n%d %d\n255\n", w, h);
+			fwrite(rows.data(), 1, rows.size(), file);
+		}
+		fclose(file);
+	}
+}
+
+// Routine to map a slot whose read has completed and queue it for encoding.
+inline void captureSubmit(CaptureSlot &slot)
+{
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	slot.mapped = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		4 * (size_t)slot.width * slot.height, GL_MAP_READ_BIT);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	{
+		std::lock_guard<std::mutex> lock(capture.mutex);
+		slot.state = SLOT_ENCODING;
+		capture.jobs.push_back(&slot);
+	}
+	capture.wake.notify_one();
+}
+
+// Routine to unmap a slot its encoder has finished with.
+inline void captureRelease(CaptureSlot &slot)
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.mapped = NULL;
+	slot.state = SLOT_FREE;
+}
+
+// Routine to advance the slots without waiting: submit completed reads, release
+// encoded buffers.
+inline void captureService(void)
+{
+	for (int i = 0; i < CAPTURE_BUFFERS; i++)
+	{
+		CaptureSlot &slot = capture.slots[i];
+		if (slot.state == SLOT_READING && glClientWaitSync(slot.fence, 0, 0) != GL_TIMEOUT_EXPIRED) captureSubmit(slot);
+		if (slot.state == SLOT_DONE) captureRelease(slot);
+	}
+}
+
+// Routine to make a slot free, waiting for the GPU and its encoder if need be.
+inline void captureWaitFree(CaptureSlot &slot)
+{
+	if (slot.state == SLOT_FREE) return;
+	capture.stalls++;
+	if (slot.state == SLOT_READING)
+	{
+		while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+		captureSubmit(slot);
+	}
+	{
+		std::unique_lock<std::mutex> lock(capture.mutex);
+		capture.done.wait(lock, [&slot] { return slot.state == SLOT_DONE; });
+	}
+	captureRelease(slot);
+}
+
+// Routine to (re)create the buffers for frames of width x height.
+inline void captureResize(int width, int height)
+{
+	for (int i = 0; i < CAPTURE_BUFFERS; i++)
+	{
+		CaptureSlot &slot = capture.slots[i];
+		if (capture.width) captureWaitFree(slot);
+		else glGenBuffers(1, &slot.buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, 4 * (size_t)width * height, NULL, GL_STREAM_READ);
+		slot.width = width;
+		slot.height = height;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	capture.width = width;
+	capture.height = height;
+}
+
+// Routine to finish the frames in flight, while the context is current, so that
+// no encoder reads a buffer after it is gone.
+inline void captureDrain(void)
+{
+	for (int i = 0; i < CAPTURE_BUFFERS; i++)
+	{
+		int k = (capture.next + i) % CAPTURE_BUFFERS; // Oldest first.
+		if (capture.slots[k].state != SLOT_FREE)
+		{
+			captureWaitFree(capture.slots[k]);
+			capture.stalls--; // Not a stall of a frame.
+		}
+	}
+}
+
+// Close callback routine: finishes the frames in flight before GLUT destroys the
+// window and its context.
+inline void captureClose(void)
+{
+	if (capture.on) captureDrain();
+}
+
+// Routine to start the read of the frame drawn; called before the swap or flush.
+inline void captureFrame(void)
+{
+	if (!capture.on) return;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	if (!capture.closeSet)
+	{
+		glutCloseFunc(captureClose);
+		capture.closeSet = true;
+	}
+
+	int width = glutGet(GLUT_WINDOW_WIDTH), height = glutGet(GLUT_WINDOW_HEIGHT);
+	if (width != capture.width || height != capture.height) captureResize(width, height);
+	captureService();
+
+	CaptureSlot &slot = capture.slots[capture.next];
+	captureWaitFree(slot);
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.frame = capture.frame++;
+	slot.state = SLOT_READING;
+	capture.next = (capture.next + 1) % CAPTURE_BUFFERS;
+
+	capture.renderMicros += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Routine to finish the frames still in flight and stop the encoders; registered
+// with atexit(), as the demos leave by exit().
+inline void captureFinish(void)
+{
+	if (!capture.on) return;
+	bool context = glutGet(GLUT_INIT_STATE) != 0; // No context once GLUT is gone.
+	size_t lost = 0; // Frames whose buffers went with the context.
+	if (context) captureDrain();
+	capture.on = false;
+	{
+		std::lock_guard<std::mutex> lock(capture.mutex);
+		if (!context)
+		{
+			lost = capture.jobs.size();
+			capture.jobs.clear();
+		}
+		capture.quit = true;
+	}
+	capture.wake.notify_all();
+	for (auto &e : capture.encoders) e.join();
+	capture.encoders.clear();
+
+	std::cout << "Recorded " << capture.frame << " frames to " << capture.prefix << "_*."
+		<< (capture.format == CAPTURE_PNG ? "png" : "ppm") << ", " << capture.stalls << " stalls, "
+		<< (capture.frame ? capture.renderMicros / capture.frame : 0.0) << " us a frame on the render thread" << std::endl;
+	if (lost) std::cout << "Lost the last " << lost << " frames: the context was gone" << std::endl;
+}
+
+// Routine to start recording if the command line holds -record prefix format,
+// removing those arguments.
+inline void captureInit(int *argc, char **argv)
+{
+	for (int i = 1; i + 2 < *argc; i++)
+	{
+		if (strcmp(argv[i], "-record")) continue;
+		capture.prefix = argv[i + 1];
+		capture.format = strcmp(argv[i + 2], "ppm") ? CAPTURE_PNG : CAPTURE_PPM;
+		for (int j = i; j + 3 <= *argc; j++) argv[j] = argv[j + 3];
+		*argc -= 3;
+		capture.on = true;
+
+		int n = (int)std::thread::hardware_concurrency() - 1;
+		for (int k = 0; k < (n > 1 ? n : 1); k++) capture.encoders.push_back(std::thread(captureEncoder));
+		for (int k = 0; k < CAPTURE_BUFFERS; k++) capture.slots[k].state = SLOT_FREE;
+		atexit(captureFinish);
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,840 @@
+////////////////////////////////////////////////////////////////////////////////////
+// glTrace.h
+//
+// Capture of the OpenGL, GLU and GLUT drawing calls of a demo to a binary trace,
+// for replay by traceReplay.cpp, or by softRaster.cpp on the CPU.
+//
+// A demo opts in by including this header after GL/glew.h and GL/freeglut.h and
+// calling glTraceInit(&argc, argv) after glutInit(). Run as
+//
+//   demo -capture trace.bin 300
+//
+// it then records every call it makes to the functions listed below, with their
+// data, from startup until 300 frames have ended (a frame ends with
+// glutSwapBuffers() or glFlush()), and writes the trace. Without -capture each
+// hook costs one test of a flag.
+//
+// The hooks are macros renaming the calls in the demo's own source to the
+// recording functions below; calls made inside GLU and GLUT are not seen, the GLU
+// and GLUT calls themselves being recorded instead. Client-side vertex arrays are
+// recorded at each glDrawElements(): the indices and, for every enabled array,
+// the elements up to the largest index. Vertex buffers and shaders are outside the
+// immediate-mode subset recorded here: draws from buffer objects (glDrawArrays(),
+// glDrawArraysInstanced(), glDrawElements() with a buffer bound,
+// glDrawElementsBaseVertex(), glDrawElementsInstanced() and the glMultiDraw*Indirect()
+// calls), such as those of vertexFormat.h, wideLines.h or postAA.h, are not
+// recorded but counted, and the counts written when the trace is, so a replay
+// missing them does not go unexplained.
+//
+// Trace format, all values little-endian as written by the CPU:
+//   header: "GLTR", uint32 version, uint32 number of frames, uint32 window width
+//   and height at the end of capture;
+//   records: uint8 opcode (TraceOp) followed by its arguments, in the order of the
+//   call's parameters, enums as uint32, GLdouble arguments as double and the rest
+//   as float or int32. Variable-length arguments are preceded by their count.
+//   TRACE_FRAME_END carries a uint8 (1 for a swap) and a uint64 time in
+//   microseconds since capture started, giving the original pacing.
+//
+// The format is read back by TraceReader, which checks every read against the end
+// of the trace and every count and index against what it bounds, so that a
+// truncated or corrupt trace is reported rather than read outside its buffers.
+// Define GL_TRACE_NO_HOOKS before including to get only the format and the reader,
+// as traceReplay.cpp and softRaster.cpp do.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define GL_TRACE_VERSION 1
+
+// Opcodes of the recorded calls.
+enum TraceOp
+{
+	TRACE_FRAME_END,
+	TRACE_BEGIN, TRACE_END, TRACE_VERTEX3F, TRACE_COLOR3F,
+	TRACE_MATRIX_MODE, TRACE_LOAD_IDENTITY, TRACE_PUSH_MATRIX, TRACE_POP_MATRIX,
+	TRACE_TRANSLATEF, TRACE_ROTATEF, TRACE_SCALEF,
+	TRACE_FRUSTUM, TRACE_ORTHO, TRACE_PERSPECTIVE, TRACE_LOOK_AT,
+	TRACE_VIEWPORT, TRACE_CLEAR, TRACE_CLEAR_COLOR,
+	TRACE_ENABLE, TRACE_DISABLE, TRACE_POLYGON_MODE, TRACE_CULL_FACE, TRACE_LINE_WIDTH,
+	TRACE_LIGHTFV, TRACE_LIGHTF, TRACE_LIGHT_MODELFV, TRACE_LIGHT_MODELI, TRACE_MATERIALFV,
+	TRACE_RASTER_POS3F, TRACE_BITMAP_CHARACTER,
+	TRACE_WIRE_SPHERE, TRACE_SOLID_SPHERE, TRACE_WIRE_CUBE, TRACE_WIRE_CONE, TRACE_WIRE_TORUS,
+	TRACE_ENABLE_CLIENT_STATE, TRACE_DISABLE_CLIENT_STATE, TRACE_DRAW_ELEMENTS,
+	NUM_TRACE_OPS
+};
+
+// Draw calls counted but not recorded.
+enum TraceUntraced
+{
+	UNTRACED_DRAW_ARRAYS, UNTRACED_DRAW_ARRAYS_INSTANCED, UNTRACED_DRAW_ELEMENTS_BUFFER,
+	UNTRACED_DRAW_ELEMENTS_BASE_VERTEX, UNTRACED_DRAW_ELEMENTS_INSTANCED,
+	UNTRACED_MULTI_DRAW_ARRAYS_INDIRECT, UNTRACED_MULTI_DRAW_ELEMENTS_INDIRECT,
+	NUM_UNTRACED
+};
+
+// Arrays recorded with TRACE_DRAW_ELEMENTS, as bits of a uint8 mask.
+enum TraceArray { TRACE_ARRAY_VERTEX = 1, TRACE_ARRAY_NORMAL = 2, TRACE_ARRAY_COLOR = 4 };
+
+// Routine to give the number of values glLightfv(), glLightModelfv() or
+// glMaterialfv() reads for pname.
+inline int traceParamCount(unsigned int pname)
+{
+	switch (pname)
+	{
+	case GL_SPOT_DIRECTION:
+	case GL_COLOR_INDEXES:
+		return 3;
+	case GL_SPOT_EXPONENT:
+	case GL_SPOT_CUTOFF:
+	case GL_CONSTANT_ATTENUATION:
+	case GL_LINEAR_ATTENUATION:
+	case GL_QUADRATIC_ATTENUATION:
+	case GL_SHININESS:
+	case GL_LIGHT_MODEL_LOCAL_VIEWER:
+	case GL_LIGHT_MODEL_TWO_SIDE:
+		return 1;
+	default:
+		return 4;
+	}
+}
+
+// GLUT bitmap fonts by trace index.
+inline void *traceFont(int index)
+{
+	void *fonts[] = { GLUT_BITMAP_8_BY_13, GLUT_BITMAP_9_BY_15, GLUT_BITMAP_TIMES_ROMAN_10,
+		GLUT_BITMAP_TIMES_ROMAN_24, GLUT_BITMAP_HELVETICA_10, GLUT_BITMAP_HELVETICA_12, GLUT_BITMAP_HELVETICA_18 };
+	return (index >= 0 && index < 7) ? fonts[index] : GLUT_BITMAP_8_BY_13;
+}
+
+// A glDrawElements() read from a trace: its indices and, for the vertex, normal and
+// color arrays recorded, size values for each of n elements.
+struct TraceDraw
+{
+	unsigned int mode, type;
+	int count, indexSize;
+	std::vector<unsigned char> indices;
+	int sizes[3], counts[3]; // Size and elements of each array, 0 if not recorded.
+	std::vector<float> arrays[3];
+
+	// Routine to give the i-th index.
+	unsigned int index(int i) const
+	{
+		unsigned int value = 0;
+		memcpy(&value, &indices[(size_t)i * indexSize], indexSize); // Little-endian, as the trace.
+		return value;
+	}
+};
+
+// Reader of a trace. A read past the end, a count out of range or an index past
+// its arrays marks the trace bad: ok turns false, badPos keeps the byte of the
+// record's failing read, the reads return zeros and more() ends the replay. What
+// the read fills in, parameters or a draw, is only used if the read succeeds.
+struct TraceReader
+{
+	std::vector<unsigned char> data; // The trace without its header.
+	size_t pos, badPos; // Read position, position of the bad read.
+	bool ok; // No bad read?
+	unsigned int numFrames;
+	int width, height; // Window size at the end of capture.
+
+	TraceReader(void) : pos(0), badPos(0), ok(true), numFrames(0), width(500), height(500) {}
+
+	// Routine to load the trace file, checking its header.
+	bool load(const char *path)
+	{
+		unsigned int header[5];
+		FILE *file = fopen(path, "rb");
+
+		if (!file) return false;
+		if (fread(header, sizeof(header), 1, file) != 1 || memcmp(header, "GLTR", 4) || header[1] != GL_TRACE_VERSION)
+		{
+			fclose(file);
+			return false;
+		}
+		numFrames = header[2];
+		width = (int)header[3];
+		height = (int)header[4];
+
+		fseek(file, 0, SEEK_END);
+		long end = ftell(file); // -1 on failure, or for a file past the range of long.
+		bool isRead = end >= (long)sizeof(header);
+		if (isRead)
+		{
+			size_t size = end - sizeof(header);
+			fseek(file, sizeof(header), SEEK_SET);
+			data.resize(size);
+			isRead = fread(data.data(), 1, size, file) == size;
+		}
+		fclose(file);
+		return isRead;
+	}
+
+	// Routine to start reading from the beginning.
+	void rewind(void) { pos = 0; }
+
+	// Routine to tell if records are left to read.
+	bool more(void) const { return ok && pos < data.size(); }
+
+	// Routine to mark the trace bad at the current position, ending the reads.
+	void fail(void)
+	{
+		if (ok) badPos = pos;
+		ok = false;
+		pos = data.size();
+	}
+
+	// Routine to tell if bytes more are in the trace, failing if not.
+	bool has(size_t bytes)
+	{
+		if (ok && bytes <= data.size() - pos) return true;
+		fail();
+		return false;
+	}
+
+	// Routine to read a value, 0 past the end.
+	template <class T> T get(void)
+	{
+		T value = T();
+		if (has(sizeof(T)))
+		{
+			memcpy(&value, &data[pos], sizeof(T));
+			pos += sizeof(T);
+		}
+		return value;
+	}
+
+	// Routine to read count values of type T into v, returning false, with v empty,
+	// past the end.
+	template <class T> bool getArray(std::vector<T> &v, size_t count)
+	{
+		v.clear();
+		if (ok && count > (data.size() - pos) / sizeof(T)) fail();
+		if (!ok) return false;
+		v.resize(count);
+		if (count) memcpy(v.data(), &data[pos], count * sizeof(T));
+		pos += count * sizeof(T);
+		return true;
+	}
+
+	// Routine to skip bytes.
+	void skip(size_t bytes)
+	{
+		if (has(bytes)) pos += bytes;
+	}
+
+	// Routine to read the counted values of a glLightfv(), glLightModelfv() or
+	// glMaterialfv() into params, the rest left as they are; the count must be the
+	// one pname takes.
+	bool getParams(unsigned int pname, float params[4])
+	{
+		int n = get<unsigned char>();
+		if (n != traceParamCount(pname)) { fail(); return false; }
+		for (int i = 0; i < n; i++) params[i] = get<float>();
+		return ok;
+	}
+
+	// Routine to read a glDrawElements() into draw, checking the index type, the
+	// array sizes and that every index is within every array recorded.
+	bool getDraw(TraceDraw &draw)
+	{
+		static const int minSizes[3] = { 2, 3, 3 }, maxSizes[3] = { 4, 3, 4 };
+
+		draw.mode = get<unsigned int>();
+		draw.count = get<int>();
+		draw.type = get<unsigned int>();
+		if (draw.type != GL_UNSIGNED_BYTE && draw.type != GL_UNSIGNED_SHORT && draw.type != GL_UNSIGNED_INT) fail();
+		draw.indexSize = draw.type == GL_UNSIGNED_BYTE ? 1 : (draw.type == GL_UNSIGNED_SHORT ? 2 : 4);
+		if (draw.count < 0) fail();
+		if (!ok || !getArray(draw.indices, (size_t)draw.count * draw.indexSize)) return false;
+		int mask = get<unsigned char>();
+		for (int k = 0; k < 3; k++)
+		{
+			draw.sizes[k] = draw.counts[k] = 0;
+			draw.arrays[k].clear();
+			if (!(mask & (1 << k))) continue;
+			draw.sizes[k] = get<int>();
+			draw.counts[k] = get<int>();
+			if (draw.sizes[k] < minSizes[k] || draw.sizes[k] > maxSizes[k] || draw.counts[k] < 0) fail();
+			if (!ok || !getArray(draw.arrays[k], (size_t)draw.sizes[k] * draw.counts[k])) return false;
+		}
+		for (int i = 0; i < draw.count; i++)
+			for (int k = 0; k < 3; k++)
+				if (draw.sizes[k] && draw.index(i) >= (unsigned int)draw.counts[k])
+				{
+					fail();
+					return false;
+				}
+		return ok;
+	}
+};
+
+#ifndef GL_TRACE_NO_HOOKS
+
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+// Capture state.
+struct GlTraceState
+{
+	bool on; // Recording?
+	const char *path; // File to write.
+	int framesLeft, frames; // Frames still to record, frames recorded.
+	std::vector<unsigned char> data; // The trace so far.
+	std::chrono::high_resolution_clock::time_point start;
+
+	// Client arrays as last specified.
+	bool arrayEnabled[3];
+	bool arrayInBuffer[3]; // Specified with a buffer bound, the pointer an offset?
+	int arraySize[3], arrayStride[3];
+	const void *arrayPointer[3];
+
+	int untraced[NUM_UNTRACED]; // Draws not recorded, by call.
+
+	template <class T> void put(T value)
+	{
+		size_t n = data.size();
+		data.resize(n + sizeof(T));
+		memcpy(&data[n], &value, sizeof(T));
+	}
+	void putBytes(const void *p, size_t bytes)
+	{
+		size_t n = data.size();
+		data.resize(n + bytes);
+		memcpy(&data[n], p, bytes);
+	}
+	void op(TraceOp code) { put((unsigned char)code); }
+};
+
+static GlTraceState glTrace = GlTraceState();
+
+// Routine to write the trace and stop recording.
+inline void glTraceFinish(void)
+{
+	unsigned int header[5] = { 0, GL_TRACE_VERSION, (unsigned int)glTrace.frames,
+		(unsigned int)glutGet(GLUT_WINDOW_WIDTH), (unsigned int)glutGet(GLUT_WINDOW_HEIGHT) };
+	FILE *file = fopen(glTrace.path, "wb");
+
+	glTrace.on = false;
+	memcpy(header, "GLTR", 4);
+	if (!file || fwrite(header, sizeof(header), 1, file) != 1 ||
+		fwrite(glTrace.data.data(), 1, glTrace.data.size(), file) != glTrace.data.size())
+		std::cout << "Could not write trace " << glTrace.path << std::endl;
+	else
+		std::cout << "Captured " << glTrace.frames << " frames (" << glTrace.data.size() << " bytes) to "
+		<< glTrace.path << std::endl;
+	if (file) fclose(file);
+	std::vector<unsigned char>().swap(glTrace.data);
+
+	static const char *names[NUM_UNTRACED] = { "glDrawArrays()", "glDrawArraysInstanced()",
+		"glDrawElements() from a buffer", "glDrawElementsBaseVertex()", "glDrawElementsInstanced()",
+		"glMultiDrawArraysIndirect()", "glMultiDrawElementsIndirect()" };
+	for (int k = 0; k < NUM_UNTRACED; k++)
+		if (glTrace.untraced[k])
+			std::cout << "Not captured: " << glTrace.untraced[k] << " calls to " << names[k] << std::endl;
+}
+
+// Routine to start capture if the command line holds -capture file frames, removing
+// those arguments.
+inline void glTraceInit(int *argc, char **argv)
+{
+	for (int i = 1; i + 2 < *argc; i++)
+	{
+		if (strcmp(argv[i], "-capture")) continue;
+		glTrace.path = argv[i + 1];
+		glTrace.framesLeft = atoi(argv[i + 2]);
+		for (int j = i; j + 3 <= *argc; j++) argv[j] = argv[j + 3];
+		*argc -= 3;
+		glTrace.on = glTrace.framesLeft > 0;
+		glTrace.data.reserve(1 << 20);
+		glTrace.start = std::chrono::high_resolution_clock::now();
+		break;
+	}
+}
+
+// Routine to record the end of a frame.
+inline void glTraceFrameEnd(bool swap)
+{
+	glTrace.op(TRACE_FRAME_END);
+	glTrace.put((unsigned char)swap);
+	glTrace.put((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::high_resolution_clock::now() - glTrace.start).count());
+	glTrace.frames++;
+	if (--glTrace.framesLeft == 0) glTraceFinish();
+}
+
+// Routine to record the elements of an enabled client array up to element count - 1.
+inline void glTraceArray(int k, int count)
+{
+	int size = glTrace.arraySize[k];
+	int stride = glTrace.arrayStride[k] ? glTrace.arrayStride[k] : size * (int)sizeof(float);
+
+	glTrace.put(size);
+	glTrace.put(count);
+	for (int i = 0; i < count; i++) glTrace.putBytes((const char *)glTrace.arrayPointer[k] + i * stride, size * sizeof(float));
+}
+
+// The hooks: each records its call when capturing, then makes it.
+
+inline void glTraceBegin(GLenum mode)
+{
+	if (glTrace.on) { glTrace.op(TRACE_BEGIN); glTrace.put(mode); }
+	glBegin(mode);
+}
+
+inline void glTraceEnd(void)
+{
+	if (glTrace.on) glTrace.op(TRACE_END);
+	glEnd();
+}
+
+inline void glTraceVertex3f(GLfloat x, GLfloat y, GLfloat z)
+{
+	if (glTrace.on) { glTrace.op(TRACE_VERTEX3F); glTrace.put(x); glTrace.put(y); glTrace.put(z); }
+	glVertex3f(x, y, z);
+}
+
+inline void glTraceColor3f(GLfloat r, GLfloat g, GLfloat b)
+{
+	if (glTrace.on) { glTrace.op(TRACE_COLOR3F); glTrace.put(r); glTrace.put(g); glTrace.put(b); }
+	glColor3f(r, g, b);
+}
+
+inline void glTraceMatrixMode(GLenum mode)
+{
+	if (glTrace.on) { glTrace.op(TRACE_MATRIX_MODE); glTrace.put(mode); }
+	glMatrixMode(mode);
+}
+
+inline void glTraceLoadIdentity(void)
+{
+	if (glTrace.on) glTrace.op(TRACE_LOAD_IDENTITY);
+	glLoadIdentity();
+}
+
+inline void glTracePushMatrix(void)
+{
+	if (glTrace.on) glTrace.op(TRACE_PUSH_MATRIX);
+	glPushMatrix();
+}
+
+inline void glTracePopMatrix(void)
+{
+	if (glTrace.on) glTrace.op(TRACE_POP_MATRIX);
+	glPopMatrix();
+}
+
+inline void glTraceTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+	if (glTrace.on) { glTrace.op(TRACE_TRANSLATEF); glTrace.put(x); glTrace.put(y); glTrace.put(z); }
+	glTranslatef(x, y, z);
+}
+
+inline void glTraceRotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
+{
+	if (glTrace.on) { glTrace.op(TRACE_ROTATEF); glTrace.put(angle); glTrace.put(x); glTrace.put(y); glTrace.put(z); }
+	glRotatef(angle, x, y, z);
+}
+
+inline void glTraceScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+	if (glTrace.on) { glTrace.op(TRACE_SCALEF); glTrace.put(x); glTrace.put(y); glTrace.put(z); }
+	glScalef(x, y, z);
+}
+
+inline void glTraceFrustum(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_FRUSTUM);
+		glTrace.put(l); glTrace.put(r); glTrace.put(b); glTrace.put(t); glTrace.put(n); glTrace.put(f);
+	}
+	glFrustum(l, r, b, t, n, f);
+}
+
+inline void glTraceOrtho(GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_ORTHO);
+		glTrace.put(l); glTrace.put(r); glTrace.put(b); glTrace.put(t); glTrace.put(n); glTrace.put(f);
+	}
+	glOrtho(l, r, b, t, n, f);
+}
+
+inline void glTracePerspective(GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_PERSPECTIVE);
+		glTrace.put(fovy); glTrace.put(aspect); glTrace.put(zNear); glTrace.put(zFar);
+	}
+	gluPerspective(fovy, aspect, zNear, zFar);
+}
+
+inline void glTraceLookAt(GLdouble ex, GLdouble ey, GLdouble ez, GLdouble cx, GLdouble cy, GLdouble cz,
+	GLdouble ux, GLdouble uy, GLdouble uz)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_LOOK_AT);
+		glTrace.put(ex); glTrace.put(ey); glTrace.put(ez);
+		glTrace.put(cx); glTrace.put(cy); glTrace.put(cz);
+		glTrace.put(ux); glTrace.put(uy); glTrace.put(uz);
+	}
+	gluLookAt(ex, ey, ez, cx, cy, cz, ux, uy, uz);
+}
+
+inline void glTraceViewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+	if (glTrace.on) { glTrace.op(TRACE_VIEWPORT); glTrace.put(x); glTrace.put(y); glTrace.put(w); glTrace.put(h); }
+	glViewport(x, y, w, h);
+}
+
+inline void glTraceClear(GLbitfield mask)
+{
+	if (glTrace.on) { glTrace.op(TRACE_CLEAR); glTrace.put(mask); }
+	glClear(mask);
+}
+
+inline void glTraceClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+	if (glTrace.on) { glTrace.op(TRACE_CLEAR_COLOR); glTrace.put(r); glTrace.put(g); glTrace.put(b); glTrace.put(a); }
+	glClearColor(r, g, b, a);
+}
+
+inline void glTraceEnable(GLenum cap)
+{
+	if (glTrace.on) { glTrace.op(TRACE_ENABLE); glTrace.put(cap); }
+	glEnable(cap);
+}
+
+inline void glTraceDisable(GLenum cap)
+{
+	if (glTrace.on) { glTrace.op(TRACE_DISABLE); glTrace.put(cap); }
+	glDisable(cap);
+}
+
+inline void glTracePolygonMode(GLenum face, GLenum mode)
+{
+	if (glTrace.on) { glTrace.op(TRACE_POLYGON_MODE); glTrace.put(face); glTrace.put(mode); }
+	glPolygonMode(face, mode);
+}
+
+inline void glTraceCullFace(GLenum mode)
+{
+	if (glTrace.on) { glTrace.op(TRACE_CULL_FACE); glTrace.put(mode); }
+	glCullFace(mode);
+}
+
+inline void glTraceLineWidth(GLfloat width)
+{
+	if (glTrace.on) { glTrace.op(TRACE_LINE_WIDTH); glTrace.put(width); }
+	glLineWidth(width);
+}
+
+inline void glTraceLightfv(GLenum light, GLenum pname, const GLfloat *params)
+{
+	if (glTrace.on)
+	{
+		int n = traceParamCount(pname);
+		glTrace.op(TRACE_LIGHTFV); glTrace.put(light); glTrace.put(pname);
+		glTrace.put((unsigned char)n); glTrace.putBytes(params, n * sizeof(GLfloat));
+	}
+	glLightfv(light, pname, params);
+}
+
+inline void glTraceLightf(GLenum light, GLenum pname, GLfloat param)
+{
+	if (glTrace.on) { glTrace.op(TRACE_LIGHTF); glTrace.put(light); glTrace.put(pname); glTrace.put(param); }
+	glLightf(light, pname, param);
+}
+
+inline void glTraceLightModelfv(GLenum pname, const GLfloat *params)
+{
+	if (glTrace.on)
+	{
+		int n = traceParamCount(pname);
+		glTrace.op(TRACE_LIGHT_MODELFV); glTrace.put(pname);
+		glTrace.put((unsigned char)n); glTrace.putBytes(params, n * sizeof(GLfloat));
+	}
+	glLightModelfv(pname, params);
+}
+
+inline void glTraceLightModeli(GLenum pname, GLint param)
+{
+	if (glTrace.on) { glTrace.op(TRACE_LIGHT_MODELI); glTrace.put(pname); glTrace.put(param); }
+	glLightModeli(pname, param);
+}
+
+inline void glTraceMaterialfv(GLenum face, GLenum pname, const GLfloat *params)
+{
+	if (glTrace.on)
+	{
+		int n = traceParamCount(pname);
+		glTrace.op(TRACE_MATERIALFV); glTrace.put(face); glTrace.put(pname);
+		glTrace.put((unsigned char)n); glTrace.putBytes(params, n * sizeof(GLfloat));
+	}
+	glMaterialfv(face, pname, params);
+}
+
+inline void glTraceRasterPos3f(GLfloat x, GLfloat y, GLfloat z)
+{
+	if (glTrace.on) { glTrace.op(TRACE_RASTER_POS3F); glTrace.put(x); glTrace.put(y); glTrace.put(z); }
+	glRasterPos3f(x, y, z);
+}
+
+inline void glTraceBitmapCharacter(void *font, int character)
+{
+	if (glTrace.on)
+	{
+		int index = 0;
+		while (index < 7 && traceFont(index) != font) index++;
+		if (index == 7) index = 0;
+		glTrace.op(TRACE_BITMAP_CHARACTER); glTrace.put(index); glTrace.put(character);
+	}
+	glutBitmapCharacter(font, character);
+}
+
+inline void glTraceWireSphere(double radius, GLint slices, GLint stacks)
+{
+	if (glTrace.on) { glTrace.op(TRACE_WIRE_SPHERE); glTrace.put(radius); glTrace.put(slices); glTrace.put(stacks); }
+	glutWireSphere(radius, slices, stacks);
+}
+
+inline void glTraceSolidSphere(double radius, GLint slices, GLint stacks)
+{
+	if (glTrace.on) { glTrace.op(TRACE_SOLID_SPHERE); glTrace.put(radius); glTrace.put(slices); glTrace.put(stacks); }
+	glutSolidSphere(radius, slices, stacks);
+}
+
+inline void glTraceWireCube(double size)
+{
+	if (glTrace.on) { glTrace.op(TRACE_WIRE_CUBE); glTrace.put(size); }
+	glutWireCube(size);
+}
+
+inline void glTraceWireCone(double base, double height, GLint slices, GLint stacks)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_WIRE_CONE);
+		glTrace.put(base); glTrace.put(height); glTrace.put(slices); glTrace.put(stacks);
+	}
+	glutWireCone(base, height, slices, stacks);
+}
+
+inline void glTraceWireTorus(double innerRadius, double outerRadius, GLint sides, GLint rings)
+{
+	if (glTrace.on)
+	{
+		glTrace.op(TRACE_WIRE_TORUS);
+		glTrace.put(innerRadius); glTrace.put(outerRadius); glTrace.put(sides); glTrace.put(rings);
+	}
+	glutWireTorus(innerRadius, outerRadius, sides, rings);
+}
+
+// Routine to give the index of a client array, or -1 if it is not recorded.
+inline int glTraceArrayIndex(GLenum array)
+{
+	return array == GL_VERTEX_ARRAY ? 0 : (array == GL_NORMAL_ARRAY ? 1 : (array == GL_COLOR_ARRAY ? 2 : -1));
+}
+
+inline void glTraceEnableClientState(GLenum array)
+{
+	int k = glTraceArrayIndex(array);
+	if (k >= 0) glTrace.arrayEnabled[k] = true;
+	if (glTrace.on) { glTrace.op(TRACE_ENABLE_CLIENT_STATE); glTrace.put(array); }
+	glEnableClientState(array);
+}
+
+inline void glTraceDisableClientState(GLenum array)
+{
+	int k = glTraceArrayIndex(array);
+	if (k >= 0) glTrace.arrayEnabled[k] = false;
+	if (glTrace.on) { glTrace.op(TRACE_DISABLE_CLIENT_STATE); glTrace.put(array); }
+	glDisableClientState(array);
+}
+
+// Routine to note whether client array k is being specified from a buffer.
+inline void glTraceArrayBuffer(int k)
+{
+	GLint buffer = 0;
+	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &buffer);
+	glTrace.arrayInBuffer[k] = buffer != 0;
+}
+
+// Only float arrays are recorded.
+inline void glTraceVertexPointer(GLint size, GLenum type, GLsizei stride, const void *pointer)
+{
+	glTraceArrayBuffer(0);
+	glTrace.arraySize[0] = size; glTrace.arrayStride[0] = stride; glTrace.arrayPointer[0] = pointer;
+	glVertexPointer(size, type, stride, pointer);
+}
+
+inline void glTraceNormalPointer(GLenum type, GLsizei stride, const void *pointer)
+{
+	glTraceArrayBuffer(1);
+	glTrace.arraySize[1] = 3; glTrace.arrayStride[1] = stride; glTrace.arrayPointer[1] = pointer;
+	glNormalPointer(type, stride, pointer);
+}
+
+inline void glTraceColorPointer(GLint size, GLenum type, GLsizei stride, const void *pointer)
+{
+	glTraceArrayBuffer(2);
+	glTrace.arraySize[2] = size; glTrace.arrayStride[2] = stride; glTrace.arrayPointer[2] = pointer;
+	glColorPointer(size, type, stride, pointer);
+}
+
+inline void glTraceDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+	bool fromBuffer = false;
+	if (glTrace.on)
+	{
+		GLint buffer = 0;
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &buffer);
+		fromBuffer = buffer != 0;
+		for (int k = 0; k < 3; k++)
+			if (glTrace.arrayEnabled[k] && glTrace.arrayInBuffer[k]) fromBuffer = true;
+		if (fromBuffer) glTrace.untraced[UNTRACED_DRAW_ELEMENTS_BUFFER]++;
+	}
+	if (glTrace.on && !fromBuffer)
+	{
+		int indexSize = type == GL_UNSIGNED_BYTE ? 1 : (type == GL_UNSIGNED_SHORT ? 2 : 4);
+		unsigned int maxIndex = 0;
+		for (int i = 0; i < count; i++)
+		{
+			unsigned int index = indexSize == 1 ? ((const unsigned char *)indices)[i] :
+				(indexSize == 2 ? ((const unsigned short *)indices)[i] : ((const unsigned int *)indices)[i]);
+			if (index > maxIndex) maxIndex = index;
+		}
+
+		unsigned char mask = 0;
+		for (int k = 0; k < 3; k++)
+			if (glTrace.arrayEnabled[k]) mask |= 1 << k;
+
+		glTrace.op(TRACE_DRAW_ELEMENTS);
+		glTrace.put(mode); glTrace.put(count); glTrace.put(type);
+		glTrace.putBytes(indices, count * indexSize);
+		glTrace.put(mask);
+		for (int k = 0; k < 3; k++)
+			if (mask & (1 << k)) glTraceArray(k, count ? maxIndex + 1 : 0);
+	}
+	glDrawElements(mode, count, type, indices);
+}
+
+// The draws counted but not recorded.
+
+inline void glTraceDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_DRAW_ARRAYS]++;
+	glDrawArrays(mode, first, count);
+}
+
+inline void glTraceDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_DRAW_ARRAYS_INSTANCED]++;
+	glDrawArraysInstanced(mode, first, count, instances);
+}
+
+inline void glTraceDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void *indices, GLint baseVertex)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_DRAW_ELEMENTS_BASE_VERTEX]++;
+	glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+inline void glTraceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_DRAW_ELEMENTS_INSTANCED]++;
+	glDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+inline void glTraceMultiDrawArraysIndirect(GLenum mode, const void *indirect, GLsizei drawCount, GLsizei stride)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_MULTI_DRAW_ARRAYS_INDIRECT]++;
+	glMultiDrawArraysIndirect(mode, indirect, drawCount, stride);
+}
+
+inline void glTraceMultiDrawElementsIndirect(GLenum mode, GLenum type, const void *indirect, GLsizei drawCount, GLsizei stride)
+{
+	if (glTrace.on) glTrace.untraced[UNTRACED_MULTI_DRAW_ELEMENTS_INDIRECT]++;
+	glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+}
+
+inline void glTraceFlush(void)
+{
+	glFlush();
+	if (glTrace.on) glTraceFrameEnd(false);
+}
+
+inline void glTraceSwapBuffers(void)
+{
+	glutSwapBuffers();
+	if (glTrace.on) glTraceFrameEnd(true);
+}
+
+#define glBegin glTraceBegin
+#define glEnd glTraceEnd
+#define glVertex3f glTraceVertex3f
+#define glColor3f glTraceColor3f
+#define glMatrixMode glTraceMatrixMode
+#define glLoadIdentity glTraceLoadIdentity
+#define glPushMatrix glTracePushMatrix
+#define glPopMatrix glTracePopMatrix
+#define glTranslatef glTraceTranslatef
+#define glRotatef glTraceRotatef
+#define glScalef glTraceScalef
+#define glFrustum glTraceFrustum
+#define glOrtho glTraceOrtho
+#define gluPerspective glTracePerspective
+#define gluLookAt glTraceLookAt
+#define glViewport glTraceViewport
+#define glClear glTraceClear
+#define glClearColor glTraceClearColor
+#define glEnable glTraceEnable
+#define glDisable glTraceDisable
+#define glPolygonMode glTracePolygonMode
+#define glCullFace glTraceCullFace
+#define glLineWidth glTraceLineWidth
+#define glLightfv glTraceLightfv
+#define glLightf glTraceLightf
+#define glLightModelfv glTraceLightModelfv
+#define glLightModeli glTraceLightModeli
+#define glMaterialfv glTraceMaterialfv
+#define glRasterPos3f glTraceRasterPos3f
+#define glutBitmapCharacter glTraceBitmapCharacter
+#define glutWireSphere glTraceWireSphere
+#define glutSolidSphere glTraceSolidSphere
+#define glutWireCube glTraceWireCube
+#define glutWireCone glTraceWireCone
+#define glutWireTorus glTraceWireTorus
+#define glEnableClientState glTraceEnableClientState
+#define glDisableClientState glTraceDisableClientState
+#define glVertexPointer glTraceVertexPointer
+#define glNormalPointer glTraceNormalPointer
+#define glColorPointer glTraceColorPointer
+#define glDrawElements glTraceDrawElements
+#undef glDrawArrays
+#define glDrawArrays glTraceDrawArrays
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced glTraceDrawArraysInstanced
+#undef glDrawElementsBaseVertex
+#define glDrawElementsBaseVertex glTraceDrawElementsBaseVertex
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced glTraceDrawElementsInstanced
+#undef glMultiDrawArraysIndirect
+#define glMultiDrawArraysIndirect glTraceMultiDrawArraysIndirect
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect glTraceMultiDrawElementsIndirect
+#define glFlush glTraceFlush
+#define glutSwapBuffers glTraceSwapBuffers
+
+#endif
+
+#endif
@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////////
+// inputLatency.h
+//
+// Measurement of the time from a key press to the frame that shows it.
+//
+// A demo calls latencyInit(&argc, argv) after glutInit(), latencyInput() first
+// thing in its keyboard routines, latencyFrameBegin() at the top of its drawing
+// routine, latencySubmit() once the frame's commands are issued, before
+// captureFrame(), and latencySwap() right after its glutSwapBuffers() or glFlush().
+// Run as
+//
+//   demo -latency
+//
+// each frame drawn after input is timed at five points on the CPU's clock:
+//
+//   input     the event's arrival, in latencyInput();
+//   frame     the start of the frame drawing it, in latencyFrameBegin();
+//   submit    the end of the frame's commands, in latencySubmit();
+//   swap      the return of glutSwapBuffers() or glFlush(), in latencySwap();
+//   GPU done  the GPU finishing every command up to the swap.
+//
+// For the last, latencySwap() places a fence and a GL_TIMESTAMP query after the
+// swap. The fence is polled without waiting, at the next frame or, if none comes,
+// from a GLUT timer every millisecond; once it has signaled the query holds the
+// GPU time at which the commands before it were done, which is moved onto the
+// CPU's clock by an offset read with glGetInteger64v(GL_TIMESTAMP), so how late
+// the poll comes does not matter. Several events before a frame each count, from
+// their own arrival; an event no frame starts to draw within LATENCY_STALE ms,
+// e.g. a key the demo ignores, is left out and counted apart.
+//
+// Every LATENCY_REPORT inputs, and on exit, the distribution of each stage over
+// all inputs so far is written to the C++ window:
+//
+//   Latency of hemisphere, single buffered, 50 inputs:
+//                          median      90%      99%      max ms
+//     input to frame          0.31     0.88     1.90     2.04
+//     frame to submit         0.42     0.61     0.95     1.01
+//     submit to swap          0.02     0.03     0.05     0.05
+//     swap to GPU done        1.73     2.40     3.12     3.20
+//     input to GPU done       2.51     3.67     5.21     5.40
+//
+// Single buffered (GLUT_SINGLE), the frame is drawn into the visible buffer, so
+// GPU done is when it is all on screen, and glFlush() only sends the commands on.
+// Double buffered (GLUT_DOUBLE), glutSwapBuffers() may return at once or wait for
+// an earlier frame, depending on the driver and swap interval, which shows in
+// submit to swap; the new buffer is shown at the vertical retrace after GPU done,
+// up to one refresh interval later, which no portable call reports. Without
+// -latency the calls cost one test of a flag.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define LATENCY_REPORT 50 // Inputs between reports.
+#define LATENCY_STALE 250.0 // Milliseconds after which an input not yet drawn is left out.
+#define LATENCY_FRAMES 8 // Frames whose fences may be unsignaled.
+#define LATENCY_STAGES 5
+
+// Times of one input, in milliseconds on the CPU's clock.
+struct LatencySample
+{
+	double input, frame, submit, swap, done;
+};
+
+// A frame drawing input, until its fence signals.
+struct LatencyFrame
+{
+	std::vector<double> inputs; // Arrivals of the inputs it draws.
+	double frame, submit, swap;
+	GLsync fence;
+	unsigned int query; // GL_TIMESTAMP after the swap.
+};
+
+// Latency state.
+struct LatencyState
+{
+	bool on; // -latency given?
+	bool doubleBuffered;
+	bool calibrated; // Offset measured?
+	bool timerSet; // Poll timer pending?
+	std::string name; // Of the demo.
+	std::chrono::high_resolution_clock::time_point zero; // Of the CPU's clock.
+	double offset; // GL time minus CPU time, in milliseconds.
+	std::vector<double> pending; // Inputs waiting for a frame.
+	bool drawing; // Is the current frame drawing input?
+	LatencyFrame current;
+	std::deque<LatencyFrame> inFlight; // Oldest first.
+	std::vector<unsigned int> freeQueries;
+	std::vector<LatencySample> samples;
+	int stale; // Inputs left out.
+	int reported; // Samples at the last report.
+};
+
+static LatencyState latency;
+
+// Routine to return the CPU's clock in milliseconds.
+inline double latencyNow(void)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - latency.zero).count();
+}
+
+// Routine to measure the offset of the GL's clock from the CPU's.
+inline void latencyCalibrate(void)
+{
+	GLint64 glTime;
+	double before = latencyNow();
+	glGetInteger64v(GL_TIMESTAMP, &glTime);
+	double after = latencyNow();
+	latency.offset = glTime * 1.0e-6 - 0.5 * (before + after);
+}
+
+// Routine to write the distribution of each stage over the samples so far.
+inline void latencyReport(void)
+{
+	latency.reported = (int)latency.samples.size();
+	if (latency.samples.empty()) return;
+
+	static const char *stages[LATENCY_STAGES] = { "input to frame", "frame to submit", "submit to swap",
+		"swap to GPU done", "input to GPU done" };
+	std::vector<double> times(latency.samples.size());
+	char line[160];
+	sprintf(line, "Latency of %s, %s buffered, %d inputs", latency.name.c_str(), latency.doubleBuffered ? "double" : "single",
+		(int)latency.samples.size());
+	std::cout << line;
+	if (latency.stale) std::cout << " (" << latency.stale << " more not drawn within " << LATENCY_STALE << " ms)";
+	std::cout << ":" << std::endl << "                       median      90%      99%      max ms" << std::endl;
+	for (int k = 0; k < LATENCY_STAGES; k++)
+	{
+		for (size_t i = 0; i < latency.samples.size(); i++)
+		{
+			const LatencySample &s = latency.samples[i];
+			const double t[LATENCY_STAGES] = { s.input, s.frame, s.submit, s.swap, s.done };
+			times[i] = k < LATENCY_STAGES - 1 ? t[k + 1] - t[k] : s.done - s.input;
+		}
+		std::sort(times.begin(), times.end());
+		size_t last = times.size() - 1;
+		sprintf(line, "  %-19s %8.2f %8.2f %8.2f %8.2f", stages[k], times[last / 2], times[last * 9 / 10],
+			times[last * 99 / 100], times[last]);
+		std::cout << line << std::endl;
+	}
+}
+
+// Routine to record the inputs of the oldest frame in flight if its fence has
+// signaled, or when wait, once it has; false if it has not.
+inline bool latencyCollect(bool wait)
+{
+	LatencyFrame &f = latency.inFlight.front();
+	GLenum status;
+	do status = glClientWaitSync(f.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000 : 0);
+	while (wait && status == GL_TIMEOUT_EXPIRED);
+	if (status == GL_TIMEOUT_EXPIRED) return false;
+
+	GLuint64 glTime;
+	glGetQueryObjectui64v(f.query, GL_QUERY_RESULT, &glTime);
+	double done = glTime * 1.0e-6 - latency.offset;
+	if (done < f.swap) done = f.swap; // Rounding of the offset.
+	for (size_t i = 0; i < f.inputs.size(); i++)
+	{
+		LatencySample s = { f.inputs[i], f.frame, f.submit, f.swap, done };
+		latency.samples.push_back(s);
+	}
+	glDeleteSync(f.fence);
+	latency.freeQueries.push_back(f.query);
+	latency.inFlight.pop_front();
+
+	if ((int)latency.samples.size() >= latency.reported + LATENCY_REPORT)
+	{
+		latencyReport();
+		latencyCalibrate(); // Against drift between the clocks.
+	}
+	return true;
+}
+
+// Timer callback routine to poll the fences of the frames in flight.
+inline void latencyTimer(int value)
+{
+	while (!latency.inFlight.empty() && latencyCollect(false));
+	latency.timerSet = !latency.inFlight.empty();
+	if (latency.timerSet) glutTimerFunc(1, latencyTimer, 0);
+}
+
+// Routine to note the arrival of an input event.
+inline void latencyInput(void)
+{
+	if (!latency.on) return;
+	latency.pending.push_back(latencyNow());
+}
+
+// Routine to start a frame: it draws the inputs that arrived since the last.
+inline void latencyFrameBegin(void)
+{
+	if (!latency.on) return;
+	double now = latencyNow();
+	while (!latency.inFlight.empty() && latencyCollect(false));
+
+	latency.drawing = false;
+	latency.current.inputs.clear();
+	for (size_t i = 0; i < latency.pending.size(); i++)
+		if (now - latency.pending[i] > LATENCY_STALE) latency.stale++;
+		else latency.current.inputs.push_back(latency.pending[i]);
+	latency.pending.clear();
+	if (latency.current.inputs.empty()) return;
+	latency.drawing = true;
+	latency.current.frame = now;
+}
+
+// Routine to mark the end of the frame's commands.
+inline void latencySubmit(void)
+{
+	if (!latency.on || !latency.drawing) return;
+	latency.current.submit = latencyNow();
+}
+
+// Routine to mark the return of the swap or flush and fence the frame.
+inline void latencySwap(void)
+{
+	if (!latency.on || !latency.drawing) return;
+	latency.current.swap = latencyNow();
+	latency.drawing = false;
+
+	if (!latency.calibrated)
+	{
+		latency.calibrated = true;
+		latency.doubleBuffered = glutGet(GLUT_WINDOW_DOUBLEBUFFER) != 0;
+		latencyCalibrate();
+	}
+	if (latency.freeQueries.empty())
+	{
+		unsigned int query;
+		glGenQueries(1, &query);
+		latency.freeQueries.push_back(query);
+	}
+	latency.current.query = latency.freeQueries.back();
+	latency.freeQueries.pop_back();
+	glQueryCounter(latency.current.query, GL_TIMESTAMP);
+	latency.current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush(); // So the fence signals without another frame.
+	latency.inFlight.push_back(latency.current);
+
+	if ((int)latency.inFlight.size() > LATENCY_FRAMES) latencyCollect(true);
+	if (!latency.timerSet)
+	{
+		latency.timerSet = true;
+		glutTimerFunc(1, latencyTimer, 0);
+	}
+}
+
+// Routine to collect the frames still in flight and write the last report;
+// registered with atexit(), as the demos leave by exit().
+inline void latencyFinish(void)
+{
+	if (!latency.on) return;
+	latency.on = false;
+	while (!latency.inFlight.empty() && glutGet(GLUT_INIT_STATE)) latencyCollect(true); // No context once GLUT is gone.
+	latency.stale += (int)latency.pending.size();
+	if ((int)latency.samples.size() > latency.reported) latencyReport();
+}
+
+// Routine to start measuring if the command line holds -latency, removing it.
+inline void latencyInit(int *argc, char **argv)
+{
+	for (int i = 1; i < *argc; i++)
+	{
+		if (strcmp(argv[i], "-latency")) continue;
+		for (int j = i; j + 1 <= *argc; j++) argv[j] = argv[j + 1];
+		*argc -= 1;
+		latency.on = true;
+		latency.zero = std::chrono::high_resolution_clock::now();
+		latency.name = argv[0];
+		size_t slash = latency.name.find_last_of("/\\");
+		if (slash != std::string::npos) latency.name = latency.name.substr(slash + 1);
+		size_t dot = latency.name.rfind('.');
+		if (dot != std::string::npos && dot > 0) latency.name = latency.name.substr(0, dot);
+		atexit(latencyFinish);
+		break;
+	}
+}
+
+#endif
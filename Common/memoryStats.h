@@ -0,0 +1,559 @@
+////////////////////////////////////////////////////////////////////////////////////
+// memoryStats.h
+//
+// Accounting of heap allocations, per frame and per zone, and of the memory given
+// to OpenGL buffers, textures and renderbuffers, by category.
+//
+// Heap: the global operator new and delete are replaced by versions which count
+// the allocations and bytes of each thread and of the whole program, and the
+// bytes and blocks live. The replacements are ordinary (not inline) functions, so
+// this header must be included in one translation unit only, which every demo
+// is. C malloc(), calloc() and realloc() calls are counted as well where they can
+// be hooked: with glibc (Linux) by replacements which forward to __libc_malloc()
+// and the like, and which, being in the executable, also see the allocations of
+// shared libraries, e.g. freeglut's primitives; on an MSVC debug build by the
+// CRT's allocation hook, which sees only the calls made through the same CRT, so
+// not those inside a freeglut DLL. Elsewhere, e.g. in an MSVC release build, only
+// operator new is seen, and the report says so: a frame which allocates only with
+// malloc() then passes -memory-strict. The heap in use counts only the blocks of
+// operator new.
+//
+// GPU: glBufferData(), glBufferStorage(), glTexImage2D(), glTexStorage2D(),
+// glRenderbufferStorage() and glRenderbufferStorageMultisample() and the
+// matching deletes are hooked by macros, as in glTrace.h, and the size of each
+// object's storage is kept under a category given by its target. Only calls
+// compiled after this header are seen, so it is included before the other
+// Common headers. Each (re)allocation of storage, e.g. the orphaning of a buffer
+// by glBufferData(), also counts as a GPU allocation of the frame.
+//
+// Zones: a MemoryZone, or a phase of MemoryPhases, adds the allocations made on
+// its thread while it is open to a table by zone name. profiler.h declares these
+// alongside its own zones, so the PROFILE_ZONE() and PROFILE_PHASE() annotations
+// of the demos also attribute allocations.
+//
+// A demo calls memoryInit(&argc, argv) after glutInit() and memoryFrameEnd() at
+// the end of each frame (profileInit() and profileFrameEnd() do both). Run as
+//
+//   demo -memory 60          or          demo -memory-strict 60
+//
+// it reports, each second, the frames which allocated after the first 60 and the
+// zones which allocated, with the heap and GPU memory in use; with -memory-strict
+// the first frame after the 60 which allocates on the heap or the GPU stops the
+// program with the zones to blame, enforcing an allocation-free render loop.
+//
+// Demos get all this by defining ENABLE_MEMORY_STATS, on which profiler.h includes
+// this header.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <map>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+
+#include <GL/glew.h>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#define MEMORY_HOOKS_MALLOC // malloc() is counted by the CRT's allocation hook.
+#elif defined(__GLIBC__)
+#define MEMORY_HOOKS_MALLOC // malloc() is counted by the replacements below.
+#endif
+
+#define MEMORY_MAX_ZONES 64 // Size of the zone table.
+
+// Allocation counts of one thread.
+struct MemoryCounters
+{
+	long long allocs, bytes;
+};
+
+// Program-wide counts; constant-initialized, so counting is right during static
+// initialization too.
+struct MemoryTotals
+{
+	constexpr MemoryTotals(void) : allocs(0), bytes(0), liveBytes(0), liveBlocks(0), gpuAllocs(0) {}
+
+	std::atomic<long long> allocs, bytes; // Allocations and bytes allocated.
+	std::atomic<long long> liveBytes, liveBlocks; // In use now.
+	std::atomic<long long> gpuAllocs; // Allocations of GPU storage.
+};
+
+static MemoryTotals memoryTotals;
+static thread_local MemoryCounters memoryThread = { 0, 0 };
+static thread_local bool memoryInNew = false; // Inside operator new (for the malloc() hooks).
+
+// Routine to count an allocation.
+inline void memoryCount(size_t bytes)
+{
+	memoryThread.allocs++;
+	memoryThread.bytes += bytes;
+	memoryTotals.allocs.fetch_add(1, std::memory_order_relaxed);
+	memoryTotals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// The replacements. Each block carries its size in a header of 16 bytes, keeping
+// the alignment malloc() gives.
+#define MEMORY_HEADER 16
+
+void *operator new(size_t size)
+{
+	memoryInNew = true;
+	char *p = (char *)malloc(size + MEMORY_HEADER);
+	memoryInNew = false;
+	if (!p) throw std::bad_alloc();
+	*(size_t *)p = size;
+	memoryCount(size);
+	memoryTotals.liveBytes.fetch_add(size, std::memory_order_relaxed);
+	memoryTotals.liveBlocks.fetch_add(1, std::memory_order_relaxed);
+	return p + MEMORY_HEADER;
+}
+
+void operator delete(void *block) noexcept
+{
+	if (!block) return;
+	char *p = (char *)block - MEMORY_HEADER;
+	memoryTotals.liveBytes.fetch_sub(*(size_t *)p, std::memory_order_relaxed);
+	memoryTotals.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+	free(p);
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *block) noexcept { operator delete(block); }
+void operator delete(void *block, size_t) noexcept { operator delete(block); }
+void operator delete[](void *block, size_t) noexcept { operator delete(block); }
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+// Routine called by the debug CRT for its allocations: counts malloc() and
+// realloc() calls other than those of operator new and the CRT's own.
+inline int memoryCrtHook(int type, void *, size_t size, int blockType, long, const unsigned char *, int)
+{
+	if (!memoryInNew && blockType != _CRT_BLOCK && (type == _HOOK_ALLOC || type == _HOOK_REALLOC)) memoryCount(size);
+	return TRUE;
+}
+#elif defined(__GLIBC__)
+// glibc's own allocators, to which the replacements forward.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *block, size_t size);
+
+// The replacements of malloc(), calloc() and realloc(), counting the calls other
+// than those of operator new. free() needs no replacement, nor does it count.
+extern "C" void *malloc(size_t size)
+{
+	if (!memoryInNew) memoryCount(size);
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+	memoryCount(count * size);
+	return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *block, size_t size)
+{
+	memoryCount(size);
+	return __libc_realloc(block, size);
+}
+#endif
+
+// Allocations of a zone name.
+struct MemoryZoneStats
+{
+	const char *name;
+	long long allocs, bytes; // Since the last report.
+	long long frameAllocs, frameBytes; // In the current frame.
+};
+
+// GPU memory categories.
+enum GpuCategory
+{
+	GPU_VERTEX, GPU_INDEX, GPU_UNIFORM, GPU_PIXEL, GPU_OTHER_BUFFER, GPU_TEXTURE, GPU_RENDERBUFFER,
+	NUM_GPU_CATEGORIES
+};
+
+static const char *gpuCategoryNames[NUM_GPU_CATEGORIES] =
+	{ "vertex", "index", "uniform", "pixel", "other buffers", "textures", "renderbuffers" };
+
+// Kinds of GL object, keeping their names apart.
+enum { GPU_KIND_BUFFER, GPU_KIND_TEXTURE, GPU_KIND_RENDERBUFFER };
+
+// Storage of a GL object, or of one image of a texture.
+struct GpuAllocation
+{
+	int category;
+	size_t bytes;
+};
+
+// Accounting state.
+struct MemoryStatsState
+{
+	MemoryStatsState(void) : reporting(false), strict(false), warmup(0), frame(0), numZones(0),
+		lastAllocs(0), lastBytes(0), lastGpuAllocs(0), allocatingFrames(0), intervalFrames(0),
+		intervalAllocs(0), intervalBytes(0), intervalGpuAllocs(0)
+	{
+		for (int i = 0; i < NUM_GPU_CATEGORIES; i++) gpuBytes[i] = 0;
+	}
+
+	bool reporting, strict; // Report each second? Stop at an allocating frame?
+	int warmup; // Frames allowed to allocate.
+	long long frame; // Frames ended.
+	std::chrono::high_resolution_clock::time_point lastReport;
+
+	std::mutex mutex; // Guards the zone table.
+	MemoryZoneStats zones[MEMORY_MAX_ZONES];
+	int numZones;
+
+	long long lastAllocs, lastBytes, lastGpuAllocs; // Totals at the last frame end.
+	long long allocatingFrames, intervalFrames; // Since the last report.
+	long long intervalAllocs, intervalBytes, intervalGpuAllocs;
+
+	std::map<unsigned long long, GpuAllocation> gpuObjects; // By key of memoryGpuKey().
+	size_t gpuBytes[NUM_GPU_CATEGORIES];
+};
+
+static MemoryStatsState memoryStats;
+
+// Routine to add allocations to the zone named name.
+inline void memoryZoneAdd(const char *name, long long allocs, long long bytes)
+{
+	if (!allocs) return;
+	std::lock_guard<std::mutex> lock(memoryStats.mutex);
+	int i = 0;
+	while (i < memoryStats.numZones && strcmp(memoryStats.zones[i].name, name)) i++;
+	if (i == MEMORY_MAX_ZONES) return;
+	if (i == memoryStats.numZones)
+	{
+		MemoryZoneStats zone = { name, 0, 0, 0, 0 };
+		memoryStats.zones[memoryStats.numZones++] = zone;
+	}
+	memoryStats.zones[i].allocs += allocs;
+	memoryStats.zones[i].bytes += bytes;
+	memoryStats.zones[i].frameAllocs += allocs;
+	memoryStats.zones[i].frameBytes += bytes;
+}
+
+// Zone from construction to destruction.
+class MemoryZone
+{
+public:
+	MemoryZone(const char *zoneName) : name(zoneName), start(memoryThread) {}
+	~MemoryZone() { memoryZoneAdd(name, memoryThread.allocs - start.allocs, memoryThread.bytes - start.bytes); }
+
+private:
+	const char *name;
+	MemoryCounters start;
+};
+
+// Consecutive zones; see ProfilePhases in profiler.h.
+class MemoryPhases
+{
+public:
+	MemoryPhases(void) : name(NULL) {}
+	~MemoryPhases() { next(NULL); }
+
+	void next(const char *phaseName)
+	{
+		if (name) memoryZoneAdd(name, memoryThread.allocs - start.allocs, memoryThread.bytes - start.bytes);
+		name = phaseName;
+		start = memoryThread;
+	}
+
+private:
+	const char *name;
+	MemoryCounters start;
+};
+
+// Routine to give the key of image level (face * 16 + level for cube maps) of
+// object name of the given kind.
+inline unsigned long long memoryGpuKey(int kind, unsigned int name, int level)
+{
+	return ((unsigned long long)kind << 40) | ((unsigned long long)name << 8) | (unsigned long long)level;
+}
+
+// Routine to set the storage of an object, or of one of its images, to bytes.
+inline void memoryGpuSet(unsigned long long key, int category, size_t bytes)
+{
+	GpuAllocation &a = memoryStats.gpuObjects[key];
+	memoryStats.gpuBytes[a.category] -= a.bytes;
+	a.category = category;
+	a.bytes = bytes;
+	memoryStats.gpuBytes[category] += bytes;
+	memoryTotals.gpuAllocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Routine to forget the storage of objects names[0..n-1] of the given kind.
+inline void memoryGpuDelete(int kind, GLsizei n, const GLuint *names)
+{
+	for (int i = 0; i < n; i++)
+	{
+		auto first = memoryStats.gpuObjects.lower_bound(memoryGpuKey(kind, names[i], 0));
+		auto last = memoryStats.gpuObjects.upper_bound(memoryGpuKey(kind, names[i], 255));
+		for (auto it = first; it != last; ++it) memoryStats.gpuBytes[it->second.category] -= it->second.bytes;
+		memoryStats.gpuObjects.erase(first, last);
+	}
+}
+
+// Routine to give the buffer bound to target and the category of its storage.
+inline unsigned int memoryBoundBuffer(GLenum target, int &category)
+{
+	GLenum binding;
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: binding = GL_ARRAY_BUFFER_BINDING; category = GPU_VERTEX; break;
+	case GL_ELEMENT_ARRAY_BUFFER: binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; category = GPU_INDEX; break;
+	case GL_UNIFORM_BUFFER: binding = GL_UNIFORM_BUFFER_BINDING; category = GPU_UNIFORM; break;
+	case GL_SHADER_STORAGE_BUFFER: binding = GL_SHADER_STORAGE_BUFFER_BINDING; category = GPU_UNIFORM; break;
+	case GL_PIXEL_PACK_BUFFER: binding = GL_PIXEL_PACK_BUFFER_BINDING; category = GPU_PIXEL; break;
+	case GL_PIXEL_UNPACK_BUFFER: binding = GL_PIXEL_UNPACK_BUFFER_BINDING; category = GPU_PIXEL; break;
+	case GL_DRAW_INDIRECT_BUFFER: binding = GL_DRAW_INDIRECT_BUFFER_BINDING; category = GPU_OTHER_BUFFER; break;
+	default: binding = target; category = GPU_OTHER_BUFFER; break; // The copy targets are their own bindings.
+	}
+	GLint name = 0;
+	glGetIntegerv(binding, &name);
+	return name;
+}
+
+// Routine to give the texture bound to target, and for a cube map face its number.
+inline unsigned int memoryBoundTexture(GLenum target, int &face)
+{
+	GLenum binding = GL_TEXTURE_BINDING_2D;
+	face = 0;
+	if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+	{
+		binding = GL_TEXTURE_BINDING_CUBE_MAP;
+		face = target - GL_TEXTURE_CUBE_MAP_POSITIVE_X;
+	}
+	else if (target == GL_TEXTURE_CUBE_MAP) binding = GL_TEXTURE_BINDING_CUBE_MAP;
+	else if (target == GL_TEXTURE_RECTANGLE) binding = GL_TEXTURE_BINDING_RECTANGLE;
+	else if (target == GL_TEXTURE_1D_ARRAY) binding = GL_TEXTURE_BINDING_1D_ARRAY;
+	GLint name = 0;
+	glGetIntegerv(binding, &name);
+	return name;
+}
+
+// Routine to estimate the bytes a texel of internalFormat takes.
+inline int memoryTexelBytes(GLenum internalFormat)
+{
+	switch (internalFormat)
+	{
+	case GL_R8: case GL_RED: case GL_ALPHA: case GL_LUMINANCE: case GL_STENCIL_INDEX8:
+		return 1;
+	case GL_RG8: case GL_R16F: case GL_LUMINANCE_ALPHA: case GL_DEPTH_COMPONENT16:
+		return 2;
+	case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8:
+		return 8;
+	case GL_RGBA32F:
+		return 16;
+	default: // RGB and RGBA8, depth and depth-stencil, R32F, RG16F: 4 bytes (RGB padded).
+		return 4;
+	}
+}
+
+// The hooks.
+
+inline void memoryBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+	int category;
+	unsigned int buffer = memoryBoundBuffer(target, category);
+	memoryGpuSet(memoryGpuKey(GPU_KIND_BUFFER, buffer, 0), category, size);
+	glBufferData(target, size, data, usage);
+}
+
+inline void memoryBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+	int category;
+	unsigned int buffer = memoryBoundBuffer(target, category);
+	memoryGpuSet(memoryGpuKey(GPU_KIND_BUFFER, buffer, 0), category, size);
+	glBufferStorage(target, size, data, flags);
+}
+
+inline void memoryDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+	memoryGpuDelete(GPU_KIND_BUFFER, n, buffers);
+	glDeleteBuffers(n, buffers);
+}
+
+inline void memoryTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+	GLint border, GLenum format, GLenum type, const void *pixels)
+{
+	int face;
+	unsigned int texture = memoryBoundTexture(target, face);
+	if (target != GL_PROXY_TEXTURE_2D)
+		memoryGpuSet(memoryGpuKey(GPU_KIND_TEXTURE, texture, 16 * face + level), GPU_TEXTURE,
+			(size_t)width * height * memoryTexelBytes(internalFormat));
+	glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+inline void memoryTexStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+	int face;
+	unsigned int texture = memoryBoundTexture(target, face);
+	size_t bytes = 0;
+	for (int i = 0; i < levels; i++)
+		bytes += (size_t)(width >> i ? width >> i : 1) * (height >> i ? height >> i : 1) * memoryTexelBytes(internalFormat);
+	if (target == GL_TEXTURE_CUBE_MAP) bytes *= 6;
+	memoryGpuSet(memoryGpuKey(GPU_KIND_TEXTURE, texture, 0), GPU_TEXTURE, bytes);
+	glTexStorage2D(target, levels, internalFormat, width, height);
+}
+
+inline void memoryDeleteTextures(GLsizei n, const GLuint *textures)
+{
+	memoryGpuDelete(GPU_KIND_TEXTURE, n, textures);
+	glDeleteTextures(n, textures);
+}
+
+inline void memoryRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat,
+	GLsizei width, GLsizei height)
+{
+	GLint renderbuffer = 0;
+	glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+	memoryGpuSet(memoryGpuKey(GPU_KIND_RENDERBUFFER, renderbuffer, 0), GPU_RENDERBUFFER,
+		(size_t)width * height * memoryTexelBytes(internalFormat) * (samples > 1 ? samples : 1));
+	glRenderbufferStorageMultisample(target, samples, internalFormat, width, height);
+}
+
+inline void memoryRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+	GLint renderbuffer = 0;
+	glGetIntegerv(GL_RENDERBUFFER_BINDING, &renderbuffer);
+	memoryGpuSet(memoryGpuKey(GPU_KIND_RENDERBUFFER, renderbuffer, 0), GPU_RENDERBUFFER,
+		(size_t)width * height * memoryTexelBytes(internalFormat));
+	glRenderbufferStorage(target, internalFormat, width, height);
+}
+
+inline void memoryDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+{
+	memoryGpuDelete(GPU_KIND_RENDERBUFFER, n, renderbuffers);
+	glDeleteRenderbuffers(n, renderbuffers);
+}
+
+// GLEW defines most of these names as macros itself, hence the #undefs.
+#undef glBufferData
+#undef glBufferStorage
+#undef glDeleteBuffers
+#undef glTexImage2D
+#undef glTexStorage2D
+#undef glDeleteTextures
+#undef glRenderbufferStorage
+#undef glRenderbufferStorageMultisample
+#undef glDeleteRenderbuffers
+#define glBufferData memoryBufferData
+#define glBufferStorage memoryBufferStorage
+#define glDeleteBuffers memoryDeleteBuffers
+#define glTexImage2D memoryTexImage2D
+#define glTexStorage2D memoryTexStorage2D
+#define glDeleteTextures memoryDeleteTextures
+#define glRenderbufferStorage memoryRenderbufferStorage
+#define glRenderbufferStorageMultisample memoryRenderbufferStorageMultisample
+#define glDeleteRenderbuffers memoryDeleteRenderbuffers
+
+// Routine to write the zones which allocated, using the frame's counts if frame
+// is set and those since the last report otherwise.
+inline void memoryWriteZones(bool frame)
+{
+	std::lock_guard<std::mutex> lock(memoryStats.mutex);
+	for (int i = 0; i < memoryStats.numZones; i++)
+	{
+		MemoryZoneStats &zone = memoryStats.zones[i];
+		long long allocs = frame ? zone.frameAllocs : zone.allocs, bytes = frame ? zone.frameBytes : zone.bytes;
+		if (allocs) std::cout << "  " << zone.name << ": " << allocs << " allocations, " << bytes << " bytes" << std::endl;
+	}
+}
+
+// Routine to write the report of the last second and start another.
+inline void memoryReport(void)
+{
+	std::cout << "Memory: " << memoryStats.intervalFrames << " frames, " << memoryStats.allocatingFrames
+		<< " allocating after warm-up (" << memoryStats.intervalAllocs << " allocations, "
+		<< memoryStats.intervalBytes << " bytes, " << memoryStats.intervalGpuAllocs << " GPU); heap "
+		<< memoryTotals.liveBytes << " bytes in " << memoryTotals.liveBlocks << " blocks" << std::endl;
+	memoryWriteZones(false);
+	std::cout << "  GPU:";
+	for (int i = 0; i < NUM_GPU_CATEGORIES; i++)
+		if (memoryStats.gpuBytes[i]) std::cout << " " << gpuCategoryNames[i] << " " << memoryStats.gpuBytes[i] / 1024 << " KB";
+	std::cout << std::endl;
+#ifndef MEMORY_HOOKS_MALLOC
+	std::cout << "  (malloc() is not counted in this build, only operator new)" << std::endl;
+#endif
+
+	std::lock_guard<std::mutex> lock(memoryStats.mutex);
+	for (int i = 0; i < memoryStats.numZones; i++) memoryStats.zones[i].allocs = memoryStats.zones[i].bytes = 0;
+	memoryStats.allocatingFrames = memoryStats.intervalFrames = 0;
+	memoryStats.intervalAllocs = memoryStats.intervalBytes = memoryStats.intervalGpuAllocs = 0;
+}
+
+// Routine to start reporting if the command line holds -memory warmup or
+// -memory-strict warmup, removing those arguments.
+inline void memoryInit(int *argc, char **argv)
+{
+#if defined(_MSC_VER) && defined(_DEBUG)
+	_CrtSetAllocHook(memoryCrtHook);
+#endif
+	for (int i = 1; i + 1 < *argc; i++)
+	{
+		if (strcmp(argv[i], "-memory") && strcmp(argv[i], "-memory-strict")) continue;
+		memoryStats.reporting = true;
+		memoryStats.strict = !strcmp(argv[i], "-memory-strict");
+		memoryStats.warmup = atoi(argv[i + 1]);
+		memoryStats.lastReport = std::chrono::high_resolution_clock::now();
+#ifndef MEMORY_HOOKS_MALLOC
+		std::cout << "Memory: malloc() is not counted in this build, only operator new" << std::endl;
+#endif
+		for (int j = i; j + 2 <= *argc; j++) argv[j] = argv[j + 2];
+		*argc -= 2;
+		break;
+	}
+}
+
+// Routine to end a frame: counts its allocations and reports each second.
+inline void memoryFrameEnd(void)
+{
+	long long allocs = memoryTotals.allocs - memoryStats.lastAllocs;
+	long long bytes = memoryTotals.bytes - memoryStats.lastBytes;
+	long long gpuAllocs = memoryTotals.gpuAllocs - memoryStats.lastGpuAllocs;
+
+	memoryStats.frame++;
+	if (memoryStats.reporting && memoryStats.frame > memoryStats.warmup && (allocs || gpuAllocs))
+	{
+		memoryStats.allocatingFrames++;
+		if (memoryStats.strict)
+		{
+			std::cout << "Frame " << memoryStats.frame << " allocated " << allocs << " times (" << bytes
+				<< " bytes) on the heap and " << gpuAllocs << " times on the GPU" << std::endl;
+			memoryWriteZones(true);
+			exit(1);
+		}
+	}
+	memoryStats.intervalFrames++;
+	memoryStats.intervalAllocs += allocs;
+	memoryStats.intervalBytes += bytes;
+	memoryStats.intervalGpuAllocs += gpuAllocs;
+
+	{
+		std::lock_guard<std::mutex> lock(memoryStats.mutex);
+		for (int i = 0; i < memoryStats.numZones; i++) memoryStats.zones[i].frameAllocs = memoryStats.zones[i].frameBytes = 0;
+	}
+
+	if (memoryStats.reporting &&
+		std::chrono::high_resolution_clock::now() - memoryStats.lastReport >= std::chrono::seconds(1))
+	{
+		memoryReport();
+		memoryStats.lastReport = std::chrono::high_resolution_clock::now();
+	}
+
+	// Taken after the report, whose output may allocate.
+	memoryStats.lastAllocs = memoryTotals.allocs;
+	memoryStats.lastBytes = memoryTotals.bytes;
+	memoryStats.lastGpuAllocs = memoryTotals.gpuAllocs;
+}
+
+#endif
@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////////
+// meshCache.h
+//
+// On-disk cache of generated meshes, e.g. a hemisphere of a million vertices,
+// so that only the first run pays for generating them.
+//
+// A mesh is named by its generator and the parameters passed to it:
+//
+//   float params[] = { R, (float)p, (float)q };
+//   CachedMesh mesh;
+//   mesh.load("hemisphere", params, 3, 3, [](std::vector<float> &v, std::vector<unsigned int> &i) { ... });
+//   glBufferData(GL_ARRAY_BUFFER, mesh.numVertices * 3 * sizeof(float), mesh.vertices, GL_STATIC_DRAW);
+//   mesh.close();
+//
+// The file, meshCache_<name>_<key>.bin in the working directory, is found by a
+// 64-bit FNV-1a hash of the name, the parameters and the format version. If it
+// is missing, or its header does not match, the generator is run and the file
+// written, through a temporary file renamed into place so a run cut short leaves
+// nothing half written. Either way the file is then mapped into memory (mmap, or
+// MapViewOfFile on Windows) and vertices and indices point into the mapping, so
+// a warm run uploads straight from the file's pages without generating, parsing
+// or copying anything.
+//
+// The file is a 64-byte header, the parameters and the name, then the vertex
+// floats and the unsigned int indices, each starting on a 64-byte boundary.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define MESH_CACHE_VERSION 1 // Bump when the format or a generator changes.
+#define MESH_CACHE_ALIGN 64 // Alignment of the vertex and index blobs.
+
+// Header of a mesh cache file.
+struct MeshFileHeader
+{
+	char magic[4]; // "MESH".
+	unsigned int version;
+	unsigned long long key;
+	unsigned int floatsPerVertex, numVertices, numIndices, numParams;
+	unsigned long long vertexOffset, indexOffset, fileSize;
+	unsigned char unused[8];
+};
+
+// Routine to round n up to the blob alignment.
+inline unsigned long long meshCacheAlign(unsigned long long n)
+{
+	return (n + MESH_CACHE_ALIGN - 1) / MESH_CACHE_ALIGN * MESH_CACHE_ALIGN;
+}
+
+// Routine to hash n bytes into h, FNV-1a.
+inline unsigned long long meshCacheHash(unsigned long long h, const void *data, size_t n)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= p[i];
+		h *= 0x100000001B3ull;
+	}
+	return h;
+}
+
+// A mesh mapped from the cache.
+class CachedMesh
+{
+public:
+	CachedMesh(void) : vertices(NULL), indices(NULL), numVertices(0), numIndices(0), floatsPerVertex(0),
+		generated(false), millis(0.0), base(NULL), size(0)
+#ifdef _WIN32
+		, file(INVALID_HANDLE_VALUE), mapping(NULL)
+#endif
+	{}
+	~CachedMesh(void) { close(); }
+
+	// Routine to map the mesh made by generator name from params, running generate,
+	// which fills the vertices (floatsPerVertex floats each) and indices, and storing
+	// its result first if the cache lacks it. False if the file cannot be written
+	// or mapped.
+	bool load(const char *name, const float *params, int numParams, int floatsPerVertex,
+		const std::function<void(std::vector<float> &, std::vector<unsigned int> &)> &generate)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		close();
+
+		unsigned long long key = 0xCBF29CE484222325ull;
+		unsigned int version = MESH_CACHE_VERSION;
+		key = meshCacheHash(key, &version, sizeof(version));
+		key = meshCacheHash(key, name, strlen(name) + 1);
+		key = meshCacheHash(key, &floatsPerVertex, sizeof(floatsPerVertex));
+		key = meshCacheHash(key, params, numParams * sizeof(float));
+		char suffix[32];
+		sprintf(suffix, "_%016llx.bin", key);
+		std::string path = std::string("meshCache_") + name + suffix;
+
+		generated = !map(path.c_str()) || !matches(key, name, params, numParams, floatsPerVertex);
+		if (generated)
+		{
+			close();
+			std::vector<float> vertexData;
+			std::vector<unsigned int> indexData;
+			generate(vertexData, indexData);
+			if (!store(path, key, name, params, numParams, floatsPerVertex, vertexData, indexData) || !map(path.c_str())) return false;
+		}
+
+		const MeshFileHeader *header = (const MeshFileHeader *)base;
+		this->floatsPerVertex = header->floatsPerVertex;
+		numVertices = header->numVertices;
+		numIndices = header->numIndices;
+		vertices = (const float *)(base + header->vertexOffset);
+		indices = numIndices ? (const unsigned int *)(base + header->indexOffset) : NULL;
+		millis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return true;
+	}
+
+	// Routine to unmap the mesh, once uploaded.
+	void close(void)
+	{
+#ifdef _WIN32
+		if (base) UnmapViewOfFile(base);
+		if (mapping) CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+		mapping = NULL;
+		file = INVALID_HANDLE_VALUE;
+#else
+		if (base) munmap(base, size);
+#endif
+		base = NULL;
+		size = 0;
+		vertices = NULL;
+		indices = NULL;
+	}
+
+	const float *vertices; // Into the mapping.
+	const unsigned int *indices; // Into the mapping, NULL if none.
+	int numVertices, numIndices, floatsPerVertex;
+	bool generated; // Missing from the cache, so generated by the last load()?
+	double millis; // Time taken by the last load().
+
+private:
+	// Routine to map the whole of file path read-only.
+	bool map(const char *path)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(MeshFileHeader)) return false;
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (!mapping) return false;
+		base = (unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		size = (size_t)fileSize.QuadPart;
+#else
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat info;
+		if (fstat(fd, &info) || info.st_size < (off_t)sizeof(MeshFileHeader))
+		{
+			::close(fd);
+			return false;
+		}
+		void *p = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd); // The mapping keeps the file open.
+		if (p == MAP_FAILED) return false;
+		base = (unsigned char *)p;
+		size = info.st_size;
+#endif
+		return base != NULL;
+	}
+
+	// Routine to check that the mapped file is the mesh asked for and intact.
+	bool matches(unsigned long long key, const char *name, const float *params, int numParams, int floatsPerVertex) const
+	{
+		const MeshFileHeader *header = (const MeshFileHeader *)base;
+		size_t nameOffset = sizeof(MeshFileHeader) + numParams * sizeof(float);
+		size_t nameLength = strlen(name) + 1;
+		return !memcmp(header->magic, "MESH", 4) && header->version == MESH_CACHE_VERSION && header->key == key
+			&& header->fileSize == size && (int)header->numParams == numParams && (int)header->floatsPerVertex == floatsPerVertex
+			&& nameOffset + nameLength <= size && !memcmp(base + sizeof(MeshFileHeader), params, numParams * sizeof(float))
+			&& !memcmp(base + nameOffset, name, nameLength)
+			&& header->vertexOffset + (unsigned long long)header->numVertices * floatsPerVertex * sizeof(float) <= size
+			&& header->indexOffset + (unsigned long long)header->numIndices * sizeof(unsigned int) <= size;
+	}
+
+	// Routine to write the mesh to path, by way of a temporary file.
+	bool store(const std::string &path, unsigned long long key, const char *name, const float *params, int numParams,
+		int floatsPerVertex, const std::vector<float> &v, const std::vector<unsigned int> &i) const
+	{
+		MeshFileHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, "MESH", 4);
+		header.version = MESH_CACHE_VERSION;
+		header.key = key;
+		header.floatsPerVertex = floatsPerVertex;
+		header.numVertices = (unsigned int)(v.size() / floatsPerVertex);
+		header.numIndices = (unsigned int)i.size();
+		header.numParams = numParams;
+		header.vertexOffset = meshCacheAlign(sizeof(header) + numParams * sizeof(float) + strlen(name) + 1);
+		header.indexOffset = meshCacheAlign(header.vertexOffset + v.size() * sizeof(float));
+		header.fileSize = header.indexOffset + i.size() * sizeof(unsigned int);
+
+		std::string temporary = path + ".tmp";
+		FILE *out = fopen(temporary.c_str(), "wb");
+		if (!out) return false;
+		std::vector<unsigned char> padding(MESH_CACHE_ALIGN, 0);
+		fwrite(&header, sizeof(header), 1, out);
+		fwrite(params, sizeof(float), numParams, out);
+		fwrite(name, 1, strlen(name) + 1, out);
+		fwrite(padding.data(), 1, header.vertexOffset - ftell(out), out);
+		fwrite(v.data(), sizeof(float), v.size(), out);
+		fwrite(padding.data(), 1, header.indexOffset - (header.vertexOffset + v.size() * sizeof(float)), out);
+		fwrite(i.data(), sizeof(unsigned int), i.size(), out);
+		bool ok = !ferror(out);
+		ok = !fclose(out) && ok;
+		if (!ok)
+		{
+			remove(temporary.c_str());
+			return false;
+		}
+		remove(path.c_str()); // rename() will not replace a file on Windows.
+		return !rename(temporary.c_str(), path.c_str());
+	}
+
+	unsigned char *base; // The mapping.
+	size_t size;
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+};
+
+#endif
@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////////////////////////////
+// picking.h
+//
+// Mouse picking by ray casting: the click is unprojected through the current
+// projection (glFrustum(), gluPerspective() or glOrtho()) and viewport into a
+// ray, which is cast against a bounding volume hierarchy (bvh.h) of the objects'
+// boxes; only the objects whose box the ray enters get an exact test against
+// their triangles, and the nearest hit wins.
+//
+// Objects are triangle meshes matching the tessellation of the GLUT shapes,
+// made once for each set of parameters and shared by every object using them:
+//
+//   pickScene.clear();
+//   ...
+//   glutWireSphere(2.0, 10, 8);
+//   pickScene.add(HEAD, pickSphere(2.0, 10, 8)); // Under the current modelview.
+//   ...
+//   int id = pickScene.pick(x, y); // In the mouse callback; -1 if nothing is hit.
+//
+// Each mesh has a hierarchy of its own over its triangles, so the exact test of
+// a sphere of 80,000 triangles costs as little as that of a cube, and a pick is
+// a few microseconds for a million objects. The hierarchy over the objects is
+// built on the first pick after the objects change; buildMicros and pickMicros
+// time the two separately.
+//
+// A ray is origin + t dir, from the near plane at t = 0 to the far plane at t = 1,
+// in the space of the objects: eye space for objects added under the modelview
+// of the frame, or the space a given view matrix maps to eye space.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PICKING_H
+#define PICKING_H
+
+#include <cmath>
+#include <vector>
+#include <map>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "bvh.h"
+#include "sphereMesh.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Routine to make the ray through the pixel at (x, y) in GLUT window coordinates,
+// y down, with the current projection matrix and viewport, in the space that view
+// (column-major, as from glGetDoublev(GL_MODELVIEW_MATRIX)) maps to eye space; in
+// eye space itself if view is NULL.
+inline void pickRay(int x, int y, const double *view, Ray &ray)
+{
+	static const double identity[16] = { 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0 };
+	double projection[16], nearPoint[3], farPoint[3];
+	int viewport[4];
+
+	glGetDoublev(GL_PROJECTION_MATRIX, projection);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	double winX = x + 0.5, winY = glutGet(GLUT_WINDOW_HEIGHT) - y - 0.5; // Pixel center, y up.
+	if (!view) view = identity;
+	gluUnProject(winX, winY, 0.0, view, projection, viewport, &nearPoint[0], &nearPoint[1], &nearPoint[2]);
+	gluUnProject(winX, winY, 1.0, view, projection, viewport, &farPoint[0], &farPoint[1], &farPoint[2]);
+
+	float o[3], d[3];
+	for (int a = 0; a < 3; a++)
+	{
+		o[a] = (float)nearPoint[a];
+		d[a] = (float)(farPoint[a] - nearPoint[a]);
+	}
+	ray.set(o, d);
+}
+
+// Routine to invert the affine matrix m (column-major) into inverse.
+inline void pickInvert(const float m[16], float inverse[16])
+{
+	float a00 = m[0], a10 = m[1], a20 = m[2], a01 = m[4], a11 = m[5], a21 = m[6], a02 = m[8], a12 = m[9], a22 = m[10];
+	float c00 = a11 * a22 - a12 * a21, c01 = a02 * a21 - a01 * a22, c02 = a01 * a12 - a02 * a11;
+	float c10 = a12 * a20 - a10 * a22, c11 = a00 * a22 - a02 * a20, c12 = a02 * a10 - a00 * a12;
+	float c20 = a10 * a21 - a11 * a20, c21 = a01 * a20 - a00 * a21, c22 = a00 * a11 - a01 * a10;
+	float det = a00 * c00 + a01 * c10 + a02 * c20;
+	float s = det != 0.0 ? 1.0f / det : 0.0f;
+
+	inverse[0] = c00 * s; inverse[4] = c01 * s; inverse[8] = c02 * s;
+	inverse[1] = c10 * s; inverse[5] = c11 * s; inverse[9] = c12 * s;
+	inverse[2] = c20 * s; inverse[6] = c21 * s; inverse[10] = c22 * s;
+	for (int r = 0; r < 3; r++)
+		inverse[12 + r] = -(inverse[r] * m[12] + inverse[4 + r] * m[13] + inverse[8 + r] * m[14]);
+	inverse[3] = inverse[7] = inverse[11] = 0.0;
+	inverse[15] = 1.0;
+}
+
+// Routine to take the ray into an object's space by the inverse of its matrix.
+// Origin and direction are transformed alike, so t is unchanged.
+inline void pickTransformRay(const float inverse[16], const Ray &ray, Ray &local)
+{
+	float o[3], d[3];
+	for (int r = 0; r < 3; r++)
+	{
+		o[r] = inverse[r] * ray.origin[0] + inverse[4 + r] * ray.origin[1] + inverse[8 + r] * ray.origin[2] + inverse[12 + r];
+		d[r] = inverse[r] * ray.dir[0] + inverse[4 + r] * ray.dir[1] + inverse[8 + r] * ray.dir[2];
+	}
+	local.set(o, d);
+}
+
+// Routine to return the t at which the ray hits triangle p0 p1 p2, either side,
+// or tMax if it does not hit it before tMax (Moller-Trumbore).
+inline float rayTriangle(const Ray &ray, const float *p0, const float *p1, const float *p2, float tMax)
+{
+	float e1[3], e2[3], s[3], p[3], q[3];
+	for (int a = 0; a < 3; a++)
+	{
+		e1[a] = p1[a] - p0[a];
+		e2[a] = p2[a] - p0[a];
+		s[a] = ray.origin[a] - p0[a];
+	}
+	p[0] = ray.dir[1] * e2[2] - ray.dir[2] * e2[1];
+	p[1] = ray.dir[2] * e2[0] - ray.dir[0] * e2[2];
+	p[2] = ray.dir[0] * e2[1] - ray.dir[1] * e2[0];
+	float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+	if (std::fabs(det) < 1.0e-12f) return tMax; // Parallel.
+	float invDet = 1.0f / det;
+	float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+	if (u < 0.0 || u > 1.0) return tMax;
+	q[0] = s[1] * e1[2] - s[2] * e1[1];
+	q[1] = s[2] * e1[0] - s[0] * e1[2];
+	q[2] = s[0] * e1[1] - s[1] * e1[0];
+	float v = (ray.dir[0] * q[0] + ray.dir[1] * q[1] + ray.dir[2] * q[2]) * invDet;
+	if (v < 0.0 || u + v > 1.0) return tMax;
+	float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+	return t >= 0.0 && t < tMax ? t : tMax;
+}
+
+// Routine to build tree over boxes, with the spheres round the boxes.
+inline void pickBuildTree(Bvh &tree, const std::vector<Aabb> &boxes)
+{
+	int n = (int)boxes.size();
+	std::vector<float> sx(n), sy(n), sz(n), sr(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		const Aabb &b = boxes[i];
+		float e[3];
+		for (int a = 0; a < 3; a++) e[a] = 0.5f * (b.max[a] - b.min[a]);
+		sx[i] = 0.5f * (b.min[0] + b.max[0]); sy[i] = 0.5f * (b.min[1] + b.max[1]); sz[i] = 0.5f * (b.min[2] + b.max[2]);
+		sr[i] = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+	}
+	tree.build(boxes, sx, sy, sz, sr);
+}
+
+// A triangle mesh in object space, with a hierarchy over its triangles.
+class PickMesh
+{
+public:
+	// Routine to make the box and the hierarchy once vertices and indices are filled.
+	void finish(void)
+	{
+		int numTriangles = (int)indices.size() / 3;
+		std::vector<Aabb> boxes(numTriangles);
+
+		for (int a = 0; a < 3; a++)
+		{
+			box.min[a] = 1e30f;
+			box.max[a] = -1e30f;
+		}
+		for (int i = 0; i < numTriangles; i++)
+		{
+			for (int a = 0; a < 3; a++)
+			{
+				boxes[i].min[a] = 1e30f;
+				boxes[i].max[a] = -1e30f;
+			}
+			for (int k = 0; k < 3; k++)
+			{
+				const float *p = &vertices[3 * indices[3 * i + k]];
+				for (int a = 0; a < 3; a++)
+				{
+					boxes[i].min[a] = std::min(boxes[i].min[a], p[a]);
+					boxes[i].max[a] = std::max(boxes[i].max[a], p[a]);
+				}
+			}
+			box.merge(boxes[i]);
+		}
+		pickBuildTree(tree, boxes);
+	}
+
+	// Routine to return the t of the nearest triangle hit by ray, in object space,
+	// before tMax, or tMax if none.
+	float hit(const Ray &ray, float tMax) const
+	{
+		RayStats stats;
+		tree.intersect(ray, tMax, [this, &ray](int i, float tBest)
+		{
+			return rayTriangle(ray, &vertices[3 * indices[3 * i]], &vertices[3 * indices[3 * i + 1]],
+				&vertices[3 * indices[3 * i + 2]], tBest);
+		}, stats);
+		return tMax;
+	}
+
+	std::vector<float> vertices; // x, y, z each.
+	std::vector<unsigned int> indices; // Three a triangle.
+	Aabb box; // Bounds of the vertices.
+
+private:
+	Bvh tree; // Over the triangles.
+};
+
+// Routine to return the mesh of the given kind and parameters, generating it
+// with generate(mesh) if it is not yet made.
+template <class Generate>
+const PickMesh &pickMesh(int kind, float a, float b, float c, float d, Generate generate)
+{
+	static std::map<std::vector<float>, PickMesh> meshes;
+	std::vector<float> key = { (float)kind, a, b, c, d };
+	auto found = meshes.find(key);
+	if (found != meshes.end()) return found->second;
+	PickMesh &mesh = meshes[key];
+	generate(mesh);
+	mesh.finish();
+	return mesh;
+}
+
+// Routine to return the mesh of glutSolidSphere(radius, slices, stacks): poles on
+// the z-axis, stacks of latitude and slices of longitude.
+inline const PickMesh &pickSphere(float radius, int slices, int stacks)
+{
+	return pickMesh(0, radius, (float)slices, (float)stacks, 0.0, [=](PickMesh &mesh)
+	{
+		sphereMeshVertices(slices, stacks, mesh.vertices);
+		for (size_t i = 0; i < mesh.vertices.size(); i++) mesh.vertices[i] *= radius;
+		sphereMeshTriangles(slices, stacks, mesh.indices);
+	});
+}
+
+// Routine to return the mesh of glutSolidCube(size), centered at the origin.
+inline const PickMesh &pickCube(float size)
+{
+	return pickMesh(1, size, 0.0, 0.0, 0.0, [=](PickMesh &mesh)
+	{
+		for (int k = 0; k < 8; k++)
+		{
+			mesh.vertices.push_back(k & 1 ? 0.5f * size : -0.5f * size);
+			mesh.vertices.push_back(k & 2 ? 0.5f * size : -0.5f * size);
+			mesh.vertices.push_back(k & 4 ? 0.5f * size : -0.5f * size);
+		}
+		mesh.indices = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+			2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+	});
+}
+
+// Routine to return the mesh of glutSolidCone(base, height, slices, stacks): base
+// on the z = 0 plane, apex on the z-axis. The stacks divide the side into bands
+// that lie in the same planes, so only the slices matter.
+inline const PickMesh &pickCone(float base, float height, int slices, int stacks)
+{
+	return pickMesh(2, base, height, (float)slices, 0.0, [=](PickMesh &mesh)
+	{
+		mesh.vertices.insert(mesh.vertices.end(), { 0.0, 0.0, 0.0, 0.0, 0.0, height }); // Base center and apex.
+		for (int j = 0; j < slices; j++)
+		{
+			float theta = 2.0 * M_PI * j / slices;
+			mesh.vertices.insert(mesh.vertices.end(), { base * std::cos(theta), base * std::sin(theta), 0.0 });
+		}
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = 2 + j, b = 2 + (j + 1) % slices;
+			mesh.indices.insert(mesh.indices.end(), { a, b, 1, 0, b, a });
+		}
+	});
+}
+
+// Routine to return the mesh of glutSolidTorus(inner, outer, sides, rings): the
+// tube of radius inner round the circle of radius outer about the z-axis.
+inline const PickMesh &pickTorus(float inner, float outer, int sides, int rings)
+{
+	return pickMesh(3, inner, outer, (float)sides, (float)rings, [=](PickMesh &mesh)
+	{
+		for (int j = 0; j < rings; j++)
+			for (int i = 0; i < sides; i++)
+			{
+				float phi = 2.0 * M_PI * j / rings, theta = 2.0 * M_PI * i / sides;
+				float r = outer + inner * std::cos(theta);
+				mesh.vertices.insert(mesh.vertices.end(), { r * std::cos(phi), r * std::sin(phi), inner * std::sin(theta) });
+			}
+		for (int j = 0; j < rings; j++)
+			for (int i = 0; i < sides; i++)
+			{
+				unsigned int a = j * sides + i, b = j * sides + (i + 1) % sides;
+				unsigned int c = (j + 1) % rings * sides + i, d = (j + 1) % rings * sides + (i + 1) % sides;
+				mesh.indices.insert(mesh.indices.end(), { a, c, b, b, c, d });
+			}
+	});
+}
+
+// Routine to return the t at which the ray hits the mesh placed by the matrix
+// whose inverse is given, or tMax if it does not before tMax.
+inline float pickHit(const PickMesh &mesh, const float inverse[16], const Ray &ray, float tMax)
+{
+	Ray local;
+	pickTransformRay(inverse, ray, local);
+	if (local.enters(mesh.box, tMax) < 0.0) return tMax;
+	return mesh.hit(local, tMax);
+}
+
+// The pickable objects of a scene.
+class PickScene
+{
+public:
+	PickScene(void) : buildMicros(0.0), pickMicros(0.0), tHit(1.0), built(false)
+	{
+		stats.nodesVisited = stats.itemsTested = 0;
+	}
+
+	// Routine to remove all objects, e.g. before adding those of a new frame.
+	void clear(void)
+	{
+		objects.clear();
+		built = false;
+	}
+
+	// Routine to add an object named id with the mesh under the current modelview matrix.
+	void add(int id, const PickMesh &mesh)
+	{
+		float m[16];
+		glGetFloatv(GL_MODELVIEW_MATRIX, m);
+		add(id, mesh, m);
+	}
+
+	// Routine to add an object named id with the mesh under matrix m (column-major).
+	void add(int id, const PickMesh &mesh, const float m[16])
+	{
+		Object object;
+		object.id = id;
+		object.mesh = &mesh;
+		for (int k = 0; k < 16; k++) object.matrix[k] = m[k];
+		pickInvert(m, object.inverse);
+		objects.push_back(object);
+		built = false;
+	}
+
+	// Routine to return the id of the nearest object under the pixel at (x, y) in GLUT
+	// window coordinates, or -1, with the current projection and viewport. The objects
+	// are in the space view maps to eye space, eye space itself if view is NULL.
+	int pick(int x, int y, const double *view = NULL)
+	{
+		if (!built) build();
+
+		auto start = std::chrono::high_resolution_clock::now();
+		Ray ray;
+		pickRay(x, y, view, ray);
+		tHit = 1.0; // The far plane.
+		int hit = bvh.intersect(ray, tHit, [this, &ray](int i, float tMax)
+		{
+			return pickHit(*objects[i].mesh, objects[i].inverse, ray, tMax);
+		}, stats);
+		pickMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+		return hit < 0 ? -1 : objects[hit].id;
+	}
+
+	int numObjects(void) const { return (int)objects.size(); }
+
+	double buildMicros, pickMicros; // Times of the last build and pick.
+	RayStats stats; // Of the last pick.
+	float tHit; // Of the last pick, from 0 at the near plane to 1 at the far.
+
+private:
+	// Routine to build the hierarchy over the objects' boxes, each the box of the
+	// eight corners of its mesh's box under its matrix.
+	void build(void)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<Aabb> boxes(objects.size());
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			const Aabb &b = objects[i].mesh->box;
+			const float *m = objects[i].matrix;
+			for (int a = 0; a < 3; a++)
+			{
+				boxes[i].min[a] = 1e30f;
+				boxes[i].max[a] = -1e30f;
+			}
+			for (int k = 0; k < 8; k++)
+			{
+				float p[3] = { k & 1 ? b.max[0] : b.min[0], k & 2 ? b.max[1] : b.min[1], k & 4 ? b.max[2] : b.min[2] };
+				for (int r = 0; r < 3; r++)
+				{
+					float q = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+					boxes[i].min[r] = std::min(boxes[i].min[r], q);
+					boxes[i].max[r] = std::max(boxes[i].max[r], q);
+				}
+			}
+		}
+		pickBuildTree(bvh, boxes);
+		built = true;
+		buildMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	struct Object
+	{
+		int id;
+		const PickMesh *mesh;
+		float matrix[16], inverse[16];
+	};
+
+	std::vector<Object> objects;
+	Bvh bvh; // Over the objects.
+	bool built; // Is bvh up to date with objects?
+};
+
+#endif
@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////////
+// postAA.h
+//
+// Optional anti-aliasing of a demo's frames, either by a single FXAA post-process
+// pass or by 4x multisampling, for comparing the two on the same scene.
+//
+// A demo calls postAAInit(&argc, argv) after glutInit(), postAABegin() at the top
+// of its drawing routine, before it clears, and postAAEnd() just before its
+// glutSwapBuffers() or glFlush() (and captureFrame()). Run as
+//
+//   demo -aa fxaa        (or msaa, or off)
+//
+// the frame is drawn into an offscreen framebuffer the size of the window, with
+// a depth and stencil buffer, then:
+//
+//   fxaa: the color target is a texture, and postAAEnd() draws one full-screen
+//         triangle into the window through an FXAA shader: where the luma of a
+//         pixel's neighbourhood has enough contrast it estimates the direction of
+//         the edge from the luma gradient and blends along it, falling back to
+//         a shorter blend when the longer one overshoots the local luma range;
+//   msaa: the targets have 4 samples a pixel and postAAEnd() resolves them into
+//         the window with glBlitFramebuffer();
+//   off:  the frame is drawn straight into the window, for a baseline.
+//
+// GPU timestamps at the start of the frame, the end of the scene and the end of
+// the resolve give both what the anti-aliasing pass itself costs and what the
+// multisampled target costs the scene; every 100 frames their averages are
+// written to the C++ window with the memory of the targets, e.g.
+//
+//   AA fxaa 500 x 500: scene 0.61 ms, resolve 0.09 ms GPU a frame, targets 1.9 MB
+//
+// The targets can also be smaller than the window, by postAAScale(s), to lower
+// the render resolution (see qualityGovernor.h): the scene is drawn at s times the
+// window's size and stretched over it by the FXAA pass, or off, by a linear blit;
+// postAABegin() then sets the viewport to the target, and postAAEnd() back to the
+// window, so this suits demos setting one viewport in their resize routine. A
+// multisampled target cannot be stretched as it is resolved, so msaa ignores it.
+//
+// Queries are read four frames after they were issued, by when they are normally
+// ready, so timing does not stall the pipeline. FXAA works on the final image,
+// text included, and so softens bitmap text slightly; MSAA does not, but reading
+// pixels back from a multisampled target is an error, so a demo reading its own
+// framebuffer mid-frame cannot run with msaa. Without -aa the calls cost one test
+// of a flag.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef POST_AA_H
+#define POST_AA_H
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "programCache.h"
+
+#define POST_AA_SAMPLES 4 // Samples a pixel of the multisampled target.
+#define POST_AA_QUERIES 4 // Frames of timestamp queries in flight.
+#define POST_AA_REPORT 100 // Frames between reports.
+
+// Anti-aliasing modes.
+enum PostAAMode { POST_AA_OFF, POST_AA_FXAA, POST_AA_MSAA };
+
+// Anti-aliasing state.
+struct PostAAState
+{
+	bool on; // -aa given, or scaled?
+	bool quiet; // Scaled without -aa: no reports.
+	PostAAMode mode;
+	float scale; // Of the targets to the window; 0 is taken as 1.
+	int width, height; // Of the targets.
+	int windowWidth, windowHeight; // Of the window.
+	unsigned int framebuffer, color, depth; // Offscreen target; color is a texture for FXAA.
+	unsigned int program, vao; // FXAA pass.
+	int texelLoc; // Uniform location.
+	unsigned int queries[POST_AA_QUERIES][3]; // Timestamps: frame start, scene end, resolve end.
+	long long frame; // Frames begun.
+	int timed; // Frames timed since the last report.
+	double sceneMillis, resolveMillis; // GPU times summed since the last report.
+};
+
+static PostAAState postAA;
+
+static const char *postAAVertexShaderSource =
+"#version 430 core\n"
+"out vec2 uv;\n"
+"void main(void)\n"
+"{\n"
+"	uv = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+"	gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);\n"
+"}\n";
+
+static const char *postAAFragmentShaderSource =
+"#version 430 core\n"
+"#define EDGE_THRESHOLD (1.0 / 8.0)\n"
+"#define EDGE_THRESHOLD_MIN (1.0 / 16.0)\n"
+"#define REDUCE_MUL (1.0 / 8.0)\n"
+"#define REDUCE_MIN (1.0 / 128.0)\n"
+"#define SPAN_MAX 8.0\n"
+"uniform sampler2D scene;\n"
+"uniform vec2 texel;\n"
+"in vec2 uv;\n"
+"out vec4 fragColor;\n"
+"float luma(vec3 c) { return dot(c, vec3(0.299, 0.587, 0.114)); }\n"
+"void main(void)\n"
+"{\n"
+"	vec3 rgbM = texture(scene, uv).rgb;\n"
+"	float lumaNW = luma(texture(scene, uv + vec2(-1.0, -1.0) * texel).rgb);\n"
+"	float lumaNE = luma(texture(scene, uv + vec2(1.0, -1.0) * texel).rgb);\n"
+"	float lumaSW = luma(texture(scene, uv + vec2(-1.0, 1.0) * texel).rgb);\n"
+"	float lumaSE = luma(texture(scene, uv + vec2(1.0, 1.0) * texel).rgb);\n"
+"	float lumaM = luma(rgbM);\n"
+"	float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+"	float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+"	if (lumaMax - lumaMin < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD))\n"
+"	{\n"
+"		fragColor = vec4(rgbM, 1.0);\n"
+"		return;\n"
+"	}\n"
+"\n"
+"	vec2 dir = vec2((lumaSW + lumaSE) - (lumaNW + lumaNE), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+"	float reduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * 0.25 * REDUCE_MUL, REDUCE_MIN);\n"
+"	float scale = 1.0 / (min(abs(dir.x), abs(dir.y)) + reduce);\n"
+"	dir = clamp(dir * scale, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texel;\n"
+"\n"
+"	vec3 rgbA = 0.5 * (texture(scene, uv + dir * (1.0 / 3.0 - 0.5)).rgb + texture(scene, uv + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+"	vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(scene, uv - dir * 0.5).rgb + texture(scene, uv + dir * 0.5).rgb);\n"
+"	float lumaB = luma(rgbB);\n"
+"	fragColor = vec4(lumaB < lumaMin || lumaB > lumaMax ? rgbA : rgbB, 1.0);\n"
+"}\n";
+
+// Routine to (re)create the offscreen targets at the window's size.
+inline void postAAResize(int width, int height)
+{
+	if (postAA.framebuffer)
+	{
+		glDeleteFramebuffers(1, &postAA.framebuffer);
+		if (postAA.mode != POST_AA_MSAA) glDeleteTextures(1, &postAA.color); else glDeleteRenderbuffers(1, &postAA.color);
+		glDeleteRenderbuffers(1, &postAA.depth);
+	}
+	postAA.width = width;
+	postAA.height = height;
+
+	glGenFramebuffers(1, &postAA.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, postAA.framebuffer);
+	int samples = 1;
+	if (postAA.mode != POST_AA_MSAA) // Texture for the FXAA pass or the stretching blit.
+	{
+		glGenTextures(1, &postAA.color);
+		glBindTexture(GL_TEXTURE_2D, postAA.color);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, postAA.color, 0);
+	}
+	else
+	{
+		int maxSamples = 1;
+		glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+		samples = POST_AA_SAMPLES < maxSamples ? POST_AA_SAMPLES : maxSamples;
+		glGenRenderbuffers(1, &postAA.color);
+		glBindRenderbuffer(GL_RENDERBUFFER, postAA.color);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, postAA.color);
+	}
+	glGenRenderbuffers(1, &postAA.depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, postAA.depth);
+	glRenderbufferStorageMultisample(GL_RENDERBUFFER, postAA.mode == POST_AA_MSAA ? samples : 0, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, postAA.depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "AA target incomplete, anti-aliasing off" << std::endl;
+		postAA.on = false;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	postAA.timed = 0;
+	postAA.sceneMillis = postAA.resolveMillis = 0.0;
+}
+
+// Routine to add the times of the frame whose queries are in slot to the sums,
+// and report every POST_AA_REPORT frames.
+inline void postAACollect(int slot)
+{
+	GLuint64 t[3];
+	for (int k = 0; k < 3; k++) glGetQueryObjectui64v(postAA.queries[slot][k], GL_QUERY_RESULT, &t[k]);
+	postAA.sceneMillis += (t[1] - t[0]) * 1.0e-6;
+	postAA.resolveMillis += (t[2] - t[1]) * 1.0e-6;
+	if (++postAA.timed < POST_AA_REPORT || postAA.quiet) return;
+
+	static const char *names[] = { "off", "fxaa", "msaa" };
+	double bytesPerPixel = !postAA.framebuffer ? 0.0 : (postAA.mode == POST_AA_MSAA ? 8.0 * POST_AA_SAMPLES : 8.0);
+	char line[160];
+	sprintf(line, "AA %s %d x %d: scene %.2f ms, resolve %.2f ms GPU a frame, targets %.1f MB", names[postAA.mode],
+		postAA.width, postAA.height, postAA.sceneMillis / postAA.timed, postAA.resolveMillis / postAA.timed,
+		bytesPerPixel * postAA.width * postAA.height / (1 << 20));
+	std::cout << line << std::endl;
+	postAA.timed = 0;
+	postAA.sceneMillis = postAA.resolveMillis = 0.0;
+}
+
+// Routine to tell whether the frame is drawn offscreen.
+inline bool postAAOffscreen(void)
+{
+	return postAA.mode != POST_AA_OFF || postAA.width != postAA.windowWidth || postAA.height != postAA.windowHeight;
+}
+
+// Routine to start a frame: bind the offscreen target, resized to the window if need be.
+inline void postAABegin(void)
+{
+	if (!postAA.on) return;
+	int slot = (int)(postAA.frame % POST_AA_QUERIES);
+	if (!postAA.frame)
+	{
+		glGenQueries(3 * POST_AA_QUERIES, &postAA.queries[0][0]);
+		if (postAA.mode == POST_AA_FXAA)
+		{
+			postAA.program = programCacheBuild(postAAVertexShaderSource, postAAFragmentShaderSource);
+			postAA.texelLoc = glGetUniformLocation(postAA.program, "texel");
+			glGenVertexArrays(1, &postAA.vao);
+		}
+	}
+	else if (postAA.frame >= POST_AA_QUERIES) postAACollect(slot); // Issued POST_AA_QUERIES frames ago.
+	postAA.frame++;
+
+	postAA.windowWidth = glutGet(GLUT_WINDOW_WIDTH);
+	postAA.windowHeight = glutGet(GLUT_WINDOW_HEIGHT);
+	float scale = postAA.scale > 0.0 && postAA.mode != POST_AA_MSAA ? postAA.scale : 1.0f;
+	int width = (int)(postAA.windowWidth * scale + 0.5), height = (int)(postAA.windowHeight * scale + 0.5);
+	if (width < 1) width = 1;
+	if (height < 1) height = 1;
+	if (postAA.mode == POST_AA_OFF && scale == 1.0)
+	{
+		postAA.width = width;
+		postAA.height = height;
+	}
+	else if (width != postAA.width || height != postAA.height || !postAA.framebuffer) postAAResize(width, height);
+	if (postAAOffscreen() && postAA.on)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, postAA.framebuffer);
+		if (scale != 1.0) glViewport(0, 0, postAA.width, postAA.height);
+	}
+	glQueryCounter(postAA.queries[slot][0], GL_TIMESTAMP);
+}
+
+// Routine to end a frame: resolve the offscreen target into the window.
+inline void postAAEnd(void)
+{
+	if (!postAA.on) return;
+	int slot = (int)((postAA.frame - 1) % POST_AA_QUERIES);
+	glQueryCounter(postAA.queries[slot][1], GL_TIMESTAMP);
+
+	if (postAAOffscreen())
+	{
+		glPushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT | GL_VIEWPORT_BIT);
+		glDisable(GL_SCISSOR_TEST);
+		if (postAA.mode == POST_AA_OFF)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, postAA.framebuffer);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, postAA.width, postAA.height, 0, 0, postAA.windowWidth, postAA.windowHeight,
+				GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		}
+		else if (postAA.mode == POST_AA_MSAA)
+		{
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, postAA.framebuffer);
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			glBlitFramebuffer(0, 0, postAA.width, postAA.height, 0, 0, postAA.width, postAA.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		}
+		else
+		{
+			int program, vao, activeTexture, texture;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+			glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+			glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+			glActiveTexture(GL_TEXTURE0);
+			glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glDisable(GL_DEPTH_TEST);
+			glDisable(GL_STENCIL_TEST);
+			glDisable(GL_BLEND);
+			glDisable(GL_CULL_FACE);
+			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+			glViewport(0, 0, postAA.windowWidth, postAA.windowHeight);
+			glBindTexture(GL_TEXTURE_2D, postAA.color);
+			glUseProgram(postAA.program);
+			glUniform2f(postAA.texelLoc, 1.0f / postAA.width, 1.0f / postAA.height);
+			glBindVertexArray(postAA.vao);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+
+			glBindVertexArray(vao);
+			glUseProgram(program);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glActiveTexture(activeTexture);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glPopAttrib();
+		if (postAA.width != postAA.windowWidth || postAA.height != postAA.windowHeight)
+			glViewport(0, 0, postAA.windowWidth, postAA.windowHeight);
+	}
+	glQueryCounter(postAA.queries[slot][2], GL_TIMESTAMP);
+}
+
+// Routine to draw the frames that follow at scale times the window's size, turning
+// the offscreen target on if -aa was not given; false if the mode cannot stretch.
+inline bool postAAScale(float scale)
+{
+	if (postAA.mode == POST_AA_MSAA) return false;
+	if (!postAA.on) postAA.on = postAA.quiet = true;
+	postAA.scale = scale;
+	return true;
+}
+
+// Routine to turn anti-aliasing on if the command line holds -aa fxaa|msaa|off,
+// removing them.
+inline void postAAInit(int *argc, char **argv)
+{
+	for (int i = 1; i + 1 < *argc; i++)
+	{
+		if (strcmp(argv[i], "-aa")) continue;
+		postAA.mode = !strcmp(argv[i + 1], "fxaa") ? POST_AA_FXAA : (!strcmp(argv[i + 1], "msaa") ? POST_AA_MSAA : POST_AA_OFF);
+		for (int j = i; j + 2 <= *argc; j++) argv[j] = argv[j + 2];
+		*argc -= 2;
+		postAA.on = true;
+		postAA.quiet = false;
+		break;
+	}
+}
+
+#endif
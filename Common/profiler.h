@@ -0,0 +1,456 @@
+////////////////////////////////////////////////////////////////////////////////////
+// profiler.h
+//
+// Scoped CPU and GPU profiling zones, written as a Chrome trace event file for
+// viewing in Perfetto (ui.perfetto.dev) or chrome://tracing.
+//
+// A zone covers a block of code:
+//
+//   {
+//       PROFILE_ZONE("helix");       // CPU time of the block on this thread.
+//       PROFILE_GPU_ZONE("helix");   // GPU time of the commands issued in it.
+//       ...
+//   }
+//
+// and the phases of a routine:
+//
+//   PROFILE_PHASES;
+//   PROFILE_PHASE("clear");
+//   glClear(GL_COLOR_BUFFER_BIT);
+//   PROFILE_PHASE("helix");      // Ends "clear".
+//   ...                          // "helix" ends on return.
+//
+// A demo calls profileInit(&argc, argv) after glutInit() and profileFrameEnd() after
+// its glutSwapBuffers() or glFlush(). Run as
+//
+//   demo -profile trace.json 300
+//
+// it records every zone of the first 300 frames, then writes the file.
+//
+// Zones are compiled in only if ENABLE_PROFILER is defined, e.g. among the
+// project's preprocessor definitions; otherwise the macros expand to nothing and
+// profileInit() and profileFrameEnd() are empty, so the annotations cost nothing.
+// Compiled in but not recording, a zone costs one test of a flag.
+// Defining ENABLE_MEMORY_STATS, as well or instead, makes the same zones and
+// phases count the heap allocations made in them; see memoryStats.h. The startup
+// breakdown of startupTimer.h, always compiled in, is driven by the same calls.
+//
+// Each thread appends its CPU zones to a buffer of its own, found through a
+// thread_local pointer, so recording takes no lock; the buffers are registered
+// once, under a mutex, and read only when the file is written at the end of a
+// frame, by which time zones on worker threads must have closed, as they have
+// once WorkerPool::run() returns. GPU zones, only on the thread owning the context,
+// place a GL_TIMESTAMP query at each end; the results are collected a few frames
+// later, when available, and moved onto the CPU time line by an offset measured
+// at the first GPU zone. They appear on a track of their own named "GPU", and the
+// frames on one named "Frames".
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <iostream>
+
+#include <GL/glew.h>
+
+// A finished zone; times in nanoseconds since profileInit().
+struct ProfileEvent
+{
+	const char *name;
+	long long start, duration;
+};
+
+// Zones of one thread.
+struct ProfileThread
+{
+	int tid;
+	const char *name;
+	std::vector<ProfileEvent> events;
+};
+
+// GPU zone whose queries have not been read yet.
+struct GpuProfilePending
+{
+	const char *name;
+	unsigned int queries[2];
+};
+
+// Profiler state.
+struct ProfilerState
+{
+	ProfilerState(void) : on(false), path(NULL), framesLeft(0), frames(0), frameStart(0),
+		calibrated(false), gpuOffset(0) {}
+
+	std::atomic<bool> on; // Recording?
+	const char *path; // File to write.
+	int framesLeft, frames; // Frames still to record, frames recorded.
+	std::chrono::high_resolution_clock::time_point start;
+	long long frameStart; // Start of the current frame.
+
+	std::mutex mutex; // Guards threads.
+	std::vector<ProfileThread *> threads; // Never freed, so zones outlive their thread.
+
+	std::vector<GpuProfilePending> pending; // In issue order.
+	std::vector<unsigned int> freeQueries;
+	std::vector<ProfileEvent> gpuEvents;
+	std::vector<ProfileEvent> frameEvents;
+	bool calibrated;
+	long long gpuOffset; // CPU time minus GPU time.
+};
+
+static ProfilerState profiler;
+
+// Tracks other than the threads'.
+enum { PROFILE_TID_FRAMES = 1000, PROFILE_TID_GPU };
+
+// Routine to give the time in nanoseconds since profileInit().
+inline long long profileNow(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::high_resolution_clock::now() - profiler.start).count();
+}
+
+// Routine to give the buffer of the calling thread, registering it the first time.
+inline ProfileThread &profileThread(void)
+{
+	static thread_local ProfileThread *thread = NULL;
+	if (!thread)
+	{
+		std::lock_guard<std::mutex> lock(profiler.mutex);
+		thread = new ProfileThread;
+		thread->tid = (int)profiler.threads.size() + 1;
+		thread->name = NULL;
+		thread->events.reserve(4096);
+		profiler.threads.push_back(thread);
+	}
+	return *thread;
+}
+
+// Routine to name the calling thread's track.
+inline void profileThreadName(const char *name)
+{
+	profileThread().name = name;
+}
+
+// Routine to record a CPU zone of the calling thread, unless recording has
+// stopped since it began.
+inline void profileRecord(const char *name, long long start)
+{
+	if (!profiler.on.load(std::memory_order_relaxed)) return;
+	ProfileEvent event = { name, start, profileNow() - start };
+	profileThread().events.push_back(event);
+}
+
+// CPU zone from construction to destruction.
+class ProfileZone
+{
+public:
+	ProfileZone(const char *zoneName) : name(zoneName), start(-1)
+	{
+		if (profiler.on.load(std::memory_order_relaxed)) start = profileNow();
+	}
+
+	~ProfileZone()
+	{
+		if (start >= 0) profileRecord(name, start);
+	}
+
+private:
+	const char *name;
+	long long start;
+};
+
+// Routine to measure the offset between the GPU and CPU clocks.
+inline void profileCalibrate(void)
+{
+	GLint64 gpuTime;
+	glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+	profiler.gpuOffset = profileNow() - gpuTime;
+	profiler.calibrated = true;
+}
+
+// Routine to take a query object from the free list.
+inline unsigned int profileQuery(void)
+{
+	unsigned int query;
+	if (profiler.freeQueries.empty()) glGenQueries(1, &query);
+	else
+	{
+		query = profiler.freeQueries.back();
+		profiler.freeQueries.pop_back();
+	}
+	return query;
+}
+
+// Routine to place the timestamp at the start of a GPU zone.
+inline void profileGpuBegin(GpuProfilePending &zone, const char *name)
+{
+	if (!profiler.calibrated) profileCalibrate();
+	zone.name = name;
+	zone.queries[0] = profileQuery();
+	zone.queries[1] = profileQuery();
+	glQueryCounter(zone.queries[0], GL_TIMESTAMP);
+}
+
+// Routine to place the timestamp at the end of a GPU zone.
+inline void profileGpuEnd(GpuProfilePending &zone)
+{
+	glQueryCounter(zone.queries[1], GL_TIMESTAMP);
+	if (profiler.on.load(std::memory_order_relaxed)) profiler.pending.push_back(zone);
+	else
+	{
+		profiler.freeQueries.push_back(zone.queries[0]);
+		profiler.freeQueries.push_back(zone.queries[1]);
+	}
+}
+
+// GPU zone from construction to destruction, with a CPU zone of the same name.
+class GpuProfileZone
+{
+public:
+	GpuProfileZone(const char *zoneName) : cpu(zoneName), active(false)
+	{
+		if (!profiler.on.load(std::memory_order_relaxed)) return;
+		profileGpuBegin(zone, zoneName);
+		active = true;
+	}
+
+	~GpuProfileZone()
+	{
+		if (active) profileGpuEnd(zone);
+	}
+
+private:
+	ProfileZone cpu;
+	GpuProfilePending zone;
+	bool active;
+};
+
+// Consecutive CPU and GPU zones, the phases of a routine such as drawScene(): each
+// call of next() ends the current phase and begins the named one, and the last
+// phase ends with the object, so a routine is annotated a line a phase.
+class ProfilePhases
+{
+public:
+	ProfilePhases(void) : name(NULL), start(-1) {}
+	~ProfilePhases() { next(NULL); }
+
+	// Routine to end the current phase and, unless phaseName is NULL, begin another.
+	void next(const char *phaseName)
+	{
+		if (start >= 0)
+		{
+			profileGpuEnd(zone);
+			profileRecord(name, start);
+			start = -1;
+		}
+		if (!phaseName || !profiler.on.load(std::memory_order_relaxed)) return;
+		name = phaseName;
+		start = profileNow();
+		profileGpuBegin(zone, phaseName);
+	}
+
+private:
+	const char *name;
+	long long start;
+	GpuProfilePending zone;
+};
+
+// Routine to read the pending GPU zones, in order, stopping at the first whose
+// result is not yet available unless wait is set.
+inline void profileCollectGpu(bool wait)
+{
+	size_t i = 0;
+	for (; i < profiler.pending.size(); i++)
+	{
+		GpuProfilePending &zone = profiler.pending[i];
+		if (!wait)
+		{
+			GLint available = 0;
+			glGetQueryObjectiv(zone.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) break;
+		}
+		GLuint64 begin, end;
+		glGetQueryObjectui64v(zone.queries[0], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(zone.queries[1], GL_QUERY_RESULT, &end);
+		ProfileEvent event = { zone.name, (long long)begin + profiler.gpuOffset, (long long)(end - begin) };
+		profiler.gpuEvents.push_back(event);
+		profiler.freeQueries.push_back(zone.queries[0]);
+		profiler.freeQueries.push_back(zone.queries[1]);
+	}
+	profiler.pending.erase(profiler.pending.begin(), profiler.pending.begin() + i);
+}
+
+// Routine to write one complete ("X") event.
+inline void profileWriteEvent(FILE *file, const ProfileEvent &event, int tid, bool &first)
+{
+	fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+		first ? "" : ",", event.name, tid, event.start / 1000.0, event.duration / 1000.0);
+	first = false;
+}
+
+// Routine to write a track name.
+inline void profileWriteThreadName(FILE *file, int tid, const char *name, bool &first)
+{
+	fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+		first ? "" : ",", tid, name);
+	first = false;
+}
+
+// Routine to write the trace file and stop recording.
+inline void profileFinish(void)
+{
+	FILE *file = fopen(profiler.path, "w");
+	bool first = true;
+	size_t numEvents = profiler.gpuEvents.size() + profiler.frameEvents.size();
+	char name[32];
+
+	profiler.on = false;
+	profileCollectGpu(true);
+	if (!file)
+	{
+		std::cout << "Could not write profile " << profiler.path << std::endl;
+		return;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	profileWriteThreadName(file, PROFILE_TID_FRAMES, "Frames", first);
+	for (size_t i = 0; i < profiler.frameEvents.size(); i++)
+		profileWriteEvent(file, profiler.frameEvents[i], PROFILE_TID_FRAMES, first);
+	profileWriteThreadName(file, PROFILE_TID_GPU, "GPU", first);
+	for (size_t i = 0; i < profiler.gpuEvents.size(); i++)
+		profileWriteEvent(file, profiler.gpuEvents[i], PROFILE_TID_GPU, first);
+
+	std::lock_guard<std::mutex> lock(profiler.mutex);
+	for (size_t t = 0; t < profiler.threads.size(); t++)
+	{
+		ProfileThread &thread = *profiler.threads[t];
+		if (thread.name) profileWriteThreadName(file, thread.tid, thread.name, first);
+		else
+		{
+			sprintf(name, "thread %d", thread.tid);
+			profileWriteThreadName(file, thread.tid, name, first);
+		}
+		for (size_t i = 0; i < thread.events.size(); i++) profileWriteEvent(file, thread.events[i], thread.tid, first);
+		numEvents += thread.events.size();
+		std::vector<ProfileEvent>().swap(thread.events);
+	}
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	std::cout << "Profiled " << profiler.frames << " frames (" << numEvents << " zones) to "
+		<< profiler.path << std::endl;
+	std::vector<ProfileEvent>().swap(profiler.gpuEvents);
+	std::vector<ProfileEvent>().swap(profiler.frameEvents);
+}
+
+// Routine to start profiling if the command line holds -profile file frames,
+// removing those arguments.
+inline void profileTraceInit(int *argc, char **argv)
+{
+	profiler.start = std::chrono::high_resolution_clock::now();
+	profileThreadName("main");
+	for (int i = 1; i + 2 < *argc; i++)
+	{
+		if (strcmp(argv[i], "-profile")) continue;
+		profiler.path = argv[i + 1];
+		profiler.framesLeft = atoi(argv[i + 2]);
+		for (int j = i; j + 3 <= *argc; j++) argv[j] = argv[j + 3];
+		*argc -= 3;
+		profiler.on = profiler.framesLeft > 0;
+		break;
+	}
+}
+
+// Routine to end a frame: records it as a zone on the track "Frames" and reads the
+// GPU zones which are ready.
+inline void profileTraceFrameEnd(void)
+{
+	if (!profiler.on.load(std::memory_order_relaxed)) return;
+
+	long long now = profileNow();
+	ProfileEvent event = { "frame", profiler.frameStart, now - profiler.frameStart };
+	profiler.frameEvents.push_back(event);
+	profiler.frameStart = now;
+	profileCollectGpu(false);
+	profiler.frames++;
+	if (--profiler.framesLeft == 0) profileFinish();
+}
+
+#define PROFILE_TIME_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name);
+#define PROFILE_TIME_GPU_ZONE(name) GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(name);
+#define PROFILE_TIME_PHASES ProfilePhases profilePhases;
+#define PROFILE_TIME_PHASE(name) profilePhases.next(name);
+#define PROFILE_THREAD_NAME(name) profileThreadName(name)
+
+#else
+
+#define PROFILE_TIME_ZONE(name)
+#define PROFILE_TIME_GPU_ZONE(name)
+#define PROFILE_TIME_PHASES
+#define PROFILE_TIME_PHASE(name)
+#define PROFILE_THREAD_NAME(name)
+
+#endif
+
+#ifdef ENABLE_MEMORY_STATS
+
+#include "memoryStats.h"
+
+#define PROFILE_MEMORY_ZONE(name) MemoryZone PROFILE_CONCAT(memoryZone, __LINE__)(name);
+#define PROFILE_MEMORY_PHASES MemoryPhases memoryPhases;
+#define PROFILE_MEMORY_PHASE(name) memoryPhases.next(name);
+
+#else
+
+#define PROFILE_MEMORY_ZONE(name)
+#define PROFILE_MEMORY_PHASES
+#define PROFILE_MEMORY_PHASE(name)
+
+#endif
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#include "startupTimer.h"
+
+// The annotations, each a timing zone and an allocation zone, either of which
+// may be compiled out.
+#define PROFILE_ZONE(name) PROFILE_TIME_ZONE(name) PROFILE_MEMORY_ZONE(name)
+#define PROFILE_GPU_ZONE(name) PROFILE_TIME_GPU_ZONE(name) PROFILE_MEMORY_ZONE(name)
+#define PROFILE_PHASES PROFILE_TIME_PHASES PROFILE_MEMORY_PHASES
+#define PROFILE_PHASE(name) PROFILE_TIME_PHASE(name) PROFILE_MEMORY_PHASE(name)
+
+// Routine to start profiling, allocation and startup reports as the command line asks.
+inline void profileInit(int *argc, char **argv)
+{
+	startupInit(argc, argv);
+#ifdef ENABLE_PROFILER
+	profileTraceInit(argc, argv);
+#endif
+#ifdef ENABLE_MEMORY_STATS
+	memoryInit(argc, argv);
+#endif
+}
+
+// Routine to end a frame for the profiler, allocation accounting and startup timer.
+inline void profileFrameEnd(void)
+{
+	startupFrameEnd();
+#ifdef ENABLE_PROFILER
+	profileTraceFrameEnd();
+#endif
+#ifdef ENABLE_MEMORY_STATS
+	memoryFrameEnd();
+#endif
+}
+
+#endif
@@ -0,0 +1,182 @@
+////////////////////////////////////////////////////////////////////////////////////
+// programCache.h
+//
+// On-disk cache of linked shader programs, so that a warm start loads the
+// driver's binary with glProgramBinary() instead of compiling and linking.
+//
+//   program = programCacheBuild(vertexShaderSource, fragmentShaderSource);
+//   program = programCacheBuild(vertexShaderSource, geometryShaderSource, fragmentShaderSource);
+//
+// The key is a 64-bit FNV-1a hash of the sources together with GL_VENDOR,
+// GL_RENDERER, GL_VERSION and GL_SHADING_LANGUAGE_VERSION, a binary being valid
+// only for the driver that made it. On a miss the program is compiled and linked
+// with GL_PROGRAM_BINARY_RETRIEVABLE_HINT, then its binary is written to
+// programCache_<key>.bin in the working directory; on a hit the binary is loaded,
+// and should the driver reject it nevertheless, the program is compiled after all
+// and the file rewritten. Each build prints whether it hit and how long it took.
+// Deleting the files gives a cold start again.
+//
+// Compilation and link errors print the info log and exit, as the demos do.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+#include <GL/glew.h>
+
+// Routine to hash n bytes into h, FNV-1a.
+inline unsigned long long programCacheHash(unsigned long long h, const void *data, size_t n)
+{
+	const unsigned char *p = (const unsigned char *)data;
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= p[i];
+		h *= 0x100000001B3ull;
+	}
+	return h;
+}
+
+// Routine to hash a string and its terminating zero, so that strings cannot run together.
+inline unsigned long long programCacheHashString(unsigned long long h, const char *s)
+{
+	return programCacheHash(h, s ? s : "", strlen(s ? s : "") + 1);
+}
+
+// Routine to compile a shader, exiting with the info log on failure.
+inline unsigned int programCacheCompile(unsigned int type, const char *source)
+{
+	int status;
+	char log[1024];
+	unsigned int shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (!status)
+	{
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "Shader compilation failed:" << std::endl << log << std::endl;
+		exit(1);
+	}
+	return shader;
+}
+
+// Routine to load the binary in file name into program; false if there is none
+// or the driver rejects it.
+inline bool programCacheLoad(unsigned int program, const char *name)
+{
+	FILE *file = fopen(name, "rb");
+	if (!file) return false;
+	unsigned int header[2]; // Binary format and length.
+	std::vector<char> binary;
+	bool read = fread(header, sizeof(header), 1, file) == 1;
+	if (read)
+	{
+		// The length must be what follows the header, so that a corrupt or foreign
+		// file is a miss rather than a huge allocation.
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file) - (long)sizeof(header);
+		fseek(file, sizeof(header), SEEK_SET);
+		read = header[1] && size >= 0 && (unsigned long)size == header[1];
+	}
+	if (read)
+	{
+		binary.resize(header[1]);
+		read = fread(binary.data(), 1, binary.size(), file) == binary.size();
+	}
+	fclose(file);
+	if (!read) return false;
+
+	int status;
+	glProgramBinary(program, header[0], binary.data(), (int)binary.size());
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	return status != 0;
+}
+
+// Routine to write the binary of the linked program to file name.
+inline void programCacheStore(unsigned int program, const char *name)
+{
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+	std::vector<char> binary(length);
+	unsigned int header[2];
+	glGetProgramBinary(program, length, NULL, &header[0], binary.data());
+	header[1] = (unsigned int)length;
+
+	FILE *file = fopen(name, "wb");
+	if (!file) return;
+	fwrite(header, sizeof(header), 1, file);
+	fwrite(binary.data(), 1, binary.size(), file);
+	fclose(file);
+}
+
+// Routine to make the program of the shaders, from the cache if possible. The
+// geometry shader may be NULL.
+inline unsigned int programCacheBuild(const char *vertexSource, const char *geometrySource, const char *fragmentSource)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	unsigned long long key = 0xCBF29CE484222325ull;
+	const unsigned int strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+	for (unsigned int s : strings) key = programCacheHashString(key, (const char *)glGetString(s));
+	key = programCacheHashString(key, vertexSource);
+	if (geometrySource) key = programCacheHashString(key, geometrySource); // Keys of two-shader programs unchanged.
+	key = programCacheHashString(key, fragmentSource);
+	char name[64];
+	sprintf(name, "programCache_%016llx.bin", key);
+
+	int numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	unsigned int program = glCreateProgram();
+	bool hit = numFormats > 0 && programCacheLoad(program, name);
+	if (!hit)
+	{
+		int status;
+		char log[1024];
+		unsigned int vertexShader = programCacheCompile(GL_VERTEX_SHADER, vertexSource);
+		unsigned int geometryShader = geometrySource ? programCacheCompile(GL_GEOMETRY_SHADER, geometrySource) : 0;
+		unsigned int fragmentShader = programCacheCompile(GL_FRAGMENT_SHADER, fragmentSource);
+		glAttachShader(program, vertexShader);
+		if (geometryShader) glAttachShader(program, geometryShader);
+		glAttachShader(program, fragmentShader);
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(program);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (!status)
+		{
+			glGetProgramInfoLog(program, sizeof(log), NULL, log);
+			std::cout << "Program link failed:" << std::endl << log << std::endl;
+			exit(1);
+		}
+		glDetachShader(program, vertexShader);
+		glDetachShader(program, fragmentShader);
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		if (geometryShader)
+		{
+			glDetachShader(program, geometryShader);
+			glDeleteShader(geometryShader);
+		}
+		if (numFormats > 0) programCacheStore(program, name);
+	}
+
+	std::cout << "Program " << name << ": " << (hit ? "loaded binary" : numFormats ? "compiled, binary stored" : "compiled, no binary formats")
+		<< " in " << std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count()
+		<< " ms" << std::endl;
+	return program;
+}
+
+// Routine to make the program of a vertex and a fragment shader, from the cache if possible.
+inline unsigned int programCacheBuild(const char *vertexSource, const char *fragmentSource)
+{
+	return programCacheBuild(vertexSource, NULL, fragmentSource);
+}
+
+#endif
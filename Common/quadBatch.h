@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////////
+// quadBatch.h
+//
+// A batch renderer for axis-aligned 2D quads, e.g. the squares drawn with
+// glBegin(GL_POLYGON) in square.cpp and experimentTwoSquares.cpp.
+//
+// Quads with a color per vertex are written straight into a mapped range of a
+// streaming vertex buffer (12 bytes a vertex: x, y and RGBA8). When the batch is
+// full, or on flush(), the range is unmapped and drawn with one glDrawElements()
+// call against a static index buffer; quads are drawn in the order they were
+// added, so overlapping quads obey the painter's algorithm. Successive batches
+// go one after another through the buffer, which is orphaned when it wraps,
+// so the mapping never waits on the GPU.
+//
+// Drawing uses the fixed-function vertex and color arrays, so the current
+// projection and modelview matrices (e.g. glOrtho(0, 100, 0, 100, -1, 1)) apply.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUAD_BATCH_H
+#define QUAD_BATCH_H
+
+#include <vector>
+
+#include <GL/glew.h>
+
+// Vertex of the batch.
+struct QuadVertex
+{
+	float x, y;
+	unsigned char color[4];
+};
+
+class QuadBatch
+{
+public:
+	QuadBatch(void) : numQuads(0), numDraws(0), vertexBuffer(0), indexBuffer(0), mapped(NULL),
+		batchQuads(0), ringQuads(0), offset(0), count(0) {}
+
+	// Routine to create the buffers: up to batchSize quads a draw, ringBatches batches
+	// in the streaming buffer before it is orphaned. Needs a current GL context.
+	void init(int batchSize = 65536, int ringBatches = 4)
+	{
+		std::vector<unsigned int> indices(6 * batchSize);
+		for (int i = 0; i < batchSize; i++)
+		{
+			unsigned int quad[] = { 0, 1, 2, 0, 2, 3 };
+			for (int j = 0; j < 6; j++) indices[6 * i + j] = 4 * i + quad[j];
+		}
+
+		batchQuads = batchSize;
+		ringQuads = batchSize * ringBatches;
+
+		glGenBuffers(1, &indexBuffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		glGenBuffers(1, &vertexBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, ringQuads * 4 * sizeof(QuadVertex), NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Routine to add the quad [x0, x1] x [y0, y1], its vertices counter-clockwise from
+	// (x0, y0) colored colors[0..3] (RGBA).
+	void addQuad(float x0, float y0, float x1, float y1, const unsigned char colors[4][4])
+	{
+		if (!mapped) map();
+
+		QuadVertex *v = mapped + 4 * count;
+		v[0].x = x0; v[0].y = y0;
+		v[1].x = x1; v[1].y = y0;
+		v[2].x = x1; v[2].y = y1;
+		v[3].x = x0; v[3].y = y1;
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++) v[i].color[j] = colors[i][j];
+
+		if (++count == batchQuads) flush();
+	}
+
+	// Routine to add a quad of a single color (components in [0, 1]).
+	void addQuad(float x0, float y0, float x1, float y1, float r, float g, float b)
+	{
+		unsigned char c[4] = { (unsigned char)(r * 255.0 + 0.5), (unsigned char)(g * 255.0 + 0.5),
+			(unsigned char)(b * 255.0 + 0.5), 255 };
+		const unsigned char colors[4][4] = { { c[0], c[1], c[2], c[3] }, { c[0], c[1], c[2], c[3] },
+			{ c[0], c[1], c[2], c[3] }, { c[0], c[1], c[2], c[3] } };
+		addQuad(x0, y0, x1, y1, colors);
+	}
+
+	// Routine to draw the quads added since the last flush.
+	void flush(void)
+	{
+		if (!mapped) return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, count * 4 * sizeof(QuadVertex));
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		mapped = NULL;
+
+		if (count > 0)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+			glEnableClientState(GL_VERTEX_ARRAY);
+			glEnableClientState(GL_COLOR_ARRAY);
+			glVertexPointer(2, GL_FLOAT, sizeof(QuadVertex), (void *)0);
+			glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(QuadVertex), (void *)(2 * sizeof(float)));
+			glDrawElementsBaseVertex(GL_TRIANGLES, 6 * count, GL_UNSIGNED_INT, (void *)0, 4 * offset);
+			glDisableClientState(GL_COLOR_ARRAY);
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+			numDraws++;
+			numQuads += count;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		offset += count;
+		count = 0;
+	}
+
+	// Routine to reset the per-frame counters.
+	void resetCounters(void) { numQuads = numDraws = 0; }
+
+	long long numQuads; // Quads drawn since resetCounters().
+	int numDraws; // Draw calls since resetCounters().
+
+private:
+	// Routine to map the next batch's range of the streaming buffer, orphaning
+	// the buffer first if the range would run past its end.
+	void map(void)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		if (offset + batchQuads > ringQuads)
+		{
+			glBufferData(GL_ARRAY_BUFFER, ringQuads * 4 * sizeof(QuadVertex), NULL, GL_STREAM_DRAW);
+			offset = 0;
+		}
+		mapped = (QuadVertex *)glMapBufferRange(GL_ARRAY_BUFFER, offset * 4 * sizeof(QuadVertex),
+			batchQuads * 4 * sizeof(QuadVertex),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	unsigned int vertexBuffer, indexBuffer;
+	QuadVertex *mapped; // Mapped range of the current batch, NULL if none.
+	int batchQuads; // Quads a batch.
+	int ringQuads; // Quads in the streaming buffer.
+	int offset; // Quad offset of the current batch in the streaming buffer.
+	int count; // Quads in the current batch.
+};
+
+#endif
@@ -0,0 +1,295 @@
+////////////////////////////////////////////////////////////////////////////////////
+// qualityGovernor.h
+//
+// A governor that holds a demo's frame time to a budget by lowering and raising
+// its tessellation levels and, optionally, its render resolution.
+//
+// A demo names the integers setting its tessellation, at their full values, in
+// its initialization routine:
+//
+//   governorKnob("p", &p, 3);     // Never below 3.
+//
+// and calls governorInit(&argc, argv) after glutInit(), governorBegin() at the top
+// of its drawing routine, before postAABegin(), and governorEnd() after
+// postAAEnd() but before captureFrame() and its glutSwapBuffers() or glFlush().
+// Run as
+//
+//   demo -budget 8                        (milliseconds a frame)
+//   demo -budget 8 -budgetscale 0.5       (also down to half the resolution)
+//
+// the demo redraws continuously and the governor measures each frame's cost as
+// the larger of its CPU time, from governorBegin() to governorEnd(), and its GPU
+// time, between GL_TIMESTAMP queries at the same two points read four frames
+// later, so a swap waiting for the vertical retrace is not counted. The governor
+// acts on the median cost of the last GOVERNOR_HOLD frames at a level, frames
+// still in flight at the old level being thrown away, so a one-off spike, such as
+// a frame building a mesh at a new tessellation, does not count:
+//
+//   over the budget:        detail, the fraction of their full values the knobs
+//                           are set to, drops by the square root of budget over
+//                           cost (between 0.5 and 0.9), tessellation cost growing
+//                           roughly with its square; at the knobs' minimums the
+//                           resolution drops a step, through postAAScale();
+//   under GOVERNOR_HEADROOM of the budget: the resolution, then detail, rises a
+//                           small step;
+//   in between:             nothing changes.
+//
+// The dead band between the two thresholds is the hysteresis. A raise that takes
+// the frame over the budget is undone, back to the level known to fit, and the
+// frames to wait before the next raise double, up to GOVERNOR_MAX_HOLD, so a demo
+// just under the budget at one level and over it at the next settles on the
+// lower one, trying the higher ever more rarely, instead of alternating; raises
+// that hold halve the wait again. Every adjustment is written to the C++ window:
+//
+//   Governor: 11.42 ms over 8.00 ms budget, detail 0.74: p 44, q 30
+//
+// A knob changed by the demo itself, e.g. from the keyboard, is taken as a new
+// full value at the current detail. Without -budget the calls cost one test of a
+// flag and the knobs keep their values.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "postAA.h"
+
+#define GOVERNOR_QUERIES 4 // Frames of timestamp queries in flight.
+#define GOVERNOR_HOLD 31 // Frames measured at a level before it is changed, odd for the median.
+#define GOVERNOR_MAX_HOLD 480 // Longest wait before a raise.
+#define GOVERNOR_HEADROOM 0.6 // Fraction of the budget below which quality rises.
+#define GOVERNOR_RAISE 1.15 // Factor by which detail rises.
+#define GOVERNOR_SCALE_STEP 0.125 // Step of the resolution scale.
+
+// An integer setting tessellation.
+struct GovernorKnob
+{
+	const char *name;
+	int *value;
+	int minimum;
+	int full; // Value at detail 1.
+	int set; // Value last set, to notice the demo changing it.
+};
+
+// Governor state.
+struct GovernorState
+{
+	bool on; // -budget given?
+	double budget; // Milliseconds a frame.
+	float minScale, scale; // Lowest and current resolution scale.
+	double detail; // Fraction of their full values the knobs are set to.
+	std::vector<GovernorKnob> knobs;
+	unsigned int queries[GOVERNOR_QUERIES][2]; // Timestamps at governorBegin() and governorEnd().
+	double cpuMillis[GOVERNOR_QUERIES]; // CPU time of the frames in flight.
+	std::chrono::high_resolution_clock::time_point start; // Of the current frame.
+	long long frame; // Frames begun.
+	long long changeFrame; // First frame at the current level.
+	double costs[GOVERNOR_HOLD]; // Of the last frames measured, round robin.
+	double cost; // Their median.
+	int samples; // Frames measured at the current level.
+	int raiseHold; // Frames to measure before a raise.
+	bool lastRaised; // Was the last adjustment a raise?
+	double raisedDetail; // Detail and resolution scale before it.
+	float raisedScale;
+	bool atFloor; // Reported being at the lowest quality?
+};
+
+static GovernorState governor;
+
+// Routine to set the knobs to detail times their full values.
+inline void governorApply(void)
+{
+	for (size_t i = 0; i < governor.knobs.size(); i++)
+	{
+		GovernorKnob &knob = governor.knobs[i];
+		int value = (int)(knob.full * governor.detail + 0.5);
+		*knob.value = knob.set = value > knob.minimum ? value : knob.minimum;
+	}
+}
+
+// Routine to write an adjustment to the C++ window and start a new level.
+inline void governorLog(const char *direction)
+{
+	char line[256];
+	int length = sprintf(line, "Governor: %.2f ms %s %.2f ms budget, detail %.2f", governor.cost, direction,
+		governor.budget, governor.detail);
+	for (size_t i = 0; i < governor.knobs.size() && length < 200; i++)
+		length += sprintf(line + length, "%s %s %d", i ? "," : ":", governor.knobs[i].name, *governor.knobs[i].value);
+	if (governor.minScale < 1.0)
+		sprintf(line + length, ", resolution %.3f", governor.scale);
+	std::cout << line << std::endl;
+
+	governor.changeFrame = governor.frame;
+	governor.samples = 0;
+}
+
+// Routine to lower the quality a step.
+inline void governorLower(void)
+{
+	double floor = 0.0; // Detail at which every knob is at its minimum.
+	for (size_t i = 0; i < governor.knobs.size(); i++)
+	{
+		const GovernorKnob &knob = governor.knobs[i];
+		double knobFloor = knob.full > 0 ? (double)knob.minimum / knob.full : 1.0;
+		if (knobFloor > floor) floor = knobFloor;
+	}
+
+	if (governor.lastRaised) // Undo it.
+	{
+		governor.detail = governor.raisedDetail;
+		governor.scale = governor.raisedScale;
+		governorApply();
+		if (governor.minScale < 1.0) postAAScale(governor.scale);
+		governor.raiseHold = governor.raiseHold * 2 < GOVERNOR_MAX_HOLD ? governor.raiseHold * 2 : GOVERNOR_MAX_HOLD;
+	}
+	else if (governor.detail > floor + 1.0e-6)
+	{
+		double factor = sqrt(governor.budget / governor.cost);
+		factor = factor < 0.5 ? 0.5 : (factor > 0.9 ? 0.9 : factor);
+		governor.detail = governor.detail * factor > floor ? governor.detail * factor : floor;
+		governorApply();
+	}
+	else if (governor.scale > governor.minScale + 1.0e-6)
+	{
+		governor.scale -= GOVERNOR_SCALE_STEP;
+		if (governor.scale < governor.minScale) governor.scale = governor.minScale;
+		postAAScale(governor.scale);
+	}
+	else
+	{
+		if (!governor.atFloor)
+			std::cout << "Governor: over budget at the lowest quality" << std::endl;
+		governor.atFloor = true;
+		governor.changeFrame = governor.frame;
+		governor.samples = 0;
+		return;
+	}
+	governor.lastRaised = false;
+	governorLog("over");
+}
+
+// Routine to raise the quality a step.
+inline void governorRaise(void)
+{
+	governor.raisedDetail = governor.detail;
+	governor.raisedScale = governor.scale;
+	if (governor.scale < 1.0 - 1.0e-6)
+	{
+		governor.scale += GOVERNOR_SCALE_STEP;
+		if (governor.scale > 1.0) governor.scale = 1.0;
+		postAAScale(governor.scale);
+	}
+	else if (governor.detail < 1.0 - 1.0e-6)
+	{
+		governor.detail = governor.detail * GOVERNOR_RAISE < 1.0 ? governor.detail * GOVERNOR_RAISE : 1.0;
+		governorApply();
+	}
+	else return;
+
+	if (governor.lastRaised)
+		governor.raiseHold = governor.raiseHold / 2 > GOVERNOR_HOLD ? governor.raiseHold / 2 : GOVERNOR_HOLD;
+	governor.lastRaised = true;
+	governor.atFloor = false;
+	governorLog("under");
+}
+
+// Routine to add the cost of a frame at the current level to the window and
+// adjust the quality if its median calls for it.
+inline void governorMeasure(double millis)
+{
+	governor.costs[governor.samples % GOVERNOR_HOLD] = millis;
+	if (++governor.samples < GOVERNOR_HOLD) return;
+
+	double sorted[GOVERNOR_HOLD];
+	memcpy(sorted, governor.costs, sizeof(sorted));
+	std::nth_element(sorted, sorted + GOVERNOR_HOLD / 2, sorted + GOVERNOR_HOLD);
+	governor.cost = sorted[GOVERNOR_HOLD / 2];
+	if (governor.cost > governor.budget) governorLower();
+	else if (governor.cost < GOVERNOR_HEADROOM * governor.budget && governor.samples >= governor.raiseHold) governorRaise();
+}
+
+// Routine to start a frame: collect the times of the frame in the oldest slot and
+// note any knob the demo changed.
+inline void governorBegin(void)
+{
+	if (!governor.on) return;
+	int slot = (int)(governor.frame % GOVERNOR_QUERIES);
+	if (!governor.frame) glGenQueries(2 * GOVERNOR_QUERIES, &governor.queries[0][0]);
+	else if (governor.frame >= GOVERNOR_QUERIES) // Issued GOVERNOR_QUERIES frames ago.
+	{
+		GLuint64 t[2];
+		for (int k = 0; k < 2; k++) glGetQueryObjectui64v(governor.queries[slot][k], GL_QUERY_RESULT, &t[k]);
+		double gpuMillis = (t[1] - t[0]) * 1.0e-6;
+		if (governor.frame - GOVERNOR_QUERIES >= governor.changeFrame)
+			governorMeasure(gpuMillis > governor.cpuMillis[slot] ? gpuMillis : governor.cpuMillis[slot]);
+	}
+
+	for (size_t i = 0; i < governor.knobs.size(); i++)
+	{
+		GovernorKnob &knob = governor.knobs[i];
+		if (*knob.value == knob.set) continue;
+		knob.full = (int)(*knob.value / governor.detail + 0.5);
+		knob.set = *knob.value;
+	}
+
+	governor.frame++;
+	governor.start = std::chrono::high_resolution_clock::now();
+	glQueryCounter(governor.queries[slot][0], GL_TIMESTAMP);
+}
+
+// Routine to end a frame's measurement and ask for the next frame.
+inline void governorEnd(void)
+{
+	if (!governor.on) return;
+	int slot = (int)((governor.frame - 1) % GOVERNOR_QUERIES);
+	glQueryCounter(governor.queries[slot][1], GL_TIMESTAMP);
+	governor.cpuMillis[slot] = std::chrono::duration<double, std::milli>(
+		std::chrono::high_resolution_clock::now() - governor.start).count();
+	glutPostRedisplay();
+}
+
+// Routine to put an integer under the governor's control, at its full value now,
+// never set below minimum.
+inline void governorKnob(const char *name, int *value, int minimum)
+{
+	GovernorKnob knob = { name, value, minimum, *value, *value };
+	governor.knobs.push_back(knob);
+}
+
+// Routine to turn the governor on if the command line holds -budget ms, and allow
+// the resolution to drop if it holds -budgetscale s, removing them.
+inline void governorInit(int *argc, char **argv)
+{
+	governor.detail = 1.0;
+	governor.scale = governor.minScale = 1.0;
+	governor.raiseHold = GOVERNOR_HOLD;
+	for (int i = 1; i + 1 < *argc; i++)
+	{
+		if (!strcmp(argv[i], "-budget")) governor.budget = atof(argv[i + 1]);
+		else if (!strcmp(argv[i], "-budgetscale")) governor.minScale = (float)atof(argv[i + 1]);
+		else continue;
+		for (int j = i; j + 2 <= *argc; j++) argv[j] = argv[j + 2];
+		*argc -= 2;
+		i--;
+	}
+	governor.on = governor.budget > 0.0;
+	if (governor.minScale < GOVERNOR_SCALE_STEP || governor.minScale > 1.0 || !governor.on) governor.minScale = 1.0;
+	if (governor.minScale < 1.0 && !postAAScale(1.0))
+	{
+		std::cout << "Governor: msaa targets cannot be scaled, resolution fixed" << std::endl;
+		governor.minScale = 1.0;
+	}
+}
+
+#endif
@@ -0,0 +1,198 @@
+////////////////////////////////////////////////////////////////////////////////////
+// renderQueue.h
+//
+// A render queue for the fixed-function demos. Draws are submitted with the state
+// they need (pass, depth test, polygon mode, lighting, material) and a depth, and
+// are packed into a 64-bit sort key:
+//
+//   bits 63-60  pass
+//   bits 59-57  depth test, polygon mode line, lighting
+//   bits 56-41  material
+//   bits 40-17  depth, quantized to 24 bits (front to back)
+//   bits 16-0   submission sequence (tie break)
+//
+// Passes marked as ordered (painter's algorithm, e.g. a white disc drawn over a
+// red one without depth testing) instead put the sequence right below the pass,
+// so that their draws keep the submission order.
+//
+// The key holds only the low bits of the sequence, so flush() breaks ties between
+// equal keys by the full submission index, and more than 2^17 draws in a pass still
+// keep their order where state and depth are equal.
+//
+// flush() sorts the keys, then issues the draws changing GL state only when the
+// next draw needs a different one. The number of state changes the same draws
+// would have caused in submission order and sorted order are both counted.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+// Draw routine: draws one object given its submitted arguments.
+typedef void (*DrawFunc)(const float *args);
+
+#define DRAW_ARGS 8 // Maximum number of arguments of a draw.
+#define MAX_PASSES 16
+
+// State a draw is to be issued with.
+struct DrawState
+{
+	int pass; // 0 to MAX_PASSES - 1, passes are issued in increasing order.
+	int depthTest; // Depth testing enabled?
+	int wire; // Polygon mode GL_LINE rather than GL_FILL?
+	int lighting; // Lighting enabled?
+	int material; // Index of the material in the queue's material table.
+};
+
+// Material: a color, used as ambient and diffuse reflectance when lighting is on.
+struct Material
+{
+	float color[4];
+};
+
+// State change counters.
+struct StateChanges
+{
+	int depthTest, wire, lighting, material;
+
+	int total(void) const { return depthTest + wire + lighting + material; }
+};
+
+class RenderQueue
+{
+public:
+	RenderQueue(void) : sortEnabled(true), numDraws(0)
+	{
+		for (int i = 0; i < MAX_PASSES; i++) ordered[i] = false;
+		unsorted = sorted = StateChanges();
+	}
+
+	// Routine to add a material, returning its index.
+	int addMaterial(float r, float g, float b)
+	{
+		Material m = { { r, g, b, 1.0 } };
+		materials.push_back(m);
+		return (int)materials.size() - 1;
+	}
+
+	// Routine to mark a pass as keeping submission order.
+	void setPassOrdered(int pass, bool isOrdered) { ordered[pass] = isOrdered; }
+
+	// Routine to submit a draw. depth is in [0, 1], 0 being nearest the viewer.
+	void submit(const DrawState &state, float depth, DrawFunc draw, const float *args, int numArgs)
+	{
+		Item item;
+		item.key = makeKey(state, depth, (unsigned int)items.size());
+		item.state = state;
+		item.draw = draw;
+		for (int i = 0; i < numArgs && i < DRAW_ARGS; i++) item.args[i] = args[i];
+		items.push_back(item);
+	}
+
+	// Routine to issue all submitted draws, sorted if sortEnabled, and clear the queue.
+	// Counters of both the submission and sorted order are updated.
+	void flush(void)
+	{
+		order.resize(items.size());
+		for (size_t i = 0; i < items.size(); i++) order[i] = (unsigned int)i;
+		unsorted = countChanges();
+
+		std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+		{
+			return items[a].key < items[b].key || (items[a].key == items[b].key && a < b);
+		});
+		sorted = countChanges();
+
+		if (!sortEnabled)
+			for (size_t i = 0; i < items.size(); i++) order[i] = (unsigned int)i;
+
+		bool first = true;
+		DrawState current = DrawState();
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			const Item &item = items[order[i]];
+			apply(item.state, current, first);
+			current = item.state;
+			first = false;
+			item.draw(item.args);
+		}
+
+		numDraws = (int)items.size();
+		items.clear();
+	}
+
+	bool sortEnabled; // Issue in sorted rather than submission order?
+	int numDraws; // Number of draws issued by the last flush.
+	StateChanges unsorted; // State changes of the last flush in submission order.
+	StateChanges sorted; // State changes of the last flush in sorted order.
+
+private:
+	struct Item
+	{
+		unsigned long long key;
+		DrawState state;
+		DrawFunc draw;
+		float args[DRAW_ARGS];
+	};
+
+	unsigned long long makeKey(const DrawState &s, float depth, unsigned int sequence) const
+	{
+		unsigned long long pass = (unsigned long long)(s.pass & 0xF) << 60;
+		unsigned long long flags = (unsigned long long)((s.depthTest ? 4 : 0) | (s.wire ? 2 : 0) | (s.lighting ? 1 : 0));
+		unsigned long long material = (unsigned long long)(s.material & 0xFFFF);
+		if (ordered[s.pass])
+			return pass | ((unsigned long long)(sequence & 0xFFFFFFF) << 32) | (flags << 16) | material;
+
+		if (depth < 0.0) depth = 0.0;
+		if (depth > 1.0) depth = 1.0;
+		unsigned long long z = (unsigned long long)(depth * 0xFFFFFF);
+		return pass | (flags << 57) | (material << 41) | (z << 17) | (sequence & 0x1FFFF);
+	}
+
+	// Routine to count the state changes of issuing the draws in the current order.
+	StateChanges countChanges(void) const
+	{
+		StateChanges c = StateChanges();
+		for (size_t i = 1; i < order.size(); i++)
+		{
+			const DrawState &a = items[order[i - 1]].state, &b = items[order[i]].state;
+			if (a.depthTest != b.depthTest) c.depthTest++;
+			if (a.wire != b.wire) c.wire++;
+			if (a.lighting != b.lighting) c.lighting++;
+			if (a.material != b.material) c.material++;
+		}
+		return c;
+	}
+
+	// Routine to set the GL state of s where it differs from current (or all of it if first).
+	void apply(const DrawState &s, const DrawState &current, bool first) const
+	{
+		if (first || s.depthTest != current.depthTest)
+		{
+			if (s.depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+		}
+		if (first || s.wire != current.wire)
+			glPolygonMode(GL_FRONT_AND_BACK, s.wire ? GL_LINE : GL_FILL);
+		if (first || s.lighting != current.lighting)
+		{
+			if (s.lighting) glEnable(GL_LIGHTING); else glDisable(GL_LIGHTING);
+		}
+		if (first || s.material != current.material || s.lighting != current.lighting)
+		{
+			const float *color = materials[s.material].color;
+			if (s.lighting) glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, color);
+			else glColor4fv(color);
+		}
+	}
+
+	std::vector<Item> items;
+	std::vector<unsigned int> order;
+	std::vector<Material> materials;
+	bool ordered[MAX_PASSES];
+};
+
+#endif
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////////
+// sharedPrimitives.h
+//
+// The GLUT primitives as compact meshes (vertexFormat.h) built once per process
+// and drawn by every window sharing its context:
+//
+//   sharedSolidSphere(1.5, 200, 200);     // For glutSolidSphere(1.5, 200, 200).
+//   sharedWireCone(2.0, 4.0, 20, 20);     // For glutWireCone(2.0, 4.0, 20, 20).
+//
+// with sharedSolidCube(), sharedWireCube(), sharedWireSphere(), sharedSolidCone(),
+// sharedSolidTorus() and sharedWireTorus() likewise. GLUT sends a primitive's
+// vertices anew at every call; here each distinct primitive is a mesh of unit
+// size, keyed by kind, solid or wire, and tessellation (and for a torus the ratio
+// of its tube to its radius, which sets its shape), and the size is a scale of
+// the modelview matrix, the normal matrix keeping the normals right. So a ball
+// drawn at any size in any number of windows is one mesh in GPU memory, and all
+// of them are drawn by the one program of vertexFormat.h.
+//
+// The tessellations are GLUT's: poles and axes along z, stacks from +z down, the
+// solid sphere the mesh of sphereMesh.h, wire spheres a loop per stack between
+// the poles and a line per slice over its vertices, wire cones a loop per stack
+// and a line per slice from base to apex, wire tori a loop per ring and per side,
+// wire cubes the outlines of their faces.
+//
+// Each mesh notes the windows that drew it; sharedPrimitivesRelease(window) drops
+// a window closing and sharedPrimitivesReport() writes what the meshes take
+// against what a copy per window would take.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHARED_PRIMITIVES_H
+#define SHARED_PRIMITIVES_H
+
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "vertexFormat.h"
+#include "sphereMesh.h"
+
+// Kinds of primitive.
+enum SharedKind { SHARED_SPHERE, SHARED_CUBE, SHARED_CONE, SHARED_TORUS };
+
+// A primitive's mesh.
+struct SharedPrimitive
+{
+	int kind;
+	bool solid;
+	int slices, stacks; // Or sides and rings of a torus.
+	float ratio; // Of a torus's tube to its radius.
+	CompactMesh *mesh;
+	std::vector<int> windows; // That drew it and are open.
+};
+
+static std::vector<SharedPrimitive> sharedPrimitives;
+
+// Vertices and indices of a primitive being generated.
+struct SharedGeometry
+{
+	std::vector<float> positions, normals;
+	std::vector<unsigned int> indices;
+
+	// Routine to add a vertex at p with normal n.
+	void vertex(double px, double py, double pz, double nx, double ny, double nz)
+	{
+		positions.push_back((float)px); positions.push_back((float)py); positions.push_back((float)pz);
+		normals.push_back((float)nx); normals.push_back((float)ny); normals.push_back((float)nz);
+	}
+
+	// Routine to add the quad a, b, c, d, counter-clockwise from outside, as two
+	// triangles, leaving out one collapsed to a line at a pole or apex.
+	void quad(unsigned int a, unsigned int b, unsigned int c, unsigned int d, bool firstAt = true, bool secondAt = true)
+	{
+		if (firstAt) indices.insert(indices.end(), { a, b, c });
+		if (secondAt) indices.insert(indices.end(), { a, c, d });
+	}
+
+	// Routine to add the line a, b.
+	void line(unsigned int a, unsigned int b)
+	{
+		indices.push_back(a);
+		indices.push_back(b);
+	}
+};
+
+// Routine to generate the sphere of radius 1, that of sphereMesh.h.
+inline void sharedMakeSphere(int slices, int stacks, bool solid, SharedGeometry &g)
+{
+	sphereMeshVertices(slices, stacks, g.positions);
+	g.normals = g.positions;
+	if (solid)
+	{
+		sphereMeshTriangles(slices, stacks, g.indices);
+		return;
+	}
+	for (int i = 0; i < stacks; i++)
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = i * slices + j, b = i * slices + (j + 1) % slices, c = a + slices;
+			if (i > 0) g.line(a, b); // A stack's loop, not at the north pole.
+			g.line(a, c);
+		}
+}
+
+// Routine to generate the cone of base radius 1 and height 1 on the xy-plane.
+inline void sharedMakeCone(int slices, int stacks, bool solid, SharedGeometry &g)
+{
+	double slant = M_PI / 4.0; // Of the side to the axis, the height being the radius.
+	for (int i = 0; i <= stacks; i++)
+		for (int j = 0; j < slices; j++)
+		{
+			double theta = 2.0 * M_PI * j / slices, r = (double)(stacks - i) / stacks;
+			g.vertex(r * cos(theta), r * sin(theta), (double)i / stacks,
+				cos(theta) * cos(slant), sin(theta) * cos(slant), sin(slant));
+		}
+	for (int i = 0; i < stacks; i++)
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = i * slices + j, b = i * slices + (j + 1) % slices;
+			unsigned int c = a + slices, d = b + slices;
+			if (solid) g.quad(a, b, d, c, true, i < stacks - 1);
+			else
+			{
+				g.line(a, b);
+				if (i == 0) g.line(a, stacks * slices + j); // Base to apex.
+			}
+		}
+	if (!solid) return;
+
+	// Base, facing down.
+	unsigned int center = (unsigned int)g.positions.size() / 3;
+	g.vertex(0.0, 0.0, 0.0, 0.0, 0.0, -1.0);
+	for (int j = 0; j < slices; j++)
+	{
+		double theta = 2.0 * M_PI * j / slices;
+		g.vertex(cos(theta), sin(theta), 0.0, 0.0, 0.0, -1.0);
+	}
+	for (int j = 0; j < slices; j++)
+		g.indices.insert(g.indices.end(), { center, center + 1 + (j + 1) % slices, center + 1 + j });
+}
+
+// Routine to generate the torus of radius 1 and tube radius ratio about the z-axis.
+inline void sharedMakeTorus(int sides, int rings, float ratio, bool solid, SharedGeometry &g)
+{
+	for (int i = 0; i < rings; i++)
+		for (int j = 0; j < sides; j++)
+		{
+			double phi = 2.0 * M_PI * i / rings, theta = 2.0 * M_PI * j / sides;
+			double r = 1.0 + ratio * cos(theta);
+			g.vertex(r * cos(phi), r * sin(phi), ratio * sin(theta), cos(phi) * cos(theta), sin(phi) * cos(theta), sin(theta));
+		}
+	for (int i = 0; i < rings; i++)
+		for (int j = 0; j < sides; j++)
+		{
+			unsigned int a = i * sides + j, b = i * sides + (j + 1) % sides;
+			unsigned int c = (i + 1) % rings * sides + j, d = (i + 1) % rings * sides + (j + 1) % sides;
+			if (solid) g.quad(a, c, d, b);
+			else
+			{
+				g.line(a, b);
+				g.line(a, c);
+			}
+		}
+}
+
+// Routine to generate the cube of side 1, a face's vertices carrying its normal.
+inline void sharedMakeCube(bool solid, SharedGeometry &g)
+{
+	static const int normals[6][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, -1 } };
+	static const int faces[6][4][3] = {
+		{ { 1, -1, 1 }, { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 } }, { { 1, 1, 1 }, { 1, 1, -1 }, { -1, 1, -1 }, { -1, 1, 1 } },
+		{ { 1, 1, 1 }, { -1, 1, 1 }, { -1, -1, 1 }, { 1, -1, 1 } }, { { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, -1 } },
+		{ { -1, -1, 1 }, { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 } }, { { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 }, { -1, -1, -1 } } };
+	for (int f = 0; f < 6; f++)
+	{
+		unsigned int a = f * 4;
+		for (int k = 0; k < 4; k++)
+			g.vertex(0.5 * faces[f][k][0], 0.5 * faces[f][k][1], 0.5 * faces[f][k][2], normals[f][0], normals[f][1], normals[f][2]);
+		if (solid) g.quad(a, a + 1, a + 2, a + 3);
+		else for (int k = 0; k < 4; k++) g.line(a + k, a + (k + 1) % 4);
+	}
+}
+
+// Routine to return the mesh of a primitive, building it on first use, and note
+// the current window draws it.
+inline CompactMesh &sharedPrimitive(int kind, bool solid, int slices, int stacks, float ratio)
+{
+	static const char *kindNames[] = { "sphere", "cube", "cone", "torus" };
+	size_t k = 0;
+	while (k < sharedPrimitives.size() && !(sharedPrimitives[k].kind == kind && sharedPrimitives[k].solid == solid &&
+		sharedPrimitives[k].slices == slices && sharedPrimitives[k].stacks == stacks && sharedPrimitives[k].ratio == ratio)) k++;
+	if (k == sharedPrimitives.size())
+	{
+		SharedGeometry g;
+		if (kind == SHARED_SPHERE) sharedMakeSphere(slices, stacks, solid, g);
+		else if (kind == SHARED_CONE) sharedMakeCone(slices, stacks, solid, g);
+		else if (kind == SHARED_TORUS) sharedMakeTorus(slices, stacks, ratio, solid, g);
+		else sharedMakeCube(solid, g);
+
+		char name[64];
+		if (kind == SHARED_CUBE) sprintf(name, "%s %s", solid ? "solid" : "wire", kindNames[kind]);
+		else sprintf(name, "%s %s %dx%d", solid ? "solid" : "wire", kindNames[kind], slices, stacks);
+		SharedPrimitive primitive = { kind, solid, slices, stacks, ratio, new CompactMesh };
+		primitive.mesh->build(name, g.positions.data(), g.normals.data(), (int)g.positions.size() / 3,
+			g.indices.data(), (int)g.indices.size(), solid ? GL_TRIANGLES : GL_LINES);
+		sharedPrimitives.push_back(primitive);
+	}
+
+	SharedPrimitive &primitive = sharedPrimitives[k];
+	int window = glutGetWindow();
+	if (std::find(primitive.windows.begin(), primitive.windows.end(), window) == primitive.windows.end())
+		primitive.windows.push_back(window);
+	return *primitive.mesh;
+}
+
+// Routine to draw a mesh scaled by x, y and z.
+inline void sharedDraw(CompactMesh &mesh, double x, double y, double z)
+{
+	glPushMatrix();
+	glScaled(x, y, z);
+	mesh.draw();
+	glPopMatrix();
+}
+
+inline void sharedSolidSphere(double radius, int slices, int stacks)
+{
+	sharedDraw(sharedPrimitive(SHARED_SPHERE, true, slices, stacks, 0.0f), radius, radius, radius);
+}
+
+inline void sharedWireSphere(double radius, int slices, int stacks)
+{
+	sharedDraw(sharedPrimitive(SHARED_SPHERE, false, slices, stacks, 0.0f), radius, radius, radius);
+}
+
+inline void sharedSolidCube(double size)
+{
+	sharedDraw(sharedPrimitive(SHARED_CUBE, true, 0, 0, 0.0f), size, size, size);
+}
+
+inline void sharedWireCube(double size)
+{
+	sharedDraw(sharedPrimitive(SHARED_CUBE, false, 0, 0, 0.0f), size, size, size);
+}
+
+inline void sharedSolidCone(double base, double height, int slices, int stacks)
+{
+	sharedDraw(sharedPrimitive(SHARED_CONE, true, slices, stacks, 0.0f), base, base, height);
+}
+
+inline void sharedWireCone(double base, double height, int slices, int stacks)
+{
+	sharedDraw(sharedPrimitive(SHARED_CONE, false, slices, stacks, 0.0f), base, base, height);
+}
+
+inline void sharedSolidTorus(double inner, double outer, int sides, int rings)
+{
+	sharedDraw(sharedPrimitive(SHARED_TORUS, true, sides, rings, (float)(inner / outer)), outer, outer, outer);
+}
+
+inline void sharedWireTorus(double inner, double outer, int sides, int rings)
+{
+	sharedDraw(sharedPrimitive(SHARED_TORUS, false, sides, rings, (float)(inner / outer)), outer, outer, outer);
+}
+
+// Routine to drop a window, e.g. from its close callback.
+inline void sharedPrimitivesRelease(int window)
+{
+	for (size_t k = 0; k < sharedPrimitives.size(); k++)
+	{
+		std::vector<int> &windows = sharedPrimitives[k].windows;
+		windows.erase(std::remove(windows.begin(), windows.end(), window), windows.end());
+	}
+}
+
+// Routine to write the meshes' memory, the windows drawing them and the memory
+// the meshes would take with a copy in each of those windows.
+inline void sharedPrimitivesReport(void)
+{
+	size_t bytes = 0, copiedBytes = 0;
+	std::vector<int> windows;
+	for (size_t k = 0; k < sharedPrimitives.size(); k++)
+	{
+		const SharedPrimitive &primitive = sharedPrimitives[k];
+		bytes += primitive.mesh->compactBytes;
+		copiedBytes += primitive.mesh->compactBytes * primitive.windows.size();
+		for (size_t i = 0; i < primitive.windows.size(); i++)
+			if (std::find(windows.begin(), windows.end(), primitive.windows[i]) == windows.end())
+				windows.push_back(primitive.windows[i]);
+	}
+	char line[200];
+	sprintf(line, "Shared primitives: %d meshes, %.1f KB, 1 program, drawn in %d windows; a copy per window would take %.1f KB",
+		(int)sharedPrimitives.size(), bytes / 1024.0, (int)windows.size(), copiedBytes / 1024.0);
+	std::cout << line << std::endl;
+}
+
+#endif
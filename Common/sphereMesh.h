@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////////
+// sphereMesh.h
+//
+// The sphere of glutSolidSphere(1.0, slices, stacks) as indexed triangles: poles
+// on the z-axis, stacks of latitude from +z down, slices of longitude. Stack i,
+// 0 to stacks, holds vertices i * slices to i * slices + slices - 1, the poles
+// repeated so that every stack has the same layout; each vertex is also its own
+// normal. The triangles are counter-clockwise from outside, none collapsed at a
+// pole.
+//
+// The one generator of the sphere on the CPU: the compact mesh of sphereInBox1.cpp,
+// the picking meshes of picking.h and the shared primitives of sharedPrimitives.h
+// all use it, scaling the vertices as they need.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPHERE_MESH_H
+#define SPHERE_MESH_H
+
+#include <cmath>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Routine to append the vertices of the unit sphere to positions, x, y, z each.
+inline void sphereMeshVertices(int slices, int stacks, std::vector<float> &positions)
+{
+	for (int i = 0; i <= stacks; i++)
+		for (int j = 0; j < slices; j++)
+		{
+			float phi = (float)(M_PI * i / stacks), theta = (float)(2.0 * M_PI * j / slices);
+			positions.push_back(cosf(theta) * sinf(phi));
+			positions.push_back(sinf(theta) * sinf(phi));
+			positions.push_back(cosf(phi));
+		}
+}
+
+// Routine to append the triangles of the sphere's vertices to indices, three each.
+inline void sphereMeshTriangles(int slices, int stacks, std::vector<unsigned int> &indices)
+{
+	for (int i = 0; i < stacks; i++)
+		for (int j = 0; j < slices; j++)
+		{
+			unsigned int a = i * slices + j, b = i * slices + (j + 1) % slices;
+			unsigned int c = a + slices, d = b + slices;
+			if (i > 0) indices.insert(indices.end(), { a, c, b }); // Not at the north pole.
+			if (i < stacks - 1) indices.insert(indices.end(), { b, c, d }); // Not at the south pole.
+		}
+}
+
+#endif
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////////
+// streamBuffer.h
+//
+// A streaming allocator for per-frame vertex data, e.g. the helix line strip of
+// rotatingHelixFPS.cpp rebuilt every frame instead of sent through glBegin()/glEnd().
+//
+// One buffer is created with glBufferStorage() and mapped once, persistently and
+// coherently, so data written through the pointer is visible to the GPU without
+// any unmap, flush or copy by the driver. The buffer is split into segments, three
+// by default, used round-robin one a frame: while the CPU writes segment k the GPU
+// may still be reading k - 1 and k - 2. A fence is inserted when a frame's
+// draws have been issued, and a segment is reused only after the fence of the
+// frame that last used it has signaled; with three segments that wait is normally
+// already satisfied and costs nothing.
+//
+// Usage each frame: beginFrame(), any number of alloc() calls whose memory is filled
+// in and drawn from at the returned offset, then endFrame() after the draws.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+
+class StreamBuffer
+{
+public:
+	StreamBuffer(void) : numWaits(0), numOverflows(0), waitMicros(0.0), frameBytes(0),
+		buffer(0), mapped(NULL), segmentSize(0), segment(0), offset(0) {}
+
+	// Routine to create a buffer of numSegments segments of segmentBytes each. Needs a
+	// current GL 4.4 context (or ARB_buffer_storage).
+	void init(size_t segmentBytes, int numSegments = 3)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		segmentSize = segmentBytes;
+		fences.assign(numSegments, (GLsync)0);
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferStorage(GL_ARRAY_BUFFER, segmentSize * numSegments, NULL, flags);
+		mapped = (unsigned char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, segmentSize * numSegments, flags);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		segment = numSegments - 1;
+	}
+
+	// Routine to release the buffer and fences.
+	void destroy(void)
+	{
+		for (size_t i = 0; i < fences.size(); i++)
+			if (fences[i]) glDeleteSync(fences[i]);
+		fences.clear();
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		mapped = NULL;
+	}
+
+	// Routine to move to the next segment, first waiting for the GPU to finish with it.
+	void beginFrame(void)
+	{
+		segment = (segment + 1) % (int)fences.size();
+		offset = 0;
+		frameBytes = 0;
+
+		GLsync &fence = fences[segment];
+		if (!fence) return;
+		GLenum status = glClientWaitSync(fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			while (status == GL_TIMEOUT_EXPIRED)
+				status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			waitMicros += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+			numWaits++;
+		}
+		glDeleteSync(fence);
+		fence = 0;
+	}
+
+	// Routine to allocate bytes in the current segment, aligned to alignment (a power
+	// of two): returns the pointer to write to and sets bufferOffset to the offset
+	// to draw from, or returns NULL if the segment is full.
+	void *alloc(size_t bytes, size_t &bufferOffset, size_t alignment = 16)
+	{
+		size_t start = (offset + alignment - 1) & ~(alignment - 1);
+		if (start + bytes > segmentSize)
+		{
+			numOverflows++;
+			return NULL;
+		}
+		offset = start + bytes;
+		frameBytes += bytes;
+		bufferOffset = segment * segmentSize + start;
+		return mapped + bufferOffset;
+	}
+
+	// Routine to fence the draws issued from the current segment.
+	void endFrame(void)
+	{
+		fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	unsigned int name(void) const { return buffer; }
+	size_t capacity(void) const { return segmentSize; } // Bytes a frame.
+
+	long long numWaits, numOverflows; // Waits for the GPU, allocations refused.
+	double waitMicros; // Total time spent waiting.
+	size_t frameBytes; // Bytes allocated this frame.
+
+private:
+	unsigned int buffer;
+	unsigned char *mapped; // Persistent mapping of the whole buffer.
+	std::vector<GLsync> fences; // Fence of the last frame to use each segment.
+	size_t segmentSize;
+	int segment; // Current segment.
+	size_t offset; // Next free byte of the current segment.
+};
+
+#endif
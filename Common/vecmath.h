@@ -0,0 +1,434 @@
+////////////////////////////////////////////////////////////////////////////////////
+// vecmath.h
+//
+// Header-only 4-vector, 4x4 matrix and quaternion types using SSE (and AVX for
+// matrix products where available), plus a CPU matrix stack replacing the
+// fixed-function matrix calls the demos make:
+//
+//   glLoadIdentity()  glPushMatrix()  glPopMatrix()  glMultMatrixf()
+//   glTranslatef()    glRotatef()     glScalef()
+//   glFrustum()       glOrtho()       gluPerspective()  gluLookAt()
+//
+// Matrices are column-major like OpenGL's, so Mat4::m can be passed straight to
+// glUniformMatrix4fv() or glLoadMatrixf(). The arithmetic follows the order of
+// operations of Mesa's matrix code and of the SGI GLU, in the same precision
+// (float, or double where GLU uses double), so results normally match the driver
+// bit for bit; a driver doing its own rounding or using fused multiply-adds may
+// differ in the last bit.
+//
+// MatrixUniform uploads a matrix to a shader uniform only when it differs from
+// the value last uploaded there.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VECMATH_H
+#define VECMATH_H
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VECMATH_USE_SSE
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define VECMATH_USE_AVX
+#include <immintrin.h>
+#endif
+
+#include <GL/glew.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// 4-vector.
+struct alignas(16) Vec4
+{
+	float x, y, z, w;
+
+	Vec4(void) : x(0.0), y(0.0), z(0.0), w(0.0) {}
+	Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+#ifdef VECMATH_USE_SSE
+	Vec4(__m128 v) { _mm_store_ps(&x, v); }
+	__m128 simd(void) const { return _mm_load_ps(&x); }
+
+	Vec4 operator+(const Vec4 &b) const { return Vec4(_mm_add_ps(simd(), b.simd())); }
+	Vec4 operator-(const Vec4 &b) const { return Vec4(_mm_sub_ps(simd(), b.simd())); }
+	Vec4 operator*(float s) const { return Vec4(_mm_mul_ps(simd(), _mm_set1_ps(s))); }
+#else
+	Vec4 operator+(const Vec4 &b) const { return Vec4(x + b.x, y + b.y, z + b.z, w + b.w); }
+	Vec4 operator-(const Vec4 &b) const { return Vec4(x - b.x, y - b.y, z - b.z, w - b.w); }
+	Vec4 operator*(float s) const { return Vec4(x * s, y * s, z * s, w * s); }
+#endif
+};
+
+inline float dot(const Vec4 &a, const Vec4 &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// Cross product of the xyz parts, w = 0.
+inline Vec4 cross3(const Vec4 &a, const Vec4 &b)
+{
+	return Vec4(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x, 0.0);
+}
+
+// xyz part scaled to unit length, as GLU's normalize() does; zero vectors are left alone.
+inline Vec4 normalize3(const Vec4 &v)
+{
+	float r = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+	if (r == 0.0) return v;
+	return Vec4(v.x / r, v.y / r, v.z / r, v.w);
+}
+
+// 4x4 matrix, column-major: m[4 * column + row].
+struct alignas(16) Mat4
+{
+	float m[16];
+
+	static Mat4 identity(void)
+	{
+		Mat4 r;
+		for (int i = 0; i < 16; i++) r.m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		return r;
+	}
+
+	static Mat4 fromArray(const float *a)
+	{
+		Mat4 r;
+		memcpy(r.m, a, sizeof(r.m));
+		return r;
+	}
+
+	float &operator()(int row, int col) { return m[4 * col + row]; }
+	float operator()(int row, int col) const { return m[4 * col + row]; }
+
+	bool operator==(const Mat4 &b) const { return memcmp(m, b.m, sizeof(m)) == 0; }
+	bool operator!=(const Mat4 &b) const { return !(*this == b); }
+
+	// Product this * b: column j is the combination of this matrix's columns with the
+	// elements of b's column j, summed left to right as Mesa's matmul4() does.
+	Mat4 operator*(const Mat4 &b) const
+	{
+		Mat4 r;
+#if defined(VECMATH_USE_AVX)
+		__m256 a01 = _mm256_loadu2_m128(m + 4, m), a23 = _mm256_loadu2_m128(m + 12, m + 8);
+		__m256 c0 = _mm256_permute2f128_ps(a01, a01, 0x00), c1 = _mm256_permute2f128_ps(a01, a01, 0x11);
+		__m256 c2 = _mm256_permute2f128_ps(a23, a23, 0x00), c3 = _mm256_permute2f128_ps(a23, a23, 0x11);
+		for (int j = 0; j < 4; j += 2) // Two columns of the product at a time.
+		{
+			const float *bj = b.m + 4 * j, *bk = b.m + 4 * (j + 1);
+			__m256 s = _mm256_mul_ps(c0, _mm256_setr_m128(_mm_set1_ps(bj[0]), _mm_set1_ps(bk[0])));
+			s = _mm256_add_ps(s, _mm256_mul_ps(c1, _mm256_setr_m128(_mm_set1_ps(bj[1]), _mm_set1_ps(bk[1]))));
+			s = _mm256_add_ps(s, _mm256_mul_ps(c2, _mm256_setr_m128(_mm_set1_ps(bj[2]), _mm_set1_ps(bk[2]))));
+			s = _mm256_add_ps(s, _mm256_mul_ps(c3, _mm256_setr_m128(_mm_set1_ps(bj[3]), _mm_set1_ps(bk[3]))));
+			_mm256_storeu_ps(r.m + 4 * j, s);
+		}
+#elif defined(VECMATH_USE_SSE)
+		__m128 c0 = _mm_load_ps(m), c1 = _mm_load_ps(m + 4), c2 = _mm_load_ps(m + 8), c3 = _mm_load_ps(m + 12);
+		for (int j = 0; j < 4; j++)
+		{
+			const float *bj = b.m + 4 * j;
+			__m128 s = _mm_mul_ps(c0, _mm_set1_ps(bj[0]));
+			s = _mm_add_ps(s, _mm_mul_ps(c1, _mm_set1_ps(bj[1])));
+			s = _mm_add_ps(s, _mm_mul_ps(c2, _mm_set1_ps(bj[2])));
+			s = _mm_add_ps(s, _mm_mul_ps(c3, _mm_set1_ps(bj[3])));
+			_mm_store_ps(r.m + 4 * j, s);
+		}
+#else
+		for (int j = 0; j < 4; j++)
+			for (int i = 0; i < 4; i++)
+				r.m[4 * j + i] = m[i] * b.m[4 * j] + m[4 + i] * b.m[4 * j + 1] + m[8 + i] * b.m[4 * j + 2] + m[12 + i] * b.m[4 * j + 3];
+#endif
+		return r;
+	}
+
+	Vec4 operator*(const Vec4 &v) const
+	{
+#ifdef VECMATH_USE_SSE
+		__m128 s = _mm_mul_ps(_mm_load_ps(m), _mm_set1_ps(v.x));
+		s = _mm_add_ps(s, _mm_mul_ps(_mm_load_ps(m + 4), _mm_set1_ps(v.y)));
+		s = _mm_add_ps(s, _mm_mul_ps(_mm_load_ps(m + 8), _mm_set1_ps(v.z)));
+		s = _mm_add_ps(s, _mm_mul_ps(_mm_load_ps(m + 12), _mm_set1_ps(v.w)));
+		return Vec4(s);
+#else
+		return Vec4(m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+			m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+			m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+			m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w);
+#endif
+	}
+
+	Mat4 transposed(void) const
+	{
+		Mat4 r;
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++) r.m[4 * i + j] = m[4 * j + i];
+		return r;
+	}
+
+	// Matrices of glTranslatef(), glScalef(), glRotatef(), glFrustum(), glOrtho(),
+	// gluPerspective() and gluLookAt() (without the final translation by -eye).
+
+	static Mat4 translation(float x, float y, float z)
+	{
+		Mat4 r = identity();
+		r.m[12] = x; r.m[13] = y; r.m[14] = z;
+		return r;
+	}
+
+	static Mat4 scaling(float x, float y, float z)
+	{
+		Mat4 r = identity();
+		r.m[0] = x; r.m[5] = y; r.m[10] = z;
+		return r;
+	}
+
+	// As Mesa's _math_matrix_rotate(): axis-aligned rotations are set directly,
+	// other axes normalized first.
+	static Mat4 rotation(float angle, float x, float y, float z)
+	{
+		Mat4 r = identity();
+		float s = (float)sin(angle * M_PI / 180.0), c = (float)cos(angle * M_PI / 180.0);
+
+		if (x == 0.0 && y == 0.0 && z != 0.0)
+		{
+			r.m[0] = c; r.m[5] = c;
+			if (z < 0.0) { r(0, 1) = s; r(1, 0) = -s; }
+			else { r(0, 1) = -s; r(1, 0) = s; }
+		}
+		else if (x == 0.0 && z == 0.0 && y != 0.0)
+		{
+			r.m[0] = c; r.m[10] = c;
+			if (y < 0.0) { r(0, 2) = -s; r(2, 0) = s; }
+			else { r(0, 2) = s; r(2, 0) = -s; }
+		}
+		else if (y == 0.0 && z == 0.0 && x != 0.0)
+		{
+			r.m[5] = c; r.m[10] = c;
+			if (x < 0.0) { r(1, 2) = s; r(2, 1) = -s; }
+			else { r(1, 2) = -s; r(2, 1) = s; }
+		}
+		else
+		{
+			float mag = sqrtf(x * x + y * y + z * z);
+			if (mag <= 1.0e-4F) return r; // No rotation, leave the identity.
+			x /= mag; y /= mag; z /= mag;
+
+			float xx = x * x, yy = y * y, zz = z * z, xy = x * y, yz = y * z, zx = z * x;
+			float xs = x * s, ys = y * s, zs = z * s, one_c = 1.0F - c;
+
+			r(0, 0) = (one_c * xx) + c; r(0, 1) = (one_c * xy) - zs; r(0, 2) = (one_c * zx) + ys;
+			r(1, 0) = (one_c * xy) + zs; r(1, 1) = (one_c * yy) + c; r(1, 2) = (one_c * yz) - xs;
+			r(2, 0) = (one_c * zx) - ys; r(2, 1) = (one_c * yz) + xs; r(2, 2) = (one_c * zz) + c;
+		}
+		return r;
+	}
+
+	static Mat4 frustum(float left, float right, float bottom, float top, float nearval, float farval)
+	{
+		Mat4 r;
+		memset(r.m, 0, sizeof(r.m));
+		r(0, 0) = (2.0F * nearval) / (right - left);
+		r(1, 1) = (2.0F * nearval) / (top - bottom);
+		r(0, 2) = (right + left) / (right - left);
+		r(1, 2) = (top + bottom) / (top - bottom);
+		r(2, 2) = -(farval + nearval) / (farval - nearval);
+		r(2, 3) = -(2.0F * farval * nearval) / (farval - nearval);
+		r(3, 2) = -1.0F;
+		return r;
+	}
+
+	static Mat4 ortho(float left, float right, float bottom, float top, float nearval, float farval)
+	{
+		Mat4 r = identity();
+		r(0, 0) = 2.0F / (right - left);
+		r(0, 3) = -(right + left) / (right - left);
+		r(1, 1) = 2.0F / (top - bottom);
+		r(1, 3) = -(top + bottom) / (top - bottom);
+		r(2, 2) = -2.0F / (farval - nearval);
+		r(2, 3) = -(farval + nearval) / (farval - nearval);
+		return r;
+	}
+
+	// As the SGI GLU: computed in double, rounded to float as glMultMatrixd() does.
+	static Mat4 perspective(double fovy, double aspect, double zNear, double zFar)
+	{
+		Mat4 r = identity();
+		double radians = fovy / 2 * M_PI / 180;
+		double deltaZ = zFar - zNear;
+		double sine = sin(radians);
+		if ((deltaZ == 0) || (sine == 0) || (aspect == 0)) return r;
+		double cotangent = cos(radians) / sine;
+
+		r.m[0] = (float)(cotangent / aspect);
+		r.m[5] = (float)cotangent;
+		r.m[10] = (float)(-(zFar + zNear) / deltaZ);
+		r.m[11] = -1.0;
+		r.m[14] = (float)(-2 * zNear * zFar / deltaZ);
+		r.m[15] = 0.0;
+		return r;
+	}
+
+	// Rotation part of gluLookAt(); follow with a translation by -eye.
+	static Mat4 lookAtRotation(float eyex, float eyey, float eyez, float centerx, float centery, float centerz,
+		float upx, float upy, float upz)
+	{
+		Vec4 forward = normalize3(Vec4(centerx - eyex, centery - eyey, centerz - eyez, 0.0));
+		Vec4 side = normalize3(cross3(forward, Vec4(upx, upy, upz, 0.0)));
+		Vec4 up = cross3(side, forward);
+
+		Mat4 r = identity();
+		r(0, 0) = side.x; r(0, 1) = side.y; r(0, 2) = side.z;
+		r(1, 0) = up.x; r(1, 1) = up.y; r(1, 2) = up.z;
+		r(2, 0) = -forward.x; r(2, 1) = -forward.y; r(2, 2) = -forward.z;
+		return r;
+	}
+};
+
+// Unit quaternion w + xi + yj + zk.
+struct alignas(16) Quat
+{
+	float x, y, z, w;
+
+	Quat(void) : x(0.0), y(0.0), z(0.0), w(1.0) {}
+	Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+	// Rotation by angle degrees about the axis (x, y, z), as glRotatef().
+	static Quat fromAxisAngle(float angle, float ax, float ay, float az)
+	{
+		float mag = std::sqrt(ax * ax + ay * ay + az * az);
+		if (mag <= 1.0e-4F) return Quat();
+		float h = (float)(angle * M_PI / 360.0), s = std::sin(h) / mag;
+		return Quat(ax * s, ay * s, az * s, std::cos(h));
+	}
+
+	Quat operator*(const Quat &b) const
+	{
+		return Quat(w * b.x + x * b.w + y * b.z - z * b.y,
+			w * b.y - x * b.z + y * b.w + z * b.x,
+			w * b.z + x * b.y - y * b.x + z * b.w,
+			w * b.w - x * b.x - y * b.y - z * b.z);
+	}
+
+	Quat normalized(void) const
+	{
+		float r = std::sqrt(x * x + y * y + z * z + w * w);
+		return Quat(x / r, y / r, z / r, w / r);
+	}
+
+	// Spherical linear interpolation from a (t = 0) to b (t = 1) along the shorter arc.
+	static Quat slerp(const Quat &a, Quat b, float t)
+	{
+		float c = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+		if (c < 0.0) { b = Quat(-b.x, -b.y, -b.z, -b.w); c = -c; }
+		float ka = 1.0 - t, kb = t;
+		if (c < 0.9995)
+		{
+			float theta = std::acos(c), s = std::sin(theta);
+			ka = std::sin((1.0 - t) * theta) / s;
+			kb = std::sin(t * theta) / s;
+		}
+		return Quat(ka * a.x + kb * b.x, ka * a.y + kb * b.y, ka * a.z + kb * b.z, ka * a.w + kb * b.w).normalized();
+	}
+
+	Mat4 toMat4(void) const
+	{
+		Mat4 r = Mat4::identity();
+		r(0, 0) = 1 - 2 * (y * y + z * z); r(0, 1) = 2 * (x * y - z * w); r(0, 2) = 2 * (x * z + y * w);
+		r(1, 0) = 2 * (x * y + z * w); r(1, 1) = 1 - 2 * (x * x + z * z); r(1, 2) = 2 * (y * z - x * w);
+		r(2, 0) = 2 * (x * z - y * w); r(2, 1) = 2 * (y * z + x * w); r(2, 2) = 1 - 2 * (x * x + y * y);
+		return r;
+	}
+};
+
+// CPU matrix stack with the fixed-function calls as methods; each multiplies the
+// top of the stack on the right, as OpenGL does.
+class MatrixStack
+{
+public:
+	MatrixStack(void) { stack.push_back(Mat4::identity()); }
+
+	const Mat4 &top(void) const { return stack.back(); }
+
+	void loadIdentity(void) { stack.back() = Mat4::identity(); }
+	void loadMatrix(const Mat4 &m) { stack.back() = m; }
+	void pushMatrix(void) { stack.push_back(stack.back()); }
+	void popMatrix(void) { if (stack.size() > 1) stack.pop_back(); }
+	void multMatrix(const Mat4 &m) { stack.back() = stack.back() * m; }
+
+	// As Mesa's _math_matrix_translate(): only the last column changes.
+	void translate(float x, float y, float z)
+	{
+		float *m = stack.back().m;
+		m[12] = m[0] * x + m[4] * y + m[8] * z + m[12];
+		m[13] = m[1] * x + m[5] * y + m[9] * z + m[13];
+		m[14] = m[2] * x + m[6] * y + m[10] * z + m[14];
+		m[15] = m[3] * x + m[7] * y + m[11] * z + m[15];
+	}
+
+	// As Mesa's _math_matrix_scale(): the first three columns are scaled.
+	void scale(float x, float y, float z)
+	{
+		float *m = stack.back().m;
+		m[0] *= x; m[4] *= y; m[8] *= z;
+		m[1] *= x; m[5] *= y; m[9] *= z;
+		m[2] *= x; m[6] *= y; m[10] *= z;
+		m[3] *= x; m[7] *= y; m[11] *= z;
+	}
+
+	void rotate(float angle, float x, float y, float z)
+	{
+		if (angle != 0.0) multMatrix(Mat4::rotation(angle, x, y, z));
+	}
+
+	void frustum(float l, float r, float b, float t, float n, float f) { multMatrix(Mat4::frustum(l, r, b, t, n, f)); }
+	void ortho(float l, float r, float b, float t, float n, float f) { multMatrix(Mat4::ortho(l, r, b, t, n, f)); }
+	void perspective(double fovy, double aspect, double zNear, double zFar) { multMatrix(Mat4::perspective(fovy, aspect, zNear, zFar)); }
+
+	void lookAt(float eyex, float eyey, float eyez, float centerx, float centery, float centerz,
+		float upx, float upy, float upz)
+	{
+		multMatrix(Mat4::lookAtRotation(eyex, eyey, eyez, centerx, centery, centerz, upx, upy, upz));
+		translate(-eyex, -eyey, -eyez);
+	}
+
+	int depth(void) const { return (int)stack.size(); }
+
+private:
+	std::vector<Mat4> stack;
+};
+
+// A mat4 shader uniform which is uploaded only when its value changes.
+class MatrixUniform
+{
+public:
+	MatrixUniform(void) : location(-1), valid(false), uploads(0), skipped(0) {}
+
+	// Routine to bind to the uniform name of program, forgetting the last value.
+	void init(unsigned int program, const char *name)
+	{
+		location = glGetUniformLocation(program, name);
+		valid = false;
+	}
+
+	// Routine to set the uniform, which must be of the current program, to m.
+	void set(const Mat4 &m)
+	{
+		if (valid && m == last)
+		{
+			skipped++;
+			return;
+		}
+		glUniformMatrix4fv(location, 1, GL_FALSE, m.m);
+		last = m;
+		valid = true;
+		uploads++;
+	}
+
+	int location;
+	bool valid; // Has last been uploaded?
+	Mat4 last; // Value last uploaded.
+	long long uploads, skipped; // Counters.
+};
+
+#endif
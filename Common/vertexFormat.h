@@ -0,0 +1,416 @@
+////////////////////////////////////////////////////////////////////////////////////
+// vertexFormat.h
+//
+// Compact vertex formats. A mesh given as float positions, float normals and
+// unsigned int indices is stored in about half the memory, and so fetched by the
+// GPU with about half the bandwidth every draw:
+//
+//   CompactMesh sphere;
+//   sphere.build("sphere", positions, normals, numVertices, indices, numIndices, GL_TRIANGLES);
+//   ...
+//   sphere.draw(); // With the current matrices, material and lights.
+//
+// - Positions are three unsigned 16-bit normalized integers (and a pad), the
+//   mesh's box mapped onto 0..65535 on each axis; the vertex shader scales and
+//   biases them back with the box's extent and minimum. The error is at most half
+//   of 1/65535 of the extent along each axis.
+// - Normals are octahedral: the unit vector is projected onto the octahedron
+//   |x| + |y| + |z| = 1, whose lower half is folded over the upper, and the x and y
+//   of the point kept as two signed 16-bit normalized integers, about 0.005
+//   degrees apart at worst.
+// - Indices are bytes up to 256 vertices, shorts up to 65536. Beyond that, lists
+//   of triangles, lines or points are cut into chunks each spanning at most 65536
+//   consecutive vertices, drawn with glDrawElementsBaseVertex() with 16-bit
+//   indices relative to the chunk's first vertex; as generated meshes number their
+//   vertices row by row, a chunk is a band of rows. Strips and fans, or meshes that
+//   would need more than COMPACT_MAX_CHUNKS chunks, keep 32-bit indices.
+//
+// So a vertex is 12 bytes instead of 24. build() prints what the mesh takes in
+// each form, with the largest position and normal errors.
+//
+// The vertex shader lights like the fixed-function pipeline (the enabled lights of
+// GL_LIGHT0 to GL_LIGHT7, the front and back materials, two-sided lighting and the
+// local viewer, all read from the current state), so a compact mesh drops into
+// the demos' fixed-function scenes. Meshes without normals take the current color.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <GL/glew.h>
+
+#include "programCache.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define COMPACT_MAX_CHUNKS 64 // Most 16-bit chunks before falling back to 32-bit indices.
+
+// A compact vertex.
+struct CompactVertex
+{
+	unsigned short position[4]; // Normalized to the mesh's box; the fourth pads to 4-byte alignment.
+	short normal[2]; // Octahedral.
+};
+
+// A run of indices drawn with one call.
+struct CompactChunk
+{
+	size_t offset; // Byte offset in the index buffer.
+	int count; // Indices.
+	int baseVertex; // Added to each index.
+};
+
+static const char *compactVertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 position;\n"
+"layout(location = 1) in vec2 octNormal;\n"
+"uniform vec3 scale;\n"
+"uniform vec3 bias;\n"
+"uniform int lightMask;\n" // Bit i set if GL_LIGHTi is enabled; 0 if lighting is off.
+"uniform int twoSide;\n"
+"uniform int localViewer;\n"
+"out vec4 frontColor;\n"
+"out vec4 backColor;\n"
+"vec3 octDecode(vec2 e)\n"
+"{\n"
+"	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+"	if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);\n"
+"	return normalize(n);\n"
+"}\n"
+"vec4 shade(vec3 p, vec3 n, gl_MaterialParameters m, vec4 sceneColor)\n"
+"{\n"
+"	vec4 color = sceneColor;\n"
+"	vec3 v = localViewer != 0 ? normalize(-p) : vec3(0.0, 0.0, 1.0);\n"
+"	for (int i = 0; i < 8; i++)\n"
+"	{\n"
+"		if ((lightMask & (1 << i)) == 0) continue;\n"
+"		gl_LightSourceParameters s = gl_LightSource[i];\n"
+"		vec3 l = s.position.xyz;\n"
+"		float attenuation = 1.0;\n"
+"		if (s.position.w != 0.0)\n"
+"		{\n"
+"			l -= p;\n"
+"			float d = length(l);\n"
+"			attenuation = 1.0 / (s.constantAttenuation + s.linearAttenuation * d + s.quadraticAttenuation * d * d);\n"
+"			if (s.spotCutoff != 180.0)\n"
+"			{\n"
+"				float c = dot(-normalize(l), normalize(s.spotDirection));\n"
+"				attenuation *= c >= s.spotCosCutoff ? pow(c, s.spotExponent) : 0.0;\n"
+"			}\n"
+"		}\n"
+"		l = normalize(l);\n"
+"		float diffuse = max(dot(n, l), 0.0);\n"
+"		float specular = diffuse > 0.0 ? pow(max(dot(n, normalize(l + v)), 0.0), m.shininess) : 0.0;\n"
+"		color += attenuation * (m.ambient * s.ambient + diffuse * m.diffuse * s.diffuse + specular * m.specular * s.specular);\n"
+"	}\n"
+"	return vec4(color.rgb, m.diffuse.a);\n"
+"}\n"
+"void main(void)\n"
+"{\n"
+"	vec4 p = vec4(bias + scale * position, 1.0);\n"
+"	gl_Position = gl_ModelViewProjectionMatrix * p;\n"
+"	if (lightMask == 0)\n"
+"	{\n"
+"		frontColor = backColor = gl_Color;\n"
+"		return;\n"
+"	}\n"
+"	vec3 eye = (gl_ModelViewMatrix * p).xyz;\n"
+"	vec3 n = normalize(gl_NormalMatrix * octDecode(octNormal));\n"
+"	frontColor = shade(eye, n, gl_FrontMaterial, gl_FrontLightModelProduct.sceneColor);\n"
+"	backColor = twoSide != 0 ? shade(eye, -n, gl_BackMaterial, gl_BackLightModelProduct.sceneColor) : frontColor;\n"
+"}\n";
+
+static const char *compactFragmentShaderSource =
+"#version 430 compatibility\n"
+"uniform int twoSide;\n"
+"in vec4 frontColor;\n"
+"in vec4 backColor;\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"	fragColor = gl_FrontFacing || twoSide == 0 ? frontColor : backColor;\n"
+"}\n";
+
+// Routine to encode the unit vector n octahedrally into e, signed 16-bit normalized.
+inline void octEncode(const float n[3], short e[2])
+{
+	float s = std::fabs(n[0]) + std::fabs(n[1]) + std::fabs(n[2]);
+	float x = s > 0.0 ? n[0] / s : 0.0f, y = s > 0.0 ? n[1] / s : 0.0f;
+	if (n[2] < 0.0) // Fold the lower half over.
+	{
+		float fx = (1.0f - std::fabs(y)) * (x >= 0.0 ? 1.0f : -1.0f);
+		float fy = (1.0f - std::fabs(x)) * (y >= 0.0 ? 1.0f : -1.0f);
+		x = fx;
+		y = fy;
+	}
+	e[0] = (short)std::floor(std::max(-1.0f, std::min(1.0f, x)) * 32767.0f + 0.5f);
+	e[1] = (short)std::floor(std::max(-1.0f, std::min(1.0f, y)) * 32767.0f + 0.5f);
+}
+
+// Routine to decode an octahedral normal into n, as the vertex shader does.
+inline void octDecode(const short e[2], float n[3])
+{
+	float x = std::max(e[0] / 32767.0f, -1.0f), y = std::max(e[1] / 32767.0f, -1.0f);
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+	if (z < 0.0)
+	{
+		float fx = (1.0f - std::fabs(y)) * (x >= 0.0 ? 1.0f : -1.0f);
+		float fy = (1.0f - std::fabs(x)) * (y >= 0.0 ? 1.0f : -1.0f);
+		x = fx;
+		y = fy;
+	}
+	float len = std::sqrt(x * x + y * y + z * z);
+	n[0] = x / len; n[1] = y / len; n[2] = z / len;
+}
+
+// Routine to return the narrowest index type for vertices 0 to numVertices - 1.
+inline GLenum compactIndexType(int numVertices)
+{
+	if (numVertices <= 256) return GL_UNSIGNED_BYTE;
+	if (numVertices <= 65536) return GL_UNSIGNED_SHORT;
+	return GL_UNSIGNED_INT;
+}
+
+// Routine to return the size of an index type.
+inline int compactIndexSize(GLenum type)
+{
+	return type == GL_UNSIGNED_BYTE ? 1 : (type == GL_UNSIGNED_SHORT ? 2 : 4);
+}
+
+class CompactMesh
+{
+public:
+	CompactMesh(void) : numVertices(0), numIndices(0), indexType(GL_UNSIGNED_INT), floatBytes(0), compactBytes(0),
+		positionError(0.0), normalError(0.0), mode(GL_TRIANGLES), hasNormals(false), vao(0), vertexBuffer(0),
+		indexBuffer(0)
+	{
+		for (int a = 0; a < 3; a++) scale[a] = bias[a] = 0.0;
+	}
+
+	// Routine to build the mesh of numVertices vertices with positions and normals
+	// (three floats each; normals may be NULL) and numIndices indices of primitives
+	// of the given mode, upload it and print its sizes under name.
+	void build(const char *name, const float *positions, const float *normals, int numVertices,
+		const unsigned int *indices, int numIndices, GLenum mode)
+	{
+		if (!vao) init();
+		this->numVertices = numVertices;
+		this->numIndices = numIndices;
+		this->mode = mode;
+		hasNormals = normals != NULL;
+
+		// Scale and bias mapping 0..65535 onto the box of the positions.
+		float lo[3] = { 1e30f, 1e30f, 1e30f }, hi[3] = { -1e30f, -1e30f, -1e30f };
+		for (int i = 0; i < numVertices; i++)
+			for (int a = 0; a < 3; a++)
+			{
+				lo[a] = std::min(lo[a], positions[3 * i + a]);
+				hi[a] = std::max(hi[a], positions[3 * i + a]);
+			}
+		for (int a = 0; a < 3; a++)
+		{
+			bias[a] = lo[a];
+			scale[a] = hi[a] > lo[a] ? hi[a] - lo[a] : 1.0f;
+		}
+
+		// Quantize, measuring the errors.
+		std::vector<CompactVertex> vertices(numVertices);
+		positionError = normalError = 0.0;
+		for (int i = 0; i < numVertices; i++)
+		{
+			CompactVertex &v = vertices[i];
+			for (int a = 0; a < 3; a++)
+			{
+				float t = (positions[3 * i + a] - bias[a]) / scale[a];
+				v.position[a] = (unsigned short)std::floor(std::max(0.0f, std::min(1.0f, t)) * 65535.0f + 0.5f);
+				positionError = std::max(positionError, std::fabs(bias[a] + scale[a] * (v.position[a] / 65535.0f) - positions[3 * i + a]));
+			}
+			v.position[3] = 0;
+			v.normal[0] = v.normal[1] = 0;
+			if (hasNormals)
+			{
+				const float *n = &normals[3 * i];
+				float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]), u[3], d[3];
+				for (int a = 0; a < 3; a++) u[a] = len > 0.0 ? n[a] / len : 0.0f;
+				octEncode(u, v.normal);
+				octDecode(v.normal, d);
+				double cx = (double)u[1] * d[2] - (double)u[2] * d[1], cy = (double)u[2] * d[0] - (double)u[0] * d[2];
+				double cz = (double)u[0] * d[1] - (double)u[1] * d[0], c = (double)u[0] * d[0] + (double)u[1] * d[1] + (double)u[2] * d[2];
+				double angle = std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), c); // Accurate for small angles, unlike acos().
+				if (len > 0.0) normalError = std::max(normalError, (float)(angle * 180.0 / M_PI));
+			}
+		}
+
+		// Indices: the narrowest type, else 16-bit chunks, else 32-bit.
+		std::vector<unsigned char> indexData;
+		chunks.clear();
+		indexType = compactIndexType(numVertices);
+		int size = compactIndexSize(indexType);
+		if (indexType != GL_UNSIGNED_INT || !chunk(indices, numIndices, indexData))
+		{
+			CompactChunk all = { 0, numIndices, 0 };
+			chunks.assign(1, all);
+			indexData.resize((size_t)numIndices * size);
+			for (int i = 0; i < numIndices; i++)
+				if (size == 1) indexData[i] = (unsigned char)indices[i];
+				else if (size == 2) ((unsigned short *)indexData.data())[i] = (unsigned short)indices[i];
+				else ((unsigned int *)indexData.data())[i] = indices[i];
+		}
+		else indexType = GL_UNSIGNED_SHORT;
+
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(CompactVertex), vertices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size(), indexData.data(), GL_STATIC_DRAW);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		floatBytes = (size_t)numVertices * (hasNormals ? 24 : 12) + (size_t)numIndices * 4;
+		compactBytes = (size_t)numVertices * sizeof(CompactVertex) + indexData.size();
+		const char *types[] = { "8-bit", "16-bit", "32-bit" };
+		char chunked[32] = "";
+		if (chunks.size() > 1) sprintf(chunked, " in %d chunks", (int)chunks.size());
+		printf("Mesh %s: %d vertices, %d indices: float%s with 32-bit indices %.1f KB, compact with %s indices%s %.1f KB (%.0f%% less); "
+			"largest error %g in position%s", name, numVertices, numIndices, hasNormals ? " positions and normals" : " positions",
+			floatBytes / 1024.0, types[size == 1 ? 0 : (indexType == GL_UNSIGNED_SHORT ? 1 : 2)], chunked, compactBytes / 1024.0,
+			100.0 * (1.0 - (double)compactBytes / floatBytes), positionError, hasNormals ? "," : "\n");
+		if (hasNormals) printf(" %g degrees in normal\n", normalError);
+	}
+
+	// Routine to draw the mesh with the current matrices, material and lights.
+	void draw(void)
+	{
+		int lightMask = 0, twoSide = 0, localViewer = 0;
+		if (glIsEnabled(GL_LIGHTING) && hasNormals)
+			for (int i = 0; i < 8; i++) if (glIsEnabled(GL_LIGHT0 + i)) lightMask |= 1 << i;
+		glGetIntegerv(GL_LIGHT_MODEL_TWO_SIDE, &twoSide);
+		glGetIntegerv(GL_LIGHT_MODEL_LOCAL_VIEWER, &localViewer);
+
+		CompactProgram &p = compactProgram();
+		glUseProgram(p.program);
+		glUniform3fv(p.scaleLoc, 1, scale);
+		glUniform3fv(p.biasLoc, 1, bias);
+		glUniform1i(p.lightMaskLoc, lightMask);
+		glUniform1i(p.twoSideLoc, lightMask ? twoSide : 0);
+		glUniform1i(p.localViewerLoc, localViewer);
+		glBindVertexArray(vao);
+		for (size_t k = 0; k < chunks.size(); k++)
+			glDrawElementsBaseVertex(mode, chunks[k].count, indexType, (void *)chunks[k].offset, chunks[k].baseVertex);
+		glBindVertexArray(0);
+		glUseProgram(0);
+	}
+
+	// Routine to release the GL objects.
+	void destroy(void)
+	{
+		glDeleteBuffers(1, &vertexBuffer);
+		glDeleteBuffers(1, &indexBuffer);
+		glDeleteVertexArrays(1, &vao);
+		vertexBuffer = indexBuffer = vao = 0;
+	}
+
+	int numVertices, numIndices;
+	GLenum indexType; // Type of the indices in the buffer.
+	size_t floatBytes, compactBytes; // Sizes of the mesh as floats with 32-bit indices, and compact.
+	float positionError, normalError; // Largest errors, in object units and degrees.
+
+private:
+	struct CompactProgram
+	{
+		unsigned int program;
+		int scaleLoc, biasLoc, lightMaskLoc, twoSideLoc, localViewerLoc;
+	};
+
+	// Routine to return the program shared by all meshes, built on first use.
+	static CompactProgram &compactProgram(void)
+	{
+		static CompactProgram p = { 0, -1, -1, -1, -1, -1 };
+		if (!p.program)
+		{
+			p.program = programCacheBuild(compactVertexShaderSource, compactFragmentShaderSource);
+			p.scaleLoc = glGetUniformLocation(p.program, "scale");
+			p.biasLoc = glGetUniformLocation(p.program, "bias");
+			p.lightMaskLoc = glGetUniformLocation(p.program, "lightMask");
+			p.twoSideLoc = glGetUniformLocation(p.program, "twoSide");
+			p.localViewerLoc = glGetUniformLocation(p.program, "localViewer");
+		}
+		return p;
+	}
+
+	// Routine to create the vertex array and buffers.
+	void init(void)
+	{
+		compactProgram();
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &vertexBuffer);
+		glGenBuffers(1, &indexBuffer);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (void *)offsetof(CompactVertex, position));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(CompactVertex), (void *)offsetof(CompactVertex, normal));
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Routine to cut a list of independent primitives into runs each spanning at most
+	// 65536 vertices, filling data with their 16-bit indices relative to each run's
+	// lowest vertex. False, with nothing done, if the mode is not such a list or it
+	// would take more than COMPACT_MAX_CHUNKS runs.
+	bool chunk(const unsigned int *indices, int numIndices, std::vector<unsigned char> &data)
+	{
+		int per = mode == GL_TRIANGLES ? 3 : (mode == GL_LINES ? 2 : (mode == GL_POINTS ? 1 : 0));
+		if (!per) return false;
+
+		std::vector<CompactChunk> runs;
+		std::vector<unsigned short> shorts(numIndices);
+		int first = 0;
+		while (first < numIndices)
+		{
+			unsigned int lo = 0xFFFFFFFF, hi = 0;
+			int end = first;
+			while (end + per <= numIndices)
+			{
+				unsigned int pLo = lo, pHi = hi;
+				for (int k = 0; k < per; k++)
+				{
+					pLo = std::min(pLo, indices[end + k]);
+					pHi = std::max(pHi, indices[end + k]);
+				}
+				if (pHi - pLo > 65535) break;
+				lo = pLo;
+				hi = pHi;
+				end += per;
+			}
+			if (end == first || (int)runs.size() == COMPACT_MAX_CHUNKS) return false; // A primitive too wide, or too many runs.
+			CompactChunk run = { first * sizeof(unsigned short), end - first, (int)lo };
+			runs.push_back(run);
+			for (int i = first; i < end; i++) shorts[i] = (unsigned short)(indices[i] - lo);
+			first = end;
+		}
+		chunks = runs;
+		data.resize(shorts.size() * sizeof(unsigned short));
+		memcpy(data.data(), shorts.data(), data.size());
+		return true;
+	}
+
+	GLenum mode; // Primitive.
+	bool hasNormals;
+	float scale[3], bias[3]; // Position = bias + scale * normalized position.
+	std::vector<CompactChunk> chunks; // Runs of indices to draw.
+	unsigned int vao, vertexBuffer, indexBuffer; // GL objects.
+};
+
+#endif
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////////
+// wideLines.h
+//
+// A renderer for wide, optionally anti-aliased polylines that does not rely on
+// glLineWidth(), whose widths above 1 are deprecated in the core profile and
+// limited or slow on many implementations.
+//
+// Polylines are given point by point, as with glBegin(GL_LINE_STRIP):
+//
+//   lines.color(0.0, 0.0, 0.0);
+//   for (...) lines.vertex(x, y, z);
+//   lines.endLine();
+//   ...
+//   lines.upload();
+//   lines.draw(3.0); // Width in pixels.
+//
+// and go into one vertex buffer, 20 bytes a point. draw() is a single instanced
+// draw with one instance per segment: the buffer is bound twice, one point apart,
+// as per-instance attributes, so each instance reads the two ends of its segment,
+// and its four vertices expand it in the vertex shader into a screen-space
+// rectangle half the width plus a pixel wider than the segment on every side.
+// The fragment shader takes each pixel's distance to the segment, giving round
+// caps and round joins where consecutive rectangles overlap, and with smoothing
+// on turns the distance into coverage in alpha for a one-pixel anti-aliased edge.
+// Work is thus a fixed four vertices a segment whatever the width; an instance
+// whose first point ends a polyline collapses outside the view volume.
+//
+// Points are transformed by the current modelview and projection matrices,
+// through gl_ModelViewProjectionMatrix, so lines drop into fixed-function code,
+// and segments crossing the near plane are clipped to it before the expansion.
+// The buffer can be uploaded once and drawn every frame, or refilled each frame.
+// Every WideLines draws with one program, built by the first init(); its uniforms
+// are set at each draw.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WIDE_LINES_H
+#define WIDE_LINES_H
+
+#include <cstddef>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "programCache.h"
+
+// A point of a polyline.
+struct WideLinePoint
+{
+	float x, y, z;
+	float end; // 1 on the last point of a polyline.
+	unsigned char color[4];
+};
+
+static const char *wideLinesVertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec4 pointA;\n"
+"layout(location = 1) in vec4 colorA;\n"
+"layout(location = 2) in vec4 pointB;\n"
+"layout(location = 3) in vec4 colorB;\n"
+"uniform vec4 viewport;\n"
+"uniform float halfWidth;\n"
+"flat out vec4 segment;\n"
+"out vec4 lineColor;\n"
+"void main(void)\n"
+"{\n"
+"	vec4 a = gl_ModelViewProjectionMatrix * vec4(pointA.xyz, 1.0);\n"
+"	vec4 b = gl_ModelViewProjectionMatrix * vec4(pointB.xyz, 1.0);\n"
+"	float da = a.z + a.w, db = b.z + b.w;\n"
+"	if (pointA.w != 0.0 || (da < 0.0 && db < 0.0))\n"
+"	{\n"
+"		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+"		return;\n"
+"	}\n"
+"	if (da < 0.0) a = mix(a, b, da / (da - db));\n"
+"	else if (db < 0.0) b = mix(b, a, db / (db - da));\n"
+"\n"
+"	vec2 sa = viewport.xy + (a.xy / a.w * 0.5 + 0.5) * viewport.zw;\n"
+"	vec2 sb = viewport.xy + (b.xy / b.w * 0.5 + 0.5) * viewport.zw;\n"
+"	vec2 d = sb - sa;\n"
+"	float len = length(d);\n"
+"	d = len > 0.0 ? d / len : vec2(1.0, 0.0);\n"
+"	vec2 n = vec2(-d.y, d.x);\n"
+"	float radius = halfWidth + 1.0;\n"
+"	bool atB = (gl_VertexID & 1) != 0;\n"
+"	vec2 corner = (atB ? sb + d * radius : sa - d * radius) + n * ((gl_VertexID & 2) != 0 ? radius : -radius);\n"
+"	vec4 end = atB ? b : a;\n"
+"	gl_Position = vec4(((corner - viewport.xy) / viewport.zw * 2.0 - 1.0) * end.w, end.z, end.w);\n"
+"	segment = vec4(sa, sb);\n"
+"	lineColor = atB ? colorB : colorA;\n"
+"}\n";
+
+static const char *wideLinesFragmentShaderSource =
+"#version 430 compatibility\n"
+"uniform float halfWidth;\n"
+"uniform int smoothed;\n"
+"flat in vec4 segment;\n"
+"in vec4 lineColor;\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"	vec2 p = gl_FragCoord.xy - segment.xy, ab = segment.zw - segment.xy;\n"
+"	float t = clamp(dot(p, ab) / max(dot(ab, ab), 1.0e-6), 0.0, 1.0);\n"
+"	float dist = length(p - ab * t);\n"
+"	float coverage = smoothed != 0 ? clamp(halfWidth + 0.5 - dist, 0.0, 1.0) : (dist <= halfWidth ? 1.0 : 0.0);\n"
+"	if (coverage <= 0.0) discard;\n"
+"	fragColor = vec4(lineColor.rgb, lineColor.a * coverage);\n"
+"}\n";
+
+class WideLines
+{
+public:
+	WideLines(void) : numSegments(0), program(0), vao(0), buffer(0), viewportLoc(-1), halfWidthLoc(-1),
+		smoothedLoc(-1), numPoints(0)
+	{
+		currentColor[0] = currentColor[1] = currentColor[2] = 0; currentColor[3] = 255;
+	}
+
+	// Routine to create the vertex array and buffer, and on first use the program,
+	// which all wide lines share. Needs a current GL context.
+	void init(void)
+	{
+		static unsigned int sharedProgram = 0; // Of all wide lines.
+		if (!sharedProgram) sharedProgram = programCacheBuild(wideLinesVertexShaderSource, wideLinesFragmentShaderSource);
+		program = sharedProgram;
+		viewportLoc = glGetUniformLocation(program, "viewport");
+		halfWidthLoc = glGetUniformLocation(program, "halfWidth");
+		smoothedLoc = glGetUniformLocation(program, "smoothed");
+
+		glGenVertexArrays(1, &vao);
+		glGenBuffers(1, &buffer);
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		for (int k = 0; k < 2; k++) // Ends A and B of a segment, one point apart.
+		{
+			size_t offset = k * sizeof(WideLinePoint);
+			glVertexAttribPointer(2 * k, 4, GL_FLOAT, GL_FALSE, sizeof(WideLinePoint), (void *)offset);
+			glVertexAttribPointer(2 * k + 1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(WideLinePoint),
+				(void *)(offset + offsetof(WideLinePoint, color)));
+			for (int i = 2 * k; i <= 2 * k + 1; i++)
+			{
+				glEnableVertexAttribArray(i);
+				glVertexAttribDivisor(i, 1);
+			}
+		}
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Routine to release the vertex array and buffer; the shared program stays.
+	void destroy(void)
+	{
+		glDeleteBuffers(1, &buffer);
+		glDeleteVertexArrays(1, &vao);
+		buffer = vao = program = 0;
+	}
+
+	// Routine to set the color of the points that follow.
+	void color(float r, float g, float b, float a = 1.0)
+	{
+		const float c[4] = { r, g, b, a };
+		for (int k = 0; k < 4; k++)
+			currentColor[k] = (unsigned char)((c[k] < 0.0 ? 0.0 : (c[k] > 1.0 ? 1.0 : c[k])) * 255.0 + 0.5);
+	}
+
+	// Routine to add the next point of the current polyline.
+	void vertex(float x, float y, float z)
+	{
+		WideLinePoint p = { x, y, z, 0.0, { currentColor[0], currentColor[1], currentColor[2], currentColor[3] } };
+		points.push_back(p);
+	}
+
+	// Routine to end the current polyline; the next point starts a new one.
+	void endLine(void)
+	{
+		if (!points.empty()) points.back().end = 1.0;
+	}
+
+	// Routine to empty the point list, e.g. to refill it each frame.
+	void clear(void)
+	{
+		points.clear();
+	}
+
+	// Routine to copy the point list into the buffer, replacing what it held.
+	void upload(void)
+	{
+		endLine();
+		numPoints = (int)points.size();
+		numSegments = 0;
+		for (int i = 0; i + 1 < numPoints; i++)
+			if (points[i].end == 0.0) numSegments++;
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(WideLinePoint), points.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	// Routine to draw the uploaded polylines width pixels wide, anti-aliased if
+	// smooth, with the current matrices and viewport.
+	void draw(float width, bool smooth = true)
+	{
+		if (numPoints < 2) return;
+		int view[4];
+		glGetIntegerv(GL_VIEWPORT, view);
+		GLboolean blend = glIsEnabled(GL_BLEND);
+
+		glUseProgram(program);
+		glUniform4f(viewportLoc, (float)view[0], (float)view[1], (float)view[2], (float)view[3]);
+		glUniform1f(halfWidthLoc, 0.5f * width);
+		glUniform1i(smoothedLoc, smooth ? 1 : 0);
+		if (smooth)
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		glBindVertexArray(vao);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, numPoints - 1);
+		glBindVertexArray(0);
+		glUseProgram(0);
+		if (smooth && !blend) glDisable(GL_BLEND);
+	}
+
+	int numSegments; // Segments in the buffer.
+
+private:
+	std::vector<WideLinePoint> points; // Point list.
+	unsigned char currentColor[4]; // RGBA8 of the next point.
+	unsigned int program, vao, buffer; // GL objects.
+	int viewportLoc, halfWidthLoc, smoothedLoc; // Uniform locations.
+	int numPoints; // Points in the buffer.
+};
+
+#endif
@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////////
+// workerPool.h
+//
+// A minimal persistent pool of worker threads which run a function over disjoint
+// parts of a range, shared by the demos that spread per-frame CPU work over cores.
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Pool of numWorkers threads. run() splits a job into parts, one a thread;
+// the calling thread takes part 0 itself.
+class WorkerPool
+{
+public:
+	WorkerPool(int numWorkers) : generation(0), pending(0), quit(false)
+	{
+		for (int i = 1; i <= numWorkers; i++) workers.push_back(std::thread(&WorkerPool::work, this, i));
+	}
+
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (auto &w : workers) w.join();
+	}
+
+	int size(void) const { return (int)workers.size() + 1; }
+
+	// Run job(part, parts) on parts = numParts threads and wait for all to finish.
+	void run(int numParts, const std::function<void(int, int)> &job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			task = job;
+			parts = numParts;
+			pending = numParts - 1;
+			generation++;
+		}
+		wake.notify_all();
+		job(0, numParts);
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this] { return pending == 0; });
+	}
+
+private:
+	void work(int index)
+	{
+		unsigned long long seen = 0;
+		for (;;)
+		{
+			std::function<void(int, int)> job;
+			int numParts;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return quit || generation != seen; });
+				if (quit) return;
+				seen = generation;
+				job = task;
+				numParts = parts;
+			}
+			if (index < numParts)
+			{
+				job(index, numParts);
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--pending == 0) done.notify_one();
+			}
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	std::function<void(int, int)> task;
+	unsigned long long generation;
+	int parts, pending;
+	bool quit;
+};
+
+#endif
@@ -2,72 +2,26 @@
 // experimentTwoSquares.cpp
 // (modifying square.cpp)
 // 
+// The squares are drawn by the unit ExperimentTwoSquares
+// (experimentTwoSquares.h), which the launcher runs too.
+//
 // Sumanta Guha.
 ////////////////////////////////////////////////////
 
 #include <GL/glew.h>
 #include <GL/freeglut.h> 
 
-// Drawing routine.
-void drawScene(void)
-{
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	// Draw a large red square.
-	glColor3f(1.0, 0.0, 0.0);
-	glBegin(GL_POLYGON);
-	glVertex3f(20.0, 20.0, 0.0);
-	glVertex3f(80.0, 20.0, 0.0);
-	glVertex3f(80.0, 80.0, 0.0);
-	glVertex3f(20.0, 80.0, 0.0);
-	glEnd();
-
-	// Draw a smaller green square.
-	glColor3f(0.0, 1.0, 0.0);
-	glBegin(GL_POLYGON);
-	glVertex3f(40.0, 40.0, 0.0);
-	glVertex3f(60.0, 40.0, 0.0);
-	glVertex3f(60.0, 60.0, 0.0);
-	glVertex3f(40.0, 60.0, 0.0);
-	glEnd();
-
-	glFlush();
-}
-
-// Initialization routine.
-void setup(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-}
+#define DEMO_GL_TRACE
+#include "../Common/demoHooks.h"
+#include "experimentTwoSquares.h"
 
-// OpenGL window reshape routine.
-void resize(int w, int h)
-{
-	glViewport(0, 0, w, h);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-}
-
-// Keyboard input processing routine.
-void keyInput(unsigned char key, int x, int y)
-{
-	switch (key)
-	{
-	case 27:
-		exit(0);
-		break;
-	default:
-		break;
-	}
-}
+static ExperimentTwoSquares experimentTwoSquares; // The demo.
 
 // Main routine.
 int main(int argc, char **argv)
 {
 	glutInit(&argc, argv);
+	demoInit(&argc, argv);
 
 	glutInitContextVersion(4, 3);
 	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
@@ -76,14 +30,9 @@ int main(int argc, char **argv)
 	glutInitWindowSize(500, 500);
 	glutInitWindowPosition(100, 100);
 	glutCreateWindow("experimentTwoSquares.cpp");
-	glutDisplayFunc(drawScene);
-	glutReshapeFunc(resize);
-	glutKeyboardFunc(keyInput);
-
-	glewExperimental = GL_TRUE;
-	glewInit();
+	demoUnitCallbacks(&experimentTwoSquares);
 
-	setup();
+	demoSetup(&experimentTwoSquares);
 
 	glutMainLoop();
 }
\ No newline at end of file
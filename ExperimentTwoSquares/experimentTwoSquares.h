@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////
+// experimentTwoSquares.h
+//
+// The two squares of experimentTwoSquares.cpp as a demo unit (demoUnit.h): its
+// routines, run by experimentTwoSquares.cpp and by the launcher.
+////////////////////////////////////////////////////
+
+#ifndef EXPERIMENT_TWO_SQUARES_H
+#define EXPERIMENT_TWO_SQUARES_H
+
+#include "../Common/demoUnit.h"
+
+class ExperimentTwoSquares : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+};
+
+// Drawing routine.
+inline void ExperimentTwoSquares::drawScene(void)
+{
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	PROFILE_PHASE("squares");
+	// Draw a large red square.
+	glColor3f(1.0, 0.0, 0.0);
+	glBegin(GL_POLYGON);
+	glVertex3f(20.0, 20.0, 0.0);
+	glVertex3f(80.0, 20.0, 0.0);
+	glVertex3f(80.0, 80.0, 0.0);
+	glVertex3f(20.0, 80.0, 0.0);
+	glEnd();
+
+	// Draw a smaller green square.
+	glColor3f(0.0, 1.0, 0.0);
+	glBegin(GL_POLYGON);
+	glVertex3f(40.0, 40.0, 0.0);
+	glVertex3f(60.0, 40.0, 0.0);
+	glVertex3f(60.0, 60.0, 0.0);
+	glVertex3f(40.0, 60.0, 0.0);
+	glEnd();
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+inline void ExperimentTwoSquares::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void ExperimentTwoSquares::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+inline void ExperimentTwoSquares::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	default:
+		break;
+	}
+}
+
+#endif
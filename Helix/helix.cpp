@@ -3,6 +3,17 @@
 //
 // This program approximates a helix with a line strip.
 //
+// The helix can also be drawn as a wide, anti-aliased polyline by wideLines.h,
+// one instanced draw of its segments, in place of the 1-pixel GL_LINE_STRIP.
+//
+// Interaction:
+// Press w to toggle between the line strip and wide lines.
+// Press +/- to widen/narrow the wide lines.
+// Press a to toggle anti-aliasing of the wide lines.
+//
+// The helix's globals and routines are those of the unit Helix (helix.h),
+// which the launcher runs too.
+//
 // Sumanta Guha.
 ///////////////////////////////////////////////////////        
 
@@ -15,60 +26,18 @@
 #include <GL/glew.h>
 #include <GL/freeglut.h>
 
-// Drawing routine.
-void drawScene(void)
-{
-	float R = 20.0; // Radius of helix.
-
-	float t; // Angle parameter.
-
-	glClear(GL_COLOR_BUFFER_BIT);
-	glColor3f(0.0, 0.0, 0.0);
-
-	glBegin(GL_LINE_STRIP);
-	for (t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
-       //glVertex3f(R * cos(t), R * sin(t), t - 60.0);
-	   glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
-	glEnd();
-
-	glFlush();
-}
-
-// Initialization routine.
-void setup(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-}
+#define DEMO_GL_TRACE
+#include "../Common/demoHooks.h"
+#include "helix.h"
 
-// OpenGL window reshape routine.
-void resize(int w, int h)
-{
-	glViewport(0, 0, w, h);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(-50.0, 50.0, -50.0, 50.0, 0.0, 100.0);
-	//glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-}
-
-// Keyboard input processing routine.
-void keyInput(unsigned char key, int x, int y)
-{
-	switch (key)
-	{
-	case 27:
-		exit(0);
-		break;
-	default:
-		break;
-	}
-}
+static Helix helix; // The demo.
 
 // Main routine.
 int main(int argc, char **argv)
 {
+	helix.printInteraction();
 	glutInit(&argc, argv);
+	demoInit(&argc, argv);
 
 	glutInitContextVersion(4, 3);
 	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
@@ -77,14 +46,9 @@ int main(int argc, char **argv)
 	glutInitWindowSize(500, 500);
 	glutInitWindowPosition(100, 100);
 	glutCreateWindow("helix.cpp");
-	glutDisplayFunc(drawScene);
-	glutReshapeFunc(resize);
-	glutKeyboardFunc(keyInput);
-
-	glewExperimental = GL_TRUE;
-	glewInit();
+	demoUnitCallbacks(&helix);
 
-	setup();
+	demoSetup(&helix);
 
 	glutMainLoop();
 }
@@ -0,0 +1,142 @@
+///////////////////////////////////////////////////////
+// helix.h
+//
+// The helix of helix.cpp as a demo unit (demoUnit.h): its globals and routines,
+// run by helix.cpp and by the launcher.
+///////////////////////////////////////////////////////
+
+#ifndef HELIX_H
+#define HELIX_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+#include "../Common/wideLines.h"
+
+class Helix : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void build(void);
+	void setup(void);
+	void destroy(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void printInteraction(void);
+
+	// Globals.
+	int isWide = 0; // Draw with wide lines?
+	float lineWidth = 3.0; // Width of the wide lines in pixels.
+	int isSmooth = 1; // Anti-alias the wide lines?
+	WideLines helix; // The helix as wide lines.
+};
+
+// Drawing routine.
+inline void Helix::drawScene(void)
+{
+	float R = 20.0; // Radius of helix.
+
+	float t; // Angle parameter.
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+
+	PROFILE_PHASE("helix");
+	if (isWide) helix.draw(lineWidth, isSmooth != 0);
+	else
+	{
+		glBegin(GL_LINE_STRIP);
+		for (t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
+		   //glVertex3f(R * cos(t), R * sin(t), t - 60.0);
+		   glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
+		glEnd();
+	}
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Routine to build the wide lines, once.
+inline void Helix::build(void)
+{
+	float R = 20.0; // Radius of helix.
+
+	// The same helix as drawScene()'s line strip, for the wide lines.
+	helix.init();
+	helix.color(0.0, 0.0, 0.0);
+	for (float t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
+		helix.vertex(R * cos(t), t, R * sin(t) - 60.0);
+	helix.endLine();
+	helix.upload();
+}
+
+// Initialization routine.
+inline void Helix::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// Routine to release the wide lines.
+inline void Helix::destroy(void)
+{
+	helix.destroy();
+}
+
+// OpenGL window reshape routine.
+inline void Helix::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(-50.0, 50.0, -50.0, 50.0, 0.0, 100.0);
+	//glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+inline void Helix::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'w':
+		if (isWide) isWide = 0; else isWide = 1;
+		std::cout << (isWide ? "Wide lines: " : "Line strip: ") << helix.numSegments << " segments" << std::endl;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (lineWidth < 32.0) lineWidth += 1.0;
+		glutPostRedisplay();
+		break;
+	case '-':
+		if (lineWidth > 1.0) lineWidth -= 1.0;
+		glutPostRedisplay();
+		break;
+	case 'a':
+		if (isSmooth) isSmooth = 0; else isSmooth = 1;
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void Helix::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press w to toggle between the line strip and wide lines." << std::endl
+		<< "Press +/- to widen/narrow the wide lines." << std::endl
+		<< "Press a to toggle anti-aliasing of the wide lines." << std::endl;
+}
+
+#endif
@@ -0,0 +1,470 @@
+////////////////////////////////////////////////////////////////////////////////////
+// helixField.cpp
+//
+// This program enhances rotatingHelix3.cpp to draw a field of helices laid out on
+// a square grid, each turning about its own axis at its own speed.
+//
+// Preparing a frame - computing each helix's modelview matrix, culling it against
+// the viewing frustum and choosing one of three levels of detail by distance - is
+// split across a pool of worker threads. Each worker records the uniforms and draw
+// of every visible helix of its share of the grid into a command buffer of its own
+// (commandBuffer.h); the GLUT thread then replays the buffers in order, which is the
+// only place GL is called. For comparison, the frame can also be prepared and
+// submitted inline on the GLUT thread.
+//
+// Interaction:
+// Press space to toggle between animation on and off.
+// Press the left/right arrow keys to turn the viewer.
+// Press n/N to halve/double the number of helices.
+// Press t/T to decrease/increase the number of worker threads.
+// Press m to toggle between recording on the workers and submitting inline.
+// Press b to time recording and replay for 1, 2, ... all threads.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/vecmath.h"
+#include "../Common/bvh.h"
+#include "../Common/workerPool.h"
+#include "../Common/commandBuffer.h"
+#include "../Common/programCache.h"
+#include "../Common/demoHooks.h"
+
+#define R 20.0 // Radius of a helix.
+#define SPACING 50.0 // Distance between neighbouring helices.
+#define HELIX_RADIUS 37.5 // Radius of the bounding sphere of a helix.
+#define NUM_LODS 3 // Levels of detail.
+
+// What drawing one helix takes.
+struct HelixDraw
+{
+	Mat4 modelview;
+	float r, g, b;
+	int lod;
+};
+
+// Globals.
+static int isAnimate = 0; // Animated?
+static int animationPeriod = 50; // Time interval between frames.
+static float yaw = 0.0; // Turn of the viewer.
+static int numHelices = 4096; // Number of helices.
+static int numThreads = 1; // Number of threads preparing the frame.
+static int isRecorded = 1; // Record on the workers rather than submit inline?
+static std::vector<float> posX, posZ; // Position of each helix.
+static std::vector<float> angle, rate; // Angle of rotation and its step of each helix.
+static WorkerPool *pool = NULL;
+static std::vector<CommandBuffer> buffers; // One command buffer a thread.
+static std::vector<int> drawnCounts; // Helices drawn by each thread.
+static ReplayStats replayStats; // Statistics of the last replay.
+static double prepareMillis = 0.0, submitMillis = 0.0; // Times of the last frame.
+static Mat4 projectionMatrix; // Projection.
+static MatrixUniform projectionUniform; // Projection uniform.
+static int modelviewLoc, colorLoc; // Uniform locations.
+static unsigned int program, vao, vertexBuffer; // GL objects.
+static int lodFirst[NUM_LODS], lodCount[NUM_LODS]; // Vertex range of each level of detail.
+static char theStringBuffer[128]; // String buffer.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+static const char *vertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 position;\n"
+"uniform mat4 projectionMatrix;\n"
+"uniform mat4 modelviewMatrix;\n"
+"void main(void)\n"
+"{\n"
+"	gl_Position = projectionMatrix * modelviewMatrix * vec4(position, 1.0);\n"
+"}\n";
+
+static const char *fragmentShaderSource =
+"#version 430 compatibility\n"
+"uniform vec4 color;\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"	fragColor = color;\n"
+"}\n";
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to lay out the helices on a square grid receding from the viewer.
+void createField(void)
+{
+	int side = (int)ceil(sqrt((float)numHelices));
+
+	posX.resize(numHelices); posZ.resize(numHelices);
+	angle.resize(numHelices); rate.resize(numHelices);
+	srand(1);
+	for (int i = 0; i < numHelices; i++)
+	{
+		posX[i] = SPACING * (i % side - 0.5 * (side - 1));
+		posZ[i] = -60.0 - SPACING * (i / side);
+		angle[i] = 360.0 * rand() / RAND_MAX;
+		rate[i] = 2.0 + 8.0 * rand() / RAND_MAX;
+	}
+}
+
+// Routine to compute the viewing transformation.
+Mat4 viewMatrix(void)
+{
+	return Mat4::rotation(yaw, 0.0, 1.0, 0.0) *
+		Mat4::lookAtRotation(0.0, 60.0, 40.0, 0.0, 0.0, -200.0, 0.0, 1.0, 0.0) * Mat4::translation(0.0, -60.0, -40.0);
+}
+
+// Routine to prepare helix i: returns 0 if it is outside the frustum, else fills in d.
+int prepareHelix(int i, const Mat4 &view, const Frustum &f, HelixDraw &d)
+{
+	float x = posX[i], z = posZ[i];
+
+	for (int k = 0; k < 6; k++)
+		if (f.nx[k] * x + f.nz[k] * z + f.d[k] < -HELIX_RADIUS) return 0;
+
+	d.modelview = view * Mat4::translation(x, 0.0, z) * Mat4::rotation(angle[i], 0.0, 1.0, 0.0);
+
+	// Level of detail from the eye space distance.
+	float dist = sqrt(d.modelview.m[12] * d.modelview.m[12] + d.modelview.m[14] * d.modelview.m[14]);
+	d.lod = dist < 300.0 ? 0 : (dist < 700.0 ? 1 : 2);
+
+	// Color from the position in the grid.
+	d.r = 0.5 + 0.5 * sin(0.01 * x);
+	d.g = 0.5 + 0.5 * sin(0.01 * z + 2.0);
+	d.b = 0.5 + 0.5 * sin(0.01 * (x + z) + 4.0);
+	return 1;
+}
+
+// Routine to compute the frustum of the projection and view.
+void viewFrustum(const Mat4 &view, Frustum &f)
+{
+	f.fromMatrix((projectionMatrix * view).m);
+}
+
+// Routine to record the helices of each thread's share of the grid into its buffer.
+void recordFrame(int threads)
+{
+	Mat4 view = viewMatrix();
+	Frustum f;
+
+	viewFrustum(view, f);
+	pool->run(threads, [&view, &f](int part, int parts)
+	{
+		PROFILE_ZONE("record helices");
+		CommandBuffer &cb = buffers[part];
+		int first = (int)((long long)numHelices * part / parts), last = (int)((long long)numHelices * (part + 1) / parts);
+		HelixDraw d;
+
+		cb.reset();
+		drawnCounts[part] = 0;
+		cb.useProgram(program);
+		cb.bindVertexArray(vao);
+		for (int i = first; i < last; i++)
+		{
+			if (!prepareHelix(i, view, f, d)) continue;
+			cb.uniformColor(colorLoc, d.r, d.g, d.b);
+			cb.uniformMatrix(modelviewLoc, d.modelview);
+			cb.drawArrays(GL_LINE_STRIP, lodFirst[d.lod], lodCount[d.lod]);
+			drawnCounts[part]++;
+		}
+	});
+}
+
+// Routine to prepare and draw every helix on this thread, calling GL directly.
+int submitInline(void)
+{
+	Mat4 view = viewMatrix();
+	Frustum f;
+	HelixDraw d;
+	int drawn = 0;
+
+	viewFrustum(view, f);
+	glUseProgram(program);
+	glBindVertexArray(vao);
+	for (int i = 0; i < numHelices; i++)
+	{
+		if (!prepareHelix(i, view, f, d)) continue;
+		glUniform4f(colorLoc, d.r, d.g, d.b, 1.0);
+		glUniformMatrix4fv(modelviewLoc, 1, GL_FALSE, d.modelview.m);
+		glDrawArrays(GL_LINE_STRIP, lodFirst[d.lod], lodCount[d.lod]);
+		drawn++;
+	}
+	return drawn;
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	int drawn = 0;
+	size_t bytes = 0;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glUseProgram(program);
+	projectionUniform.set(projectionMatrix);
+
+	if (isRecorded)
+	{
+		PROFILE_PHASE("record");
+		auto start = std::chrono::high_resolution_clock::now();
+		recordFrame(numThreads);
+		auto recorded = std::chrono::high_resolution_clock::now();
+		PROFILE_PHASE("replay");
+		replayCommands(buffers.data(), numThreads, replayStats);
+		glFinish();
+		prepareMillis = std::chrono::duration<double, std::milli>(recorded - start).count();
+		submitMillis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recorded).count();
+		for (int i = 0; i < numThreads; i++)
+		{
+			drawn += drawnCounts[i];
+			bytes += buffers[i].size();
+		}
+	}
+	else
+	{
+		PROFILE_PHASE("submit inline");
+		auto start = std::chrono::high_resolution_clock::now();
+		drawn = submitInline();
+		glFinish();
+		prepareMillis = 0.0;
+		submitMillis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+	glBindVertexArray(0);
+	glUseProgram(0);
+
+	PROFILE_PHASE("text");
+	// Write the statistics.
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(theStringBuffer, "%d of %d helices drawn, %s", drawn, numHelices,
+		isRecorded ? "recorded" : "inline");
+	glWindowPos2i(5, 35);
+	writeBitmapString((void*)font, theStringBuffer);
+	if (isRecorded)
+	{
+		sprintf(theStringBuffer, "Record %.2f ms on %d threads, replay %.2f ms", prepareMillis, numThreads, submitMillis);
+		glWindowPos2i(5, 20);
+		writeBitmapString((void*)font, theStringBuffer);
+		sprintf(theStringBuffer, "%d packets, %d KB, %d redundant dropped", replayStats.commands, (int)(bytes >> 10),
+			replayStats.redundant);
+	}
+	else sprintf(theStringBuffer, "Prepare and submit %.2f ms", submitMillis);
+	glWindowPos2i(5, 5);
+	writeBitmapString((void*)font, theStringBuffer);
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Routine to time recording and replay for each thread count from 1 to the pool size,
+// and inline submission.
+void benchmark(void)
+{
+	const int frames = 20;
+
+	std::cout << numHelices << " helices. Threads, record ms, replay ms:" << std::endl;
+	glUseProgram(program);
+	projectionUniform.set(projectionMatrix);
+	for (int threads = 1; threads <= pool->size(); threads++)
+	{
+		double record = 0.0, replay = 0.0;
+		for (int i = 0; i < frames; i++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			recordFrame(threads);
+			auto recorded = std::chrono::high_resolution_clock::now();
+			replayCommands(buffers.data(), threads, replayStats);
+			glFinish();
+			record += std::chrono::duration<double, std::milli>(recorded - start).count();
+			replay += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recorded).count();
+		}
+		std::cout << threads << ", " << record / frames << ", " << replay / frames << std::endl;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < frames; i++) submitInline();
+	glFinish();
+	std::cout << "Inline prepare and submit: "
+		<< std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / frames
+		<< " ms" << std::endl;
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glutPostRedisplay();
+}
+
+// Routine to advance every helix's angle.
+void increaseAngles(void)
+{
+	for (int i = 0; i < numHelices; i++)
+	{
+		angle[i] += rate[i];
+		if (angle[i] > 360.0) angle[i] -= 360.0;
+	}
+}
+
+// Routine to animate with a recursive call made after animationPeriod msecs.
+void animate(int value)
+{
+	if (isAnimate)
+	{
+		increaseAngles();
+
+		glutPostRedisplay();
+		glutTimerFunc(animationPeriod, animate, 1);
+	}
+}
+
+// Initialization routine.
+void setup(void)
+{
+	std::vector<float> vertices;
+
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	program = programCacheBuild(vertexShaderSource, fragmentShaderSource);
+	projectionUniform.init(program, "projectionMatrix");
+	modelviewLoc = glGetUniformLocation(program, "modelviewMatrix");
+	colorLoc = glGetUniformLocation(program, "color");
+
+	// The helix of rotatingHelix3.cpp, centered on the origin, at steps of pi/20,
+	// pi/10 and pi/5 along it, one level of detail after the other.
+	for (int lod = 0; lod < NUM_LODS; lod++)
+	{
+		lodFirst[lod] = (int)vertices.size() / 3;
+		for (float t = -10 * M_PI; t <= 10 * M_PI + 1.0e-3; t += (M_PI / 20.0) * (1 << lod))
+		{
+			vertices.push_back(R * cos(t));
+			vertices.push_back(t);
+			vertices.push_back(R * sin(t));
+		}
+		lodCount[lod] = (int)vertices.size() / 3 - lodFirst[lod];
+	}
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &vertexBuffer);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	pool = new WorkerPool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+	numThreads = pool->size();
+	buffers.resize(pool->size());
+	drawnCounts.resize(pool->size());
+
+	createField();
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	projectionMatrix = Mat4::frustum(-5.0, 5.0, -5.0, 5.0, 5.0, 2000.0);
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		delete pool;
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate) isAnimate = 0;
+		else
+		{
+			isAnimate = 1;
+			animate(1);
+		}
+		break;
+	case 'n':
+		if (numHelices > 1) numHelices /= 2;
+		createField();
+		break;
+	case 'N':
+		if (numHelices < (1 << 20)) numHelices *= 2;
+		createField();
+		break;
+	case 't':
+		if (numThreads > 1) numThreads--;
+		break;
+	case 'T':
+		if (numThreads < pool->size()) numThreads++;
+		break;
+	case 'm':
+		if (isRecorded) isRecorded = 0; else isRecorded = 1;
+		break;
+	case 'b':
+		benchmark();
+		break;
+	default:
+		break;
+	}
+	glutPostRedisplay();
+}
+
+// Callback routine for non-ASCII key entry.
+void specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_LEFT) yaw -= 5.0;
+	if (key == GLUT_KEY_RIGHT) yaw += 5.0;
+	glutPostRedisplay();
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl
+		<< "Press the left/right arrow keys to turn the viewer." << std::endl
+		<< "Press n/N to halve/double the number of helices." << std::endl
+		<< "Press t/T to decrease/increase the number of worker threads." << std::endl
+		<< "Press m to toggle between recording on the workers and submitting inline." << std::endl
+		<< "Press b to time recording and replay for 1, 2, ... all threads." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("helixField.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+	glutSpecialFunc(specialKeyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
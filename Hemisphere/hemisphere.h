@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// hemisphere.h
+//
+// The hemisphere of hemisphere.cpp as a demo unit (demoUnit.h): its globals and
+// routines, run by hemisphere.cpp and by the launcher.
+///////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HEMISPHERE_H
+#define HEMISPHERE_H
+
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+
+class Hemisphere : public DemoUnit
+{
+public:
+	void build(void);
+	void setup(void);
+	void drawScene(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void printInteraction(void);
+
+	// Globals.
+	float R = 5.0; // Radius of hemisphere.
+	int p = 6; // Number of longitudinal slices.
+	int q = 4; // Number of latitudinal slices.
+	float Xangle = 0.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate hemisphere.
+};
+
+// Routine to register the quality governor's knobs, once.
+inline void Hemisphere::build(void)
+{
+	governorKnob("p", &p, 3);
+	governorKnob("q", &q, 3);
+}
+
+// Initialization routine.
+inline void Hemisphere::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// Drawing routine.
+inline void Hemisphere::drawScene(void)
+{
+	int  i, j;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glLoadIdentity();
+
+	PROFILE_PHASE("hemisphere");
+	// Command to push the hemisphere, which is drawn centered at the origin, 
+	// into the viewing frustum.
+	glTranslatef(0.0, 0.0, -10.0);
+
+	// Commands to turn the hemisphere.
+	glRotatef(Zangle, 0.0, 0.0, 1.0);
+	glRotatef(Yangle, 0.0, 1.0, 0.0);
+	glRotatef(Xangle, 1.0, 0.0, 0.0);
+
+	// Hemisphere properties.
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	glColor3f(0.0, 0.0, 0.0);
+
+	// Array of latitudinal triangle strips, each parallel to the equator, stacked one
+	// above the other from the equator to the north pole.
+	for (j = 0; j < q; j++)
+	{
+		// One latitudinal triangle strip.
+		glBegin(GL_TRIANGLE_STRIP);
+		for (i = 0; i <= p; i++)
+		{
+			glVertex3f(R * cos((float)(j + 1) / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI),
+				R * sin((float)(j + 1) / q * M_PI / 2.0),
+				-R * cos((float)(j + 1) / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+			glVertex3f(R * cos((float)j / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI),
+				R * sin((float)j / q * M_PI / 2.0),
+				-R * cos((float)j / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+		}
+		glEnd();
+	}
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// OpenGL window reshape routine.
+inline void Hemisphere::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+inline void Hemisphere::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'P':
+		p += 1;
+		glutPostRedisplay();
+		break;
+	case 'p':
+		if (p > 3) p -= 1;
+		glutPostRedisplay();
+		break;
+	case 'Q':
+		q += 1;
+		glutPostRedisplay();
+		break;
+	case 'q':
+		if (q > 3) q -= 1;
+		glutPostRedisplay();
+		break;
+	case 'x':
+		Xangle += 5.0;
+		if (Xangle > 360.0) Xangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'X':
+		Xangle -= 5.0;
+		if (Xangle < 0.0) Xangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'y':
+		Yangle += 5.0;
+		if (Yangle > 360.0) Yangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Y':
+		Yangle -= 5.0;
+		if (Yangle < 0.0) Yangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'z':
+		Zangle += 5.0;
+		if (Zangle > 360.0) Zangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Z':
+		Zangle -= 5.0;
+		if (Zangle < 0.0) Zangle += 360.0;
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void Hemisphere::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press P/p to increase/decrease the number of longitudinal slices." << std::endl
+		<< "Press Q/q to increase/decrease the number of latitudinal slices." << std::endl
+		<< "Press x, X, y, Y, z, Z to turn the hemisphere." << std::endl;
+}
+
+#endif
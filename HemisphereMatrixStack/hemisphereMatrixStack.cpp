@@ -0,0 +1,588 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// hemisphereMatrixStack.cpp
+// (modifying hemisphere.cpp)
+//
+// This program draws the hemisphere of hemisphere.cpp with a vertex shader, the
+// projection and modelview matrices being computed on the CPU by the matrix stacks
+// of vecmath.h instead of by glFrustum(), gluPerspective(), glTranslatef() and
+// glRotatef() in the driver. The matrices are uploaded as shader uniforms only when
+// they change: the projection on a reshape, the modelview when the hemisphere turns.
+// The fixed-function path, with the driver's matrices, is kept for comparison.
+//
+// The matrices of the transformation sequences of hemisphere.cpp, hemispherePerspective.cpp,
+// clown3.cpp and lightAndMaterial2.cpp can be compared element by element
+// with the driver's, and the two paths timed against each other.
+//
+// Interaction:
+// Press P/p to increase/decrease the number of longitudinal slices.
+// Press Q/q to increase/decrease the number of latitudinal slices.
+// Press x, X, y, Y, z, Z to turn the hemisphere.
+// Press f to toggle between glFrustum() and gluPerspective() projection.
+// Press m to toggle between the CPU matrix stacks and the driver's matrices.
+// Press v to compare the CPU matrices with the driver's.
+// Press b to time the CPU matrix stack against the driver's.
+// Press h to toggle a high-resolution hemisphere, p = q = 1024, kept in the mesh cache.
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/vecmath.h"
+#include "../Common/meshCache.h"
+#include "../Common/programCache.h"
+#include "../Common/demoHooks.h"
+
+#define CACHED_VERTICES 100000 // Hemispheres of at least this many vertices come from the mesh cache.
+
+// A call to a matrix routine with its arguments.
+struct MatrixOp
+{
+	enum Type { IDENTITY, PUSH, POP, TRANSLATE, ROTATE, SCALE, FRUSTUM, PERSPECTIVE, ORTHO, LOOKAT } type;
+	float a[9];
+};
+
+// Globals.
+static float R = 5.0; // Radius of hemisphere.
+static int p = 6; // Number of longitudinal slices.
+static int q = 4; // Number of latitudinal slices.
+static int savedP = 0, savedQ = 0; // Slices to return to from the high-resolution hemisphere, 0 if not shown.
+static float Xangle = 0.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate hemisphere.
+static int isPerspective = 0; // gluPerspective() rather than glFrustum()?
+static int isCpuStack = 1; // Draw with the CPU matrix stacks?
+static int width = 500, height = 500; // Window size.
+static MatrixStack projection, modelview; // CPU matrix stacks.
+static MatrixUniform projectionUniform, modelviewUniform; // Shader matrix uniforms.
+static unsigned int program, vao, buffer; // Shader program, vertex array and buffer.
+static int numVertices = 0; // Vertices in the buffer.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+static const char *vertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 position;\n"
+"uniform mat4 projectionMatrix;\n"
+"uniform mat4 modelviewMatrix;\n"
+"void main(void)\n"
+"{\n"
+"	gl_Position = projectionMatrix * modelviewMatrix * vec4(position, 1.0);\n"
+"}\n";
+
+static const char *fragmentShaderSource =
+"#version 430 compatibility\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"	fragColor = vec4(0.0, 0.0, 0.0, 1.0);\n"
+"}\n";
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to apply a sequence of matrix operations to a CPU stack or, if stack is
+// NULL, to the driver's current matrix.
+void applyOps(const std::vector<MatrixOp> &ops, MatrixStack *stack)
+{
+	for (size_t i = 0; i < ops.size(); i++)
+	{
+		const float *a = ops[i].a;
+		switch (ops[i].type)
+		{
+		case MatrixOp::IDENTITY:
+			if (stack) stack->loadIdentity(); else glLoadIdentity();
+			break;
+		case MatrixOp::PUSH:
+			if (stack) stack->pushMatrix(); else glPushMatrix();
+			break;
+		case MatrixOp::POP:
+			if (stack) stack->popMatrix(); else glPopMatrix();
+			break;
+		case MatrixOp::TRANSLATE:
+			if (stack) stack->translate(a[0], a[1], a[2]); else glTranslatef(a[0], a[1], a[2]);
+			break;
+		case MatrixOp::ROTATE:
+			if (stack) stack->rotate(a[0], a[1], a[2], a[3]); else glRotatef(a[0], a[1], a[2], a[3]);
+			break;
+		case MatrixOp::SCALE:
+			if (stack) stack->scale(a[0], a[1], a[2]); else glScalef(a[0], a[1], a[2]);
+			break;
+		case MatrixOp::FRUSTUM:
+			if (stack) stack->frustum(a[0], a[1], a[2], a[3], a[4], a[5]);
+			else glFrustum(a[0], a[1], a[2], a[3], a[4], a[5]);
+			break;
+		case MatrixOp::PERSPECTIVE:
+			if (stack) stack->perspective(a[0], a[1], a[2], a[3]); else gluPerspective(a[0], a[1], a[2], a[3]);
+			break;
+		case MatrixOp::ORTHO:
+			if (stack) stack->ortho(a[0], a[1], a[2], a[3], a[4], a[5]);
+			else glOrtho(a[0], a[1], a[2], a[3], a[4], a[5]);
+			break;
+		case MatrixOp::LOOKAT:
+			if (stack) stack->lookAt(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+			else gluLookAt(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+			break;
+		}
+	}
+}
+
+// Routine to append an operation to a sequence.
+void addOp(std::vector<MatrixOp> &ops, MatrixOp::Type type, float a0 = 0.0, float a1 = 0.0, float a2 = 0.0,
+	float a3 = 0.0, float a4 = 0.0, float a5 = 0.0, float a6 = 0.0, float a7 = 0.0, float a8 = 0.0)
+{
+	MatrixOp op = { type, { a0, a1, a2, a3, a4, a5, a6, a7, a8 } };
+	ops.push_back(op);
+}
+
+// Routine to build the modelview sequence of hemisphere.cpp at the given angles.
+void hemisphereOps(std::vector<MatrixOp> &ops, float xAngle, float yAngle, float zAngle)
+{
+	ops.clear();
+	addOp(ops, MatrixOp::IDENTITY);
+	addOp(ops, MatrixOp::TRANSLATE, 0.0, 0.0, -10.0);
+	addOp(ops, MatrixOp::ROTATE, zAngle, 0.0, 0.0, 1.0);
+	addOp(ops, MatrixOp::ROTATE, yAngle, 0.0, 1.0, 0.0);
+	addOp(ops, MatrixOp::ROTATE, xAngle, 1.0, 0.0, 0.0);
+}
+
+// Routine to build the projection sequence of the current mode.
+void projectionOps(std::vector<MatrixOp> &ops)
+{
+	ops.clear();
+	addOp(ops, MatrixOp::IDENTITY);
+	if (isPerspective) addOp(ops, MatrixOp::PERSPECTIVE, 90.0, (float)width / (float)height, 5.0, 100.0);
+	else addOp(ops, MatrixOp::FRUSTUM, -5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+}
+
+// Routine to build a modelview sequence from the transformations of clown3.cpp at the given
+// angle: those of the hat, an ear's pushed and popped, then those of the right spring.
+void clownOps(std::vector<MatrixOp> &ops, float angle)
+{
+	float s = sin((M_PI / 180.0) * angle);
+
+	ops.clear();
+	addOp(ops, MatrixOp::IDENTITY);
+	addOp(ops, MatrixOp::TRANSLATE, 0.0, 0.0, -9.0);
+	addOp(ops, MatrixOp::ROTATE, angle, 0.0, 1.0, 0.0);
+	addOp(ops, MatrixOp::ROTATE, 30.0, 0.0, 0.0, 1.0);
+	addOp(ops, MatrixOp::ROTATE, -90.0, 1.0, 0.0, 0.0);
+	addOp(ops, MatrixOp::TRANSLATE, 0.0, 0.0, 2.0);
+	addOp(ops, MatrixOp::PUSH);
+	addOp(ops, MatrixOp::TRANSLATE, s, 0.0, 0.0);
+	addOp(ops, MatrixOp::TRANSLATE, 3.5, 0.0, 0.0);
+	addOp(ops, MatrixOp::POP);
+	addOp(ops, MatrixOp::TRANSLATE, 2.0, 0.0, 0.0);
+	addOp(ops, MatrixOp::SCALE, 1 + s, 1.0, 1.0);
+}
+
+// Routine to build the projection and light modelview sequences of lightAndMaterial2.cpp.
+void lightOps(std::vector<MatrixOp> &ops, float xAngle, float yAngle)
+{
+	ops.clear();
+	addOp(ops, MatrixOp::IDENTITY);
+	addOp(ops, MatrixOp::PERSPECTIVE, 60.0, 1.0, 1.0, 20.0);
+	addOp(ops, MatrixOp::LOOKAT, 0.0, 3.0, 5.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+	addOp(ops, MatrixOp::ROTATE, xAngle, 1.0, 0.0, 0.0);
+	addOp(ops, MatrixOp::ROTATE, yAngle, 0.0, 1.0, 0.0);
+	addOp(ops, MatrixOp::TRANSLATE, 0.0, 1.5, 3.0);
+}
+
+// Routine to build a sequence rotating about an oblique axis, with glOrtho() of circularAnnuluses.cpp.
+void obliqueOps(std::vector<MatrixOp> &ops, float angle)
+{
+	ops.clear();
+	addOp(ops, MatrixOp::IDENTITY);
+	addOp(ops, MatrixOp::ORTHO, 0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	addOp(ops, MatrixOp::ROTATE, angle, 1.0, 2.0, 3.0);
+	addOp(ops, MatrixOp::SCALE, 0.5, 2.0, -1.0);
+}
+
+// Routine to compare the matrix of a sequence computed by a CPU stack and by the
+// driver, accumulating the number of bit-identical elements and the largest difference.
+void compareOps(const std::vector<MatrixOp> &ops, int &same, int &total, float &maxDiff)
+{
+	MatrixStack stack;
+	float m[16];
+
+	applyOps(ops, &stack);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	applyOps(ops, NULL);
+	glGetFloatv(GL_MODELVIEW_MATRIX, m);
+	glPopMatrix();
+
+	for (int i = 0; i < 16; i++)
+	{
+		float d = fabs(m[i] - stack.top().m[i]);
+		if (m[i] == stack.top().m[i]) same++;
+		if (d > maxDiff) maxDiff = d;
+		total++;
+	}
+}
+
+// Routine to compare the CPU matrices with the driver's for every sequence, over a sweep of angles.
+void verify(void)
+{
+	const char *names[] = { "hemisphere.cpp modelview", "hemispherePerspective.cpp projection", "hemisphere.cpp projection",
+		"clown3.cpp", "lightAndMaterial2.cpp", "oblique axis" };
+	std::vector<MatrixOp> ops;
+	int savedIsPerspective = isPerspective;
+
+	std::cout << "Sequence: bit-identical elements, largest difference" << std::endl;
+	for (int k = 0; k < 6; k++)
+	{
+		int same = 0, total = 0;
+		float maxDiff = 0.0;
+		for (int a = 0; a < 360; a += 5)
+		{
+			switch (k)
+			{
+			case 0: hemisphereOps(ops, a, 2 * a, 3 * a); break;
+			case 1: isPerspective = 1; projectionOps(ops); break;
+			case 2: isPerspective = 0; projectionOps(ops); break;
+			case 3: clownOps(ops, a); break;
+			case 4: lightOps(ops, a, 2 * a); break;
+			case 5: obliqueOps(ops, a); break;
+			}
+			compareOps(ops, same, total, maxDiff);
+		}
+		std::cout << names[k] << ": " << same << " of " << total << ", " << maxDiff << std::endl;
+	}
+	isPerspective = savedIsPerspective;
+}
+
+// Routine to time the transformation sequences of clown3.cpp and hemisphere.cpp on a
+// CPU stack, in the driver, and the uniform uploads with and without change tracking.
+void benchmark(void)
+{
+	const int repeats = 100000;
+	std::vector<MatrixOp> ops[2];
+	float m[16];
+	MatrixStack stack;
+	double micros[2];
+
+	clownOps(ops[0], 30.0);
+	hemisphereOps(ops[1], 10.0, 20.0, 30.0);
+
+	std::cout << "Sequence, CPU stack us, driver us:" << std::endl;
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	for (int k = 0; k < 2; k++)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < repeats; i++) applyOps(ops[k], &stack);
+		micros[0] = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+
+		glFinish();
+		start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < repeats; i++) applyOps(ops[k], NULL);
+		glGetFloatv(GL_MODELVIEW_MATRIX, m);
+		micros[1] = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+
+		std::cout << (k ? "hemisphere.cpp" : "clown3.cpp") << " (" << ops[k].size() << " calls), "
+			<< micros[0] << ", " << micros[1] << std::endl;
+	}
+	glPopMatrix();
+
+	// Upload the same modelview every time, then only when it changes.
+	MatrixUniform uniform;
+	glUseProgram(program);
+	uniform.init(program, "modelviewMatrix");
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++) glUniformMatrix4fv(uniform.location, 1, GL_FALSE, stack.top().m);
+	glFinish();
+	micros[0] = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < repeats; i++) uniform.set(stack.top());
+	glFinish();
+	micros[1] = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count() / repeats;
+	glUseProgram(0);
+	std::cout << "Unchanged modelview uniform: always uploaded " << micros[0] << " us, tracked "
+		<< micros[1] << " us (" << uniform.uploads << " uploads)" << std::endl;
+}
+
+// Routine to generate the latitudinal triangle strips of hemisphere.cpp.
+void makeHemisphere(std::vector<float> &vertices)
+{
+	for (int j = 0; j < q; j++)
+		for (int i = 0; i <= p; i++)
+		{
+			vertices.push_back(R * cos((float)(j + 1) / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * sin((float)(j + 1) / q * M_PI / 2.0));
+			vertices.push_back(-R * cos((float)(j + 1) / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * cos((float)j / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * sin((float)j / q * M_PI / 2.0));
+			vertices.push_back(-R * cos((float)j / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+		}
+}
+
+// Routine to fill the vertex buffer with the hemisphere, a large one from the mesh
+// cache, uploaded straight from the mapped file.
+void fillVertexBuffer(void)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	if (2 * (p + 1) * q >= CACHED_VERTICES)
+	{
+		float params[] = { R, (float)p, (float)q };
+		CachedMesh mesh;
+		if (mesh.load("hemisphere", params, 3, 3, [](std::vector<float> &v, std::vector<unsigned int> &) { makeHemisphere(v); }))
+		{
+			numVertices = mesh.numVertices;
+			glBufferData(GL_ARRAY_BUFFER, numVertices * 3 * sizeof(float), mesh.vertices, GL_STATIC_DRAW);
+			std::cout << "Hemisphere p = " << p << ", q = " << q << ": " << numVertices << " vertices "
+				<< (mesh.generated ? "generated and cached" : "mapped from the mesh cache") << " in " << mesh.millis << " ms" << std::endl;
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			return;
+		}
+	}
+
+	std::vector<float> vertices;
+	makeHemisphere(vertices);
+	numVertices = (int)vertices.size() / 3;
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	std::vector<MatrixOp> ops;
+	char buffer[128];
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	PROFILE_PHASE("matrices");
+	hemisphereOps(ops, Xangle, Yangle, Zangle);
+	if (isCpuStack)
+	{
+		applyOps(ops, &modelview);
+		glUseProgram(program);
+		projectionUniform.set(projection.top());
+		modelviewUniform.set(modelview.top());
+	}
+	else
+	{
+		applyOps(ops, NULL);
+		glColor3f(0.0, 0.0, 0.0);
+	}
+
+	PROFILE_PHASE("hemisphere");
+	// Hemisphere properties.
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+	// Array of latitudinal triangle strips.
+	glBindVertexArray(vao);
+	for (int j = 0; j < q; j++) glDrawArrays(GL_TRIANGLE_STRIP, 2 * (p + 1) * j, 2 * (p + 1));
+	glBindVertexArray(0);
+
+	glUseProgram(0);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	PROFILE_PHASE("text");
+	// Write the uniform upload counts.
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(buffer, "%s, %s", isCpuStack ? "CPU matrix stacks" : "driver matrices",
+		isPerspective ? "gluPerspective()" : "glFrustum()");
+	glWindowPos2i(5, 20);
+	writeBitmapString((void*)font, buffer);
+	sprintf(buffer, "Uniform uploads %lld, skipped %lld", projectionUniform.uploads + modelviewUniform.uploads,
+		projectionUniform.skipped + modelviewUniform.skipped);
+	glWindowPos2i(5, 5);
+	writeBitmapString((void*)font, buffer);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	program = programCacheBuild(vertexShaderSource, fragmentShaderSource);
+	projectionUniform.init(program, "projectionMatrix");
+	modelviewUniform.init(program, "modelviewMatrix");
+
+	// The vertex array feeds both the shader's position attribute and, for the
+	// driver's path, the fixed-function vertex array.
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &buffer);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glEnableVertexAttribArray(0);
+	glVertexPointer(3, GL_FLOAT, 0, 0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	fillVertexBuffer();
+}
+
+// Routine to set the projection, on the CPU stack and in the driver.
+void setProjection(void)
+{
+	std::vector<MatrixOp> ops;
+
+	projectionOps(ops);
+	applyOps(ops, &projection);
+	glMatrixMode(GL_PROJECTION);
+	applyOps(ops, NULL);
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	width = w;
+	height = h;
+	glViewport(0, 0, w, h);
+	setProjection();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'P':
+		p += 1;
+		fillVertexBuffer();
+		glutPostRedisplay();
+		break;
+	case 'p':
+		if (p > 3) p -= 1;
+		fillVertexBuffer();
+		glutPostRedisplay();
+		break;
+	case 'Q':
+		q += 1;
+		fillVertexBuffer();
+		glutPostRedisplay();
+		break;
+	case 'q':
+		if (q > 3) q -= 1;
+		fillVertexBuffer();
+		glutPostRedisplay();
+		break;
+	case 'x':
+		Xangle += 5.0;
+		if (Xangle > 360.0) Xangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'X':
+		Xangle -= 5.0;
+		if (Xangle < 0.0) Xangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'y':
+		Yangle += 5.0;
+		if (Yangle > 360.0) Yangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Y':
+		Yangle -= 5.0;
+		if (Yangle < 0.0) Yangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'z':
+		Zangle += 5.0;
+		if (Zangle > 360.0) Zangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Z':
+		Zangle -= 5.0;
+		if (Zangle < 0.0) Zangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'f':
+		if (isPerspective) isPerspective = 0; else isPerspective = 1;
+		setProjection();
+		glutPostRedisplay();
+		break;
+	case 'm':
+		if (isCpuStack) isCpuStack = 0; else isCpuStack = 1;
+		glutPostRedisplay();
+		break;
+	case 'v':
+		verify();
+		break;
+	case 'b':
+		benchmark();
+		break;
+	case 'h':
+		if (savedP)
+		{
+			p = savedP;
+			q = savedQ;
+			savedP = 0;
+		}
+		else
+		{
+			savedP = p;
+			savedQ = q;
+			p = q = 1024;
+		}
+		fillVertexBuffer();
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press P/p to increase/decrease the number of longitudinal slices." << std::endl
+		<< "Press Q/q to increase/decrease the number of latitudinal slices." << std::endl
+		<< "Press x, X, y, Y, z, Z to turn the hemisphere." << std::endl
+		<< "Press f to toggle between glFrustum() and gluPerspective() projection." << std::endl
+		<< "Press m to toggle between the CPU matrix stacks and the driver's matrices." << std::endl
+		<< "Press v to compare the CPU matrices with the driver's." << std::endl
+		<< "Press b to time the CPU matrix stack against the driver's." << std::endl
+		<< "Press h to toggle a high-resolution hemisphere, p = q = 1024, kept in the mesh cache." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("hemisphereMatrixStack.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
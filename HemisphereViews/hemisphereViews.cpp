@@ -0,0 +1,510 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// hemisphereViews.cpp
+// (modifying hemisphereMatrixStack.cpp)
+//
+// This program draws the hemisphere of hemisphere.cpp in up to 16 viewports at once,
+// each with its own projection: the glFrustum() of hemisphere.cpp, the
+// gluPerspective() of hemispherePerspective.cpp, a narrower gluPerspective(), a
+// glOrtho(), and further gluPerspective()s of widening field of view. So the
+// projections that hemisphere.cpp and hemispherePerspective.cpp show one at a time,
+// in separate programs, are seen side by side.
+//
+// The viewports are a viewport array, set with glViewportArrayv(), and the
+// projections a uniform array. The hemisphere is drawn in one of three ways:
+//
+// - One pass a view: glViewport() and the projection uniform are set and the
+//   hemisphere drawn again for each view, as separate programs would.
+// - Geometry shader instancing: one draw; the geometry shader runs once for each
+//   view on every triangle (layout(invocations = 16)), projecting it and sending it
+//   to its viewport with gl_ViewportIndex. Vertices are fetched and transformed by
+//   the modelview once, whatever the number of views.
+// - Instanced draw: one draw of as many instances as views; the vertex shader
+//   projects for view gl_InstanceID and writes gl_ViewportIndex itself. Needs
+//   GL_ARB_shader_viewport_layer_array, and is skipped without it.
+//
+// Each way draws the q latitudinal strips with one glMultiDrawArraysIndirect(),
+// so the last two submit the same single call for any number of views. The CPU
+// time of the submission and the GPU time of the drawing (a GL_TIME_ELAPSED query
+// read back a frame later) are written at the bottom.
+//
+// Interaction:
+// Press P/p to increase/decrease the number of longitudinal slices.
+// Press Q/q to increase/decrease the number of latitudinal slices.
+// Press x, X, y, Y, z, Z to turn the hemisphere.
+// Press +/- to add/remove a view.
+// Press m to cycle between one pass a view, geometry shader instancing and instanced draw.
+// Press h to toggle a high-resolution hemisphere, p = q = 512.
+///////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/vecmath.h"
+#include "../Common/programCache.h"
+#include "../Common/demoHooks.h"
+
+#define MAX_VIEWS 16 // Also the geometry shader's invocations.
+
+// A command of glMultiDrawArraysIndirect().
+struct DrawArraysCommand
+{
+	unsigned int count, instanceCount, first, baseInstance;
+};
+
+// Globals.
+static float R = 5.0; // Radius of hemisphere.
+static int p = 6; // Number of longitudinal slices.
+static int q = 4; // Number of latitudinal slices.
+static int savedP = 0, savedQ = 0; // Slices to return to from the high-resolution hemisphere, 0 if not shown.
+static float Xangle = 0.0, Yangle = 0.0, Zangle = 0.0; // Angles to rotate hemisphere.
+static int numViews = 4; // Views shown.
+static int maxViews = MAX_VIEWS; // Views the implementation allows.
+static int mode = 1; // 0 one pass a view, 1 geometry shader instancing, 2 instanced draw.
+static int hasLayerArray = 0; // GL_ARB_shader_viewport_layer_array?
+static int width = 500, height = 500; // Window size.
+static float viewports[4 * MAX_VIEWS]; // x, y, width, height of each view.
+static Mat4 projections[MAX_VIEWS]; // Projection of each view.
+static char viewNames[MAX_VIEWS][32]; // Projection call of each view.
+static unsigned int passProgram, geometryProgram, instancedProgram; // Shader programs of the three ways.
+static unsigned int vao, buffer, commandBuffer; // Vertex array, vertex buffer and indirect command buffer.
+static unsigned int queries[2]; // GPU timers of alternate frames.
+static int frame = 0; // Frames drawn.
+static double cpuMicros = 0.0, gpuMicros = 0.0; // Submission and drawing times.
+static int drawCalls = 0; // Draw calls of the last frame.
+static const char *modeNames[] = { "one pass a view", "geometry shader instancing", "instanced draw" };
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+static const char *passVertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 position;\n"
+"uniform mat4 projectionMatrix;\n"
+"uniform mat4 modelviewMatrix;\n"
+"void main(void)\n"
+"{\n"
+"	gl_Position = projectionMatrix * modelviewMatrix * vec4(position, 1.0);\n"
+"}\n";
+
+static const char *geometryVertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 position;\n"
+"uniform mat4 modelviewMatrix;\n"
+"void main(void)\n"
+"{\n"
+"	gl_Position = modelviewMatrix * vec4(position, 1.0);\n"
+"}\n";
+
+static const char *geometryShaderSource =
+"#version 430 compatibility\n"
+"layout(triangles, invocations = 16) in;\n"
+"layout(triangle_strip, max_vertices = 3) out;\n"
+"uniform mat4 projectionMatrices[16];\n"
+"uniform int numViews;\n"
+"void main(void)\n"
+"{\n"
+"	if (gl_InvocationID >= numViews) return;\n"
+"	for (int k = 0; k < 3; k++)\n"
+"	{\n"
+"		gl_Position = projectionMatrices[gl_InvocationID] * gl_in[k].gl_Position;\n"
+"		gl_ViewportIndex = gl_InvocationID;\n"
+"		EmitVertex();\n"
+"	}\n"
+"	EndPrimitive();\n"
+"}\n";
+
+static const char *instancedVertexShaderSource =
+"#version 430 compatibility\n"
+"#extension GL_ARB_shader_viewport_layer_array : require\n"
+"layout(location = 0) in vec3 position;\n"
+"uniform mat4 projectionMatrices[16];\n"
+"uniform mat4 modelviewMatrix;\n"
+"void main(void)\n"
+"{\n"
+"	gl_Position = projectionMatrices[gl_InstanceID] * modelviewMatrix * vec4(position, 1.0);\n"
+"	gl_ViewportIndex = gl_InstanceID;\n"
+"}\n";
+
+static const char *fragmentShaderSource =
+"#version 430 compatibility\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"	fragColor = vec4(0.0, 0.0, 0.0, 1.0);\n"
+"}\n";
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to check for an extension by name.
+int hasExtension(const char *name)
+{
+	int n = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &n);
+	for (int i = 0; i < n; i++)
+		if (!strcmp((const char *)glGetStringi(GL_EXTENSIONS, i), name)) return 1;
+	return 0;
+}
+
+// Routine to lay the views out on a grid filling the window and compute their
+// projections, perspective ones for the aspect ratio of their viewport.
+void layoutViews(void)
+{
+	int columns = (int)ceil(sqrt((float)numViews)), rows = (numViews + columns - 1) / columns;
+	float w = (float)width / columns, h = (float)(height - 20) / rows; // A line of text at the bottom.
+
+	for (int k = 0; k < numViews; k++)
+	{
+		float *v = &viewports[4 * k];
+		v[0] = w * (k % columns);
+		v[1] = 20.0 + h * (rows - 1 - k / columns);
+		v[2] = w;
+		v[3] = h;
+
+		MatrixStack stack;
+		switch (k)
+		{
+		case 0:
+			stack.frustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+			sprintf(viewNames[k], "glFrustum()");
+			break;
+		case 1:
+			stack.perspective(90.0, w / h, 5.0, 100.0);
+			sprintf(viewNames[k], "gluPerspective(90)");
+			break;
+		case 2:
+			stack.perspective(60.0, w / h, 5.0, 100.0);
+			sprintf(viewNames[k], "gluPerspective(60)");
+			break;
+		case 3:
+			stack.ortho(-6.0, 6.0, -6.0, 6.0, 5.0, 100.0);
+			sprintf(viewNames[k], "glOrtho()");
+			break;
+		default:
+			stack.perspective(30.0 + 10.0 * (k - 4), w / h, 5.0, 100.0);
+			sprintf(viewNames[k], "gluPerspective(%d)", 30 + 10 * (k - 4));
+			break;
+		}
+		projections[k] = stack.top();
+	}
+}
+
+// Routine to fill the vertex buffer with the latitudinal triangle strips of
+// hemisphere.cpp and the command buffer with a command for each strip.
+void fillBuffers(void)
+{
+	std::vector<float> vertices;
+	std::vector<DrawArraysCommand> commands;
+
+	for (int j = 0; j < q; j++)
+	{
+		DrawArraysCommand command = { (unsigned int)(2 * (p + 1)), 1, (unsigned int)(2 * (p + 1) * j), 0 };
+		commands.push_back(command);
+		for (int i = 0; i <= p; i++)
+		{
+			vertices.push_back(R * cos((float)(j + 1) / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * sin((float)(j + 1) / q * M_PI / 2.0));
+			vertices.push_back(-R * cos((float)(j + 1) / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * cos((float)j / q * M_PI / 2.0) * cos(2.0 * (float)i / p * M_PI));
+			vertices.push_back(R * sin((float)j / q * M_PI / 2.0));
+			vertices.push_back(-R * cos((float)j / q * M_PI / 2.0) * sin(2.0 * (float)i / p * M_PI));
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawArraysCommand), commands.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+// Routine to set the instance count of every command: one instance a view for the
+// instanced draw, else one.
+void setInstanceCount(void)
+{
+	unsigned int count = mode == 2 ? numViews : 1;
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	for (int j = 0; j < q; j++)
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, j * sizeof(DrawArraysCommand) + sizeof(unsigned int), sizeof(unsigned int), &count);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+// Routine to set the uniforms of a program common to every view.
+void setUniforms(unsigned int program, const Mat4 &modelview)
+{
+	glUseProgram(program);
+	glUniformMatrix4fv(glGetUniformLocation(program, "modelviewMatrix"), 1, GL_FALSE, modelview.m);
+	int location = glGetUniformLocation(program, "projectionMatrices");
+	if (location >= 0) glUniformMatrix4fv(location, numViews, GL_FALSE, projections[0].m);
+	location = glGetUniformLocation(program, "numViews");
+	if (location >= 0) glUniform1i(location, numViews);
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	MatrixStack modelview;
+	char text[128];
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	PROFILE_PHASE("hemisphere");
+	// Read the GPU time of the frame before last, if in.
+	int available = 0;
+	if (frame >= 2) glGetQueryObjectiv(queries[frame % 2], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available)
+	{
+		GLuint64 nanos;
+		glGetQueryObjectui64v(queries[frame % 2], GL_QUERY_RESULT, &nanos);
+		gpuMicros = nanos / 1000.0;
+	}
+
+	modelview.translate(0.0, 0.0, -10.0);
+	modelview.rotate(Zangle, 0.0, 0.0, 1.0);
+	modelview.rotate(Yangle, 0.0, 1.0, 0.0);
+	modelview.rotate(Xangle, 1.0, 0.0, 0.0);
+
+	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+	glBeginQuery(GL_TIME_ELAPSED, queries[frame % 2]);
+	auto start = std::chrono::high_resolution_clock::now();
+	if (mode == 0)
+	{
+		setUniforms(passProgram, modelview.top());
+		int location = glGetUniformLocation(passProgram, "projectionMatrix");
+		for (int k = 0; k < numViews; k++)
+		{
+			const float *v = &viewports[4 * k];
+			glViewport((int)v[0], (int)v[1], (int)v[2], (int)v[3]);
+			glUniformMatrix4fv(location, 1, GL_FALSE, projections[k].m);
+			glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, 0, q, 0);
+		}
+		drawCalls = numViews;
+	}
+	else
+	{
+		glViewportArrayv(0, numViews, viewports);
+		setUniforms(mode == 1 ? geometryProgram : instancedProgram, modelview.top());
+		glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, 0, q, 0);
+		drawCalls = 1;
+	}
+	cpuMicros = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+	glEndQuery(GL_TIME_ELAPSED);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glViewport(0, 0, width, height); // Every viewport back to the window.
+	frame++;
+
+	PROFILE_PHASE("text");
+	glColor3f(0.0, 0.0, 0.0);
+	for (int k = 0; k < numViews; k++)
+	{
+		glWindowPos2i((int)viewports[4 * k] + 5, (int)(viewports[4 * k + 1] + viewports[4 * k + 3]) - 15);
+		writeBitmapString((void*)font, viewNames[k]);
+	}
+	sprintf(text, "%d views, %s: %d draws, CPU %.0f us, GPU %.0f us", numViews, modeNames[mode], drawCalls,
+		cpuMicros, gpuMicros);
+	glWindowPos2i(5, 5);
+	writeBitmapString((void*)font, text);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	glGetIntegerv(GL_MAX_VIEWPORTS, &maxViews);
+	if (maxViews > MAX_VIEWS) maxViews = MAX_VIEWS;
+	if (numViews > maxViews) numViews = maxViews;
+	hasLayerArray = hasExtension("GL_ARB_shader_viewport_layer_array");
+	std::cout << maxViews << " viewports; instanced draw "
+		<< (hasLayerArray ? "available" : "unavailable, no GL_ARB_shader_viewport_layer_array") << std::endl;
+
+	passProgram = programCacheBuild(passVertexShaderSource, fragmentShaderSource);
+	geometryProgram = programCacheBuild(geometryVertexShaderSource, geometryShaderSource, fragmentShaderSource);
+	if (hasLayerArray) instancedProgram = programCacheBuild(instancedVertexShaderSource, fragmentShaderSource);
+
+	glGenVertexArrays(1, &vao);
+	glGenBuffers(1, &buffer);
+	glGenBuffers(1, &commandBuffer);
+	glGenQueries(2, queries);
+	glBindVertexArray(vao);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	fillBuffers();
+	setInstanceCount();
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	width = w;
+	height = h;
+	glViewport(0, 0, w, h);
+	layoutViews();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'P':
+		p += 1;
+		fillBuffers();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'p':
+		if (p > 3) p -= 1;
+		fillBuffers();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'Q':
+		q += 1;
+		fillBuffers();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'q':
+		if (q > 3) q -= 1;
+		fillBuffers();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'x':
+		Xangle += 5.0;
+		if (Xangle > 360.0) Xangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'X':
+		Xangle -= 5.0;
+		if (Xangle < 0.0) Xangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'y':
+		Yangle += 5.0;
+		if (Yangle > 360.0) Yangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Y':
+		Yangle -= 5.0;
+		if (Yangle < 0.0) Yangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case 'z':
+		Zangle += 5.0;
+		if (Zangle > 360.0) Zangle -= 360.0;
+		glutPostRedisplay();
+		break;
+	case 'Z':
+		Zangle -= 5.0;
+		if (Zangle < 0.0) Zangle += 360.0;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (numViews < maxViews) numViews++;
+		layoutViews();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case '-':
+		if (numViews > 1) numViews--;
+		layoutViews();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'm':
+		mode = (mode + 1) % 3;
+		if (mode == 2 && !hasLayerArray) mode = 0;
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	case 'h':
+		if (savedP)
+		{
+			p = savedP;
+			q = savedQ;
+			savedP = 0;
+		}
+		else
+		{
+			savedP = p;
+			savedQ = q;
+			p = q = 512;
+		}
+		fillBuffers();
+		setInstanceCount();
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press P/p to increase/decrease the number of longitudinal slices." << std::endl
+		<< "Press Q/q to increase/decrease the number of latitudinal slices." << std::endl
+		<< "Press x, X, y, Y, z, Z to turn the hemisphere." << std::endl
+		<< "Press +/- to add/remove a view." << std::endl
+		<< "Press m to cycle between one pass a view, geometry shader instancing and instanced draw." << std::endl
+		<< "Press h to toggle a high-resolution hemisphere, p = q = 512." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("hemisphereViews.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
@@ -0,0 +1,324 @@
+////////////////////////////////////////////////////////////////////////////////////
+// launcher.cpp
+//
+// This program opens any set of demos as windows of one process, e.g.
+//
+//   launcher lightAndMaterial1 lightAndMaterial2 clown3 clown3
+//
+// opens four windows, the clown twice; without arguments it opens one of each.
+// The demos are the fifteen of box.cpp to square.cpp, each run from its unit
+// (demoUnit.h), the same code its own program runs, with an object per window
+// holding that window's globals; each window takes the keys and mouse of its
+// demo, but Esc closes the window, and the program ends with the last.
+//
+// Every window draws with one GL context, that of a hidden window created first:
+// freeglut has no share lists, but with GLUT_RENDERING_CONTEXT set to
+// GLUT_USE_CURRENT_CONTEXT the windows created after it take its context, and a
+// context is deleted only with its last window. So the windows share buffers,
+// vertex arrays and programs, and the demos' GLUT primitives are drawn from
+// sharedPrimitives.h: each distinct sphere, cube, cone or torus is one compact mesh
+// however many windows draw it, at whatever size, and the memory stays flat as
+// demos repeat, which the C++ window shows each time a window opens or closes.
+// Sharing a context needs one pixel format, so every window is double buffered
+// with a depth buffer, the single-buffered demos included; and as the GL state is
+// shared too, each of a demo's routines is called between glPushAttrib() and
+// glPopAttrib(), after the demo's setup() and resize() have set the window's
+// state again.
+//
+// Instead of glutMainLoop() the program runs its own loop, which services all
+// the windows by glutMainLoopEvent(), calls the demos' idle routines and writes
+// the report. The measurement hooks of the demos (demoHooks.h) read no options
+// here, so they stay off.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define DEMO_GOVERNOR
+#include "../Common/demoHooks.h"
+#include "../Common/sharedPrimitives.h"
+
+// The GLUT primitives of the demos, from the shared meshes.
+#define glutSolidSphere sharedSolidSphere
+#define glutWireSphere sharedWireSphere
+#define glutSolidCube sharedSolidCube
+#define glutWireCube sharedWireCube
+#define glutSolidCone sharedSolidCone
+#define glutWireCone sharedWireCone
+#define glutSolidTorus sharedSolidTorus
+#define glutWireTorus sharedWireTorus
+
+#include "../Box/box.h"
+#include "../CircularAnnuluses/circularAnnuluses.h"
+#include "../Clown3/clown3.h"
+#include "../ExperimentTwoSquares/experimentTwoSquares.h"
+#include "../Helix/helix.h"
+#include "../Hemisphere/hemisphere.h"
+#include "../HemispherePerspective/hemispherePerspective.h"
+#include "../LightAndMaterial1/lightAndMaterial1.h"
+#include "../LightAndMaterial2/lightAndMaterial2.h"
+#include "../RotatingHelix1/rotatingHelix1.h"
+#include "../RotatingHelix2/rotatingHelix2.h"
+#include "../RotatingHelix3/rotatingHelix3.h"
+#include "../RotatingHelixFPS/rotatingHelixFPS.h"
+#include "../SphereInBox1/sphereInBox1.h"
+#include "../Square/square.h"
+
+// Routine to create the unit of a demo.
+template <class T> DemoUnit *newDemo(void)
+{
+	return new T;
+}
+
+// A demo, by the name of its program.
+struct Demo
+{
+	const char *name;
+	DemoUnit *(*create)(void);
+};
+
+// A demo's window.
+struct DemoWindow
+{
+	DemoUnit *unit;
+	int width, height;
+	bool isDrawn;
+};
+
+// Globals.
+static const Demo demos[] =
+{
+	{ "box", newDemo<Box> },
+	{ "circularAnnuluses", newDemo<CircularAnnuluses> },
+	{ "clown3", newDemo<Clown3> },
+	{ "experimentTwoSquares", newDemo<ExperimentTwoSquares> },
+	{ "helix", newDemo<Helix> },
+	{ "hemisphere", newDemo<Hemisphere> },
+	{ "hemispherePerspective", newDemo<HemispherePerspective> },
+	{ "lightAndMaterial1", newDemo<LightAndMaterial1> },
+	{ "lightAndMaterial2", newDemo<LightAndMaterial2> },
+	{ "rotatingHelix1", newDemo<RotatingHelix1> },
+	{ "rotatingHelix2", newDemo<RotatingHelix2> },
+	{ "rotatingHelix3", newDemo<RotatingHelix3> },
+	{ "rotatingHelixFPS", newDemo<RotatingHelixFPS> },
+	{ "sphereInBox1", newDemo<SphereInBox1> },
+	{ "square", newDemo<Square> }
+};
+static const int numDemos = sizeof(demos) / sizeof(demos[0]);
+static std::vector<DemoWindow> windows; // In order of opening.
+static int numOpen = 0; // Windows open.
+static bool isChanged = false; // Has a window drawn its first frame or closed since the last report?
+
+// Routine to return the window of the current GLUT window, NULL if it has no open
+// demo.
+DemoWindow *currentWindow(void)
+{
+	DemoUnit *unit = demoUnitCurrent();
+	if (!unit) return NULL;
+	for (size_t k = 0; k < windows.size(); k++)
+		if (windows[k].unit == unit) return &windows[k];
+	return NULL;
+}
+
+// Routine to give the GL state to the current window's demo before a routine of
+// it: the state pushed, the matrices reset, then the demo's setup and projection.
+// Returns NULL, with nothing pushed, if the window has no open demo.
+DemoWindow *beginState(void)
+{
+	DemoWindow *w = currentWindow();
+	if (!w) return NULL;
+
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+
+	w->unit->setup();
+	w->unit->resize(w->width, w->height);
+	return w;
+}
+
+// Routine to take the state back after a routine of a demo.
+void endState(void)
+{
+	glPopClientAttrib();
+	glPopAttrib();
+}
+
+// Drawing routine of every window.
+void drawScene(void)
+{
+	DemoWindow *w = beginState();
+	if (!w) return;
+	w->unit->drawScene();
+	endState();
+
+	if (!w->isDrawn) isChanged = true;
+	w->isDrawn = true;
+}
+
+// Drawing routine of the hidden window holding the context.
+void drawNothing(void)
+{
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	DemoWindow *window = currentWindow();
+	if (!window) return;
+	window->width = w;
+	window->height = h > 0 ? h : 1;
+}
+
+// Keyboard input processing routine: Esc closes the window, other keys are the
+// demo's.
+void keyInput(unsigned char key, int x, int y)
+{
+	if (key == 27)
+	{
+		glutDestroyWindow(glutGetWindow());
+		return;
+	}
+	DemoWindow *w = beginState();
+	if (!w) return;
+	w->unit->keyInput(key, x, y);
+	endState();
+}
+
+// Callback routine for non-ASCII key entry.
+void specialKeyInput(int key, int x, int y)
+{
+	DemoWindow *w = beginState();
+	if (!w) return;
+	w->unit->specialKeyInput(key, x, y);
+	endState();
+}
+
+// Mouse callback routine.
+void mouseControl(int button, int state, int x, int y)
+{
+	DemoWindow *w = beginState();
+	if (!w) return;
+	w->unit->mouseControl(button, state, x, y);
+	endState();
+}
+
+// Routine called as a window closes, by Esc or its close button, with its window
+// current: its demo releases what it built and is deleted.
+void closeWindow(void)
+{
+	DemoWindow *w = currentWindow();
+	if (!w) return;
+	w->unit->destroy();
+	demoUnitDetach(w->unit);
+	sharedPrimitivesRelease(glutGetWindow());
+	delete w->unit;
+	w->unit = NULL;
+	numOpen--;
+	isChanged = true;
+}
+
+// Routine to open the window of a demo.
+void openDemo(int demo)
+{
+	DemoWindow w = { demos[demo].create(), 500, 500, false };
+
+	int k = (int)windows.size();
+	glutInitWindowSize(w.width, w.height);
+	glutInitWindowPosition(100 + 40 * k, 100 + 40 * k);
+	glutCreateWindow((std::string(demos[demo].name) + ".cpp").c_str());
+	demoUnitAttach(w.unit);
+	windows.push_back(w);
+	numOpen++;
+
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+	glutSpecialFunc(specialKeyInput);
+	glutMouseFunc(mouseControl);
+	glutCloseFunc(closeWindow);
+
+	w.unit->build();
+}
+
+// Routine to output interaction instructions to the C++ window, those of each
+// demo opened.
+void printInteraction(const std::vector<int> &opened)
+{
+	for (int demo = 0; demo < numDemos; demo++)
+		if (std::find(opened.begin(), opened.end(), demo) != opened.end())
+		{
+			DemoUnit *unit = demos[demo].create();
+			std::cout << demos[demo].name << ".cpp" << std::endl;
+			unit->printInteraction();
+			delete unit;
+		}
+	std::cout << "Press Esc to close a window." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	glutInit(&argc, argv);
+
+	std::vector<int> opened;
+	for (int i = 1; i < argc; i++)
+	{
+		int demo = 0;
+		while (demo < numDemos && strcmp(argv[i], demos[demo].name)) demo++;
+		if (demo < numDemos) opened.push_back(demo);
+		else std::cout << "Unknown demo " << argv[i] << std::endl;
+	}
+	if (opened.empty()) for (int demo = 0; demo < numDemos; demo++) opened.push_back(demo);
+	printInteraction(opened);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
+	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_CONTINUE_EXECUTION);
+
+	// The window whose context every demo window draws with, hidden.
+	glutInitWindowSize(64, 64);
+	glutCreateWindow("launcher.cpp");
+	glutDisplayFunc(drawNothing);
+	glutHideWindow();
+
+	glewExperimental = GL_TRUE;
+	glewInit();
+
+	glutSetOption(GLUT_RENDERING_CONTEXT, GLUT_USE_CURRENT_CONTEXT);
+	windows.reserve(opened.size());
+	for (size_t k = 0; k < opened.size(); k++) openDemo(opened[k]);
+
+	// Event loop: service every window's events, timers and redisplays, call the
+	// demos' idle routines, report a change in the windows, and sleep a
+	// millisecond when no demo is idling so as not to spin.
+	while (numOpen > 0)
+	{
+		glutMainLoopEvent();
+		if (!demoIdleUnits.empty()) demoUnitIdle();
+		else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (isChanged)
+		{
+			isChanged = false;
+			sharedPrimitivesReport();
+		}
+	}
+	return 0;
+}
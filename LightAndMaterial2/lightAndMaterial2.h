@@ -0,0 +1,392 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// lightAndMaterial2.h
+//
+// The lit ball of lightAndMaterial2.cpp as a demo unit (demoUnit.h): its globals
+// and routines, run by lightAndMaterial2.cpp and by the launcher.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LIGHT_AND_MATERIAL2_H
+#define LIGHT_AND_MATERIAL2_H
+
+#include <iostream>
+#include <fstream>
+
+#include "../Common/demoUnit.h"
+#include "../Common/wideLines.h"
+#include "../Common/picking.h"
+
+class LightAndMaterial2 : public DemoUnit
+{
+public:
+	void buildArrow(void);
+	void writeBitmapString(void *font, char *string);
+	void floatToString(char * destStr, int precision, float val);
+	void writeData(void);
+	void build(void);
+	void setup(void);
+	void destroy(void);
+	void drawScene();
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void specialKeyInput(int key, int x, int y);
+	void mouseControl(int button, int state, int x, int y);
+	void printInteraction(void);
+
+	enum { WHITE_LIGHT, GREEN_LIGHT, BALL }; // Objects.
+
+	// Globals.
+	int light0On = 1; // White light on?
+	int light1On = 1; // Green light on?
+	float d = 1.0; // Diffuse and specular white light intensity.
+	float m = 0.2; // Global ambient white light intensity.
+	int localViewer = 1; // Local viewpoint?
+	float p = 1.0; // Positional light?
+	float t = 0.0; // Quadratic attenuation factor.
+	float zMove = 0.0; // z-direction component.
+	int ballSlices = 200, ballStacks = 200; // Longitudinal and latitudinal slices of the ball.
+	float xAngle = 0.0, yAngle = 0.0; // Rotation angles of white light.
+	long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+	char theStringBuffer[10]; // String buffer.
+	WideLines arrow; // Arrow of the directional light.
+	float arrowShade = -1.0; // Intensity d the arrow was built with.
+	PickScene pickScene; // Light spheres and ball drawn in the last frame.
+	int picked = -1; // Object picked, -1 if none.
+	const char *objectNames[3] = { "White light", "Green light", "Ball" };
+};
+
+// Routine to build the arrow of the directional light in the shade of intensity d and
+// upload it; called only when d changes, so no frame reallocates its buffer.
+inline void LightAndMaterial2::buildArrow(void)
+{
+	arrow.clear();
+	arrow.color(d, d, d);
+	arrow.vertex(0.0, 0.0, 0.25);
+	arrow.vertex(0.0, 0.0, -0.25);
+	arrow.endLine();
+	arrow.vertex(0.05, 0.0, -0.2);
+	arrow.vertex(0.0, 0.0, -0.25);
+	arrow.vertex(-0.05, 0.0, -0.2);
+	arrow.endLine();
+	arrow.upload();
+	arrowShade = d;
+}
+
+// Routine to draw a bitmap character string.
+inline void LightAndMaterial2::writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to convert floating point to char string.
+inline void LightAndMaterial2::floatToString(char * destStr, int precision, float val)
+{
+	sprintf(destStr, "%f", val);
+	destStr[precision] = '\0';
+}
+
+// Write data.
+inline void LightAndMaterial2::writeData(void)
+{
+	glDisable(GL_LIGHTING); // Disable lighting.
+	glColor3f(1.0, 1.0, 1.0);
+
+	floatToString(theStringBuffer, 4, d);
+	glRasterPos3f(-1.0, 1.05, -2.0);
+	writeBitmapString((void*)font, "Diffuse and specular white light intensity: ");
+	writeBitmapString((void*)font, theStringBuffer);
+
+	floatToString(theStringBuffer, 4, m);
+	glRasterPos3f(-1.0, 1.0, -2.0);
+	writeBitmapString((void*)font, "Global ambient whitle light intensity: ");
+	writeBitmapString((void*)font, theStringBuffer);
+
+	floatToString(theStringBuffer, 4, t);
+	glRasterPos3f(-1.0, 0.95, -2.0);
+	writeBitmapString((void*)font, "Quadratic attenuation: ");
+	writeBitmapString((void*)font, theStringBuffer);
+
+	glRasterPos3f(-1.0, 0.9, -2.0);
+	if (localViewer) writeBitmapString((void*)font, "Local viewpoint.");
+	else writeBitmapString((void*)font, "Infinite viewpoint.");
+
+	glRasterPos3f(-1.0, 0.85, -2.0);
+	writeBitmapString((void*)font, "Picked: ");
+	writeBitmapString((void*)font, (char *)(picked >= 0 ? objectNames[picked] : "nothing"));
+
+	glEnable(GL_LIGHTING); // Re-enable lighting.
+}
+
+// Routine to build the arrow and register the quality governor's knobs, once.
+inline void LightAndMaterial2::build(void)
+{
+	arrow.init();
+	buildArrow();
+	governorKnob("ball slices", &ballSlices, 8);
+	governorKnob("ball stacks", &ballStacks, 8);
+}
+
+// Initialization routine.
+inline void LightAndMaterial2::setup(void)
+{
+	glClearColor(0.0, 0.0, 0.0, 0.0);
+	glEnable(GL_DEPTH_TEST); // Enable depth testing.
+
+	// Turn on OpenGL lighting.
+	glEnable(GL_LIGHTING);
+
+	// Material property vectors.
+	float matAmbAndDif[] = { 0.0, 0.0, 1.0, 1.0 };
+	float matSpec[] = { 1.0, 1.0, 1,0, 1.0 };
+	float matShine[] = { 50.0 };
+
+	// Material properties of ball.
+	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, matAmbAndDif);
+	glMaterialfv(GL_FRONT, GL_SPECULAR, matSpec);
+	glMaterialfv(GL_FRONT, GL_SHININESS, matShine);
+
+	// Cull back faces.
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+}
+
+// Routine to release the arrow.
+inline void LightAndMaterial2::destroy(void)
+{
+	arrow.destroy();
+}
+
+// Drawing routine.
+inline void LightAndMaterial2::drawScene()
+{
+	// Light property vectors.
+	float lightAmb[] = { 0.0, 0.0, 0.0, 1.0 };
+	float lightDifAndSpec0[] = { d, d, d, 1.0 };
+	float lightPos0[] = { 0.0, 0.0, 3.0, p };
+	float lightDifAndSpec1[] = { 0.0, 1.0, 0.0, 1.0 };
+	float lightPos1[] = { 1.0, 2.0, 0.0, 1.0 };
+	float globAmb[] = { m, m, m, 1.0 };
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("lighting setup");
+	// Light0 properties.
+	glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmb);
+	glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDifAndSpec0);
+	glLightfv(GL_LIGHT0, GL_SPECULAR, lightDifAndSpec0);
+
+	// Light1 properties.
+	glLightfv(GL_LIGHT1, GL_AMBIENT, lightAmb);
+	glLightfv(GL_LIGHT1, GL_DIFFUSE, lightDifAndSpec1);
+	glLightfv(GL_LIGHT1, GL_SPECULAR, lightDifAndSpec1);
+
+	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globAmb); // Global ambient light.
+	glLightModeli(GL_LIGHT_MODEL_LOCAL_VIEWER, localViewer); // Enable local viewpoint
+
+	// Turn lights off/on.
+	if (light0On) glEnable(GL_LIGHT0); else glDisable(GL_LIGHT0);
+	if (light1On) glEnable(GL_LIGHT1); else glDisable(GL_LIGHT1);
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glLoadIdentity();
+	pickScene.clear();
+
+	PROFILE_PHASE("lighting setup");
+	// Light quadratic attenuation factor.
+	glLightf(GL_LIGHT0, GL_QUADRATIC_ATTENUATION, t);
+	glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, t);
+
+	PROFILE_PHASE("text");
+	writeData();
+
+	PROFILE_PHASE("lights");
+	gluLookAt(0.0, 3.0, 5.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+
+	// Draw light source spheres (or arrow) after disabling lighting.
+	glDisable(GL_LIGHTING);
+
+	// Light0 positioned and sphere positioned in case of positional light
+	// and arrow in case of directional light.
+	glPushMatrix();
+	glRotatef(xAngle, 1.0, 0.0, 0.0); // Rotation about x-axis.
+	glRotatef(yAngle, 0.0, 1.0, 0.0); // Rotation about y-axis.
+	glLightfv(GL_LIGHT0, GL_POSITION, lightPos0);
+	glTranslatef(lightPos0[0], lightPos0[1], lightPos0[2]);
+	glColor3f(d, d, d);
+	if (light0On)
+	{
+		if (p) // Sphere at positional light source.
+		{
+			glutWireSphere(0.05, 8, 8);
+			pickScene.add(WHITE_LIGHT, pickSphere(0.05, 8, 8));
+		}
+		else // Arrow pointing along incoming directional light, 3 pixels wide.
+		{
+			if (d != arrowShade) buildArrow();
+			arrow.draw(3.0);
+		}
+	}
+	glPopMatrix();
+
+	// Light1 and its sphere positioned.
+	glPushMatrix();
+	glLightfv(GL_LIGHT1, GL_POSITION, lightPos1);
+	glTranslatef(lightPos1[0], lightPos1[1], lightPos1[2]);
+	glColor3f(0.0, 1.0, 0.0);
+	if (light1On)
+	{
+		glutWireSphere(0.05, 8, 8);
+		pickScene.add(GREEN_LIGHT, pickSphere(0.05, 8, 8));
+	}
+	glPopMatrix();
+
+	glEnable(GL_LIGHTING);
+
+	PROFILE_PHASE("ball");
+	// Ball.
+	glTranslatef(0.0, 0.0, zMove); // Move the ball.
+	glutSolidSphere(1.5, ballSlices, ballStacks);
+	pickScene.add(BALL, pickSphere(1.5, ballSlices, ballStacks));
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// OpenGL window reshape routine.
+inline void LightAndMaterial2::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	gluPerspective(60.0, (float)w / (float)h, 1.0, 20.0);
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+inline void LightAndMaterial2::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'w':
+		if (light0On) light0On = 0; else light0On = 1;
+		glutPostRedisplay();
+		break;
+	case 'g':
+		if (light1On) light1On = 0; else light1On = 1;
+		glutPostRedisplay();
+		break;
+	case 'l':
+		if (localViewer) localViewer = 0; else localViewer = 1;
+		glutPostRedisplay();
+		break;
+	case 'L':
+		if (localViewer) localViewer = 0; else localViewer = 1;
+		glutPostRedisplay();
+		break;
+	case 'p':
+		if (p) p = 0.0; else p = 1.0;
+		glutPostRedisplay();
+		break;
+	case 'P':
+		if (p) p = 0.0; else p = 1.0;
+		glutPostRedisplay();
+		break;
+	case 'd':
+		if (d > 0.0) d -= 0.05;
+		glutPostRedisplay();
+		break;
+	case 'D':
+		if (d < 1.0) d += 0.05;
+		glutPostRedisplay();
+		break;
+	case 'm':
+		if (m > 0.0) m -= 0.05;
+		glutPostRedisplay();
+		break;
+	case 'M':
+		if (m < 1.0) m += 0.05;
+		glutPostRedisplay();
+		break;
+	case 't':
+		if (t > 0.0) t -= 0.01;
+		glutPostRedisplay();
+		break;
+	case 'T':
+		t += 0.01;
+		glutPostRedisplay();
+		break;
+	case 'r':
+		zMove = 0.0; xAngle = 0.0, yAngle = 0.0;
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Callback routine for non-ASCII key entry.
+inline void LightAndMaterial2::specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_DOWN)
+	{
+		xAngle++;
+		if (xAngle > 360.0) xAngle -= 360.0;
+	}
+	if (key == GLUT_KEY_UP)
+	{
+		xAngle--;
+		if (xAngle < 0.0) xAngle += 360.0;
+	}
+	if (key == GLUT_KEY_RIGHT)
+	{
+		yAngle++;
+		if (yAngle > 360.0) yAngle -= 360.0;
+	}
+	if (key == GLUT_KEY_LEFT)
+	{
+		yAngle--;
+		if (yAngle < 0.0) yAngle += 360.0;
+	}
+	if (key == GLUT_KEY_PAGE_UP) zMove -= 0.1;
+	if (key == GLUT_KEY_PAGE_DOWN) if (zMove < 3.0) zMove += 0.1;
+	glutPostRedisplay();
+}
+
+// Mouse callback routine.
+inline void LightAndMaterial2::mouseControl(int button, int state, int x, int y)
+{
+	if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN)
+	{
+		picked = pickScene.pick(x, y);
+		std::cout << "Picked " << (picked >= 0 ? objectNames[picked] : "nothing") << " in " << pickScene.pickMicros
+			<< " us, hierarchy of " << pickScene.numObjects() << " objects built in " << pickScene.buildMicros << " us" << std::endl;
+		glutPostRedisplay();
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void LightAndMaterial2::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press 'w' to toggle the white light off/on." << std::endl
+		<< "Press 'g' to toggle the green light off/on." << std::endl
+		<< "Press 'd/D' to decrease/increase the white light's diffuse and specular intensity." << std::endl
+		<< "Press 'm/M' to decrease/increase global ambient white light intensity." << std::endl
+		<< "Press 't/T' to decrease/increase the quadratic attenuation parameter." << std::endl
+		<< "Press 'l' to toggle between infinite and local viewpoint." << std::endl
+		<< "Press 'p' to toggle between positional and directional white light." << std::endl
+		<< "Press the page up/down keys to move the ball." << std::endl
+		<< "Press arrow keys to rotate the white light about the original position of the ball." << std::endl
+		<< "Press 'r' to reset the ball and white light to their original positions." << std::endl
+		<< "Click the left mouse button on a light's sphere to pick it." << std::endl;
+}
+
+#endif
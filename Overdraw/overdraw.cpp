@@ -0,0 +1,331 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// overdraw.cpp
+//
+// This program measures overdraw in the layered 2D scenes of experimentTwoSquares.cpp
+// (a green square painted over a red one) and circularAnnuluses.cpp (a white disc
+// painted over a red one), and in a stack of many overlapping rectangles.
+//
+// Heat map mode counts the fragments written to each pixel with the stencil buffer
+// (incremented by every fragment that passes the depth test) and shows the count as
+// a color: blue 1, green 2, yellow 3, orange 4, red 5 or more.
+//
+// Front-to-back mode gives every layer a depth from its place in the painter's order,
+// later layers nearer, and draws the layers in reverse order with the depth test on,
+// so fragments hidden by layers already drawn are rejected before being shaded. The
+// picture is unchanged.
+//
+// Every frame the scene is also drawn both ways with color writes off, counting the
+// fragments with occlusion queries, and the fragment savings of front-to-back order
+// are written to the window.
+//
+// Interaction:
+// Press 1, 2, 3 to choose the two squares, the overwritten annulus or the stack.
+// Press h to toggle the overdraw heat map.
+// Press f to toggle front-to-back drawing.
+// Press +/- to double/halve the number of rectangles in the stack.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define DEMO_NO_POST_AA
+#include "../Common/demoHooks.h"
+
+#define N 40.0 // Number of vertices on the boundary of a disc.
+#define HEAT_LEVELS 5 // Number of colors of the heat map.
+
+// A layer of the scene: a rectangle or a disc.
+struct Layer
+{
+	int isDisc;
+	float a, b, c, d; // Rectangle (x0, y0, x1, y1) or disc (R, X, Y, unused).
+	float r, g, bl; // Color.
+};
+
+// Globals.
+static int scene = 1; // Scene 1, 2 or 3.
+static int isHeatMap = 0; // Show the heat map?
+static int isFrontToBack = 0; // Draw front to back?
+static int stackSize = 32; // Number of rectangles in the stack.
+static std::vector<Layer> layers; // Layers of the scene in painter's order.
+static unsigned int queries[2]; // Occlusion queries.
+static int width = 500, height = 500; // Window size.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Routine to add a layer.
+void addLayer(int isDisc, float a, float b, float c, float d, float r, float g, float bl)
+{
+	Layer layer = { isDisc, a, b, c, d, r, g, bl };
+	layers.push_back(layer);
+}
+
+// Routine to build the layers of the current scene.
+void createScene(void)
+{
+	layers.clear();
+	switch (scene)
+	{
+	case 1: // experimentTwoSquares.cpp.
+		addLayer(0, 20.0, 20.0, 80.0, 80.0, 1.0, 0.0, 0.0);
+		addLayer(0, 40.0, 40.0, 60.0, 60.0, 0.0, 1.0, 0.0);
+		break;
+	case 2: // Upper left annulus of circularAnnuluses.cpp, centered.
+		addLayer(1, 40.0, 50.0, 50.0, 0.0, 1.0, 0.0, 0.0);
+		addLayer(1, 20.0, 50.0, 50.0, 0.0, 1.0, 1.0, 1.0);
+		break;
+	case 3: // A stack of rectangles, each placed at random.
+		srand(1);
+		for (int i = 0; i < stackSize; i++)
+		{
+			float x = 60.0 * rand() / RAND_MAX, y = 60.0 * rand() / RAND_MAX;
+			addLayer(0, x, y, x + 20.0 + 20.0 * rand() / RAND_MAX, y + 20.0 + 20.0 * rand() / RAND_MAX,
+				(float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to draw one layer at depth z.
+void drawLayer(const Layer &layer, float z)
+{
+	glColor3f(layer.r, layer.g, layer.bl);
+	if (layer.isDisc)
+	{
+		glBegin(GL_TRIANGLE_FAN);
+		glVertex3f(layer.b, layer.c, z);
+		for (int i = 0; i <= N; ++i)
+		{
+			float t = 2 * M_PI * i / N;
+			glVertex3f(layer.b + cos(t) * layer.a, layer.c + sin(t) * layer.a, z);
+		}
+		glEnd();
+	}
+	else
+	{
+		glBegin(GL_POLYGON);
+		glVertex3f(layer.a, layer.b, z);
+		glVertex3f(layer.c, layer.b, z);
+		glVertex3f(layer.c, layer.d, z);
+		glVertex3f(layer.a, layer.d, z);
+		glEnd();
+	}
+}
+
+// Routine to draw all layers, either in painter's order with no depth test, or front
+// to back with depths assigned from the painter's order: layer i of n at
+// z = -0.9 + 1.8 i / (n - 1), nearer the later it is painted.
+void drawLayers(int frontToBack)
+{
+	int n = (int)layers.size();
+
+	if (!frontToBack)
+	{
+		for (int i = 0; i < n; i++) drawLayer(layers[i], 0.0);
+		return;
+	}
+
+	glEnable(GL_DEPTH_TEST);
+	for (int i = n - 1; i >= 0; i--) drawLayer(layers[i], n > 1 ? -0.9 + 1.8 * i / (n - 1) : 0.0);
+	glDisable(GL_DEPTH_TEST);
+}
+
+// Routine to count the fragments drawing the layers takes, without touching the colors.
+unsigned int countFragments(int frontToBack, unsigned int query)
+{
+	unsigned int fragments;
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glBeginQuery(GL_SAMPLES_PASSED, query);
+	drawLayers(frontToBack);
+	glEndQuery(GL_SAMPLES_PASSED);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, &fragments);
+	return fragments;
+}
+
+// Routine to color every pixel by the number of fragments counted in its stencil value.
+void drawHeatMap(void)
+{
+	const float colors[HEAT_LEVELS][3] =
+	{ { 0.0, 0.0, 1.0 }, { 0.0, 0.8, 0.0 }, { 1.0, 1.0, 0.0 }, { 1.0, 0.5, 0.0 }, { 1.0, 0.0, 0.0 } };
+
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	for (int k = 1; k <= HEAT_LEVELS; k++)
+	{
+		glStencilFunc(k < HEAT_LEVELS ? GL_EQUAL : GL_LEQUAL, k, 0xFF);
+		glColor3fv(colors[k - 1]);
+		glRectf(0.0, 0.0, 100.0, 100.0);
+	}
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	char buffer[128];
+	unsigned int painterFragments, frontToBackFragments;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+	PROFILE_PHASE("count fragments");
+	// Count the fragments of both orders.
+	painterFragments = countFragments(0, queries[0]);
+	frontToBackFragments = countFragments(1, queries[1]);
+
+	PROFILE_PHASE("layers");
+	// Draw the scene, counting fragments per pixel in the stencil buffer.
+	glEnable(GL_STENCIL_TEST);
+	glStencilFunc(GL_ALWAYS, 0, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+	drawLayers(isFrontToBack);
+
+	PROFILE_PHASE("read stencil");
+	// Covered pixels and the largest count.
+	std::vector<unsigned char> stencil(width * height);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, stencil.data());
+	long long covered = 0;
+	int maxCount = 0;
+	for (size_t i = 0; i < stencil.size(); i++)
+	{
+		if (stencil[i]) covered++;
+		if (stencil[i] > maxCount) maxCount = stencil[i];
+	}
+
+	PROFILE_PHASE("heat map");
+	if (isHeatMap) drawHeatMap();
+	glDisable(GL_STENCIL_TEST);
+
+	PROFILE_PHASE("text");
+	// Write the measurements.
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(buffer, "Pixels covered %lld, max %d fragments/pixel", covered, maxCount);
+	glRasterPos3f(2.0, 96.0, 0.0);
+	writeBitmapString((void*)font, buffer);
+	sprintf(buffer, "Painter's %u fragments (x%.2f)", painterFragments, covered ? (double)painterFragments / covered : 0.0);
+	glRasterPos3f(2.0, 92.0, 0.0);
+	writeBitmapString((void*)font, buffer);
+	sprintf(buffer, "Front-to-back %u fragments (x%.2f), saves %.1f%%", frontToBackFragments,
+		covered ? (double)frontToBackFragments / covered : 0.0,
+		painterFragments ? 100.0 * (painterFragments - (double)frontToBackFragments) / painterFragments : 0.0);
+	glRasterPos3f(2.0, 88.0, 0.0);
+	writeBitmapString((void*)font, buffer);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	glGenQueries(2, queries);
+	createScene();
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	width = w;
+	height = h;
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case '1':
+	case '2':
+	case '3':
+		scene = key - '0';
+		createScene();
+		glutPostRedisplay();
+		break;
+	case 'h':
+		if (isHeatMap) isHeatMap = 0; else isHeatMap = 1;
+		glutPostRedisplay();
+		break;
+	case 'f':
+		if (isFrontToBack) isFrontToBack = 0; else isFrontToBack = 1;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (stackSize < 4096) stackSize *= 2;
+		createScene();
+		glutPostRedisplay();
+		break;
+	case '-':
+		if (stackSize > 1) stackSize /= 2;
+		createScene();
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press 1, 2, 3 to choose the two squares, the overwritten annulus or the stack." << std::endl
+		<< "Press h to toggle the overdraw heat map." << std::endl
+		<< "Press f to toggle front-to-back drawing." << std::endl
+		<< "Press +/- to double/halve the number of rectangles in the stack." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH | GLUT_STENCIL);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("overdraw.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
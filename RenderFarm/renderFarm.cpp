@@ -0,0 +1,413 @@
+////////////////////////////////////////////////////////////////////////////////////
+// renderFarm.cpp
+//
+// This program renders an animation of the rotating helix of rotatingHelix1.cpp or
+// of the opening lid of sphereInBox1.cpp to an image sequence, splitting the
+// frames between worker processes, e.g.
+//
+//   renderFarm -scene lid -frames 0 359 -workers 8 -out lid
+//
+// writes lid_00000.ppm to lid_00359.ppm. Each frame is a function of its time
+// alone, t = frame / fps: the helix turns 90 degrees a second and the lid opens
+// and closes every 6 seconds. So any frame can be rendered by any process, and
+// gives the same image.
+//
+// The program starts the given number of copies of itself with -worker first last,
+// each rendering a contiguous part of the range. A worker creates its own window,
+// which is hidden, and draws into an offscreen framebuffer object of the
+// requested size, then reads each frame back and writes it to its file. The
+// parent waits for all the workers, checks every frame was written, and writes
+// the throughput. With -scaling the range is rendered with 1, 2, 4, ... workers
+// up to the given number, to show how throughput grows with the number of cores.
+//
+// Options: -scene helix|lid, -frames first last (default 0 119), -fps f (30),
+// -size w h (500 500), -workers n (the number of cores), -out prefix (frame),
+// -scaling.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define ONE_BY_ROOT_THREE 0.57735
+
+// Scenes.
+enum Scene { HELIX, LID, NUM_SCENES };
+
+// Globals.
+static const char *sceneNames[NUM_SCENES] = { "helix", "lid" };
+static int scene = HELIX; // Scene rendered.
+static int firstFrame = 0, lastFrame = 119; // Frame range.
+static double fps = 30.0; // Frames per second of animation time.
+static int width = 500, height = 500; // Image size.
+static int numWorkers = 0; // Worker processes (0: one per core).
+static const char *outPrefix = "frame"; // Image file names.
+static bool isScaling = false; // Render with 1, 2, 4, ... workers?
+static bool isWorker = false; // Running as a worker?
+static int workerFirst, workerLast; // Frames of a worker.
+static unsigned int framebuffer, colorBuffer, depthBuffer; // Offscreen target.
+
+// Box of sphereInBox1.cpp.
+static float vertices[] =
+{
+	1.0, -1.0, 1.0,
+	1.0, 1.0, 1.0,
+	1.0, 1.0, -1.0,
+	1.0, -1.0, -1.0,
+	-1.0, -1.0, 1.0,
+	-1.0, 1.0, 1.0,
+	-1.0, 1.0, -1.0,
+	-1.0, -1.0, -1.0
+};
+static unsigned char stripIndices0[] = { 5, 4, 1, 0, 2, 3, 6, 7, 5, 4 };
+static unsigned char stripIndices1[] = { 0, 4, 3, 7 };
+static unsigned char stripIndices2[] = { 6, 5, 2, 1 };
+static float normals[] =
+{
+	ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+	ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+	ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+	ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+	-ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+	-ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+	-ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+	-ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE
+};
+
+// Routine to draw the helix of rotatingHelix1.cpp at time t.
+void drawHelix(double t)
+{
+	float R = 20.0; // Radius of helix.
+	float angle = fmod(90.0 * t, 360.0); // Angle of rotation.
+
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+	glLoadIdentity();
+
+	glTranslatef(0.0, 0.0, -60.0);
+	glRotatef(angle, 0.0, 1.0, 0.0);
+	glTranslatef(0.0, 0.0, 60.0);
+
+	glBegin(GL_LINE_STRIP);
+	for (int i = 0; i <= 400; i++)
+	{
+		float s = -10 * M_PI + i * M_PI / 20.0; // Angle parameter along helix.
+		glVertex3f(R * cos(s), s, R * sin(s) - 60.0);
+	}
+	glEnd();
+}
+
+// Routine to draw the sphere in the box of sphereInBox1.cpp at time t.
+void drawLid(double t)
+{
+	float matAmbAndDif1[] = { 0.9, 0.0, 0.0, 1.0 };
+	float matAmbAndDif2[] = { 0.0, 0.9, 0.0, 1.0 };
+	float matSpec[] = { 1.0, 1.0, 1.0, 1.0 };
+	float matShine[] = { 50.0 };
+	float step = 90.0 * (1.0 - cos(2.0 * M_PI * t / 6.0)); // Lid angle, 0 to 180 and back.
+
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glLoadIdentity();
+	gluLookAt(0.0, 3.0, 3.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+
+	glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, matAmbAndDif1);
+	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, matSpec);
+	glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, matShine);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	glNormalPointer(GL_FLOAT, 0, normals);
+	glDrawElements(GL_TRIANGLE_STRIP, 10, GL_UNSIGNED_BYTE, stripIndices0);
+	glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, stripIndices1);
+
+	glPushMatrix();
+	glTranslatef(0.0, 1.0, -1.0);
+	glRotatef(step, -1.0, 0.0, 0.0);
+	glTranslatef(0.0, -1.0, 1.0);
+	glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, stripIndices2);
+	glPopMatrix();
+
+	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, matAmbAndDif2);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+	glutSolidSphere(1.0, 40, 40);
+	glDisable(GL_CULL_FACE);
+}
+
+// Routine to set up the state and projection of the scene, as the setup() and
+// resize() routines of the original programs do.
+void setupScene(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	glViewport(0, 0, width, height);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+
+	if (scene == HELIX) glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	else
+	{
+		float lightAmb[] = { 0.0, 0.0, 0.0, 1.0 };
+		float lightDifAndSpec[] = { 1.0, 1.0, 1.0, 1.0 };
+		float lightPos[] = { 0.0, 1.5, 3.0, 1.0 };
+		float globAmb[] = { 0.2, 0.2, 0.2, 1.0 };
+
+		gluPerspective(60.0, (float)width / (float)height, 1.0, 20.0);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+
+		glEnable(GL_DEPTH_TEST);
+		glEnable(GL_LIGHTING);
+		glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmb);
+		glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDifAndSpec);
+		glLightfv(GL_LIGHT0, GL_SPECULAR, lightDifAndSpec);
+		glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+		glEnable(GL_LIGHT0);
+		glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globAmb);
+		glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+		glLightModeli(GL_LIGHT_MODEL_LOCAL_VIEWER, GL_TRUE);
+	}
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Routine to create the offscreen framebuffer.
+void createFramebuffer(void)
+{
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Framebuffer incomplete" << std::endl;
+		exit(1);
+	}
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+}
+
+// Routine to give the file name of a frame.
+std::string frameFileName(int frame)
+{
+	char name[32];
+	sprintf(name, "_%05d.ppm", frame);
+	return std::string(outPrefix) + name;
+}
+
+// Routine to write the RGB image, bottom row first as read, to a binary PPM file.
+bool writePpm(const char *fileName, const std::vector<unsigned char> &pixels)
+{
+	FILE *file = fopen(fileName, "wb");
+	if (!file) return false;
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	for (int y = height - 1; y >= 0; y--) fwrite(&pixels[3 * width * y], 1, 3 * width, file);
+	return fclose(file) == 0;
+}
+
+// Routine to render, read back and write frames first to last; run by a worker.
+void renderFrames(int first, int last)
+{
+	std::vector<unsigned char> pixels(3 * width * height);
+	auto start = std::chrono::high_resolution_clock::now();
+
+	createFramebuffer();
+	setupScene();
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	for (int frame = first; frame <= last; frame++)
+	{
+		double t = frame / fps;
+		if (scene == HELIX) drawHelix(t); else drawLid(t);
+		glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+		if (!writePpm(frameFileName(frame).c_str(), pixels))
+		{
+			std::cout << "Could not write " << frameFileName(frame) << std::endl;
+			exit(1);
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	std::cout << "Worker rendered frames " << first << "-" << last << " in " << seconds << " s" << std::endl;
+}
+
+// Routine to tell if the output prefix can go into a worker's command line between
+// double quotes, holding none of the characters a shell still reads there.
+bool isPrefixQuotable(void)
+{
+#ifdef _WIN32
+	const char *special = "\"%!^\r\n"; // Backslashes are path separators.
+#else
+	const char *special = "\"$`\\\r\n";
+#endif
+	return strpbrk(outPrefix, special) == NULL;
+}
+
+// Routine to build the command line of a worker for frames first to last, the
+// program and the output prefix quoted.
+std::string workerCommand(const char *program, int first, int last)
+{
+	char options[128];
+	sprintf(options, " -scene %s -fps %g -size %d %d", sceneNames[scene], fps, width, height);
+	std::string command = std::string("\"") + program + "\"" + options + " -out \"" + outPrefix + "\"";
+	sprintf(options, " -worker %d %d", first, last);
+	command += options;
+#ifdef _WIN32
+	command = "\"" + command + "\""; // cmd.exe strips the outer quotes.
+#endif
+	return command;
+}
+
+// Routine to give the size in bytes of a frame's PPM file, as writePpm() writes it.
+long ppmFileSize(void)
+{
+	char header[64];
+	return sprintf(header, "P6\n%d %d\n255\n", width, height) + 3L * width * height;
+}
+
+// Routine to render the frame range on the given number of worker processes and
+// check the images. Returns the time taken in seconds, or a negative value on
+// failure.
+double runFarm(const char *program, int workers)
+{
+	int numFrames = lastFrame - firstFrame + 1;
+	std::vector<std::thread> threads;
+	std::vector<int> results(workers, 0);
+
+	// Delete the images of an earlier run, or of the previous -scaling step, so
+	// that only this run's can pass the check.
+	for (int frame = firstFrame; frame <= lastFrame; frame++) remove(frameFileName(frame).c_str());
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < workers; i++)
+	{
+		int first = firstFrame + (int)((long long)numFrames * i / workers);
+		int last = firstFrame + (int)((long long)numFrames * (i + 1) / workers) - 1;
+		if (first > last) continue;
+		std::string command = workerCommand(program, first, last);
+		threads.push_back(std::thread([command, &results, i] { results[i] = system(command.c_str()); }));
+	}
+	for (auto &t : threads) t.join();
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	for (int i = 0; i < workers; i++)
+		if (results[i] != 0)
+		{
+			std::cout << "Worker " << i << " failed" << std::endl;
+			return -1.0;
+		}
+	for (int frame = firstFrame; frame <= lastFrame; frame++)
+	{
+		FILE *file = fopen(frameFileName(frame).c_str(), "rb");
+		if (!file)
+		{
+			std::cout << "Frame " << frame << " missing" << std::endl;
+			return -1.0;
+		}
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fclose(file);
+		if (size != ppmFileSize())
+		{
+			std::cout << "Frame " << frame << " incomplete: " << size << " bytes of " << ppmFileSize() << std::endl;
+			return -1.0;
+		}
+	}
+	return seconds;
+}
+
+// Routine to read the options.
+void readOptions(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-scene") && i + 1 < argc)
+		{
+			i++;
+			for (int s = 0; s < NUM_SCENES; s++) if (!strcmp(argv[i], sceneNames[s])) scene = s;
+		}
+		else if (!strcmp(argv[i], "-frames") && i + 2 < argc) { firstFrame = atoi(argv[i + 1]); lastFrame = atoi(argv[i + 2]); i += 2; }
+		else if (!strcmp(argv[i], "-fps") && i + 1 < argc) fps = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-size") && i + 2 < argc) { width = atoi(argv[i + 1]); height = atoi(argv[i + 2]); i += 2; }
+		else if (!strcmp(argv[i], "-workers") && i + 1 < argc) numWorkers = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-out") && i + 1 < argc) outPrefix = argv[++i];
+		else if (!strcmp(argv[i], "-scaling")) isScaling = true;
+		else if (!strcmp(argv[i], "-worker") && i + 2 < argc)
+		{
+			isWorker = true;
+			workerFirst = atoi(argv[i + 1]);
+			workerLast = atoi(argv[i + 2]);
+			i += 2;
+		}
+	}
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	readOptions(argc, argv);
+
+	if (isWorker)
+	{
+		glutInit(&argc, argv);
+
+		glutInitContextVersion(4, 3);
+		glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+		glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+		glutInitWindowSize(64, 64);
+		glutCreateWindow("renderFarm.cpp worker");
+		glutHideWindow();
+
+		glewExperimental = GL_TRUE;
+		glewInit();
+
+		renderFrames(workerFirst, workerLast);
+		return 0;
+	}
+
+	int numFrames = lastFrame - firstFrame + 1;
+	if (!isPrefixQuotable())
+	{
+		std::cout << "Output prefix " << outPrefix << " holds a quote or a shell character" << std::endl;
+		return 1;
+	}
+	if (numWorkers <= 0) numWorkers = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1;
+	if (numFrames <= 0)
+	{
+		std::cout << "Empty frame range " << firstFrame << "-" << lastFrame << std::endl;
+		return 1;
+	}
+
+	std::cout << "Rendering " << sceneNames[scene] << " frames " << firstFrame << "-" << lastFrame
+		<< " at " << width << "x" << height << " to " << outPrefix << "_*.ppm" << std::endl;
+	double oneWorker = 0.0; // Time taken by one worker.
+	for (int workers = isScaling ? 1 : numWorkers; workers <= numWorkers;
+		workers = (workers < numWorkers && 2 * workers > numWorkers) ? numWorkers : 2 * workers)
+	{
+		double seconds = runFarm(argv[0], workers);
+		if (seconds < 0.0) return 1;
+		if (workers == 1) oneWorker = seconds;
+		std::cout << workers << " workers: " << seconds << " s, " << numFrames / seconds << " frames/s";
+		if (oneWorker > 0.0) std::cout << ", speedup " << oneWorker / seconds;
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// renderQueue.cpp
+//
+// This program enhances circularAnnuluses.cpp to draw a grid of cells, each holding
+// one of the three annuluses of circularAnnuluses.cpp or a lit disc with an unlit
+// marker on it (as the light gizmos of lightAndMaterial2.cpp), all submitted to the
+// sort-key render queue of renderQueue.h instead of being drawn immediately.
+//
+// Drawing cell by cell interleaves color, polygon mode, depth test and lighting
+// changes; the queue sorts the draws by state and issues them with the fewest state
+// changes. The "overwritten" annuluses, which rely on drawing order rather than
+// depth, go into a pass that keeps submission order.
+//
+// The number of state changes in submission order and in sorted order is shown,
+// with the time taken to sort and issue the draws.
+//
+// Interaction:
+// Press the space bar to toggle between wireframe and filled for the true annuluses.
+// Press s to toggle between issuing draws sorted and in submission order.
+// Press +/- to increase/decrease the number of cells.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/renderQueue.h"
+#include "../Common/demoHooks.h"
+
+#define N 40.0 // Number of vertices on the boundary of the disc.
+
+// Kinds of cell, as in circularAnnuluses.cpp, plus a lit disc.
+enum Cell { OVERWRITTEN, FLOATING, REAL_DEAL, LIT, NUM_CELL_KINDS };
+
+// Passes.
+#define OPAQUE_PASS 0
+#define PAINTER_PASS 1
+
+// Globals.
+static int isWire = 0; // Is wireframe?
+static int gridSize = 8; // Number of cells along each side.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+static RenderQueue queue; // Render queue.
+static int red, white, blue; // Materials.
+static double flushMillis = 0.0; // CPU time of the last flush.
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Function to draw a disc with center at (X, Y, Z) = (args[1], args[2], args[3]),
+// radius R = args[0], parallel to the xy-plane.
+void drawDisc(const float *args)
+{
+	float R = args[0], X = args[1], Y = args[2], Z = args[3];
+	float t;
+	int i;
+
+	glBegin(GL_TRIANGLE_FAN);
+	glNormal3f(0.0, 0.0, 1.0);
+	glVertex3f(X, Y, Z);
+	for (i = 0; i <= N; ++i)
+	{
+		t = 2 * M_PI * i / N;
+		glVertex3f(X + cos(t) * R, Y + sin(t) * R, Z);
+	}
+	glEnd();
+}
+
+// Function to draw an annulus with a true hole, inner radius args[0], outer radius
+// args[1] and center (args[2], args[3]).
+void drawAnnulus(const float *args)
+{
+	float angle;
+	int i;
+
+	glBegin(GL_TRIANGLE_STRIP);
+	for (i = 0; i <= N; ++i)
+	{
+		angle = 2 * M_PI * i / N;
+		glVertex3f(args[2] + cos(angle) * args[0], args[3] + sin(angle) * args[0], 0.0);
+		glVertex3f(args[2] + cos(angle) * args[1], args[3] + sin(angle) * args[1], 0.0);
+	}
+	glEnd();
+}
+
+// Routine to submit a disc. z is in [-1, 1] as set by glOrtho().
+void submitDisc(int pass, int depthTest, int lighting, int material, float R, float X, float Y, float Z)
+{
+	DrawState state = { pass, depthTest, 0, lighting, material };
+	float args[] = { R, X, Y, Z };
+	queue.submit(state, (1.0 - Z) / 2.0, drawDisc, args, 4);
+}
+
+// Routine to submit the draws of one cell of size s with lower left corner (x, y),
+// in the same order as circularAnnuluses.cpp would draw them.
+void submitCell(int kind, float x, float y, float s)
+{
+	float cx = x + 0.5 * s, cy = y + 0.5 * s;
+
+	switch (kind)
+	{
+	case OVERWRITTEN: // The white disc overwrites the red disc.
+		submitDisc(PAINTER_PASS, 0, 0, red, 0.4 * s, cx, cy, 0.0);
+		submitDisc(PAINTER_PASS, 0, 0, white, 0.2 * s, cx, cy, 0.0);
+		break;
+	case FLOATING: // The white disc is in front of the red disc blocking it.
+		submitDisc(OPAQUE_PASS, 1, 0, red, 0.4 * s, cx, cy, 0.0);
+		submitDisc(OPAQUE_PASS, 1, 0, white, 0.2 * s, cx, cy, 0.5);
+		break;
+	case REAL_DEAL: // A true hole.
+	{
+		DrawState state = { OPAQUE_PASS, 0, isWire, 0, red };
+		float args[] = { 0.2f * s, 0.4f * s, cx, cy };
+		queue.submit(state, 0.5, drawAnnulus, args, 4);
+		break;
+	}
+	case LIT: // A lit blue disc with an unlit white marker in front of it.
+		submitDisc(OPAQUE_PASS, 1, 1, blue, 0.4 * s, cx, cy, 0.0);
+		submitDisc(OPAQUE_PASS, 1, 0, white, 0.05 * s, cx, cy, 0.5);
+		break;
+	default:
+		break;
+	}
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	char buffer[128];
+	float s = 90.0 / gridSize;
+	int i, j;
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	PROFILE_PHASE("submit");
+	for (j = 0; j < gridSize; j++)
+		for (i = 0; i < gridSize; i++)
+			submitCell((i + 3 * j) % NUM_CELL_KINDS, 5.0 + i * s, 8.0 + j * s, s);
+
+	PROFILE_PHASE("flush queue");
+	auto start = std::chrono::high_resolution_clock::now();
+	queue.flush();
+	flushMillis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	PROFILE_PHASE("text");
+	// Write state change counts.
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(buffer, "%d draws, state changes: %d in submission order, %d sorted (%s), flush %.2f ms",
+		queue.numDraws, queue.unsorted.total(), queue.sorted.total(), queue.sortEnabled ? "sorted" : "unsorted", flushMillis);
+	glRasterPos3f(2.0, 4.0, 0.0);
+	writeBitmapString((void*)font, buffer);
+	sprintf(buffer, "depth %d/%d, polygon mode %d/%d, lighting %d/%d, material %d/%d",
+		queue.unsorted.depthTest, queue.sorted.depthTest, queue.unsorted.wire, queue.sorted.wire,
+		queue.unsorted.lighting, queue.sorted.lighting, queue.unsorted.material, queue.sorted.material);
+	glRasterPos3f(2.0, 1.0, 0.0);
+	writeBitmapString((void*)font, buffer);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	float lightPos[] = { 0.0, 0.0, 1.0, 0.0 };
+
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	// A directional light along the viewing direction for the lit discs.
+	glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+	glEnable(GL_LIGHT0);
+
+	red = queue.addMaterial(1.0, 0.0, 0.0);
+	white = queue.addMaterial(1.0, 1.0, 1.0);
+	blue = queue.addMaterial(0.0, 0.0, 1.0);
+	queue.setPassOrdered(PAINTER_PASS, true);
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case ' ':
+		if (isWire == 0) isWire = 1;
+		else isWire = 0;
+		glutPostRedisplay();
+		break;
+	case 's':
+		queue.sortEnabled = !queue.sortEnabled;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (gridSize < 256) gridSize *= 2;
+		glutPostRedisplay();
+		break;
+	case '-':
+		if (gridSize > 1) gridSize /= 2;
+		glutPostRedisplay();
+		break;
+	case 27:
+		exit(0);
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press the space bar to toggle between wireframe and filled for the true annuluses." << std::endl
+		<< "Press s to toggle between issuing draws sorted and in submission order." << std::endl
+		<< "Press +/- to increase/decrease the number of cells." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("renderQueue.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
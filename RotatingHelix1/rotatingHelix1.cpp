@@ -7,6 +7,9 @@
 // Interaction:
 // Press space to turn the helix.
 //
+// The helix's globals and routines are those of the unit RotatingHelix1
+// (rotatingHelix1.h), which the launcher runs too.
+//
 //  Sumanta Guha.
 /////////////////////////////////////////////////////////////////
 
@@ -19,88 +22,18 @@
 #include <GL/glew.h>
 #include <GL/freeglut.h> 
 
-// Globals.
-static float angle = 0.0; // Angle of rotation.
-
-// Drawing routine.
-void drawScene(void)
-{
-	float R = 20.0; // Radius of helix.
-
-	float t; // Angle parameter along helix.
-
-	glClear(GL_COLOR_BUFFER_BIT);
-	glColor3f(0.0, 0.0, 0.0);
-	glPushMatrix();
-
-	// The Trick: to align the axis of the helix along the y-axis prior to rotation
-	// and then return it to its original location.
-	glTranslatef(0.0, 0.0, -60.0);
-	glRotatef(angle, 0.0, 1.0, 0.0);
-	glTranslatef(0.0, 0.0, 60.0);
-
-	glBegin(GL_LINE_STRIP);
-	for (t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
-		glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
-	glEnd();
-
-	glPopMatrix();
-	glutSwapBuffers();
-}
-
-// Initialization routine.
-void setup(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-}
-
-// OpenGL window reshape routine.
-void resize(int w, int h)
-{
-	glViewport(0, 0, w, h);
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-}
-
-// Routine to increase the rotation angle.
-void increaseAngle(void)
-{
-	angle += 5.0;
-	if (angle > 360.0) angle -= 360.0;
-	glutPostRedisplay();
-}
-
-// Keyboard input processing routine.
-void keyInput(unsigned char key, int x, int y)
-{
-	switch (key)
-	{
-	case 27:
-		exit(0);
-		break;
-	case ' ':
-		increaseAngle();
-		break;
-	default:
-		break;
-	}
-}
+#define DEMO_GL_TRACE
+#include "../Common/demoHooks.h"
+#include "rotatingHelix1.h"
 
-// Routine to output interaction instructions to the C++ window.
-void printInteraction(void)
-{
-	std::cout << "Interaction:" << std::endl;
-	std::cout << "Press space to turn the helix." << std::endl;
-}
+static RotatingHelix1 rotatingHelix1; // The demo.
 
 // Main routine.
 int main(int argc, char **argv)
 {
-	printInteraction();
+	rotatingHelix1.printInteraction();
 	glutInit(&argc, argv);
+	demoInit(&argc, argv);
 
 	glutInitContextVersion(4, 3);
 	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
@@ -109,14 +42,9 @@ int main(int argc, char **argv)
 	glutInitWindowSize(500, 500);
 	glutInitWindowPosition(100, 100);
 	glutCreateWindow("rotatingHelix1.cpp");
-	glutDisplayFunc(drawScene);
-	glutReshapeFunc(resize);
-	glutKeyboardFunc(keyInput);
-
-	glewExperimental = GL_TRUE;
-	glewInit();
+	demoUnitCallbacks(&rotatingHelix1);
 
-	setup();
+	demoSetup(&rotatingHelix1);
 
 	glutMainLoop();
 }
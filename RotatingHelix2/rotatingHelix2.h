@@ -0,0 +1,122 @@
+/////////////////////////////////////////////////////////////////
+// rotatingHelix2.h
+//
+// The rotating helix of rotatingHelix2.cpp as a demo unit (demoUnit.h): its globals
+// and routines, run by rotatingHelix2.cpp and by the launcher.
+/////////////////////////////////////////////////////////////////
+
+#ifndef ROTATING_HELIX2_H
+#define ROTATING_HELIX2_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+
+class RotatingHelix2 : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void increaseAngle(void);
+	void keyInput(unsigned char key, int x, int y);
+	void printInteraction(void);
+
+	// Globals.
+	int isAnimate = 0; // Animated?
+	float angle = 0.0; // Angle of rotation.
+};
+
+// Drawing routine.
+inline void RotatingHelix2::drawScene(void)
+{
+	float R = 20.0; // Radius of helix.
+
+	float t; // Angle parameter along helix.
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+
+	PROFILE_PHASE("helix");
+	glPushMatrix();
+
+	// The Trick: to align the axis of the helix along the y-axis prior to rotation
+	// and then return it to its original location.
+	glTranslatef(0.0, 0.0, -60.0);
+	glRotatef(angle, 0.0, 1.0, 0.0);
+	glTranslatef(0.0, 0.0, 60.0);
+
+	glBegin(GL_LINE_STRIP);
+	for (t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
+		glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
+	glEnd();
+
+	glPopMatrix();
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+inline void RotatingHelix2::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void RotatingHelix2::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Routine to increase the rotation angle.
+inline void RotatingHelix2::increaseAngle(void)
+{
+	angle += 5.0;
+	if (angle > 360.0) angle -= 360.0;
+	glutPostRedisplay();
+}
+
+// Keyboard input processing routine.
+inline void RotatingHelix2::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate)
+		{
+			isAnimate = 0;
+			idleFunc(NULL);
+		}
+		else
+		{
+			isAnimate = 1;
+			idleFunc(&RotatingHelix2::increaseAngle);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void RotatingHelix2::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl;
+}
+
+#endif
@@ -0,0 +1,143 @@
+//////////////////////////////////////////////////////////////////////
+// rotatingHelix3.h
+//
+// The rotating helix of rotatingHelix3.cpp as a demo unit (demoUnit.h): its globals
+// and routines, run by rotatingHelix3.cpp and by the launcher.
+//////////////////////////////////////////////////////////////////////
+
+#ifndef ROTATING_HELIX3_H
+#define ROTATING_HELIX3_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+
+class RotatingHelix3 : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void increaseAngle(void);
+	void animate(int value);
+	void keyInput(unsigned char key, int x, int y);
+	void specialKeyInput(int key, int x, int y);
+	void printInteraction(void);
+
+	// Globals.
+	int isAnimate = 0; // Animated?
+	int animationPeriod = 50; // Time interval between frames.
+	float angle = 0.0; // Angle of rotation.
+};
+
+// Drawing routine.
+inline void RotatingHelix3::drawScene(void)
+{
+	float R = 20.0; // Radius of helix.
+
+	float t; // Angle parameter along helix.
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+
+	PROFILE_PHASE("helix");
+	glPushMatrix();
+
+	// The Trick: to align the axis of the helix along the y-axis prior to rotation
+	// and then return it to its original location.
+	glTranslatef(0.0, 0.0, -60.0);
+	glRotatef(angle, 0.0, 1.0, 0.0);
+	glTranslatef(0.0, 0.0, 60.0);
+
+	glBegin(GL_LINE_STRIP);
+	for (t = -10 * M_PI; t <= 10 * M_PI; t += M_PI / 20.0)
+		glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
+	glEnd();
+
+	glPopMatrix();
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+inline void RotatingHelix3::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void RotatingHelix3::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Routine to increase the rotation angle.
+inline void RotatingHelix3::increaseAngle(void)
+{
+	angle += 5.0;
+	if (angle > 360.0) angle -= 360.0;
+}
+
+// Routine to animate with a recursive call made after animationPeriod msecs.
+inline void RotatingHelix3::animate(int value)
+{
+	if (isAnimate)
+	{
+		increaseAngle();
+
+		glutPostRedisplay();
+		timerFunc(animationPeriod, &RotatingHelix3::animate, 1);
+	}
+}
+
+// Keyboard input processing routine.
+inline void RotatingHelix3::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate) isAnimate = 0;
+		else
+		{
+			isAnimate = 1;
+			animate(1);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+// Callback routine for non-ASCII key entry.
+inline void RotatingHelix3::specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_DOWN) animationPeriod += 5;
+	if (key == GLUT_KEY_UP)
+		if (animationPeriod > 5) animationPeriod -= 5;
+	glutPostRedisplay();
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void RotatingHelix3::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl
+		<< "Press the up/down arrow keys to speed up/slow down animation." << std::endl;
+}
+
+#endif
@@ -0,0 +1,142 @@
+////////////////////////////////////////////////////////////////
+// rotatingHelixFPS.h
+//
+// The rotating helix of rotatingHelixFPS.cpp as a demo unit (demoUnit.h): its
+// globals and routines, run by rotatingHelixFPS.cpp and by the launcher.
+////////////////////////////////////////////////////////////////
+
+#ifndef ROTATING_HELIX_FPS_H
+#define ROTATING_HELIX_FPS_H
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include "../Common/demoUnit.h"
+
+class RotatingHelixFPS : public DemoUnit
+{
+public:
+   void drawScene(void);
+   void build(void);
+   void setup(void);
+   void resize(int w, int h);
+   void increaseAngle(void);
+   void frameCounter(int value);
+   void keyInput(unsigned char key, int x, int y);
+   void printInteraction(void);
+
+   // Globals.
+   int isAnimate = 0; // Animated?
+   float angle = 0.0; // Angle of rotation.
+   int frameCount = 0; // Number of frames
+};
+
+// Drawing routine.
+inline void RotatingHelixFPS::drawScene(void)
+{  
+   float R = 20.0; // Radius of helix.
+
+   float t; // Angle parameter along helix.
+
+   frameCount++; // Increment number of frames every redraw.
+
+   demoFrameBegin();
+
+   PROFILE_PHASE("clear");
+   glClear(GL_COLOR_BUFFER_BIT);
+   glColor3f(0.0, 0.0, 0.0);
+
+   PROFILE_PHASE("helix");
+   glPushMatrix();
+
+   // The Trick: to align the axis of the helix along the y-axis prior to rotation
+   // and then return it to its original location.
+   glTranslatef(0.0, 0.0, -60.0);
+   glRotatef(angle, 0.0, 1.0, 0.0);
+   glTranslatef(0.0, 0.0, 60.0);
+
+   glBegin(GL_LINE_STRIP);
+   for(t = -10 * M_PI; t <= 10 * M_PI; t += M_PI/20.0) 
+      glVertex3f(R * cos(t), t, R * sin(t) - 60.0);
+   glEnd();
+   
+   glPopMatrix();
+   PROFILE_PHASE("swap");
+   demoFrameEnd();
+}
+
+// Routine to start counting frames, once.
+inline void RotatingHelixFPS::build(void)
+{
+   timerFunc(0, &RotatingHelixFPS::frameCounter, 0); // Initial call of frameCounter().
+}
+
+// Initialization routine.
+inline void RotatingHelixFPS::setup(void)
+{
+   glClearColor(1.0, 1.0, 1.0, 0.0); 
+}
+
+// OpenGL window reshape routine.
+inline void RotatingHelixFPS::resize(int w, int h)
+{
+   glViewport(0, 0, w, h);
+   glMatrixMode(GL_PROJECTION);
+   glLoadIdentity();
+   glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+   glMatrixMode(GL_MODELVIEW);
+   glLoadIdentity();
+}
+
+// Routine to increase the rotation angle.
+inline void RotatingHelixFPS::increaseAngle(void)
+{
+   angle += 5.0;
+   if (angle > 360.0) angle -= 360.0;
+   glutPostRedisplay();
+}
+
+// Routine to count the number of frames drawn every second.
+inline void RotatingHelixFPS::frameCounter(int value)
+{
+   if (value != 0) // No output the first time frameCounter() is called (from build()).
+      std::cout << "FPS = " << frameCount << std::endl;
+   frameCount = 0;
+   timerFunc(1000, &RotatingHelixFPS::frameCounter, 1);
+}
+
+// Keyboard input processing routine.
+inline void RotatingHelixFPS::keyInput(unsigned char key, int x, int y)
+{
+   demoInput();
+   switch(key) 
+   {
+      case 27:
+         exit(0);
+         break;
+      case ' ':
+         if(isAnimate) 
+		 {
+            isAnimate = 0;
+		    idleFunc(NULL);
+		 }
+		 else 
+		 {
+            isAnimate = 1;
+		    idleFunc(&RotatingHelixFPS::increaseAngle);
+		 }
+         break;
+      default:
+         break;
+   }
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void RotatingHelixFPS::printInteraction(void)
+{
+   std::cout << "Interaction:" << std::endl;
+   std::cout << "Press space to toggle between animation on and off." << std::endl;
+}
+
+#endif
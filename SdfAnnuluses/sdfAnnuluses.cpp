@@ -0,0 +1,395 @@
+///////////////////////////////////////////////////////////////////////////////////////////
+// sdfAnnuluses.cpp
+//
+// This program enhances circularAnnuluses.cpp with a signed-distance mode: instead of
+// approximating each disc by a 40-segment triangle fan and each annulus by an 82-vertex
+// triangle strip, every disc or annulus is a single quad whose fragment shader computes
+// the distance to the center, and from it the coverage of the disc or ring, with
+// anti-aliased edges one pixel wide. The circles are exact at any resolution.
+//
+// All quads of a frame are drawn by one instanced draw call, one instance per disc or
+// annulus. To compare the costs, the scene can be replaced by a grid of many rings,
+// drawn either way; the vertices sent and the CPU and GPU (timer query) times are shown
+// in the window, the GPU time read a frame or more late so as not to wait for it.
+//
+// Interaction:
+// Press the space bar to toggle between wirefrime and filled for the lower annulus
+// (outlines in signed-distance mode).
+// Press m to toggle between triangle geometry and signed-distance quads.
+// Press +/- to multiply/divide the number of rings of the grid by 4 (0 for the
+// original scene).
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/programCache.h"
+#include "../Common/demoHooks.h"
+
+#define N 40.0 // Number of vertices on the boundary of the disc.
+
+// One disc (inner radius 0) or annulus, as one instance.
+struct Ring
+{
+	float x, y, z; // Center.
+	float inner, outer; // Radii.
+	float r, g, b; // Color.
+	float outline; // Draw only the edges?
+};
+
+// Globals.
+static int isWire = 0; // Is wireframe?
+static int isSdf = 1; // Signed-distance mode?
+static int numRings = 0; // Rings in the grid, 0 for the original scene.
+static long font = (long)GLUT_BITMAP_8_BY_13; // Font selection.
+static int width = 500, height = 500; // Window size.
+static std::vector<Ring> rings; // Rings of the frame.
+static unsigned int program, vao, ringBuffer; // GL objects.
+static unsigned int queries[2]; // GPU timers of alternate frames.
+static int frame = 0; // Frames drawn.
+static double cpuMillis = 0.0, gpuMillis = 0.0; // Times of the scene.
+static int pixelSizeLoc; // Location of the pixelSize uniform.
+static long long numVertices; // Vertices sent in the frame.
+
+// Vertex shader: expand the instance into a quad covering the ring plus a pixel of margin.
+static const char *vertexShaderSource =
+"#version 430 compatibility\n"
+"layout(location = 0) in vec3 center;\n"
+"layout(location = 1) in vec2 radii;\n"
+"layout(location = 2) in vec3 color;\n"
+"layout(location = 3) in float outline;\n"
+"uniform float pixelSize;\n"
+"out vec2 local;\n"
+"flat out vec2 ringRadii;\n"
+"flat out vec3 ringColor;\n"
+"flat out float ringOutline;\n"
+"void main(void)\n"
+"{\n"
+"   vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;\n"
+"   local = corner * (radii.y + pixelSize);\n"
+"   ringRadii = radii;\n"
+"   ringColor = color;\n"
+"   ringOutline = outline;\n"
+"   gl_Position = gl_ModelViewProjectionMatrix * vec4(center.xy + local, center.z, 1.0);\n"
+"}\n";
+
+// Fragment shader: coverage of the ring from the distance to its center; the
+// transition over one pixel (fwidth) gives resolution-independent anti-aliasing.
+static const char *fragmentShaderSource =
+"#version 430 compatibility\n"
+"in vec2 local;\n"
+"flat in vec2 ringRadii;\n"
+"flat in vec3 ringColor;\n"
+"flat in float ringOutline;\n"
+"out vec4 fragColor;\n"
+"void main(void)\n"
+"{\n"
+"   float d = length(local);\n"
+"   float aa = fwidth(d);\n"
+"   float coverage = clamp((ringRadii.y - d) / aa + 0.5, 0.0, 1.0);\n"
+"   if (ringRadii.x > 0.0) coverage *= clamp((d - ringRadii.x) / aa + 0.5, 0.0, 1.0);\n"
+"   if (ringOutline != 0.0)\n"
+"      coverage *= 1.0 - clamp(min(ringRadii.y - d, d - ringRadii.x) / aa - 0.5, 0.0, 1.0);\n"
+"   if (coverage <= 0.0) discard;\n"
+"   fragColor = vec4(ringColor, coverage);\n"
+"}\n";
+
+// Routine to draw a bitmap character string.
+void writeBitmapString(void *font, char *string)
+{
+	char *c;
+
+	for (c = string; *c != '\0'; c++) glutBitmapCharacter(font, *c);
+}
+
+// Function to draw a disc with center at (X, Y, Z), radius R, parallel to the xy-plane.
+void drawDisc(float R, float X, float Y, float Z)
+{
+	float t;
+	int i;
+
+	numVertices += (int)N + 2;
+	glBegin(GL_TRIANGLE_FAN);
+	glVertex3f(X, Y, Z);
+	for (i = 0; i <= N; ++i)
+	{
+		t = 2 * M_PI * i / N;
+		glVertex3f(X + cos(t) * R, Y + sin(t) * R, Z);
+	}
+	glEnd();
+}
+
+// Function to draw an annulus with a true hole, as the lower annulus of circularAnnuluses.cpp.
+void drawAnnulus(float inner, float outer, float X, float Y)
+{
+	float angle;
+	int i;
+
+	numVertices += 2 * (int)N + 2;
+	glBegin(GL_TRIANGLE_STRIP);
+	for (i = 0; i <= N; ++i)
+	{
+		angle = 2 * M_PI * i / N;
+		glVertex3f(X + cos(angle) * inner, Y + sin(angle) * inner, 0.0);
+		glVertex3f(X + cos(angle) * outer, Y + sin(angle) * outer, 0.0);
+	}
+	glEnd();
+}
+
+// Routine to add a ring to the frame's list.
+void addRing(float inner, float outer, float X, float Y, float Z, float r, float g, float b, int outline)
+{
+	Ring ring = { X, Y, Z, inner, outer, r, g, b, (float)outline };
+	rings.push_back(ring);
+}
+
+// Routine to draw all rings of the list with one instanced draw.
+void drawRings(void)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, ringBuffer);
+	glBufferData(GL_ARRAY_BUFFER, rings.size() * sizeof(Ring), rings.data(), GL_STREAM_DRAW);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glUseProgram(program);
+	glUniform1f(pixelSizeLoc, 100.0 / (width < height ? width : height));
+	glBindVertexArray(vao);
+	numVertices += 4 * (long long)rings.size();
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (int)rings.size());
+	glBindVertexArray(0);
+	glUseProgram(0);
+	glDisable(GL_BLEND);
+
+	rings.clear();
+}
+
+// Routine to draw the three annuluses of circularAnnuluses.cpp.
+void drawOriginalScene(void)
+{
+	if (!isSdf)
+	{
+		glPolygonMode(GL_FRONT, GL_FILL);
+
+		// Upper left circular annulus: the white disc overwrites the red disc.
+		glColor3f(1.0, 0.0, 0.0);
+		drawDisc(20.0, 25.0, 75.0, 0.0);
+		glColor3f(1.0, 1.0, 1.0);
+		drawDisc(10.0, 25.0, 75.0, 0.0);
+
+		// Upper right circular annulus: the white disc is in front of the red disc blocking it.
+		glEnable(GL_DEPTH_TEST);
+		glColor3f(1.0, 0.0, 0.0);
+		drawDisc(20.0, 75.0, 75.0, 0.0);
+		glColor3f(1.0, 1.0, 1.0);
+		drawDisc(10.0, 75.0, 75.0, 0.5);
+		glDisable(GL_DEPTH_TEST);
+
+		// Lower circular annulus: with a true hole.
+		if (isWire) glPolygonMode(GL_FRONT, GL_LINE); else glPolygonMode(GL_FRONT, GL_FILL);
+		glColor3f(1.0, 0.0, 0.0);
+		drawAnnulus(10.0, 20.0, 50.0, 30.0);
+		glPolygonMode(GL_FRONT, GL_FILL);
+	}
+	else
+	{
+		// The same discs and annulus, in the same order, one quad each. Depth testing is
+		// on for all of them: the overwritten pair is at the same depth, drawn in order.
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(GL_LEQUAL);
+		addRing(0.0, 20.0, 25.0, 75.0, 0.0, 1.0, 0.0, 0.0, 0);
+		addRing(0.0, 10.0, 25.0, 75.0, 0.0, 1.0, 1.0, 1.0, 0);
+		addRing(0.0, 20.0, 75.0, 75.0, 0.0, 1.0, 0.0, 0.0, 0);
+		addRing(0.0, 10.0, 75.0, 75.0, 0.5, 1.0, 1.0, 1.0, 0);
+		addRing(10.0, 20.0, 50.0, 30.0, 0.0, 1.0, 0.0, 0.0, isWire);
+		drawRings();
+		glDepthFunc(GL_LESS);
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	// Write labels.
+	glColor3f(0.0, 0.0, 0.0);
+	glRasterPos3f(15.0, 51.0, 0.0);
+	writeBitmapString((void*)font, "Overwritten");
+	glRasterPos3f(69.0, 51.0, 0.0);
+	writeBitmapString((void*)font, "Floating");
+	glRasterPos3f(38.0, 6.0, 0.0);
+	writeBitmapString((void*)font, "The real deal!");
+}
+
+// Routine to draw a square grid of numRings red annuluses.
+void drawGrid(void)
+{
+	int side = (int)ceil(sqrt((float)numRings));
+	float s = 100.0 / side;
+	int i;
+
+	if (!isSdf)
+	{
+		glPolygonMode(GL_FRONT, isWire ? GL_LINE : GL_FILL);
+		glColor3f(1.0, 0.0, 0.0);
+		for (i = 0; i < numRings; i++)
+			drawAnnulus(0.2 * s, 0.4 * s, (i % side + 0.5) * s, (i / side + 0.5) * s);
+		glPolygonMode(GL_FRONT, GL_FILL);
+	}
+	else
+	{
+		for (i = 0; i < numRings; i++)
+			addRing(0.2 * s, 0.4 * s, (i % side + 0.5) * s, (i / side + 0.5) * s, 0.0, 1.0, 0.0, 0.0, isWire);
+		drawRings();
+	}
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	char text[128];
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear the buffers including the depth buffer.
+
+	PROFILE_PHASE("scene");
+	// Read the GPU time of the frame before last, if in.
+	int available = 0;
+	if (frame >= 2) glGetQueryObjectiv(queries[frame % 2], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available)
+	{
+		GLuint64 nanos;
+		glGetQueryObjectui64v(queries[frame % 2], GL_QUERY_RESULT, &nanos);
+		gpuMillis = nanos * 1.0e-6;
+	}
+
+	numVertices = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	glBeginQuery(GL_TIME_ELAPSED, queries[frame % 2]);
+	if (numRings == 0) drawOriginalScene(); else drawGrid();
+	glEndQuery(GL_TIME_ELAPSED);
+	cpuMillis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	frame++;
+
+	PROFILE_PHASE("text");
+	glColor3f(0.0, 0.0, 0.0);
+	sprintf(text, "%s: %d discs/annuluses, %lld vertices, CPU %.2f ms, GPU %.2f ms",
+		isSdf ? "Signed distance" : "Geometry", numRings ? numRings : 5, numVertices, cpuMillis, gpuMillis);
+	glWindowPos2i(5, height - 15);
+	writeBitmapString((void*)font, text);
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	program = programCacheBuild(vertexShaderSource, fragmentShaderSource);
+	pixelSizeLoc = glGetUniformLocation(program, "pixelSize");
+
+	// Instance attributes from the Ring array.
+	glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+	glGenBuffers(1, &ringBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, ringBuffer);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Ring), (void *)offsetof(Ring, x));
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Ring), (void *)offsetof(Ring, inner));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Ring), (void *)offsetof(Ring, r));
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Ring), (void *)offsetof(Ring, outline));
+	for (int i = 0; i < 4; i++)
+	{
+		glEnableVertexAttribArray(i);
+		glVertexAttribDivisor(i, 1);
+	}
+	glBindVertexArray(0);
+
+	glGenQueries(2, queries);
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	width = w;
+	height = h;
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case ' ':
+		if (isWire == 0) isWire = 1;
+		else isWire = 0;
+		glutPostRedisplay();
+		break;
+	case 'm':
+		if (isSdf == 0) isSdf = 1;
+		else isSdf = 0;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (numRings == 0) numRings = 1;
+		else if (numRings < (1 << 20)) numRings *= 4;
+		glutPostRedisplay();
+		break;
+	case '-':
+		numRings /= 4;
+		glutPostRedisplay();
+		break;
+	case 27:
+		exit(0);
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press the space bar to toggle between wirefrime and filled for the lower annulus." << std::endl
+		<< "Press m to toggle between triangle geometry and signed-distance quads." << std::endl
+		<< "Press +/- to multiply/divide the number of rings of the grid by 4 (0 for the original scene)." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_SINGLE | GLUT_RGBA | GLUT_DEPTH);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("sdfAnnuluses.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
@@ -0,0 +1,1471 @@
+////////////////////////////////////////////////////////////////////////////////////
+// softRaster.cpp
+//
+// This program renders a trace captured from a demo with glTrace.h on the CPU,
+// with a rasterizer implementing just the subset of OpenGL the demos use, for
+// machines without a GPU where the general-purpose llvmpipe is the alternative:
+//
+//   hemisphere -capture hemisphere.trace 300
+//   softRaster hemisphere.trace [-threads n] [-repeat n] [-out prefix]
+//
+// Supported are immediate mode (all glBegin() primitives), glDrawElements() of
+// client arrays, the matrix calls including gluPerspective() and gluLookAt(),
+// glPolygonMode() fill and line, back-face culling, the depth test (GL_LESS), and
+// fixed-function lighting: up to 8 lights, positional or directional, with
+// attenuation and spots, front and back materials, GL_COLOR_MATERIAL, local viewer
+// and two-sided lighting. The GLUT wire and solid shapes are tessellated as
+// freeglut does. Bitmap text, which needs GLUT's fonts, is skipped and counted.
+//
+// Each frame runs in two stages. The front end, on the main thread, transforms and
+// lights the vertices, assembles and clips the primitives, and sets each one up,
+// snapped to 28.4 fixed point, in the bins of the 64x64-pixel tiles it touches,
+// in submission order. At the end of the frame the back end rasterizes the tiles
+// in parallel on a WorkerPool: each thread starts with a contiguous range of the
+// non-empty tiles and, when done, steals the upper half of the largest range left,
+// so an expensive tile costs no more than its own time. Triangles are rasterized
+// with half-space edge functions: an edge which misses a tile rejects it, one
+// which covers it is dropped from the per-pixel test, and the rest are evaluated
+// four pixels at a time with SSE2 integers, exactly, followed by a 4-wide depth
+// test and perspective-correct color interpolation in float.
+//
+// Per frame, the front end, raster and total times are written to the C++ window,
+// then their minimum, mean, median and maximum; with -out every frame is written
+// as prefix_00000.ppm, ... For comparison with llvmpipe replay the same trace with
+// traceReplay on Mesa's software driver (LIBGL_ALWAYS_SOFTWARE=1 on Linux) and
+// compare its wall times with the totals here. Measured so on one core of a Xeon,
+// with Mesa 22.3.6's llvmpipe and traces of 300 frames at 500x500, the medians in
+// ms, llvmpipe then softRaster, were: hemisphere 0.67 and 0.63, clown3 0.46 and
+// 0.37, sphereInBox1 1.87 and 2.83, lightAndMaterial1 24.8 and 33.6 (llvmpipe
+// also drawing the text skipped here). With one core the tiles cannot be spread
+// over threads, and llvmpipe is ahead on the heavier scenes.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE
+#include <emmintrin.h>
+#endif
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define GL_TRACE_NO_HOOKS
+#include "../Common/glTrace.h"
+#include "../Common/vecmath.h"
+#include "../Common/workerPool.h"
+
+#define TILE 64 // Tile size in pixels.
+#define SUBPIXEL 16 // Fixed-point steps per pixel.
+#define MAX_SIZE 4096 // Largest framebuffer side, keeping edge values in 32 bits within a tile.
+#define MAX_LIGHTS 8
+#define MAX_POLYGON 32 // Vertices of a polygon clipped whole; a larger GL_POLYGON is split.
+#define MAX_CLIPPED (MAX_POLYGON + 6) // Each of the 6 planes adds at most one vertex.
+
+// A vertex after transformation and lighting, in clip coordinates.
+struct ClipVertex
+{
+	Vec4 clip;
+	float front[3], back[3]; // Colors for front and back faces.
+};
+
+// A vertex in window coordinates.
+struct WindowVertex
+{
+	float x, y, z, invW;
+	float color[3];
+};
+
+// A triangle set up for rasterization.
+struct SetupTriangle
+{
+	int A[3], B[3]; // Edge function coefficients, per pixel in fixed point.
+	long long C[3]; // Edge function constants, with the fill-rule bias.
+	int minX, minY, maxX, maxY; // Pixel bounds, inclusive, within the viewport.
+	float ox, oy; // Window position of vertex 0.
+	float plane[5][3]; // z, 1/w, r/w, g/w, b/w: value at vertex 0, x and y gradients.
+	bool depthTest;
+};
+
+// A line set up for rasterization.
+struct SetupLine
+{
+	WindowVertex v[2];
+	int width;
+	int minX, minY, maxX, maxY; // Viewport, inclusive.
+	bool depthTest;
+};
+
+// A clear.
+struct SetupClear
+{
+	unsigned int mask;
+	unsigned int color;
+};
+
+// Rasterizer commands, in the bins of the tiles.
+enum CommandType { COMMAND_CLEAR, COMMAND_TRIANGLE, COMMAND_LINE };
+
+struct Command
+{
+	unsigned char type;
+	unsigned int index;
+};
+
+// A light's parameters, positions and directions in eye coordinates.
+struct Light
+{
+	float ambient[4], diffuse[4], specular[4];
+	Vec4 position, spotDirection;
+	float spotExponent, spotCutoff, attenuation[3];
+	bool enabled;
+};
+
+// A material.
+struct Material
+{
+	float ambient[4], diffuse[4], specular[4], emission[4], shininess;
+};
+
+// Timing and counts of one frame.
+struct FrameStats
+{
+	double front, raster, total; // ms.
+	int triangles, lines, culled, tiles, steals;
+};
+
+// Globals: the trace.
+static TraceReader trace; // The trace.
+static TraceDraw draw; // The glDrawElements() being run.
+static int width = 500, height = 500; // Window size during capture.
+
+// Globals: the front end's GL state.
+static MatrixStack modelview, projection;
+static MatrixStack *current = &modelview; // Stack of the matrix mode.
+static float normalMatrix[9]; // Inverse transpose of the modelview's upper 3x3.
+static bool normalMatrixValid = false;
+static int viewport[4] = { 0, 0, 500, 500 };
+static float clearColor[4] = { 0.0, 0.0, 0.0, 0.0 };
+static float currentColor[3] = { 1.0, 1.0, 1.0 }, currentNormal[3] = { 0.0, 0.0, 1.0 };
+static bool depthTest = false, cullFace = false, lighting = false, colorMaterial = false, normalize = false;
+static unsigned int cullMode = GL_BACK, polygonMode[2] = { GL_FILL, GL_FILL }; // Front, back.
+static int lineWidth = 1;
+static Light lights[MAX_LIGHTS];
+static Material materials[2]; // Front, back.
+static float modelAmbient[4] = { 0.2, 0.2, 0.2, 1.0 };
+static bool localViewer = false, twoSide = false;
+static unsigned int primitiveMode = GL_POINTS; // Of glBegin().
+static std::vector<ClipVertex> primitive; // Vertices since glBegin().
+
+// Globals: the frame's setup primitives, bins and framebuffer.
+static std::vector<SetupTriangle> triangles;
+static std::vector<SetupLine> lines;
+static std::vector<SetupClear> clears;
+static std::vector<Command> commands;
+static std::vector<std::vector<unsigned int> > bins; // Command indices per tile.
+static int tilesX, tilesY, stride; // Tiles across and down, framebuffer row length.
+static std::vector<unsigned int> colorBuffer; // RGBA8, bottom row first, padded to whole tiles.
+static std::vector<float> depthBuffer;
+static FrameStats stats;
+static long long skippedText = 0; // Bitmap characters not drawn.
+
+// Globals: the back end.
+static WorkerPool *pool = NULL;
+static std::vector<unsigned int> work; // Non-empty tiles of the frame.
+static std::vector<std::atomic<unsigned long long> > ranges; // Per thread: first << 32 | end of its tiles.
+static std::atomic<int> steals;
+
+// Routine to set the GL defaults of lights and materials.
+void resetState(void)
+{
+	for (int i = 0; i < MAX_LIGHTS; i++)
+	{
+		Light &l = lights[i];
+		float one = i == 0 ? 1.0 : 0.0; // Only light 0 is white by default.
+		for (int k = 0; k < 4; k++)
+		{
+			l.ambient[k] = k == 3 ? 1.0 : 0.0;
+			l.diffuse[k] = k == 3 ? 1.0 : one;
+			l.specular[k] = k == 3 ? 1.0 : one;
+		}
+		l.position = Vec4(0.0, 0.0, 1.0, 0.0);
+		l.spotDirection = Vec4(0.0, 0.0, -1.0, 0.0);
+		l.spotExponent = 0.0;
+		l.spotCutoff = 180.0;
+		l.attenuation[0] = 1.0; l.attenuation[1] = 0.0; l.attenuation[2] = 0.0;
+		l.enabled = false;
+	}
+	for (int f = 0; f < 2; f++)
+	{
+		Material &m = materials[f];
+		for (int k = 0; k < 4; k++)
+		{
+			m.ambient[k] = k == 3 ? 1.0 : 0.2;
+			m.diffuse[k] = k == 3 ? 1.0 : 0.8;
+			m.specular[k] = k == 3 ? 1.0 : 0.0;
+			m.emission[k] = k == 3 ? 1.0 : 0.0;
+		}
+		m.shininess = 0.0;
+	}
+}
+
+// Routine to compute the normal matrix from the modelview, once after each change.
+const float *getNormalMatrix(void)
+{
+	if (normalMatrixValid) return normalMatrix;
+	const Mat4 &m = modelview.top();
+	float a = m(0, 0), b = m(0, 1), c = m(0, 2), d = m(1, 0), e = m(1, 1), f = m(1, 2), g = m(2, 0), h = m(2, 1), i = m(2, 2);
+	float det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+	float s = det != 0.0 ? 1.0 / det : 0.0;
+	// Inverse transpose, row-major: the cofactors over the determinant.
+	normalMatrix[0] = (e * i - f * h) * s; normalMatrix[1] = -(d * i - f * g) * s; normalMatrix[2] = (d * h - e * g) * s;
+	normalMatrix[3] = -(b * i - c * h) * s; normalMatrix[4] = (a * i - c * g) * s; normalMatrix[5] = -(a * h - b * g) * s;
+	normalMatrix[6] = (b * f - c * e) * s; normalMatrix[7] = -(a * f - c * d) * s; normalMatrix[8] = (a * e - b * d) * s;
+	normalMatrixValid = true;
+	return normalMatrix;
+}
+
+// Routine to give the lit color of a vertex at eye position p with unit normal n.
+void lightVertex(const Material &m, const Vec4 &p, const float n[3], float color[3])
+{
+	for (int k = 0; k < 3; k++) color[k] = m.emission[k] + m.ambient[k] * modelAmbient[k];
+	for (int i = 0; i < MAX_LIGHTS; i++)
+	{
+		const Light &l = lights[i];
+		if (!l.enabled) continue;
+
+		float L[3], attenuation = 1.0, spot = 1.0;
+		if (l.position.w == 0.0)
+		{
+			float r = sqrtf(l.position.x * l.position.x + l.position.y * l.position.y + l.position.z * l.position.z);
+			L[0] = l.position.x / r; L[1] = l.position.y / r; L[2] = l.position.z / r;
+		}
+		else
+		{
+			L[0] = l.position.x / l.position.w - p.x;
+			L[1] = l.position.y / l.position.w - p.y;
+			L[2] = l.position.z / l.position.w - p.z;
+			float d = sqrtf(L[0] * L[0] + L[1] * L[1] + L[2] * L[2]);
+			if (d > 0.0) { L[0] /= d; L[1] /= d; L[2] /= d; }
+			attenuation = 1.0 / (l.attenuation[0] + l.attenuation[1] * d + l.attenuation[2] * d * d);
+			if (l.spotCutoff != 180.0)
+			{
+				Vec4 s = normalize3(l.spotDirection);
+				float c = -(L[0] * s.x + L[1] * s.y + L[2] * s.z);
+				spot = c < cosf(l.spotCutoff * M_PI / 180.0) ? 0.0 : powf(c, l.spotExponent);
+			}
+		}
+		float scale = attenuation * spot;
+		if (scale == 0.0) continue;
+
+		float nDotL = n[0] * L[0] + n[1] * L[1] + n[2] * L[2];
+		float specular = 0.0;
+		if (nDotL > 0.0)
+		{
+			float H[3] = { L[0], L[1], L[2] + 1.0f };
+			if (localViewer)
+			{
+				float r = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+				if (r > 0.0) { H[0] = L[0] - p.x / r; H[1] = L[1] - p.y / r; H[2] = L[2] - p.z / r; }
+			}
+			float h = sqrtf(H[0] * H[0] + H[1] * H[1] + H[2] * H[2]);
+			float nDotH = h > 0.0 ? (n[0] * H[0] + n[1] * H[1] + n[2] * H[2]) / h : 0.0;
+			specular = nDotH > 0.0 ? powf(nDotH, m.shininess) : (m.shininess == 0.0 ? 1.0 : 0.0);
+		}
+		else nDotL = 0.0;
+		for (int k = 0; k < 3; k++)
+			color[k] += scale * (l.ambient[k] * m.ambient[k] + l.diffuse[k] * m.diffuse[k] * nDotL
+				+ (nDotL > 0.0 ? l.specular[k] * m.specular[k] * specular : 0.0));
+	}
+	for (int k = 0; k < 3; k++) color[k] = color[k] < 0.0 ? 0.0 : (color[k] > 1.0 ? 1.0 : color[k]);
+}
+
+// Routine to transform and light a vertex in object coordinates and add it to the
+// current primitive.
+void addVertex(float x, float y, float z)
+{
+	ClipVertex v;
+	Vec4 eye = modelview.top() * Vec4(x, y, z, 1.0);
+	v.clip = projection.top() * eye;
+
+	if (lighting)
+	{
+		const float *N = getNormalMatrix();
+		float n[3];
+		for (int i = 0; i < 3; i++) n[i] = N[3 * i] * currentNormal[0] + N[3 * i + 1] * currentNormal[1] + N[3 * i + 2] * currentNormal[2];
+		if (normalize)
+		{
+			float r = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (r > 0.0) { n[0] /= r; n[1] /= r; n[2] /= r; }
+		}
+		lightVertex(materials[0], eye, n, v.front);
+		if (twoSide)
+		{
+			float back[3] = { -n[0], -n[1], -n[2] };
+			lightVertex(materials[1], eye, back, v.back);
+		}
+		else memcpy(v.back, v.front, sizeof(v.front));
+	}
+	else
+	{
+		memcpy(v.front, currentColor, sizeof(currentColor));
+		memcpy(v.back, currentColor, sizeof(currentColor));
+	}
+	primitive.push_back(v);
+}
+
+// Routine to interpolate between two clip vertices.
+ClipVertex lerp(const ClipVertex &a, const ClipVertex &b, float t)
+{
+	ClipVertex v;
+	v.clip = a.clip + (b.clip - a.clip) * t;
+	for (int k = 0; k < 3; k++)
+	{
+		v.front[k] = a.front[k] + (b.front[k] - a.front[k]) * t;
+		v.back[k] = a.back[k] + (b.back[k] - a.back[k]) * t;
+	}
+	return v;
+}
+
+// Routine to give the distance of a clip vertex inside plane k of the view volume.
+inline float planeDistance(const Vec4 &c, int k)
+{
+	switch (k)
+	{
+	case 0: return c.w + c.x;
+	case 1: return c.w - c.x;
+	case 2: return c.w + c.y;
+	case 3: return c.w - c.y;
+	case 4: return c.w + c.z;
+	default: return c.w - c.z;
+	}
+}
+
+// Routine to clip the polygon of n vertices to the view volume, Sutherland-Hodgman,
+// into clipped, which has room for MAX_CLIPPED vertices; gives the number left.
+int clipPolygon(const ClipVertex *polygon, int n, ClipVertex *clipped)
+{
+	ClipVertex scratch[MAX_CLIPPED];
+	const ClipVertex *in = polygon;
+	for (int k = 0; k < 6 && n; k++)
+	{
+		ClipVertex *out = k % 2 ? clipped : scratch; // The last plane, 5, writes to clipped.
+		int m = 0;
+		for (int i = 0; i < n; i++)
+		{
+			const ClipVertex &a = in[i], &b = in[(i + 1) % n];
+			float da = planeDistance(a.clip, k), db = planeDistance(b.clip, k);
+			if (da >= 0.0) out[m++] = a;
+			if ((da >= 0.0) != (db >= 0.0)) out[m++] = lerp(a, b, da / (da - db));
+		}
+		in = out;
+		n = m;
+	}
+	return n;
+}
+
+// Routine to clip a line to the view volume, Liang-Barsky; false if nothing is left.
+bool clipLine(ClipVertex &a, ClipVertex &b)
+{
+	float t0 = 0.0, t1 = 1.0;
+	for (int k = 0; k < 6; k++)
+	{
+		float da = planeDistance(a.clip, k), db = planeDistance(b.clip, k);
+		if (da < 0.0 && db < 0.0) return false;
+		if (da < 0.0) t0 = std::max(t0, da / (da - db));
+		else if (db < 0.0) t1 = std::min(t1, da / (da - db));
+	}
+	if (t0 > t1) return false;
+	ClipVertex a0 = a;
+	if (t1 < 1.0) b = lerp(a0, b, t1);
+	if (t0 > 0.0) a = lerp(a0, b, t0 / t1);
+	return true;
+}
+
+// Routine to map a clip vertex to the window, taking the color of the given side.
+WindowVertex toWindow(const ClipVertex &c, bool back)
+{
+	WindowVertex v;
+	float invW = 1.0 / c.clip.w;
+	v.x = viewport[0] + (c.clip.x * invW + 1.0) * 0.5 * viewport[2];
+	v.y = viewport[1] + (c.clip.y * invW + 1.0) * 0.5 * viewport[3];
+	v.z = (c.clip.z * invW + 1.0) * 0.5;
+	v.invW = invW;
+	memcpy(v.color, back ? c.back : c.front, sizeof(v.color));
+	return v;
+}
+
+// Routine to give the pixel bounds of the viewport within the framebuffer, inclusive.
+void viewportBounds(int &minX, int &minY, int &maxX, int &maxY)
+{
+	minX = std::max(viewport[0], 0);
+	minY = std::max(viewport[1], 0);
+	maxX = std::min(viewport[0] + viewport[2], width) - 1;
+	maxY = std::min(viewport[1] + viewport[3], height) - 1;
+}
+
+// Routine to append a command to the bins of the tiles [tx0, tx1] x [ty0, ty1].
+void binCommand(CommandType type, unsigned int index, int tx0, int ty0, int tx1, int ty1)
+{
+	unsigned int c = (unsigned int)commands.size();
+	Command command = { (unsigned char)type, index };
+	commands.push_back(command);
+	for (int ty = ty0; ty <= ty1; ty++)
+		for (int tx = tx0; tx <= tx1; tx++) bins[ty * tilesX + tx].push_back(c);
+}
+
+// Routine to give an edge function's largest value over the pixel centres of the
+// rectangle [x0, x1] x [y0, y1].
+inline long long edgeMax(const SetupTriangle &t, int i, int x0, int y0, int x1, int y1)
+{
+	long long x = t.A[i] > 0 ? x1 : x0, y = t.B[i] > 0 ? y1 : y0;
+	return (long long)t.A[i] * x + (long long)t.B[i] * y + t.C[i];
+}
+
+// Routine to set up a filled triangle in window coordinates and bin it.
+void setupTriangle(WindowVertex v0, WindowVertex v1, WindowVertex v2)
+{
+	SetupTriangle t;
+	int x[3], y[3];
+	const WindowVertex *v[3] = { &v0, &v1, &v2 };
+
+	for (int i = 0; i < 3; i++)
+	{
+		x[i] = (int)floorf(v[i]->x * SUBPIXEL + 0.5f);
+		y[i] = (int)floorf(v[i]->y * SUBPIXEL + 0.5f);
+	}
+	long long area = (long long)(x[1] - x[0]) * (y[2] - y[0]) - (long long)(x[2] - x[0]) * (y[1] - y[0]);
+	if (area == 0) return;
+	if (area < 0) // Counterclockwise, for edge functions positive inside.
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(v[1], v[2]);
+		area = -area;
+	}
+
+	// Edge i runs from vertex i + 1 to i + 2, so its function vanishes at both and
+	// is positive at vertex i; evaluated at pixel centres (px + 1/2, py + 1/2).
+	for (int i = 0; i < 3; i++)
+	{
+		int a = (i + 1) % 3, b = (i + 2) % 3;
+		int dx = x[b] - x[a], dy = y[b] - y[a];
+		t.A[i] = -dy * SUBPIXEL;
+		t.B[i] = dx * SUBPIXEL;
+		t.C[i] = (long long)dx * (SUBPIXEL / 2 - y[a]) - (long long)dy * (SUBPIXEL / 2 - x[a]);
+		bool topLeft = dy < 0 || (dy == 0 && dx > 0); // Exactly one of two triangles sharing an edge owns it.
+		if (!topLeft) t.C[i] -= 1;
+	}
+
+	int minX, minY, maxX, maxY;
+	viewportBounds(minX, minY, maxX, maxY);
+	t.minX = std::max(minX, (std::min(x[0], std::min(x[1], x[2]))) / SUBPIXEL);
+	t.minY = std::max(minY, (std::min(y[0], std::min(y[1], y[2]))) / SUBPIXEL);
+	t.maxX = std::min(maxX, (std::max(x[0], std::max(x[1], x[2]))) / SUBPIXEL);
+	t.maxY = std::min(maxY, (std::max(y[0], std::max(y[1], y[2]))) / SUBPIXEL);
+	if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+	// Attribute planes through the three vertices, from vertex 0.
+	float fx1 = (x[1] - x[0]) / (float)SUBPIXEL, fy1 = (y[1] - y[0]) / (float)SUBPIXEL;
+	float fx2 = (x[2] - x[0]) / (float)SUBPIXEL, fy2 = (y[2] - y[0]) / (float)SUBPIXEL;
+	float invArea = (float)(SUBPIXEL * SUBPIXEL) / (float)area;
+	float values[5][3];
+	for (int i = 0; i < 3; i++)
+	{
+		values[0][i] = v[i]->z;
+		values[1][i] = v[i]->invW;
+		for (int k = 0; k < 3; k++) values[2 + k][i] = v[i]->color[k] * v[i]->invW;
+	}
+	for (int p = 0; p < 5; p++)
+	{
+		float d1 = values[p][1] - values[p][0], d2 = values[p][2] - values[p][0];
+		t.plane[p][0] = values[p][0];
+		t.plane[p][1] = (d1 * fy2 - d2 * fy1) * invArea;
+		t.plane[p][2] = (d2 * fx1 - d1 * fx2) * invArea;
+	}
+	t.ox = x[0] / (float)SUBPIXEL;
+	t.oy = y[0] / (float)SUBPIXEL;
+	t.depthTest = depthTest;
+
+	// Bin to the tiles of the bounds that no edge rejects.
+	unsigned int index = (unsigned int)triangles.size();
+	triangles.push_back(t);
+	unsigned int c = (unsigned int)commands.size();
+	Command command = { COMMAND_TRIANGLE, index };
+	commands.push_back(command);
+	for (int ty = t.minY / TILE; ty <= t.maxY / TILE; ty++)
+		for (int tx = t.minX / TILE; tx <= t.maxX / TILE; tx++)
+		{
+			int x0 = std::max(t.minX, tx * TILE), y0 = std::max(t.minY, ty * TILE);
+			int x1 = std::min(t.maxX, tx * TILE + TILE - 1), y1 = std::min(t.maxY, ty * TILE + TILE - 1);
+			if (edgeMax(t, 0, x0, y0, x1, y1) < 0 || edgeMax(t, 1, x0, y0, x1, y1) < 0 || edgeMax(t, 2, x0, y0, x1, y1) < 0)
+				continue;
+			bins[ty * tilesX + tx].push_back(c);
+		}
+	stats.triangles++;
+}
+
+// Routine to set up a line in window coordinates and bin it.
+void setupLine(const WindowVertex &v0, const WindowVertex &v1)
+{
+	SetupLine l;
+	l.v[0] = v0;
+	l.v[1] = v1;
+	l.width = lineWidth;
+	l.depthTest = depthTest;
+	viewportBounds(l.minX, l.minY, l.maxX, l.maxY);
+
+	int r = (lineWidth + 1) / 2;
+	int x0 = std::max(l.minX, (int)floorf(std::min(v0.x, v1.x)) - r), x1 = std::min(l.maxX, (int)floorf(std::max(v0.x, v1.x)) + r);
+	int y0 = std::max(l.minY, (int)floorf(std::min(v0.y, v1.y)) - r), y1 = std::min(l.maxY, (int)floorf(std::max(v0.y, v1.y)) + r);
+	if (x0 > x1 || y0 > y1) return;
+
+	unsigned int index = (unsigned int)lines.size();
+	lines.push_back(l);
+	unsigned int c = (unsigned int)commands.size();
+	Command command = { COMMAND_LINE, index };
+	commands.push_back(command);
+
+	// Bin to the tiles along the line: for each tile column (row) of an x-major
+	// (y-major) line, the tile rows (columns) its minor coordinate spans there.
+	float dx = v1.x - v0.x, dy = v1.y - v0.y;
+	bool xMajor = fabsf(dx) >= fabsf(dy);
+	int major0 = xMajor ? x0 : y0, major1 = xMajor ? x1 : y1;
+	for (int m = major0 / TILE; m <= major1 / TILE; m++)
+	{
+		float a = (float)std::max(major0, m * TILE), b = (float)std::min(major1, m * TILE + TILE - 1) + 1.0f;
+		float s = xMajor ? (dx != 0.0 ? dy / dx : 0.0) : (dy != 0.0 ? dx / dy : 0.0);
+		float origin = xMajor ? v0.x : v0.y, minor = xMajor ? v0.y : v0.x;
+		float ma = minor + (a - origin) * s, mb = minor + (b - origin) * s;
+		int lo = (int)floorf(std::min(ma, mb)) - r, hi = (int)floorf(std::max(ma, mb)) + r;
+		lo = std::max(lo, xMajor ? y0 : x0);
+		hi = std::min(hi, xMajor ? y1 : x1);
+		for (int n = lo / TILE; n <= hi / TILE && lo <= hi; n++)
+			bins[xMajor ? n * tilesX + m : m * tilesX + n].push_back(c);
+	}
+	stats.lines++;
+}
+
+// Routine to draw a polygon (triangle, quad or GL_POLYGON) of n <= MAX_POLYGON clip
+// vertices, culling it and drawing it filled or as its edges as the polygon mode
+// says. In line mode the edges from the first vertex to the second and from the
+// last back to the first are left out if inner, when a larger polygon is split.
+void drawPolygon(const ClipVertex *polygon, int n, bool firstInner = false, bool lastInner = false)
+{
+	ClipVertex clipped[MAX_CLIPPED];
+	WindowVertex w[MAX_CLIPPED];
+	int m = clipPolygon(polygon, n, clipped);
+	if (m < 3) return;
+
+	// Facing, from the signed area in window coordinates; counterclockwise is front.
+	for (int i = 0; i < m; i++) w[i] = toWindow(clipped[i], false);
+	float area = 0.0;
+	for (int i = 0; i < m; i++)
+	{
+		const WindowVertex &a = w[i], &b = w[(i + 1) % m];
+		area += a.x * b.y - b.x * a.y;
+	}
+	bool back = area < 0.0;
+	if (cullFace && (cullMode == GL_FRONT_AND_BACK || (cullMode == GL_BACK) == back))
+	{
+		stats.culled++;
+		return;
+	}
+	if (back && twoSide && lighting)
+		for (int i = 0; i < m; i++) memcpy(w[i].color, clipped[i].back, sizeof(w[i].color));
+
+	unsigned int mode = polygonMode[back ? 1 : 0];
+	if (mode == GL_FILL)
+	{
+		for (int i = 1; i + 1 < m; i++) setupTriangle(w[0], w[i], w[i + 1]);
+	}
+	else // The original edges, clipped, so no edge made by clipping is drawn.
+	{
+		for (int i = 0; i < n; i++)
+		{
+			if ((i == 0 && firstInner) || (i == n - 1 && lastInner)) continue;
+			ClipVertex a = polygon[i], b = polygon[(i + 1) % n];
+			if (!clipLine(a, b)) continue;
+			WindowVertex wa = toWindow(a, back && twoSide && lighting), wb = toWindow(b, back && twoSide && lighting);
+			if (mode == GL_LINE) setupLine(wa, wb);
+			else
+			{
+				setupLine(wa, wa);
+				setupLine(wb, wb);
+			}
+		}
+	}
+}
+
+// Routine to draw a GL_POLYGON of any number of vertices, split if need be into
+// pieces of at most MAX_POLYGON sharing the first vertex.
+void drawLargePolygon(const ClipVertex *polygon, int n)
+{
+	ClipVertex piece[MAX_POLYGON];
+	piece[0] = polygon[0];
+	for (int i = 1; i + 1 < n; i += MAX_POLYGON - 2)
+	{
+		int m = std::min(n - i, MAX_POLYGON - 1);
+		memcpy(piece + 1, polygon + i, m * sizeof(ClipVertex));
+		drawPolygon(piece, m + 1, i > 1, i + m < n);
+	}
+}
+
+// Routine to draw a line between two clip vertices.
+void drawLine(ClipVertex a, ClipVertex b)
+{
+	if (clipLine(a, b)) setupLine(toWindow(a, false), toWindow(b, false));
+}
+
+// Routine to assemble the vertices since glBegin() into primitives, at glEnd().
+void endPrimitive(void)
+{
+	std::vector<ClipVertex> &v = primitive;
+	size_t n = v.size();
+
+	switch (primitiveMode)
+	{
+	case GL_POINTS:
+		for (size_t i = 0; i < n; i++) drawLine(v[i], v[i]);
+		break;
+	case GL_LINES:
+		for (size_t i = 0; i + 1 < n; i += 2) drawLine(v[i], v[i + 1]);
+		break;
+	case GL_LINE_STRIP:
+	case GL_LINE_LOOP:
+		for (size_t i = 0; i + 1 < n; i++) drawLine(v[i], v[i + 1]);
+		if (primitiveMode == GL_LINE_LOOP && n > 2) drawLine(v[n - 1], v[0]);
+		break;
+	case GL_TRIANGLES:
+		for (size_t i = 0; i + 2 < n; i += 3) drawPolygon(&v[i], 3);
+		break;
+	case GL_TRIANGLE_STRIP:
+		for (size_t i = 0; i + 2 < n; i++)
+			if (i % 2)
+			{
+				ClipVertex t[3] = { v[i + 1], v[i], v[i + 2] };
+				drawPolygon(t, 3);
+			}
+			else drawPolygon(&v[i], 3);
+		break;
+	case GL_TRIANGLE_FAN:
+		for (size_t i = 1; i + 1 < n; i++)
+		{
+			ClipVertex t[3] = { v[0], v[i], v[i + 1] };
+			drawPolygon(t, 3);
+		}
+		break;
+	case GL_QUADS:
+		for (size_t i = 0; i + 3 < n; i += 4) drawPolygon(&v[i], 4);
+		break;
+	case GL_QUAD_STRIP:
+		for (size_t i = 0; i + 3 < n; i += 2)
+		{
+			ClipVertex q[4] = { v[i], v[i + 1], v[i + 3], v[i + 2] };
+			drawPolygon(q, 4);
+		}
+		break;
+	case GL_POLYGON:
+		if (n >= 3) drawLargePolygon(v.data(), (int)n);
+		break;
+	}
+	v.clear();
+}
+
+// Routine to draw a primitive of vertices and normals given as flat arrays.
+void drawArrays(unsigned int mode, const std::vector<float> &vertices, const std::vector<float> &normals)
+{
+	primitiveMode = mode;
+	for (size_t i = 0; i < vertices.size(); i += 3)
+	{
+		memcpy(currentNormal, &normals[i], 3 * sizeof(float));
+		addVertex(vertices[i], vertices[i + 1], vertices[i + 2]);
+	}
+	endPrimitive();
+}
+
+// Routine to draw glutWireSphere() or glutSolidSphere() as freeglut tessellates them:
+// stacks from +z to -z, slices around z, normals radial.
+void drawSphere(double radius, int slices, int stacks, bool solid)
+{
+	std::vector<float> v, n;
+	auto add = [&](int i, int j)
+	{
+		double phi = M_PI * i / stacks, theta = 2.0 * M_PI * j / slices;
+		float nx = (float)(cos(theta) * sin(phi)), ny = (float)(-sin(theta) * sin(phi)), nz = (float)cos(phi);
+		v.push_back(nx * radius); v.push_back(ny * radius); v.push_back(nz * radius);
+		n.push_back(nx); n.push_back(ny); n.push_back(nz);
+	};
+	if (solid)
+	{
+		for (int i = 0; i < stacks; i++)
+		{
+			v.clear(); n.clear();
+			for (int j = 0; j <= slices; j++) { add(i, j); add(i + 1, j); }
+			drawArrays(GL_TRIANGLE_STRIP, v, n);
+		}
+		return;
+	}
+	for (int i = 1; i < stacks; i++) // Latitude loops.
+	{
+		v.clear(); n.clear();
+		for (int j = 0; j < slices; j++) add(i, j);
+		drawArrays(GL_LINE_LOOP, v, n);
+	}
+	for (int j = 0; j < slices; j++) // Meridians.
+	{
+		v.clear(); n.clear();
+		for (int i = 0; i <= stacks; i++) add(i, j);
+		drawArrays(GL_LINE_STRIP, v, n);
+	}
+}
+
+// Routine to draw glutWireCone(): base circles up the z axis and lines to the apex.
+void drawCone(double base, double height, int slices, int stacks)
+{
+	std::vector<float> v, n;
+	double slant = atan2(base, height);
+	auto add = [&](double r, double z, int j)
+	{
+		double theta = 2.0 * M_PI * j / slices;
+		v.push_back((float)(r * cos(theta))); v.push_back((float)(r * sin(theta))); v.push_back((float)z);
+		n.push_back((float)(cos(theta) * cos(slant))); n.push_back((float)(sin(theta) * cos(slant))); n.push_back((float)sin(slant));
+	};
+	for (int i = 0; i < stacks; i++)
+	{
+		v.clear(); n.clear();
+		for (int j = 0; j < slices; j++) add(base * (stacks - i) / stacks, height * i / stacks, j);
+		drawArrays(GL_LINE_LOOP, v, n);
+	}
+	for (int j = 0; j < slices; j++)
+	{
+		v.clear(); n.clear();
+		add(base, 0.0, j);
+		add(0.0, height, j);
+		drawArrays(GL_LINES, v, n);
+	}
+}
+
+// Routine to draw glutWireTorus() about the z axis: a loop per ring and per side.
+void drawTorus(double inner, double outer, int sides, int rings)
+{
+	std::vector<float> v, n;
+	auto add = [&](int ring, int side)
+	{
+		double phi = 2.0 * M_PI * ring / rings, theta = 2.0 * M_PI * side / sides;
+		double r = outer + inner * cos(theta);
+		v.push_back((float)(r * cos(phi))); v.push_back((float)(r * sin(phi))); v.push_back((float)(inner * sin(theta)));
+		n.push_back((float)(cos(phi) * cos(theta))); n.push_back((float)(sin(phi) * cos(theta))); n.push_back((float)sin(theta));
+	};
+	for (int i = 0; i < rings; i++)
+	{
+		v.clear(); n.clear();
+		for (int j = 0; j < sides; j++) add(i, j);
+		drawArrays(GL_LINE_LOOP, v, n);
+	}
+	for (int j = 0; j < sides; j++)
+	{
+		v.clear(); n.clear();
+		for (int i = 0; i < rings; i++) add(i, j);
+		drawArrays(GL_LINE_LOOP, v, n);
+	}
+}
+
+// Routine to draw glutWireCube(): the outlines of its six faces.
+void drawCube(double size)
+{
+	static const float normals[6][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { -1, 0, 0 }, { 0, -1, 0 }, { 0, 0, -1 } };
+	static const int faces[6][4][3] = {
+		{ { 1, -1, 1 }, { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 } }, { { 1, 1, 1 }, { 1, 1, -1 }, { -1, 1, -1 }, { -1, 1, 1 } },
+		{ { 1, 1, 1 }, { -1, 1, 1 }, { -1, -1, 1 }, { 1, -1, 1 } }, { { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, -1 } },
+		{ { -1, -1, 1 }, { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 } }, { { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 }, { -1, -1, -1 } } };
+	std::vector<float> v, n;
+	for (int f = 0; f < 6; f++)
+	{
+		v.clear(); n.clear();
+		for (int k = 0; k < 4; k++)
+			for (int i = 0; i < 3; i++)
+			{
+				v.push_back((float)(faces[f][k][i] * size / 2.0));
+				n.push_back(normals[f][i]);
+			}
+		drawArrays(GL_LINE_LOOP, v, n);
+	}
+}
+
+// Routine to set a light parameter, transforming positions and directions to eye
+// coordinates by the current modelview as GL does.
+void setLight(unsigned int light, unsigned int pname, const float *params)
+{
+	if (light < GL_LIGHT0 || light >= GL_LIGHT0 + MAX_LIGHTS) return;
+	Light &l = lights[light - GL_LIGHT0];
+	switch (pname)
+	{
+	case GL_AMBIENT: memcpy(l.ambient, params, sizeof(l.ambient)); break;
+	case GL_DIFFUSE: memcpy(l.diffuse, params, sizeof(l.diffuse)); break;
+	case GL_SPECULAR: memcpy(l.specular, params, sizeof(l.specular)); break;
+	case GL_POSITION: l.position = modelview.top() * Vec4(params[0], params[1], params[2], params[3]); break;
+	case GL_SPOT_DIRECTION: l.spotDirection = modelview.top() * Vec4(params[0], params[1], params[2], 0.0); break;
+	case GL_SPOT_EXPONENT: l.spotExponent = params[0]; break;
+	case GL_SPOT_CUTOFF: l.spotCutoff = params[0]; break;
+	case GL_CONSTANT_ATTENUATION: l.attenuation[0] = params[0]; break;
+	case GL_LINEAR_ATTENUATION: l.attenuation[1] = params[0]; break;
+	case GL_QUADRATIC_ATTENUATION: l.attenuation[2] = params[0]; break;
+	}
+}
+
+// Routine to set a material parameter of the front, back or both materials.
+void setMaterial(unsigned int face, unsigned int pname, const float *params)
+{
+	for (int f = 0; f < 2; f++)
+	{
+		if ((f == 0 && face == GL_BACK) || (f == 1 && face == GL_FRONT)) continue;
+		Material &m = materials[f];
+		switch (pname)
+		{
+		case GL_AMBIENT: memcpy(m.ambient, params, sizeof(m.ambient)); break;
+		case GL_DIFFUSE: memcpy(m.diffuse, params, sizeof(m.diffuse)); break;
+		case GL_AMBIENT_AND_DIFFUSE:
+			memcpy(m.ambient, params, sizeof(m.ambient));
+			memcpy(m.diffuse, params, sizeof(m.diffuse));
+			break;
+		case GL_SPECULAR: memcpy(m.specular, params, sizeof(m.specular)); break;
+		case GL_EMISSION: memcpy(m.emission, params, sizeof(m.emission)); break;
+		case GL_SHININESS: m.shininess = params[0]; break;
+		}
+	}
+}
+
+// Routine to set a light model parameter.
+void setLightModel(unsigned int pname, const float *params)
+{
+	if (pname == GL_LIGHT_MODEL_AMBIENT) memcpy(modelAmbient, params, sizeof(modelAmbient));
+	else if (pname == GL_LIGHT_MODEL_LOCAL_VIEWER) localViewer = params[0] != 0.0;
+	else if (pname == GL_LIGHT_MODEL_TWO_SIDE) twoSide = params[0] != 0.0;
+}
+
+// Routine to set a capability.
+void setCapability(unsigned int cap, bool on)
+{
+	switch (cap)
+	{
+	case GL_DEPTH_TEST: depthTest = on; break;
+	case GL_CULL_FACE: cullFace = on; break;
+	case GL_LIGHTING: lighting = on; break;
+	case GL_COLOR_MATERIAL: colorMaterial = on; break;
+	case GL_NORMALIZE:
+	case GL_RESCALE_NORMAL: normalize = on; break;
+	default:
+		if (cap >= GL_LIGHT0 && cap < GL_LIGHT0 + MAX_LIGHTS) lights[cap - GL_LIGHT0].enabled = on;
+	}
+}
+
+// Routine to pack a color as RGBA8.
+inline unsigned int packColor(const float *c, float alpha)
+{
+	unsigned int r = 0;
+	for (int k = 0; k < 4; k++)
+	{
+		float v = k < 3 ? c[k] : alpha;
+		v = v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+		r |= (unsigned int)(v * 255.0f + 0.5f) << (8 * k);
+	}
+	return r;
+}
+
+// Routine to rasterize a triangle within the pixels [x0, x1] x [y0, y1] of a tile.
+void rasterTriangle(const SetupTriangle &t, int x0, int y0, int x1, int y1)
+{
+	// Edges covering the whole rectangle need no test; the rest cross it, so their
+	// values there fit in 32 bits.
+	bool test[3];
+	int e0[3]; // At the pixel (x0 rounded down to 4, y0).
+	int xs = x0 & ~3;
+	for (int i = 0; i < 3; i++)
+	{
+		long long emin = (long long)t.A[i] * (t.A[i] > 0 ? xs : x1) + (long long)t.B[i] * (t.B[i] > 0 ? y0 : y1) + t.C[i];
+		if (edgeMax(t, i, xs, y0, x1, y1) < 0) return;
+		test[i] = emin < 0;
+		e0[i] = test[i] ? (int)((long long)t.A[i] * xs + (long long)t.B[i] * y0 + t.C[i]) : 0;
+	}
+	float dx0 = xs + 0.5f - t.ox, dy0 = y0 + 0.5f - t.oy;
+
+#ifdef USE_SSE
+	const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i stepX[3], edgeRow[3];
+	for (int i = 0; i < 3; i++)
+	{
+		stepX[i] = _mm_set1_epi32(4 * t.A[i]);
+		edgeRow[i] = _mm_setr_epi32(e0[i], e0[i] + t.A[i], e0[i] + 2 * t.A[i], e0[i] + 3 * t.A[i]);
+	}
+	const __m128 laneF = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	__m128 planeX[5], planeStep[5];
+	for (int p = 0; p < 5; p++)
+	{
+		planeX[p] = _mm_add_ps(_mm_set1_ps(t.plane[p][0] + t.plane[p][1] * dx0), _mm_mul_ps(laneF, _mm_set1_ps(t.plane[p][1])));
+		planeStep[p] = _mm_set1_ps(4.0f * t.plane[p][1]);
+	}
+	const __m128i minusOne = _mm_set1_epi32(-1), alpha = _mm_set1_epi32((int)0xFF000000);
+	const __m128 scale = _mm_set1_ps(255.0f), half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+	__m128i xFirst = _mm_set1_epi32(x0 - 1), xEnd = _mm_set1_epi32(x1 + 1);
+
+	for (int y = y0; y <= y1; y++)
+	{
+		__m128i e[3] = { edgeRow[0], edgeRow[1], edgeRow[2] };
+		float dy = dy0 + (y - y0);
+		__m128 v[5];
+		for (int p = 0; p < 5; p++) v[p] = _mm_add_ps(planeX[p], _mm_set1_ps(t.plane[p][2] * dy));
+		unsigned int *color = &colorBuffer[(size_t)y * stride];
+		float *depth = &depthBuffer[(size_t)y * stride];
+		__m128i px = _mm_add_epi32(_mm_set1_epi32(xs), lane);
+
+		for (int x = xs; x <= x1; x += 4)
+		{
+			__m128i mask = _mm_and_si128(_mm_cmpgt_epi32(px, xFirst), _mm_cmplt_epi32(px, xEnd));
+			for (int i = 0; i < 3; i++)
+				if (test[i]) mask = _mm_and_si128(mask, _mm_cmpgt_epi32(e[i], minusOne));
+			if (_mm_movemask_epi8(mask))
+			{
+				__m128 z = v[0];
+				__m128 d = _mm_loadu_ps(depth + x);
+				if (t.depthTest)
+				{
+					mask = _mm_and_si128(mask, _mm_castps_si128(_mm_cmplt_ps(z, d)));
+					__m128 m = _mm_castsi128_ps(mask);
+					_mm_storeu_ps(depth + x, _mm_or_ps(_mm_and_ps(m, z), _mm_andnot_ps(m, d)));
+				}
+				if (_mm_movemask_epi8(mask))
+				{
+					__m128 w = _mm_div_ps(one, v[1]);
+					__m128i rgb = alpha;
+					for (int k = 0; k < 3; k++)
+					{
+						__m128 c = _mm_min_ps(_mm_max_ps(_mm_mul_ps(v[2 + k], w), zero), one);
+						__m128i ci = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), half));
+						rgb = _mm_or_si128(rgb, _mm_slli_epi32(ci, 8 * k));
+					}
+					__m128i old = _mm_loadu_si128((const __m128i *)(color + x));
+					_mm_storeu_si128((__m128i *)(color + x), _mm_or_si128(_mm_and_si128(mask, rgb), _mm_andnot_si128(mask, old)));
+				}
+			}
+			for (int i = 0; i < 3; i++) e[i] = _mm_add_epi32(e[i], stepX[i]);
+			for (int p = 0; p < 5; p++) v[p] = _mm_add_ps(v[p], planeStep[p]);
+			px = _mm_add_epi32(px, _mm_set1_epi32(4));
+		}
+		for (int i = 0; i < 3; i++) edgeRow[i] = _mm_add_epi32(edgeRow[i], _mm_set1_epi32(t.B[i]));
+	}
+#else
+	for (int y = y0; y <= y1; y++)
+	{
+		int e[3] = { e0[0] + t.B[0] * (y - y0), e0[1] + t.B[1] * (y - y0), e0[2] + t.B[2] * (y - y0) };
+		float dy = dy0 + (y - y0);
+		unsigned int *color = &colorBuffer[(size_t)y * stride];
+		float *depth = &depthBuffer[(size_t)y * stride];
+		for (int x = xs; x <= x1; x++, e[0] += t.A[0], e[1] += t.A[1], e[2] += t.A[2])
+		{
+			if (x < x0 || (test[0] && e[0] < 0) || (test[1] && e[1] < 0) || (test[2] && e[2] < 0)) continue;
+			float dx = dx0 + (x - xs), v[5];
+			for (int p = 0; p < 5; p++) v[p] = t.plane[p][0] + t.plane[p][1] * dx + t.plane[p][2] * dy;
+			if (t.depthTest)
+			{
+				if (!(v[0] < depth[x])) continue;
+				depth[x] = v[0];
+			}
+			float c[3] = { v[2] / v[1], v[3] / v[1], v[4] / v[1] };
+			color[x] = packColor(c, 1.0);
+		}
+	}
+#endif
+}
+
+// Routine to rasterize a line within the pixels [x0, x1] x [y0, y1] of a tile:
+// one pixel a column (row) of an x-major (y-major) line, replicated across the
+// minor axis for wide lines, as for GL's aliased lines.
+void rasterLine(const SetupLine &l, int x0, int y0, int x1, int y1)
+{
+	const WindowVertex &a = l.v[0], &b = l.v[1];
+	x0 = std::max(x0, l.minX); y0 = std::max(y0, l.minY);
+	x1 = std::min(x1, l.maxX); y1 = std::min(y1, l.maxY);
+	float dx = b.x - a.x, dy = b.y - a.y;
+	bool xMajor = fabsf(dx) >= fabsf(dy);
+	float length = xMajor ? dx : dy;
+	int lo = -(l.width - 1) / 2, hi = l.width / 2;
+
+	// Centres of the major-axis pixels from a's up to but excluding b's, so strips
+	// draw shared vertices once; a point or zero-length line covers its own pixel.
+	float start = xMajor ? a.x : a.y, end = xMajor ? b.x : b.y;
+	int first, last;
+	if (length == 0.0) first = last = (int)floorf(start);
+	else if (length > 0.0) { first = (int)floorf(start + 0.5f); last = (int)floorf(end + 0.5f) - 1; }
+	else { first = (int)floorf(end + 0.5f) + 1; last = (int)floorf(start + 0.5f); }
+	first = std::max(first, xMajor ? x0 : y0);
+	last = std::min(last, xMajor ? x1 : y1);
+
+	for (int m = first; m <= last; m++)
+	{
+		float t = length == 0.0 ? 0.0 : ((m + 0.5f) - start) / length;
+		t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+		float minor = xMajor ? a.y + t * dy : a.x + t * dx;
+		float z = a.z + t * (b.z - a.z);
+		float invW = a.invW + t * (b.invW - a.invW), c[3];
+		for (int k = 0; k < 3; k++) c[k] = (a.color[k] * a.invW + t * (b.color[k] * b.invW - a.color[k] * a.invW)) / invW;
+		unsigned int packed = packColor(c, 1.0);
+		int n0 = (int)floorf(minor);
+		for (int n = n0 + lo; n <= n0 + hi; n++)
+		{
+			int x = xMajor ? m : n, y = xMajor ? n : m;
+			if (x < x0 || x > x1 || y < y0 || y > y1) continue;
+			size_t p = (size_t)y * stride + x;
+			if (l.depthTest)
+			{
+				if (!(z < depthBuffer[p])) continue;
+				depthBuffer[p] = z;
+			}
+			colorBuffer[p] = packed;
+		}
+	}
+}
+
+// Routine to run the commands binned to one tile, in order.
+void rasterTile(unsigned int tile)
+{
+	int tx = tile % tilesX, ty = tile / tilesX;
+	int x0 = tx * TILE, y0 = ty * TILE, x1 = x0 + TILE - 1, y1 = y0 + TILE - 1;
+	const std::vector<unsigned int> &bin = bins[tile];
+
+	for (size_t i = 0; i < bin.size(); i++)
+	{
+		const Command &c = commands[bin[i]];
+		if (c.type == COMMAND_CLEAR)
+		{
+			const SetupClear &s = clears[c.index];
+			for (int y = y0; y <= y1; y++)
+			{
+				if (s.mask & GL_COLOR_BUFFER_BIT) std::fill(&colorBuffer[(size_t)y * stride + x0], &colorBuffer[(size_t)y * stride + x1] + 1, s.color);
+				if (s.mask & GL_DEPTH_BUFFER_BIT) std::fill(&depthBuffer[(size_t)y * stride + x0], &depthBuffer[(size_t)y * stride + x1] + 1, 1.0f);
+			}
+		}
+		else if (c.type == COMMAND_TRIANGLE)
+		{
+			const SetupTriangle &t = triangles[c.index];
+			int ax = std::max(x0, t.minX), ay = std::max(y0, t.minY), bx = std::min(x1, t.maxX), by = std::min(y1, t.maxY);
+			if (ax <= bx && ay <= by) rasterTriangle(t, ax, ay, bx, by);
+		}
+		else rasterLine(lines[c.index], x0, y0, x1, y1);
+	}
+}
+
+// Routine to take the next tile of range r from its front; false if it is empty.
+bool takeTile(int r, unsigned int &tile)
+{
+	unsigned long long range = ranges[r].load();
+	for (;;)
+	{
+		unsigned int first = (unsigned int)(range >> 32), end = (unsigned int)range;
+		if (first >= end) return false;
+		if (ranges[r].compare_exchange_weak(range, ((unsigned long long)(first + 1) << 32) | end))
+		{
+			tile = work[first];
+			return true;
+		}
+	}
+}
+
+// Routine to steal the upper half of the largest range left into range r; false
+// if all are empty.
+bool stealTiles(int r, int numRanges)
+{
+	for (;;)
+	{
+		int victim = -1;
+		unsigned int most = 0;
+		unsigned long long range = 0;
+		for (int i = 0; i < numRanges; i++)
+		{
+			unsigned long long v = ranges[i].load();
+			unsigned int left = (unsigned int)v - (unsigned int)(v >> 32);
+			if ((unsigned int)(v >> 32) < (unsigned int)v && left > most)
+			{
+				most = left;
+				victim = i;
+				range = v;
+			}
+		}
+		if (victim < 0) return false;
+
+		unsigned int first = (unsigned int)(range >> 32), end = (unsigned int)range;
+		unsigned int middle = first + (end - first) / 2; // A single tile left is taken whole.
+		if (ranges[victim].compare_exchange_strong(range, ((unsigned long long)first << 32) | middle))
+		{
+			ranges[r].store(((unsigned long long)middle << 32) | end);
+			steals++;
+			return true;
+		}
+	}
+}
+
+// Routine to rasterize all the binned tiles on the pool, with work stealing.
+void rasterizeFrame(void)
+{
+	work.clear();
+	for (unsigned int i = 0; i < bins.size(); i++)
+		if (!bins[i].empty()) work.push_back(i);
+	stats.tiles = (int)work.size();
+	steals = 0;
+
+	int numRanges = pool->size();
+	for (int r = 0; r < numRanges; r++)
+	{
+		unsigned long long first = work.size() * r / numRanges, end = work.size() * (r + 1) / numRanges;
+		ranges[r].store((first << 32) | end);
+	}
+	pool->run(numRanges, [](int part, int parts)
+	{
+		unsigned int tile;
+		do
+		{
+			while (takeTile(part, tile)) rasterTile(tile);
+		} while (stealTiles(part, parts));
+	});
+	stats.steals = steals;
+}
+
+// Routine to start a frame: empty the bins and setup lists.
+void beginFrame(void)
+{
+	for (auto &bin : bins) bin.clear();
+	triangles.clear();
+	lines.clear();
+	clears.clear();
+	commands.clear();
+	memset(&stats, 0, sizeof(stats));
+}
+
+// Routine to write the framebuffer as a PPM, top row first.
+void writeFrame(const char *prefix, int frame)
+{
+	char name[256];
+	sprintf(name, "%s_%05d.ppm", prefix, frame);
+	FILE *file = fopen(name, "wb");
+	if (!file) return;
+	fprintf(file, "P6\n%d %d\n255\n", width, height);
+	std::vector<unsigned char> row(3 * width);
+	for (int y = height - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			unsigned int c = colorBuffer[(size_t)y * stride + x];
+			row[3 * x] = c & 0xFF; row[3 * x + 1] = (c >> 8) & 0xFF; row[3 * x + 2] = (c >> 16) & 0xFF;
+		}
+		fwrite(row.data(), 1, row.size(), file);
+	}
+	fclose(file);
+}
+
+// Routine to run the front end over the calls of one frame, returning 0 at the end
+// of the trace.
+int replayFrame(void)
+{
+	while (trace.more())
+	{
+		unsigned char op = trace.get<unsigned char>();
+		switch (op)
+		{
+		case TRACE_FRAME_END:
+			trace.get<unsigned char>();
+			trace.get<unsigned long long>();
+			return 1;
+		case TRACE_BEGIN:
+			primitiveMode = trace.get<unsigned int>();
+			primitive.clear();
+			break;
+		case TRACE_END: endPrimitive(); break;
+		case TRACE_VERTEX3F:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			addVertex(x, y, z);
+			break;
+		}
+		case TRACE_COLOR3F:
+			for (int k = 0; k < 3; k++) currentColor[k] = trace.get<float>();
+			if (colorMaterial)
+			{
+				float c[4] = { currentColor[0], currentColor[1], currentColor[2], 1.0 };
+				setMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, c);
+			}
+			break;
+		case TRACE_MATRIX_MODE: current = trace.get<unsigned int>() == GL_PROJECTION ? &projection : &modelview; break;
+		case TRACE_LOAD_IDENTITY: current->loadIdentity(); normalMatrixValid = false; break;
+		case TRACE_PUSH_MATRIX: current->pushMatrix(); break;
+		case TRACE_POP_MATRIX: current->popMatrix(); normalMatrixValid = false; break;
+		case TRACE_TRANSLATEF:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			current->translate(x, y, z);
+			break;
+		}
+		case TRACE_ROTATEF:
+		{
+			float a = trace.get<float>(), x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			current->rotate(a, x, y, z);
+			normalMatrixValid = false;
+			break;
+		}
+		case TRACE_SCALEF:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			current->scale(x, y, z);
+			normalMatrixValid = false;
+			break;
+		}
+		case TRACE_FRUSTUM:
+		case TRACE_ORTHO:
+		{
+			double a[6];
+			for (int i = 0; i < 6; i++) a[i] = trace.get<double>();
+			if (op == TRACE_FRUSTUM) current->frustum(a[0], a[1], a[2], a[3], a[4], a[5]);
+			else current->ortho(a[0], a[1], a[2], a[3], a[4], a[5]);
+			normalMatrixValid = false;
+			break;
+		}
+		case TRACE_PERSPECTIVE:
+		{
+			double a[4];
+			for (int i = 0; i < 4; i++) a[i] = trace.get<double>();
+			current->perspective(a[0], a[1], a[2], a[3]);
+			normalMatrixValid = false;
+			break;
+		}
+		case TRACE_LOOK_AT:
+		{
+			double a[9];
+			for (int i = 0; i < 9; i++) a[i] = trace.get<double>();
+			current->lookAt(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+			normalMatrixValid = false;
+			break;
+		}
+		case TRACE_VIEWPORT: // Clamped, as to GL_MAX_VIEWPORT_DIMS, to keep window coordinates in range.
+			for (int i = 0; i < 4; i++) viewport[i] = std::max(i < 2 ? -MAX_SIZE : 0, std::min(trace.get<int>(), MAX_SIZE));
+			break;
+		case TRACE_CLEAR:
+		{
+			SetupClear c = { trace.get<unsigned int>(), packColor(clearColor, clearColor[3]) };
+			clears.push_back(c);
+			binCommand(COMMAND_CLEAR, (unsigned int)clears.size() - 1, 0, 0, tilesX - 1, tilesY - 1);
+			break;
+		}
+		case TRACE_CLEAR_COLOR:
+			for (int k = 0; k < 4; k++) clearColor[k] = trace.get<float>();
+			break;
+		case TRACE_ENABLE: setCapability(trace.get<unsigned int>(), true); break;
+		case TRACE_DISABLE: setCapability(trace.get<unsigned int>(), false); break;
+		case TRACE_POLYGON_MODE:
+		{
+			unsigned int face = trace.get<unsigned int>(), mode = trace.get<unsigned int>();
+			if (face != GL_BACK) polygonMode[0] = mode;
+			if (face != GL_FRONT) polygonMode[1] = mode;
+			break;
+		}
+		case TRACE_CULL_FACE: cullMode = trace.get<unsigned int>(); break;
+		case TRACE_LINE_WIDTH: lineWidth = std::max(1, (int)floorf(trace.get<float>() + 0.5f)); break;
+		case TRACE_LIGHTFV:
+		case TRACE_MATERIALFV:
+		{
+			unsigned int a = trace.get<unsigned int>(), pname = trace.get<unsigned int>();
+			float params[4] = { 0.0, 0.0, 0.0, 1.0 };
+			if (!trace.getParams(pname, params)) break;
+			if (op == TRACE_LIGHTFV) setLight(a, pname, params); else setMaterial(a, pname, params);
+			break;
+		}
+		case TRACE_LIGHTF:
+		{
+			unsigned int light = trace.get<unsigned int>(), pname = trace.get<unsigned int>();
+			float params[4] = { trace.get<float>(), 0.0, 0.0, 1.0 };
+			setLight(light, pname, params);
+			break;
+		}
+		case TRACE_LIGHT_MODELFV:
+		{
+			unsigned int pname = trace.get<unsigned int>();
+			float params[4] = { 0.0, 0.0, 0.0, 1.0 };
+			if (!trace.getParams(pname, params)) break;
+			setLightModel(pname, params);
+			break;
+		}
+		case TRACE_LIGHT_MODELI:
+		{
+			unsigned int pname = trace.get<unsigned int>();
+			float params[4] = { (float)trace.get<int>(), 0.0, 0.0, 1.0 };
+			setLightModel(pname, params);
+			break;
+		}
+		case TRACE_RASTER_POS3F:
+			trace.skip(3 * sizeof(float));
+			break;
+		case TRACE_BITMAP_CHARACTER:
+			trace.skip(2 * sizeof(int));
+			skippedText++;
+			break;
+		case TRACE_WIRE_SPHERE:
+		case TRACE_SOLID_SPHERE:
+		{
+			double radius = trace.get<double>();
+			int slices = trace.get<int>(), stacks = trace.get<int>();
+			drawSphere(radius, slices, stacks, op == TRACE_SOLID_SPHERE);
+			break;
+		}
+		case TRACE_WIRE_CUBE: drawCube(trace.get<double>()); break;
+		case TRACE_WIRE_CONE:
+		case TRACE_WIRE_TORUS:
+		{
+			double a = trace.get<double>(), b = trace.get<double>();
+			int c = trace.get<int>(), d = trace.get<int>();
+			if (op == TRACE_WIRE_CONE) drawCone(a, b, c, d); else drawTorus(a, b, c, d);
+			break;
+		}
+		case TRACE_ENABLE_CLIENT_STATE:
+		case TRACE_DISABLE_CLIENT_STATE:
+			trace.get<unsigned int>(); // The arrays recorded with each draw are those enabled.
+			break;
+		case TRACE_DRAW_ELEMENTS:
+		{
+			if (!trace.getDraw(draw)) break;
+			const int *sizes = draw.sizes;
+			primitiveMode = draw.mode;
+			for (int i = 0; i < draw.count; i++)
+			{
+				unsigned int index = draw.index(i);
+				if (sizes[1]) memcpy(currentNormal, &draw.arrays[1][3 * index], 3 * sizeof(float));
+				if (sizes[2]) memcpy(currentColor, &draw.arrays[2][sizes[2] * index], 3 * sizeof(float));
+				if (!sizes[0]) continue;
+				const float *v = &draw.arrays[0][sizes[0] * index];
+				addVertex(v[0], sizes[0] > 1 ? v[1] : 0.0f, sizes[0] > 2 ? v[2] : 0.0f);
+			}
+			endPrimitive();
+			break;
+		}
+		default:
+			std::cout << "Unknown opcode " << (int)op << " at byte " << trace.pos - 1 << std::endl;
+			exit(1);
+		}
+	}
+	if (!trace.ok)
+	{
+		std::cout << "Corrupt trace at byte " << trace.badPos << std::endl;
+		exit(1);
+	}
+	return 0;
+}
+
+// Routine to write the minimum, mean, median and maximum of one column of the timings.
+void writeSummary(const char *name, std::vector<FrameStats> &times, double FrameStats::*column)
+{
+	std::vector<double> v;
+	double sum = 0.0;
+
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		v.push_back(times[i].*column);
+		sum += v.back();
+	}
+	std::sort(v.begin(), v.end());
+	std::cout << name << " ms: min " << v.front() << ", mean " << sum / v.size() << ", median "
+		<< v[v.size() / 2] << ", max " << v.back() << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	int repeats = 1, numThreads = (int)std::thread::hardware_concurrency();
+	const char *path = NULL, *prefix = NULL;
+	std::vector<FrameStats> times;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-repeat") && i + 1 < argc) repeats = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-threads") && i + 1 < argc) numThreads = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-out") && i + 1 < argc) prefix = argv[++i];
+		else path = argv[i];
+	}
+	if (!path)
+	{
+		std::cout << "Usage: softRaster trace [-threads n] [-repeat n] [-out prefix]" << std::endl;
+		return 1;
+	}
+	if (!trace.load(path))
+	{
+		std::cout << "Could not read trace " << path << std::endl;
+		return 1;
+	}
+	width = trace.width;
+	height = trace.height;
+	if (width <= 0 || height <= 0 || width > MAX_SIZE || height > MAX_SIZE)
+	{
+		std::cout << "Window size " << width << " x " << height << " not supported" << std::endl;
+		return 1;
+	}
+	numThreads = std::max(1, numThreads);
+
+	tilesX = (width + TILE - 1) / TILE;
+	tilesY = (height + TILE - 1) / TILE;
+	stride = tilesX * TILE;
+	bins.resize(tilesX * tilesY);
+	colorBuffer.assign((size_t)stride * tilesY * TILE, 0);
+	depthBuffer.assign((size_t)stride * tilesY * TILE, 1.0f);
+	pool = new WorkerPool(numThreads - 1);
+	ranges = std::vector<std::atomic<unsigned long long> >(numThreads);
+
+	std::cout << path << ": " << trace.numFrames << " frames, " << width << " x " << height << ", "
+		<< tilesX * tilesY << " tiles, " << numThreads << " threads" << std::endl;
+	std::cout << "Frame, front end ms, raster ms, total ms, triangles, lines, culled, tiles, steals:" << std::endl;
+	for (int r = 0; r < repeats; r++)
+	{
+		trace.rewind();
+		modelview = MatrixStack();
+		projection = MatrixStack();
+		current = &modelview;
+		normalMatrixValid = false;
+		resetState();
+		for (int frame = 0; ; frame++)
+		{
+			beginFrame();
+			auto start = std::chrono::high_resolution_clock::now();
+			int more = replayFrame();
+			auto binned = std::chrono::high_resolution_clock::now();
+			if (!more) break;
+			rasterizeFrame();
+			auto finished = std::chrono::high_resolution_clock::now();
+
+			stats.front = std::chrono::duration<double, std::milli>(binned - start).count();
+			stats.raster = std::chrono::duration<double, std::milli>(finished - binned).count();
+			stats.total = stats.front + stats.raster;
+			times.push_back(stats);
+			std::cout << frame << ", " << stats.front << ", " << stats.raster << ", " << stats.total << ", "
+				<< stats.triangles << ", " << stats.lines << ", " << stats.culled << ", " << stats.tiles << ", "
+				<< stats.steals << std::endl;
+			if (prefix && r == 0) writeFrame(prefix, frame);
+		}
+	}
+
+	if (!times.empty())
+	{
+		std::cout << times.size() << " frames rendered" << std::endl;
+		writeSummary("Front end", times, &FrameStats::front);
+		writeSummary("Raster", times, &FrameStats::raster);
+		writeSummary("Total", times, &FrameStats::total);
+	}
+	if (skippedText) std::cout << skippedText << " bitmap characters skipped" << std::endl;
+	delete pool;
+	return 0;
+}
@@ -0,0 +1,276 @@
+//////////////////////////////////////////////////////
+// sphereInBox1.h
+//
+// The sphere in the box of sphereInBox1.cpp as a demo unit (demoUnit.h): its
+// globals and routines, run by sphereInBox1.cpp and by the launcher.
+//////////////////////////////////////////////////////
+
+#ifndef SPHERE_IN_BOX1_H
+#define SPHERE_IN_BOX1_H
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "../Common/demoUnit.h"
+#include "../Common/vertexFormat.h"
+#include "../Common/sphereMesh.h"
+
+#define ONE_BY_ROOT_THREE 0.57735
+
+class SphereInBox1 : public DemoUnit
+{
+public:
+	void build(void);
+	void setup(void);
+	void destroy(void);
+	void drawScene(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+	void specialKeyInput(int key, int x, int y);
+	void printInteraction(void);
+	void buildSphere(void);
+	void buildBox(void);
+
+	// Begin globals.
+	int step = 0; // Steps in open/closing the box lid.
+	int isCompact = 0; // Draw from compact vertex formats?
+	int sphereSlices = 40; // Slices and stacks of the sphere.
+	CompactMesh boxSides, boxBottom, boxLid, sphere; // Compact meshes.
+
+	// Box vertex co-ordinate vectors. 
+	float vertices[24] =
+	{
+		1.0, -1.0, 1.0,
+		1.0, 1.0, 1.0,
+		1.0, 1.0, -1.0,
+		1.0, -1.0, -1.0,
+		-1.0, -1.0, 1.0,
+		-1.0, 1.0, 1.0,
+		-1.0, 1.0, -1.0,
+		-1.0, -1.0, -1.0
+	};
+
+	// Vertex indices of triangle strip going around the box, making the 
+	// front, right, back and left sides in that order (exactly similar
+	// to the triangle strip going around a square annulus in Ch. 3).
+	unsigned char stripIndices0[10] = { 5, 4, 1, 0, 2, 3, 6, 7, 5, 4 };
+	// { 5, 6, 4, 7, 0, 3, 1, 2 };
+
+	// Vertex indices of triangle strip making the bottom of the box.
+	unsigned char stripIndices1[4] = { 0, 4, 3, 7 };
+
+	// Vertex indices of triangle strip making the top of the box.
+	unsigned char stripIndices2[4] = { 6, 5, 2, 1 };
+
+	// Box vertex normal vectors = normalized unit vector pointing from origin to vertex.
+	float normals[24] =
+	{
+		ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+		ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+		ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+		ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+		-ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+		-ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE,
+		-ONE_BY_ROOT_THREE, ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE,
+		-ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE, -ONE_BY_ROOT_THREE
+	};
+	// End globals.
+};
+
+// Routine to build the compact sphere.
+inline void SphereInBox1::buildSphere(void)
+{
+	std::vector<float> positions;
+	std::vector<unsigned int> indices;
+
+	sphereMeshVertices(sphereSlices, sphereSlices, positions);
+	sphereMeshTriangles(sphereSlices, sphereSlices, indices);
+	sphere.build("sphere", positions.data(), positions.data(), (int)positions.size() / 3, indices.data(),
+		(int)indices.size(), GL_TRIANGLES);
+}
+
+// Routine to build the compact box, each strip a mesh of the eight vertices.
+inline void SphereInBox1::buildBox(void)
+{
+	unsigned int sides[10], bottom[4], lid[4];
+
+	for (int i = 0; i < 10; i++) sides[i] = stripIndices0[i];
+	for (int i = 0; i < 4; i++)
+	{
+		bottom[i] = stripIndices1[i];
+		lid[i] = stripIndices2[i];
+	}
+	boxSides.build("box sides", vertices, normals, 8, sides, 10, GL_TRIANGLE_STRIP);
+	boxBottom.build("box bottom", vertices, normals, 8, bottom, 4, GL_TRIANGLE_STRIP);
+	boxLid.build("box lid", vertices, normals, 8, lid, 4, GL_TRIANGLE_STRIP);
+}
+
+// Routine to build the compact meshes, once.
+inline void SphereInBox1::build(void)
+{
+	buildBox();
+	buildSphere();
+}
+
+// Initialization routine.
+inline void SphereInBox1::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+	glEnable(GL_DEPTH_TEST); // Enable depth testing.
+
+	// Turn on OpenGL lighting.
+	glEnable(GL_LIGHTING);
+
+	// Light property vectors.
+	float lightAmb[] = { 0.0, 0.0, 0.0, 1.0 };
+	float lightDifAndSpec[] = { 1.0, 1.0, 1.0, 1.0 };
+	float lightPos[] = { 0.0, 1.5, 3.0, 1.0 };
+	float globAmb[] = { 0.2, 0.2, 0.2, 1.0 };
+
+	// Light properties.
+	glLightfv(GL_LIGHT0, GL_AMBIENT, lightAmb);
+	glLightfv(GL_LIGHT0, GL_DIFFUSE, lightDifAndSpec);
+	glLightfv(GL_LIGHT0, GL_SPECULAR, lightDifAndSpec);
+	glLightfv(GL_LIGHT0, GL_POSITION, lightPos);
+
+	glEnable(GL_LIGHT0); // Enable particular light source.
+	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, globAmb); // Global ambient light.
+	glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE); // Enable two-sided lighting.
+	glLightModeli(GL_LIGHT_MODEL_LOCAL_VIEWER, GL_TRUE); // Enable local viewpoint.
+}
+
+// Routine to release the compact meshes.
+inline void SphereInBox1::destroy(void)
+{
+	boxSides.destroy();
+	boxBottom.destroy();
+	boxLid.destroy();
+	sphere.destroy();
+}
+
+// Drawing routine.
+inline void SphereInBox1::drawScene(void)
+{
+	// Material property vectors.
+	float matAmbAndDif1[] = { 0.9, 0.0, 0.0, 1.0 };
+	float matAmbAndDif2[] = { 0.0, 0.9, 0.0, 1.0 };
+	float matSpec[] = { 1.0, 1.0, 1.0, 1.0 };
+	float matShine[] = { 50.0 };
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glLoadIdentity();
+
+	PROFILE_PHASE("box");
+	// Position the box for viewing.
+	gluLookAt(0.0, 3.0, 3.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+
+	// Material properties of the box.
+	glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, matAmbAndDif1);
+	glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, matSpec);
+	glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, matShine);
+
+	// Enable two vertex arrays: position and normal.
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+
+	// Specify locations for the position and normal arrays.
+	glVertexPointer(3, GL_FLOAT, 0, vertices);
+	glNormalPointer(GL_FLOAT, 0, normals);
+
+	// Five sides of the box, excluding the top. The normal at each 
+	// vertex is along the line from the origin to that vertex.
+	if (isCompact)
+	{
+		boxSides.draw();
+		boxBottom.draw();
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLE_STRIP, 10, GL_UNSIGNED_BYTE, stripIndices0);
+		glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, stripIndices1);
+	}
+
+	// The rotated lid (top side) of the box. 
+	glPushMatrix();
+	glTranslatef(0.0, 1.0, -1.0);
+	glRotatef((float)step, -1.0, 0.0, 0.0);
+	glTranslatef(0.0, -1.0, 1.0);
+	if (isCompact) boxLid.draw();
+	else glDrawElements(GL_TRIANGLE_STRIP, 4, GL_UNSIGNED_BYTE, stripIndices2);
+	glPopMatrix();
+
+	PROFILE_PHASE("sphere");
+	// Material properties of the sphere (only the front is ever seen).
+	glMaterialfv(GL_FRONT, GL_AMBIENT_AND_DIFFUSE, matAmbAndDif2);
+
+	// Cull the back faces of the sphere.
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+
+	// Sphere.
+	if (isCompact) sphere.draw();
+	else glutSolidSphere(1.0, sphereSlices, sphereSlices);
+
+	glDisable(GL_CULL_FACE);
+
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// OpenGL window reshape routine.
+inline void SphereInBox1::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	gluPerspective(60.0, (float)w / (float)h, 1.0, 20.0);
+	glMatrixMode(GL_MODELVIEW);
+}
+
+// Keyboard input processing routine.
+inline void SphereInBox1::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	case 'c':
+		if (isCompact) isCompact = 0; else isCompact = 1;
+		glutPostRedisplay();
+		break;
+	case 'h':
+		if (sphereSlices == 40) sphereSlices = 400; else sphereSlices = 40;
+		buildSphere();
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Callback routine for non-ASCII key entry.
+inline void SphereInBox1::specialKeyInput(int key, int x, int y)
+{
+	demoInput();
+	if (key == GLUT_KEY_UP) if (step < 180) step++;;
+	if (key == GLUT_KEY_DOWN) if (step > 0) step--;;
+	glutPostRedisplay();
+}
+
+// Routine to output interaction instructions to the C++ window.
+inline void SphereInBox1::printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press up/down arrow keys to open/close the box." << std::endl
+		<< "Press c to toggle between float and compact vertex formats." << std::endl
+		<< "Press h to toggle a high-resolution sphere, 400 slices and stacks." << std::endl;
+}
+
+#endif
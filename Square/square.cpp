@@ -3,66 +3,26 @@
 //
 // OpenGL program to draw a square.
 // 
+// The square is drawn by the unit Square (square.h),
+// which the launcher runs too.
+//
 // Sumanta Guha.
 ///////////////////////////////////
 
 #include <GL/glew.h>
 #include <GL/freeglut.h> 
 
-// Drawing routine.
-void drawScene(void)
-{
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	glColor3f(0.0, 0.0, 0.0);
-
-	// Draw a polygon with specified vertices.
-	glBegin(GL_POLYGON);
-	glVertex3f(20.0, 20.0, 0.0);
-	glVertex3f(80.0, 20.0, 0.0);
-	glVertex3f(80.0, 80.0, 0.0);
-	glVertex3f(20.0, 80.0, 0.0);
-	glEnd();
+#define DEMO_GL_TRACE
+#include "../Common/demoHooks.h"
+#include "square.h"
 
-	glFlush();
-}
-
-// Initialization routine.
-void setup(void)
-{
-	glClearColor(1.0, 1.0, 1.0, 0.0);
-}
-
-// OpenGL window reshape routine.
-void resize(int w, int h)
-{
-	glViewport(0, 0, w, h);
-
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
-	
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-}
-
-// Keyboard input processing routine.
-void keyInput(unsigned char key, int x, int y)
-{
-	switch (key)
-	{
-	case 27:
-		exit(0);
-		break;
-	default:
-		break;
-	}
-}
+static Square square; // The demo.
 
 // Main routine.
 int main(int argc, char **argv)
 {
 	glutInit(&argc, argv);
+	demoInit(&argc, argv);
 
 	glutInitContextVersion(4, 3);
 	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
@@ -74,14 +34,9 @@ int main(int argc, char **argv)
 	
 	glutCreateWindow("square.cpp");
 	
-	glutDisplayFunc(drawScene);
-	glutReshapeFunc(resize);
-	glutKeyboardFunc(keyInput);
-
-	glewExperimental = GL_TRUE;
-	glewInit();
+	demoUnitCallbacks(&square);
 
-	setup();
+	demoSetup(&square);
 
 	glutMainLoop();
 }
\ No newline at end of file
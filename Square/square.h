@@ -0,0 +1,78 @@
+///////////////////////////////////
+// square.h
+//
+// The square of square.cpp as a demo unit (demoUnit.h): its routines, run by
+// square.cpp and by the launcher.
+///////////////////////////////////
+
+#ifndef SQUARE_H
+#define SQUARE_H
+
+#include "../Common/demoUnit.h"
+
+class Square : public DemoUnit
+{
+public:
+	void drawScene(void);
+	void setup(void);
+	void resize(int w, int h);
+	void keyInput(unsigned char key, int x, int y);
+};
+
+// Drawing routine.
+inline void Square::drawScene(void)
+{
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	glColor3f(0.0, 0.0, 0.0);
+
+	PROFILE_PHASE("square");
+	// Draw a polygon with specified vertices.
+	glBegin(GL_POLYGON);
+	glVertex3f(20.0, 20.0, 0.0);
+	glVertex3f(80.0, 20.0, 0.0);
+	glVertex3f(80.0, 80.0, 0.0);
+	glVertex3f(20.0, 80.0, 0.0);
+	glEnd();
+
+	PROFILE_PHASE("flush");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+inline void Square::setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+}
+
+// OpenGL window reshape routine.
+inline void Square::resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0.0, 100.0, 0.0, 100.0, -1.0, 1.0);
+	
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Keyboard input processing routine.
+inline void Square::keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		exit(0);
+		break;
+	default:
+		break;
+	}
+}
+
+#endif
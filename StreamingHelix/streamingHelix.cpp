@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////////
+// streamingHelix.cpp
+//
+// This program enhances rotatingHelixFPS.cpp to rebuild the helix every frame -
+// its radius ripples as it turns, so the vertices really change - and to send the
+// line strip to the GPU in one of three ways:
+//
+// immediate: glBegin()/glVertex3f()/glEnd() as in rotatingHelixFPS.cpp;
+// buffer data: the vertices are built in an array and copied by glBufferData() into
+//   a vertex buffer, orphaning the previous contents;
+// persistent: the vertices are written straight into a segment of the persistently
+//   mapped ring buffer of streamBuffer.h and drawn from there.
+//
+// The frames per second, the vertex count and, for the ring, the number of waits on
+// a fence are written to the C++ window every second.
+//
+// Interaction:
+// Press space to toggle between animation on and off.
+// Press m to cycle between immediate, buffer data and persistent streaming.
+// Press +/- to double/halve the number of vertices on the helix.
+////////////////////////////////////////////////////////////////////////////////////
+
+#define _USE_MATH_DEFINES
+
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#include "../Common/demoHooks.h"
+#include "../Common/streamBuffer.h"
+
+#define MAX_DETAIL 1024 // Largest number of vertices per step of rotatingHelixFPS.cpp.
+
+// Ways of streaming the vertices.
+enum Mode { IMMEDIATE, BUFFER_DATA, PERSISTENT, NUM_MODES };
+
+// Globals.
+static int isAnimate = 0; // Animated?
+static float angle = 0.0; // Angle of rotation.
+static int frameCount = 0; // Number of frames
+static int mode = PERSISTENT; // Streaming mode.
+static int detail = 1; // Vertices per step of pi/20 along the helix.
+static StreamBuffer ring; // Persistent ring buffer.
+static unsigned int dataBuffer; // Vertex buffer for glBufferData().
+static std::vector<float> vertices; // Vertex array for glBufferData().
+static const char *modeNames[NUM_MODES] = { "immediate", "buffer data", "persistent" };
+
+// Routine to count the vertices of the helix.
+int numVertices(void)
+{
+	return 400 * detail + 1;
+}
+
+// Routine to write the vertices of the rippling helix to v.
+void buildHelix(float *v)
+{
+	int n = numVertices();
+
+	for (int i = 0; i < n; i++)
+	{
+		float t = -10 * M_PI + i * (M_PI / 20.0) / detail;
+		float R = 20.0 + 2.0 * sin(3.0 * t + (M_PI / 180.0) * 4.0 * angle); // Radius of helix.
+		v[3 * i] = R * cos(t);
+		v[3 * i + 1] = t;
+		v[3 * i + 2] = R * sin(t) - 60.0;
+	}
+}
+
+// Routine to draw the helix line strip from the current array buffer at offset.
+void drawFromBuffer(unsigned int buffer, size_t offset)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glVertexPointer(3, GL_FLOAT, 0, (void *)offset);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glDrawArrays(GL_LINE_STRIP, 0, numVertices());
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Drawing routine.
+void drawScene(void)
+{
+	int n = numVertices();
+	size_t offset;
+
+	frameCount++; // Increment number of frames every redraw.
+
+	demoFrameBegin();
+
+	PROFILE_PHASE("clear");
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor3f(0.0, 0.0, 0.0);
+	glPushMatrix();
+
+	// The Trick: to align the axis of the helix along the y-axis prior to rotation
+	// and then return it to its original location.
+	glTranslatef(0.0, 0.0, -60.0);
+	glRotatef(angle, 0.0, 1.0, 0.0);
+	glTranslatef(0.0, 0.0, 60.0);
+
+	PROFILE_PHASE(modeNames[mode]);
+	switch (mode)
+	{
+	case IMMEDIATE:
+		vertices.resize(3 * n);
+		buildHelix(vertices.data());
+		glBegin(GL_LINE_STRIP);
+		for (int i = 0; i < n; i++) glVertex3fv(&vertices[3 * i]);
+		glEnd();
+		break;
+	case BUFFER_DATA:
+		vertices.resize(3 * n);
+		buildHelix(vertices.data());
+		glBindBuffer(GL_ARRAY_BUFFER, dataBuffer);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+		drawFromBuffer(dataBuffer, 0);
+		break;
+	case PERSISTENT:
+	{
+		ring.beginFrame();
+		float *v = (float *)ring.alloc(3 * n * sizeof(float), offset);
+		if (v)
+		{
+			buildHelix(v);
+			drawFromBuffer(ring.name(), offset);
+		}
+		ring.endFrame();
+		break;
+	}
+	}
+
+	glPopMatrix();
+	PROFILE_PHASE("swap");
+	demoFrameEnd();
+}
+
+// Initialization routine.
+void setup(void)
+{
+	glClearColor(1.0, 1.0, 1.0, 0.0);
+
+	glGenBuffers(1, &dataBuffer);
+	ring.init((400 * MAX_DETAIL + 1) * 3 * sizeof(float));
+}
+
+// OpenGL window reshape routine.
+void resize(int w, int h)
+{
+	glViewport(0, 0, w, h);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glFrustum(-5.0, 5.0, -5.0, 5.0, 5.0, 100.0);
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+}
+
+// Routine to increase the rotation angle.
+void increaseAngle(void)
+{
+	angle += 5.0;
+	if (angle > 360.0) angle -= 360.0;
+	glutPostRedisplay();
+}
+
+// Routine to count the number of frames drawn every second.
+void frameCounter(int value)
+{
+	if (value != 0) // No output the first time frameCounter() is called (from main()).
+	{
+		std::cout << "FPS = " << frameCount << ", " << modeNames[mode] << ", " << numVertices() << " vertices";
+		if (mode == PERSISTENT) std::cout << ", " << ring.numWaits << " fence waits (" << ring.waitMicros << " us)";
+		std::cout << std::endl;
+	}
+	frameCount = 0;
+	glutTimerFunc(1000, frameCounter, 1);
+}
+
+// Keyboard input processing routine.
+void keyInput(unsigned char key, int x, int y)
+{
+	demoInput();
+	switch (key)
+	{
+	case 27:
+		ring.destroy();
+		exit(0);
+		break;
+	case ' ':
+		if (isAnimate)
+		{
+			isAnimate = 0;
+			glutIdleFunc(NULL);
+		}
+		else
+		{
+			isAnimate = 1;
+			glutIdleFunc(increaseAngle);
+		}
+		break;
+	case 'm':
+		mode = (mode + 1) % NUM_MODES;
+		glutPostRedisplay();
+		break;
+	case '+':
+		if (detail < MAX_DETAIL) detail *= 2;
+		glutPostRedisplay();
+		break;
+	case '-':
+		if (detail > 1) detail /= 2;
+		glutPostRedisplay();
+		break;
+	default:
+		break;
+	}
+}
+
+// Routine to output interaction instructions to the C++ window.
+void printInteraction(void)
+{
+	std::cout << "Interaction:" << std::endl;
+	std::cout << "Press space to toggle between animation on and off." << std::endl
+		<< "Press m to cycle between immediate, buffer data and persistent streaming." << std::endl
+		<< "Press +/- to double/halve the number of vertices on the helix." << std::endl;
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	printInteraction();
+	glutInit(&argc, argv);
+	demoInit(&argc, argv);
+
+	glutInitContextVersion(4, 4);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
+	glutInitWindowSize(500, 500);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("streamingHelix.cpp");
+	glutDisplayFunc(drawScene);
+	glutReshapeFunc(resize);
+	glutKeyboardFunc(keyInput);
+	glutTimerFunc(0, frameCounter, 0); // Initial call of frameCounter().
+
+	demoSetup(setup);
+
+	glutMainLoop();
+}
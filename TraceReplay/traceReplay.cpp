@@ -0,0 +1,332 @@
+////////////////////////////////////////////////////////////////////////////////////
+// traceReplay.cpp
+//
+// This program replays a trace captured from a demo with glTrace.h, e.g.
+//
+//   hemisphere -capture hemisphere.trace 300
+//   traceReplay hemisphere.trace [-paced] [-repeat n]
+//
+// Every recorded call is issued again with its recorded arguments and data, frame
+// by frame, into a window of the size the demo's had. By default the frames are
+// replayed as fast as possible; with -paced each frame starts no earlier than it
+// did during capture. The trace is replayed n times (default 1).
+//
+// For every frame the CPU time to issue its calls, the GPU time (a GL_TIME_ELAPSED
+// query) and the wall time up to glFinish() are written to the C++ window, followed
+// by their minimum, mean, median and maximum over the replay.
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <GL/glew.h>
+#include <GL/freeglut.h>
+
+#define GL_TRACE_NO_HOOKS
+#include "../Common/glTrace.h"
+
+// Timing of one replayed frame, in milliseconds.
+struct FrameTime
+{
+	double cpu, gpu, wall;
+};
+
+// Globals.
+static TraceReader trace; // The trace.
+static TraceDraw draw; // The last glDrawElements(), its client arrays.
+
+// Routine to issue the calls of one frame, returning 0 at the end of the trace, else
+// setting the frame's capture time in microseconds.
+int replayFrame(unsigned long long &captureMicros)
+{
+	while (trace.more())
+	{
+		unsigned char op = trace.get<unsigned char>();
+		switch (op)
+		{
+		case TRACE_FRAME_END:
+		{
+			int swap = trace.get<unsigned char>();
+			captureMicros = trace.get<unsigned long long>();
+			if (swap) glutSwapBuffers(); else glFlush();
+			return 1;
+		}
+		case TRACE_BEGIN: glBegin(trace.get<unsigned int>()); break;
+		case TRACE_END: glEnd(); break;
+		case TRACE_VERTEX3F:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			glVertex3f(x, y, z);
+			break;
+		}
+		case TRACE_COLOR3F:
+		{
+			float r = trace.get<float>(), g = trace.get<float>(), b = trace.get<float>();
+			glColor3f(r, g, b);
+			break;
+		}
+		case TRACE_MATRIX_MODE: glMatrixMode(trace.get<unsigned int>()); break;
+		case TRACE_LOAD_IDENTITY: glLoadIdentity(); break;
+		case TRACE_PUSH_MATRIX: glPushMatrix(); break;
+		case TRACE_POP_MATRIX: glPopMatrix(); break;
+		case TRACE_TRANSLATEF:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			glTranslatef(x, y, z);
+			break;
+		}
+		case TRACE_ROTATEF:
+		{
+			float a = trace.get<float>(), x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			glRotatef(a, x, y, z);
+			break;
+		}
+		case TRACE_SCALEF:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			glScalef(x, y, z);
+			break;
+		}
+		case TRACE_FRUSTUM:
+		case TRACE_ORTHO:
+		{
+			double a[6];
+			for (int i = 0; i < 6; i++) a[i] = trace.get<double>();
+			if (op == TRACE_FRUSTUM) glFrustum(a[0], a[1], a[2], a[3], a[4], a[5]);
+			else glOrtho(a[0], a[1], a[2], a[3], a[4], a[5]);
+			break;
+		}
+		case TRACE_PERSPECTIVE:
+		{
+			double a[4];
+			for (int i = 0; i < 4; i++) a[i] = trace.get<double>();
+			gluPerspective(a[0], a[1], a[2], a[3]);
+			break;
+		}
+		case TRACE_LOOK_AT:
+		{
+			double a[9];
+			for (int i = 0; i < 9; i++) a[i] = trace.get<double>();
+			gluLookAt(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], a[8]);
+			break;
+		}
+		case TRACE_VIEWPORT:
+		{
+			int x = trace.get<int>(), y = trace.get<int>(), w = trace.get<int>(), h = trace.get<int>();
+			glViewport(x, y, w, h);
+			break;
+		}
+		case TRACE_CLEAR: glClear(trace.get<unsigned int>()); break;
+		case TRACE_CLEAR_COLOR:
+		{
+			float r = trace.get<float>(), g = trace.get<float>(), b = trace.get<float>(), a = trace.get<float>();
+			glClearColor(r, g, b, a);
+			break;
+		}
+		case TRACE_ENABLE: glEnable(trace.get<unsigned int>()); break;
+		case TRACE_DISABLE: glDisable(trace.get<unsigned int>()); break;
+		case TRACE_POLYGON_MODE:
+		{
+			unsigned int face = trace.get<unsigned int>(), mode = trace.get<unsigned int>();
+			glPolygonMode(face, mode);
+			break;
+		}
+		case TRACE_CULL_FACE: glCullFace(trace.get<unsigned int>()); break;
+		case TRACE_LINE_WIDTH: glLineWidth(trace.get<float>()); break;
+		case TRACE_LIGHTFV:
+		case TRACE_MATERIALFV:
+		{
+			unsigned int a = trace.get<unsigned int>(), pname = trace.get<unsigned int>();
+			float params[4];
+			if (!trace.getParams(pname, params)) break;
+			if (op == TRACE_LIGHTFV) glLightfv(a, pname, params); else glMaterialfv(a, pname, params);
+			break;
+		}
+		case TRACE_LIGHTF:
+		{
+			unsigned int light = trace.get<unsigned int>(), pname = trace.get<unsigned int>();
+			glLightf(light, pname, trace.get<float>());
+			break;
+		}
+		case TRACE_LIGHT_MODELFV:
+		{
+			unsigned int pname = trace.get<unsigned int>();
+			float params[4];
+			if (!trace.getParams(pname, params)) break;
+			glLightModelfv(pname, params);
+			break;
+		}
+		case TRACE_LIGHT_MODELI:
+		{
+			unsigned int pname = trace.get<unsigned int>();
+			glLightModeli(pname, trace.get<int>());
+			break;
+		}
+		case TRACE_RASTER_POS3F:
+		{
+			float x = trace.get<float>(), y = trace.get<float>(), z = trace.get<float>();
+			glRasterPos3f(x, y, z);
+			break;
+		}
+		case TRACE_BITMAP_CHARACTER:
+		{
+			int font = trace.get<int>();
+			glutBitmapCharacter(traceFont(font), trace.get<int>());
+			break;
+		}
+		case TRACE_WIRE_SPHERE:
+		case TRACE_SOLID_SPHERE:
+		{
+			double radius = trace.get<double>();
+			int slices = trace.get<int>(), stacks = trace.get<int>();
+			if (op == TRACE_WIRE_SPHERE) glutWireSphere(radius, slices, stacks);
+			else glutSolidSphere(radius, slices, stacks);
+			break;
+		}
+		case TRACE_WIRE_CUBE: glutWireCube(trace.get<double>()); break;
+		case TRACE_WIRE_CONE:
+		case TRACE_WIRE_TORUS:
+		{
+			double a = trace.get<double>(), b = trace.get<double>();
+			int c = trace.get<int>(), d = trace.get<int>();
+			if (op == TRACE_WIRE_CONE) glutWireCone(a, b, c, d); else glutWireTorus(a, b, c, d);
+			break;
+		}
+		case TRACE_ENABLE_CLIENT_STATE: glEnableClientState(trace.get<unsigned int>()); break;
+		case TRACE_DISABLE_CLIENT_STATE: glDisableClientState(trace.get<unsigned int>()); break;
+		case TRACE_DRAW_ELEMENTS:
+			if (!trace.getDraw(draw)) break;
+			for (int k = 0; k < 3; k++)
+			{
+				if (!draw.sizes[k]) continue;
+				if (k == 0) glVertexPointer(draw.sizes[k], GL_FLOAT, 0, draw.arrays[k].data());
+				else if (k == 1) glNormalPointer(GL_FLOAT, 0, draw.arrays[k].data());
+				else glColorPointer(draw.sizes[k], GL_FLOAT, 0, draw.arrays[k].data());
+			}
+			glDrawElements(draw.mode, draw.count, draw.type, draw.indices.data());
+			break;
+		default:
+			std::cout << "Unknown opcode " << (int)op << " at byte " << trace.pos - 1 << std::endl;
+			exit(1);
+		}
+	}
+	if (!trace.ok)
+	{
+		std::cout << "Corrupt trace at byte " << trace.badPos << std::endl;
+		exit(1);
+	}
+	return 0;
+}
+
+// Routine to write the minimum, mean, median and maximum of one column of the timings.
+void writeSummary(const char *name, std::vector<FrameTime> &times, double FrameTime::*column)
+{
+	std::vector<double> v;
+	double sum = 0.0;
+
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		v.push_back(times[i].*column);
+		sum += v.back();
+	}
+	std::sort(v.begin(), v.end());
+	std::cout << name << " ms: min " << v.front() << ", mean " << sum / v.size() << ", median "
+		<< v[v.size() / 2] << ", max " << v.back() << std::endl;
+}
+
+// Drawing routine; replay happens in main().
+void drawScene(void)
+{
+}
+
+// Main routine.
+int main(int argc, char **argv)
+{
+	int isPaced = 0, repeats = 1;
+	const char *path = NULL;
+	unsigned int query;
+	std::vector<FrameTime> times;
+
+	glutInit(&argc, argv);
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "-paced")) isPaced = 1;
+		else if (!strcmp(argv[i], "-repeat") && i + 1 < argc) repeats = atoi(argv[++i]);
+		else path = argv[i];
+	}
+	if (!path)
+	{
+		std::cout << "Usage: traceReplay trace [-paced] [-repeat n]" << std::endl;
+		return 1;
+	}
+	if (!trace.load(path))
+	{
+		std::cout << "Could not read trace " << path << std::endl;
+		return 1;
+	}
+
+	glutInitContextVersion(4, 3);
+	glutInitContextProfile(GLUT_COMPATIBILITY_PROFILE);
+
+	glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_STENCIL);
+	glutInitWindowSize(trace.width, trace.height);
+	glutInitWindowPosition(100, 100);
+	glutCreateWindow("traceReplay.cpp");
+	glutDisplayFunc(drawScene);
+
+	glewExperimental = GL_TRUE;
+	glewInit();
+
+	glGenQueries(1, &query);
+	glutMainLoopEvent(); // Show the window.
+
+	std::cout << path << ": " << trace.numFrames << " frames, " << trace.data.size() << " bytes, "
+		<< (isPaced ? "original pacing" : "as fast as possible") << std::endl;
+	std::cout << "Frame, CPU ms, GPU ms, wall ms:" << std::endl;
+	for (int r = 0; r < repeats; r++)
+	{
+		unsigned long long captureMicros, firstMicros = 0;
+		auto replayStart = std::chrono::high_resolution_clock::now();
+		trace.rewind();
+		for (int frame = 0; ; frame++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			glBeginQuery(GL_TIME_ELAPSED, query);
+			int more = replayFrame(captureMicros);
+			glEndQuery(GL_TIME_ELAPSED);
+			auto issued = std::chrono::high_resolution_clock::now();
+			glFinish();
+			auto finished = std::chrono::high_resolution_clock::now();
+			if (!more) break;
+
+			GLuint64 gpuTime;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &gpuTime);
+			FrameTime t = { std::chrono::duration<double, std::milli>(issued - start).count(), gpuTime * 1.0e-6,
+				std::chrono::duration<double, std::milli>(finished - start).count() };
+			times.push_back(t);
+			std::cout << frame << ", " << t.cpu << ", " << t.gpu << ", " << t.wall << std::endl;
+
+			glutMainLoopEvent();
+
+			// Wait for the next frame's original start.
+			if (frame == 0) firstMicros = captureMicros;
+			if (isPaced)
+				std::this_thread::sleep_until(replayStart + std::chrono::microseconds(captureMicros - firstMicros));
+		}
+	}
+
+	if (!times.empty())
+	{
+		std::cout << times.size() << " frames replayed" << std::endl;
+		writeSummary("CPU", times, &FrameTime::cpu);
+		writeSummary("GPU", times, &FrameTime::gpu);
+		writeSummary("Wall", times, &FrameTime::wall);
+	}
+	return 0;
+}